@@ -0,0 +1,146 @@
+# Copyright 2020 Greg Tucker
+#
+# This file is part of brille.
+#
+# brille is free software: you can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option)
+# any later version.
+#
+# brille is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+# or FITNESS FOR A PARTICULAR PURPOSE.
+#
+# See the GNU Affero General Public License for more details.
+# You should have received a copy of the GNU Affero General Public License
+# along with brille. If not, see <https://www.gnu.org/licenses/>.
+"""
+Share one filled interpolator between worker processes.
+
+A built and filled interpolator is published once, into a POSIX shared-memory
+segment or a file, and any number of processes attach to it. Attaching does
+not rebuild anything and does not copy the interpolation data -- the
+eigenvalues and eigenvectors held by every attached object reference the one
+shared copy. Only the (comparatively small) geometry is copied per process.
+
+    handle = publish(trellis)            # in the parent
+    pool.map(work, [handle]*n)           # the handle is small and picklable
+    trellis = attach(handle)             # in each worker
+    ...
+    unpublish(handle)                    # in the parent, once workers finish
+
+Attached objects are read-only views; refilling one replaces its data with a
+private copy and leaves the shared copy untouched.
+
+POSIX shared memory needs Python 3.8 or later; with older versions objects are
+always published to a (temporary, unless given) file.
+"""
+import mmap
+import os
+import sys
+import tempfile
+from collections import namedtuple
+try:
+    from multiprocessing import shared_memory
+except ImportError:  # Python < 3.8
+    shared_memory = None
+
+import brille as br
+
+Handle = namedtuple('Handle', ('cls', 'name', 'size', 'path'))
+Handle.__doc__ = """A picklable reference to a published interpolator.
+
+cls : the name of the brille class which was published
+name : the shared-memory segment name, or None if published to a file
+size : the number of bytes used by the published interpolator
+path : the file the interpolator was published to, or None
+"""
+
+# Segments created by this process, kept open until `unpublish`
+_published = {}
+# Temporary files created by this process in place of segments
+_published_files = set()
+
+
+def publish(obj, path=None):
+    """Publish a filled interpolator for other processes to attach to.
+
+    Parameters
+    ----------
+    obj : BZTrellisQ, BZNestQ, BZMeshQ, or BZGridQ (any data type variant)
+        The interpolator, which should already be filled.
+    path : str, optional
+        Write to this file, for use with a file-backed mmap, instead of a new
+        POSIX shared-memory segment. Without shared-memory support a temporary
+        file is used if no path is given.
+
+    Returns
+    -------
+    Handle
+        A picklable reference to pass to `attach`.
+    """
+    size = obj.serialized_size
+    cls = type(obj).__name__
+    if path is None and shared_memory is None:
+        fd, path = tempfile.mkstemp(prefix='brille-', suffix='.bin')
+        os.close(fd)
+        _published_files.add(path)
+    if path is not None:
+        with open(path, 'w+b') as file:
+            file.truncate(size)
+            with mmap.mmap(file.fileno(), size) as mem:
+                obj.to_buffer(mem)
+        return Handle(cls, None, size, path)
+    shm = shared_memory.SharedMemory(create=True, size=size)
+    obj.to_buffer(shm.buf[:size])
+    _published[shm.name] = shm
+    return Handle(cls, shm.name, size, None)
+
+
+def attach(handle):
+    """Attach to a published interpolator without copying its data.
+
+    The shared segment or mapped file is kept open for as long as the returned
+    object exists.
+    """
+    cls = getattr(br, handle.cls)
+    if handle.path is not None:
+        with open(handle.path, 'rb') as file:
+            mem = mmap.mmap(file.fileno(), 0, access=mmap.ACCESS_READ)
+        obj = cls.from_buffer(mem, copy=False)
+        obj._shared_mmap = mem
+        return obj
+    shm = _attach_segment(handle.name)
+    obj = cls.from_buffer(shm.buf[:handle.size], copy=False)
+    obj._shared_memory = shm
+    return obj
+
+
+def unpublish(handle):
+    """Release and remove a segment published by this process.
+
+    Processes which are still attached keep their mapping until they exit.
+    Files are left in place, to be removed by the caller, unless they were
+    created by `publish` in place of a shared-memory segment.
+    """
+    if handle.path in _published_files:
+        _published_files.discard(handle.path)
+        os.remove(handle.path)
+    shm = _published.pop(handle.name, None) if handle.name else None
+    if shm is not None:
+        shm.close()
+        shm.unlink()
+
+
+def _attach_segment(name):
+    if sys.version_info >= (3, 13):
+        return shared_memory.SharedMemory(name=name, track=False)
+    shm = shared_memory.SharedMemory(name=name)
+    # Before Python 3.13 attaching registers the segment with this process's
+    # resource tracker, which would remove it when this process exits.
+    try:
+        from multiprocessing import resource_tracker
+        resource_tracker.unregister(shm._name, 'shared_memory')
+    except (ImportError, AttributeError, KeyError):
+        pass
+    return shm
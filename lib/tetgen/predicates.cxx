@@ -122,6 +122,7 @@
 #include <math.h>
 #ifdef CPU86
 #include <float.h>
+#include <mutex>
 #endif /* CPU86 */
 #ifdef LINUX
 #include <fpu_control.h>
@@ -388,14 +389,16 @@ static REAL isperrboundA, isperrboundB, isperrboundC;
 
 // Options to choose types of geometric computtaions.
 // Added by H. Si, 2012-08-23.
-static int  _use_inexact_arith; // -X option.
-static int  _use_static_filter; // Default option, disable it by -X1
+// The options and static filters belong to one tetrahedralization, so they
+// are kept per thread to let several threads run tetgen at the same time.
+static thread_local int  _use_inexact_arith; // -X option.
+static thread_local int  _use_static_filter; // Default option, disable it by -X1
 
 // Static filters for orient3d() and insphere().
 // They are pre-calcualted and set in exactinit().
 // Added by H. Si, 2012-08-23.
-static REAL o3dstaticfilter;
-static REAL ispstaticfilter;
+static thread_local REAL o3dstaticfilter;
+static thread_local REAL ispstaticfilter;
 
 
 
@@ -543,52 +546,27 @@ int test_double(int verbose)
 /*  Don't change this routine unless you fully understand it.                */
 /*                                                                           */
 /*****************************************************************************/
-static int previous_cword;
-void exactinit(int verbose, int noexact, int nofilter, REAL maxx, REAL maxy,
-               REAL maxz)
+static thread_local int previous_cword;
+/*****************************************************************************/
+/*                                                                           */
+/*  exactinitconstants()   Compute `epsilon', `splitter' and the error       */
+/*                         bounds. They depend only on the machine, so are   */
+/*                         computed once no matter how often, or from how    */
+/*                         many threads, this is called.                     */
+/*                                                                           */
+/*****************************************************************************/
+static std::once_flag exactconstants_once;
+void exactinitconstants()
 {
+  std::call_once(exactconstants_once, [](){
   REAL half;
   REAL check, lastcheck;
   int every_other;
-#ifdef LINUX
-  int cword;
-#endif /* LINUX */
 
-#ifdef CPU86
-#ifdef SINGLE
-  _control87(_PC_24, _MCW_PC); /* Set FPU control word for single precision. */
-#else /* not SINGLE */
-  _control87(_PC_53, _MCW_PC); /* Set FPU control word for double precision. */
-#endif /* not SINGLE */
-#endif /* CPU86 */
-#ifdef LINUX
-  _FPU_GETCW(previous_cword);
 #ifdef SINGLE
-  /*  cword = 4223; */
-  cword = 4210;                 /* set FPU control word for single precision */
-#else /* not SINGLE */
-  /*  cword = 4735; */
-  cword = 4722;                 /* set FPU control word for double precision */
-#endif /* not SINGLE */
-  _FPU_SETCW(cword);
-#endif /* LINUX */
-
-  if (verbose) {
-    printf("  Initializing robust predicates.\n");
-  }
-
-#ifdef USE_CGAL_PREDICATES
-  if (cgal_pred_obj.Has_static_filters) {
-    printf("  Use static filter.\n");
-  } else {
-    printf("  No static filter.\n");
-  }
-#endif // USE_CGAL_PREDICATES
-
-#ifdef SINGLE
-  test_float(verbose);
+  test_float(0);
 #else
-  test_double(verbose);
+  test_double(0);
 #endif
 
   every_other = 1;
@@ -625,6 +603,55 @@ void exactinit(int verbose, int noexact, int nofilter, REAL maxx, REAL maxy,
   isperrboundA = (16.0 + 224.0 * epsilon) * epsilon;
   isperrboundB = (5.0 + 72.0 * epsilon) * epsilon;
   isperrboundC = (71.0 + 1408.0 * epsilon) * epsilon * epsilon;
+  });
+}
+
+void exactinit(int verbose, int noexact, int nofilter, REAL maxx, REAL maxy,
+               REAL maxz)
+{
+  REAL half;
+#ifdef LINUX
+  int cword;
+#endif /* LINUX */
+
+#ifdef CPU86
+#ifdef SINGLE
+  _control87(_PC_24, _MCW_PC); /* Set FPU control word for single precision. */
+#else /* not SINGLE */
+  _control87(_PC_53, _MCW_PC); /* Set FPU control word for double precision. */
+#endif /* not SINGLE */
+#endif /* CPU86 */
+#ifdef LINUX
+  _FPU_GETCW(previous_cword);
+#ifdef SINGLE
+  /*  cword = 4223; */
+  cword = 4210;                 /* set FPU control word for single precision */
+#else /* not SINGLE */
+  /*  cword = 4735; */
+  cword = 4722;                 /* set FPU control word for double precision */
+#endif /* not SINGLE */
+  _FPU_SETCW(cword);
+#endif /* LINUX */
+
+  if (verbose) {
+    printf("  Initializing robust predicates.\n");
+  }
+
+#ifdef USE_CGAL_PREDICATES
+  if (cgal_pred_obj.Has_static_filters) {
+    printf("  Use static filter.\n");
+  } else {
+    printf("  No static filter.\n");
+  }
+#endif // USE_CGAL_PREDICATES
+
+#ifdef SINGLE
+  if (verbose) test_float(verbose);
+#else
+  if (verbose) test_double(verbose);
+#endif
+
+  exactinitconstants();
 
   // Set TetGen options.  Added by H. Si, 2012-08-23.
   _use_inexact_arith = noexact;
@@ -4612,7 +4612,10 @@ void tetgenmesh::initializepools()
     printf("  tetrahedron per block: %d.\n", b->tetrahedraperblock);
   }
 
-  inittables();
+  // The tables are shared by all meshes, which may be built concurrently, and
+  //   never change once filled.
+  static std::once_flag tables_once;
+  std::call_once(tables_once, [this](){ inittables(); });
 
   // There are three input point lists available, which are in, addin,
   //   and bgm->in. These point lists may have different number of
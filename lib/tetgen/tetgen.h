@@ -42,6 +42,7 @@
 // TetGen only uses the C standard library.
 #include <stdexcept>
 #include <string>
+#include <mutex>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -829,6 +830,7 @@ public:
 //                                                                           //
 ///////////////////////////////////////////////////////////////////////////////
 
+void exactinitconstants();
 void exactinit(int, int, int, REAL, REAL, REAL);
 void exactdeinit();
 REAL orient3d(REAL *pa, REAL *pb, REAL *pc, REAL *pd);
@@ -2342,7 +2344,7 @@ public:
   }
 };
 
-static selfint_event sevent;
+static thread_local selfint_event sevent; // per thread, as tetgen may run on several
 
 inline void terminatetetgen(tetgenmesh *m, int x)
 {
@@ -74,6 +74,61 @@ typedef struct{
   bool aorb;    //!< does "a" hold more Vector(/Scalar) elements
 } AVSizeInfo;
 
+/*! \brief A non-owning view of one or more arrays held elsewhere
+
+  An ArrayVectorView holds a pointer to the first element of its first array,
+  the number of elements per array, the number of arrays, and the number of
+  elements between the start of consecutive arrays. It provides the read
+  access methods of ArrayVector without allocating or copying, so that, e.g.,
+  a single array can be passed to per-point routines in a tight loop.
+  The viewed memory must outlive the view.
+*/
+template<typename T> class ArrayVectorView{
+  T* _data;       //!< A pointer to the first element of the first viewed array
+  size_t M;       //!< The number of elements within each array
+  size_t N;       //!< The number of viewed arrays
+  size_t _stride; //!< The number of elements between consecutive arrays
+public:
+  ArrayVectorView(): _data(nullptr), M(0), N(0), _stride(0) {}
+  /*! View n arrays of m elements separated by s elements starting at d
+      @note all four values are required to avoid ambiguity with, e.g.,
+            the ArrayVector(m,n) constructor in brace initialisation.
+  */
+  ArrayVectorView(T* d, size_t m, size_t n, size_t s):
+    _data(d), M(m), N(n), _stride(s) {}
+  //! View all arrays of an ArrayVector
+  ArrayVectorView(const ArrayVector<T>& av):
+    _data(av.size() && av.numel() ? av.data() : nullptr),
+    M(av.numel()), N(av.size()), _stride(av.numel()) {}
+  //! Return the number of arrays
+  size_t size() const {return N;}
+  //! Return the number of elements in each array
+  size_t numel() const {return M;}
+  //! Return the number of elements between consecutive arrays
+  size_t stride() const {return _stride;}
+  //! Return the pointer to the ith array's jth element
+  T* data(const size_t i=0, const size_t j=0) const {return _data + i*_stride + j;}
+  //! Return the value of the ith array's jth element
+  T getvalue(const size_t i=0, const size_t j=0) const {return _data[i*_stride + j];}
+  //! Return a view of the ith array
+  ArrayVectorView<T> view(const size_t i) const {
+    if (i >= N) throw std::out_of_range("Attempting to view out of bounds array");
+    return ArrayVectorView<T>(this->data(i), M, 1u, _stride);
+  }
+  //! Return a std::string containing the ith array
+  std::string to_string(const size_t i) const {
+    std::string out;
+    for (size_t j=0; j<M; ++j) out += my_to_string(this->getvalue(i,j)) + " ";
+    return out;
+  }
+  //! Return a std::string containing all viewed arrays
+  std::string to_string() const {
+    std::string out;
+    for (size_t i=0; i<N; ++i) out += this->to_string(i) + "\n";
+    return out;
+  }
+};
+
 /**********************************************************
  * The ArrayVector class is intended to hold a continuous *
  * block of equal-length vector-like arrays. Within this  *
@@ -88,6 +143,7 @@ protected:
   size_t M; //!< The number of elements within each array
   size_t N; //!< The number of arrays in the ArrayVector
   T* _data;  //!< A pointer to the first element of the contiguous memory _data block
+  bool _borrowed{false}; //!< true if `_data` is owned by someone else, see `borrow`
 public:
   /*! Standard ArrayVector constructor
       @param m the number of elements within each array
@@ -213,6 +269,46 @@ public:
       if (d) for(size_t i=0; i<m*n; i++) _data[i] = static_cast<T>(d[i]);
     }
   }
+  /*! Move constructor
+      @param vec another ArrayVector whose data block is taken by the new object
+      @note `vec` is left empty
+  */
+  ArrayVector(ArrayVector<T>&& vec) noexcept: M(vec.M), N(vec.N), _data(vec._data), _borrowed(vec._borrowed){
+    vec.M = 0;
+    vec.N = 0;
+    vec._data = nullptr;
+    vec._borrowed = false;
+  }
+  /*! \brief Construct an ArrayVector which references existing memory
+
+  No data is copied and the memory is not freed by the ArrayVector, so the
+  caller must keep the n*m row-ordered block at d alive for the lifetime of
+  the returned object (and any object it is moved into). Copies own their
+  data as usual, and any operation which reallocates the block – e.g.,
+  `resize` – swaps the reference for an owned copy. Element-wise writes, and
+  assignment from an equally-sized ArrayVector, modify the referenced memory.
+
+  @param d a pointer to the first element of a contiguous n*m block
+  @param m the number of elements within each array
+  @param n the number of arrays
+  */
+  static ArrayVector<T> borrow(T* d, const size_t m, const size_t n){
+    ArrayVector<T> out;
+    out.M = m;
+    out.N = n;
+    out._data = (m && n) ? d : nullptr;
+    out._borrowed = m && n;
+    return out;
+  }
+  //! Whether the data block is referenced rather than owned
+  bool is_borrowed() const {return _borrowed;}
+  //! Copy the arrays of a (possibly strided) ArrayVectorView into a new ArrayVector
+  explicit ArrayVector(const ArrayVectorView<T>& view): M(view.numel()), N(view.size()), _data(nullptr){
+    if (M && N){
+      _data = new T[M*N]();
+      for (size_t i=0; i<N; ++i) for (size_t j=0; j<M; ++j) _data[i*M+j] = view.getvalue(i,j);
+    }
+  }
   // Assignment operator
   ArrayVector<T>& operator=(const ArrayVector<T>& other){
     if ( this != &other ){ // avoid self-assignment
@@ -228,6 +324,21 @@ public:
     }
     return *this;
   }
+  // Move assignment operator
+  ArrayVector<T>& operator=(ArrayVector<T>&& other) noexcept {
+    if ( this != &other ){
+      if (M && N && !_borrowed) delete[] _data;
+      M = other.M;
+      N = other.N;
+      _data = other._data;
+      _borrowed = other._borrowed;
+      other.M = 0;
+      other.N = 0;
+      other._data = nullptr;
+      other._borrowed = false;
+    }
+    return *this;
+  }
   //! Accessor for single-arrays -- preforms a memory copy
   ArrayVector<T> operator[](const size_t i) const{
     bool isok = i < this->size();
@@ -238,7 +349,7 @@ public:
     return out;
   }
   //! Custom deconstructor to deallocate heap memory
-  ~ArrayVector() { if (M && N) delete[] _data; };
+  ~ArrayVector() { if (M && N && !_borrowed) delete[] _data; };
   //! Return the number of arrays
   size_t size() const {return N;};
   //! Return the number of elements in each array
@@ -253,6 +364,13 @@ public:
   ArrayVector<T> extract(const size_t i=0) const ;
   //! Return the first `num` arrays of the ArrayVector
   ArrayVector<T> first(const size_t num) const;
+  //! Return a non-owning view of all arrays
+  ArrayVectorView<T> view() const {return ArrayVectorView<T>(*this);}
+  //! Return a non-owning view of the ith array -- with bounds checking
+  ArrayVectorView<T> view(const size_t i) const {
+    if (i >= this->size()) throw std::out_of_range("Attempting to view out of bounds ArrayVector");
+    return ArrayVectorView<T>(this->data(i), this->numel(), 1u, this->numel());
+  }
   /*! Return a collection of arrays from the ArrayVector
     @param n the number of arrays to return
     @param i a pointer to the first index of the n arrays to return
@@ -523,7 +641,8 @@ public:
             if ( j < from || j > last)
               newdata[i*remaining_elements + idx++] = this->_data[i*this->N + j];
          }
-         delete[] this->_data; //before we loose its pointer
+         if (!this->_borrowed) delete[] this->_data; //before we loose its pointer
+         this->_borrowed = false;
          this->M = remaining_elements;
          this->_data = newdata;
          return 0;
@@ -545,7 +664,8 @@ public:
       for (j=0; j<this->M; ++j) newdata[i*newM+j] = this->_data[i*this->M+j];
       for (j=this->M; j<newM; ++j)  newdata[i*newM+j] = valtoadd;
     }
-    delete[] this->_data;
+    if (this->N && this->M && !this->_borrowed) delete[] this->_data;
+    this->_borrowed = false;
     this->M = newM;
     this->_data = newdata;
     return 0;
@@ -586,6 +706,7 @@ public:
 
 #include "arrayvector_operators.tpp"
 #include "arrayvector.tpp"
+#include "arrayvector_expression.tpp"
 
 
 #endif
@@ -279,8 +279,9 @@ template<typename T> size_t ArrayVector<T>::resize(size_t newsize){
     size_t smallerN = (this->size() < newsize) ? this->size() : newsize;
     for (size_t i=0; i<smallerN*this->numel(); i++) newdata[i] = this->_data[i];
     // hand-back the chunk of memory which _data points to
-    delete[] this->_data;
+    if (!this->_borrowed) delete[] this->_data;
   }
+  this->_borrowed = false;
   // and set _data to the newdata pointer;
   this->N = newsize;
   if (std) this->_data = newdata;
@@ -288,7 +289,8 @@ template<typename T> size_t ArrayVector<T>::resize(size_t newsize){
 }
 template<typename T> size_t ArrayVector<T>::refresh(size_t newnumel, size_t newsize){
   // first off, remove the old _data block, if it exists
-  if (this->size() && this->numel())  delete[] this->_data;
+  if (this->size() && this->numel() && !this->_borrowed)  delete[] this->_data;
+  this->_borrowed = false;
   bool std = (newsize*newnumel)>0;
   T * newdata = nullptr;
   // allocate a new block of memory
@@ -400,60 +402,62 @@ template<typename T> bool ArrayVector<T>::all_approx(const T val, const size_t n
     if (!_approx_scalar(this->getvalue(i,j), val, u,Tt,Rt)) return false;
   return true;
 }
-template<typename T> bool ArrayVector<T>::none_approx(const T val, const size_t n) const{
-  size_t upto = (n>0 && n<=this->size()) ? n : this->size();
+template<class G, class T> bool arrayvector_none_approx(const G& a, const T val, const size_t upto){
   bool c, u;
   T Tt, Rt;
   std::tie(c,u,Tt,Rt) = determine_tols<T,T>();
   for (size_t i=0; i<upto; ++i)
-  for (size_t j=0; j<this->numel(); ++j)
-  if (_approx_scalar(this->getvalue(i,j), val,u,Tt,Rt)) return false;
+  for (size_t j=0; j<a.numel(); ++j)
+  if (_approx_scalar(a.getvalue(i,j), val,u,Tt,Rt)) return false;
   return true;
 }
-template<typename T> bool ArrayVector<T>::all_approx(const Comp expr, const T val, const size_t n) const{
+template<typename T> bool ArrayVector<T>::none_approx(const T val, const size_t n) const{
   size_t upto = (n>0 && n<=this->size()) ? n : this->size();
+  return arrayvector_none_approx(*this, val, upto);
+}
+template<class G, class T> bool arrayvector_all_approx(const G& a, const Comp expr, const T val, const size_t upto){
   bool c, u;
   T Tt, Rt;
   std::tie(c,u,Tt,Rt) = determine_tols<T,T>();
   switch (expr){
     case Comp::lt:{
-    for (size_t i=0; i<upto; ++i) for (size_t j=0; j<this->numel(); ++j)
-    if (_approx_scalar(this->getvalue(i,j), val, u,Tt,Rt) || this->getvalue(i,j) > val) return false;
+    for (size_t i=0; i<upto; ++i) for (size_t j=0; j<a.numel(); ++j)
+    if (_approx_scalar(a.getvalue(i,j), val, u,Tt,Rt) || a.getvalue(i,j) > val) return false;
     return true;}
     case Comp::gt:{
-    for (size_t i=0; i<upto; ++i) for (size_t j=0; j<this->numel(); ++j)
-    if (_approx_scalar(this->getvalue(i,j), val, u,Tt,Rt) || this->getvalue(i,j) < val) return false;
+    for (size_t i=0; i<upto; ++i) for (size_t j=0; j<a.numel(); ++j)
+    if (_approx_scalar(a.getvalue(i,j), val, u,Tt,Rt) || a.getvalue(i,j) < val) return false;
     return true;}
     case Comp::le:{
-    for (size_t i=0; i<upto; ++i) for (size_t j=0; j<this->numel(); ++j)
-    if (!_approx_scalar(this->getvalue(i,j), val, u,Tt,Rt) && this->getvalue(i,j) > val) return false;
+    for (size_t i=0; i<upto; ++i) for (size_t j=0; j<a.numel(); ++j)
+    if (!_approx_scalar(a.getvalue(i,j), val, u,Tt,Rt) && a.getvalue(i,j) > val) return false;
     return true;}
     case Comp::ge:{
-    for (size_t i=0; i<upto; ++i) for (size_t j=0; j<this->numel(); ++j)
-    if (!_approx_scalar(this->getvalue(i,j), val, u,Tt,Rt) && this->getvalue(i,j) < val) return false;
+    for (size_t i=0; i<upto; ++i) for (size_t j=0; j<a.numel(); ++j)
+    if (!_approx_scalar(a.getvalue(i,j), val, u,Tt,Rt) && a.getvalue(i,j) < val) return false;
     return true;}
     case Comp::nle:{
     size_t n_approx=0, n_more=0;
-    for (size_t i=0; i<upto; ++i) for (size_t j=0; j<this->numel(); ++j)
-    if (_approx_scalar(this->getvalue(i,j), val, u,Tt,Rt)) ++n_approx;
-    else if (this->getvalue(i,j) > val)  ++n_more;
+    for (size_t i=0; i<upto; ++i) for (size_t j=0; j<a.numel(); ++j)
+    if (_approx_scalar(a.getvalue(i,j), val, u,Tt,Rt)) ++n_approx;
+    else if (a.getvalue(i,j) > val)  ++n_more;
     return (n_more > 0 || n_approx==upto);}
     case Comp::nge:{
     size_t n_approx=0, n_less=0;
-    for (size_t i=0; i<upto; ++i) for (size_t j=0; j<this->numel(); ++j)
-    if (_approx_scalar(this->getvalue(i,j), val, u,Tt,Rt)) ++n_approx;
-    else if (this->getvalue(i,j) < val)  ++n_less;
+    for (size_t i=0; i<upto; ++i) for (size_t j=0; j<a.numel(); ++j)
+    if (_approx_scalar(a.getvalue(i,j), val, u,Tt,Rt)) ++n_approx;
+    else if (a.getvalue(i,j) < val)  ++n_less;
     return (n_less > 0 || n_approx==upto);}
     case Comp::eq:{
-    for (size_t i=0; i<upto; ++i) for (size_t j=0; j<this->numel(); ++j)
-    if (!_approx_scalar(this->getvalue(i,j), val, u,Tt,Rt)) return false;
+    for (size_t i=0; i<upto; ++i) for (size_t j=0; j<a.numel(); ++j)
+    if (!_approx_scalar(a.getvalue(i,j), val, u,Tt,Rt)) return false;
     return true;
     case Comp::le_ge:
     bool allle=true, allge=true, ijneq;
-    for (size_t i=0; i<upto; ++i) for (size_t j=0; j<this->numel(); ++j){
-      ijneq = !_approx_scalar(this->getvalue(i,j), val, u,Tt,Rt);
-      if (allle && ijneq && this->getvalue(i,j) > val) allle = false;
-      if (allge && ijneq && this->getvalue(i,j) < val) allge = false;
+    for (size_t i=0; i<upto; ++i) for (size_t j=0; j<a.numel(); ++j){
+      ijneq = !_approx_scalar(a.getvalue(i,j), val, u,Tt,Rt);
+      if (allle && ijneq && a.getvalue(i,j) > val) allle = false;
+      if (allge && ijneq && a.getvalue(i,j) < val) allge = false;
       if (!(allle||allge)) return false;
     }
     return true;}
@@ -463,31 +467,34 @@ template<typename T> bool ArrayVector<T>::all_approx(const Comp expr, const T va
     throw std::runtime_error(msg);
   }
 }
-template<typename T> bool ArrayVector<T>::any_approx(const Comp expr, const T val, const size_t n) const{
+template<typename T> bool ArrayVector<T>::all_approx(const Comp expr, const T val, const size_t n) const{
   size_t upto = (n>0 && n<=this->size()) ? n : this->size();
+  return arrayvector_all_approx(*this, expr, val, upto);
+}
+template<class G, class T> bool arrayvector_any_approx(const G& a, const Comp expr, const T val, const size_t upto){
   bool c, u;
   T Tt, Rt;
   std::tie(c,u,Tt,Rt) = determine_tols<T,T>();
   switch(expr){
     case Comp::lt:
-    for (size_t i=0; i<upto; ++i) for (size_t j=0; j<this->numel(); ++j)
-    if (!_approx_scalar(this->getvalue(i,j), val, u, Tt, Rt) && this->getvalue(i,j) < val) return true;
+    for (size_t i=0; i<upto; ++i) for (size_t j=0; j<a.numel(); ++j)
+    if (!_approx_scalar(a.getvalue(i,j), val, u, Tt, Rt) && a.getvalue(i,j) < val) return true;
     break;
     case Comp::gt:
-    for (size_t i=0; i<upto; ++i) for (size_t j=0; j<this->numel(); ++j)
-    if (!_approx_scalar(this->getvalue(i,j), val, u, Tt, Rt) && this->getvalue(i,j) > val) return true;
+    for (size_t i=0; i<upto; ++i) for (size_t j=0; j<a.numel(); ++j)
+    if (!_approx_scalar(a.getvalue(i,j), val, u, Tt, Rt) && a.getvalue(i,j) > val) return true;
     break;
     case Comp::le:
-    for (size_t i=0; i<upto; ++i) for (size_t j=0; j<this->numel(); ++j)
-    if (_approx_scalar(this->getvalue(i,j), val, u, Tt, Rt) || this->getvalue(i,j) < val) return true;
+    for (size_t i=0; i<upto; ++i) for (size_t j=0; j<a.numel(); ++j)
+    if (_approx_scalar(a.getvalue(i,j), val, u, Tt, Rt) || a.getvalue(i,j) < val) return true;
     break;
     case Comp::ge:
-    for (size_t i=0; i<upto; ++i) for (size_t j=0; j<this->numel(); ++j)
-    if (_approx_scalar(this->getvalue(i,j), val, u, Tt, Rt) || this->getvalue(i,j) < val) return true;
+    for (size_t i=0; i<upto; ++i) for (size_t j=0; j<a.numel(); ++j)
+    if (_approx_scalar(a.getvalue(i,j), val, u, Tt, Rt) || a.getvalue(i,j) < val) return true;
     break;
     case Comp::eq:
-    for (size_t i=0; i<upto; ++i) for (size_t j=0; j<this->numel(); ++j)
-    if (_approx_scalar(this->getvalue(i,j), val, u, Tt, Rt)) return true;
+    for (size_t i=0; i<upto; ++i) for (size_t j=0; j<a.numel(); ++j)
+    if (_approx_scalar(a.getvalue(i,j), val, u, Tt, Rt)) return true;
     break;
     default:
     std::string msg = __PRETTY_FUNCTION__;
@@ -496,53 +503,56 @@ template<typename T> bool ArrayVector<T>::any_approx(const Comp expr, const T va
   }
   return false;
 }
-template<typename T> ArrayVector<bool> ArrayVector<T>::is_approx(const Comp expr, const T val, const size_t n) const{
+template<typename T> bool ArrayVector<T>::any_approx(const Comp expr, const T val, const size_t n) const{
   size_t upto = (n>0 && n<=this->size()) ? n : this->size();
-  ArrayVector<bool> out(1u, this->size());
-  for (size_t i=0; i<this->size(); ++i) out.insert(false, i);
+  return arrayvector_any_approx(*this, expr, val, upto);
+}
+template<class G, class T> ArrayVector<bool> arrayvector_is_approx(const G& a, const Comp expr, const T val, const size_t upto){
+  ArrayVector<bool> out(1u, a.size());
+  for (size_t i=0; i<a.size(); ++i) out.insert(false, i);
   bool onearray, c, u;
   T Tt, Rt;
   std::tie(c,u,Tt,Rt) = determine_tols<T,T>();
   switch (expr){
     case Comp::lt: for (size_t i=0; i<upto; ++i){
       onearray = true;
-      for (size_t j=0; j<this->numel(); ++j)
-      if (_approx_scalar(this->getvalue(i,j), val, u,Tt,Rt) || this->getvalue(i,j) > val)
+      for (size_t j=0; j<a.numel(); ++j)
+      if (_approx_scalar(a.getvalue(i,j), val, u,Tt,Rt) || a.getvalue(i,j) > val)
         onearray = false;
       out.insert(onearray, i);
     } break;
     case Comp::gt: for (size_t i=0; i<upto; ++i){
       onearray = true;
-      for (size_t j=0; j<this->numel(); ++j)
-      if (_approx_scalar(this->getvalue(i,j), val, u,Tt,Rt) || this->getvalue(i,j) < val)
+      for (size_t j=0; j<a.numel(); ++j)
+      if (_approx_scalar(a.getvalue(i,j), val, u,Tt,Rt) || a.getvalue(i,j) < val)
         onearray = false;
       out.insert(onearray, i);
     } break;
     case Comp::le: for (size_t i=0; i<upto; ++i){
       onearray = true;
-      for (size_t j=0; j<this->numel(); ++j)
-      if (!_approx_scalar(this->getvalue(i,j), val, u,Tt,Rt) && this->getvalue(i,j) > val)
+      for (size_t j=0; j<a.numel(); ++j)
+      if (!_approx_scalar(a.getvalue(i,j), val, u,Tt,Rt) && a.getvalue(i,j) > val)
         onearray = false;
       out.insert(onearray, i);
     } break;
     case Comp::ge: for (size_t i=0; i<upto; ++i){
       onearray = true;
-      for (size_t j=0; j<this->numel(); ++j)
-      if (!_approx_scalar(this->getvalue(i,j), val, u,Tt,Rt) && this->getvalue(i,j) < val)
+      for (size_t j=0; j<a.numel(); ++j)
+      if (!_approx_scalar(a.getvalue(i,j), val, u,Tt,Rt) && a.getvalue(i,j) < val)
         onearray = false;
       out.insert(onearray, i);
     } break;
     case Comp::eq: for (size_t i=0; i<upto; ++i){
       onearray = true;
-      for (size_t j=0; j<this->numel(); ++j)
-      if (!_approx_scalar(this->getvalue(i,j), val, u,Tt,Rt))
+      for (size_t j=0; j<a.numel(); ++j)
+      if (!_approx_scalar(a.getvalue(i,j), val, u,Tt,Rt))
         onearray = false;
       out.insert(onearray, i);
     } break;
     case Comp::neq: for (size_t i=0; i<upto; ++i){
       onearray = true;
-      for (size_t j=0; j<this->numel(); ++j)
-      if (_approx_scalar(this->getvalue(i,j), val, u,Tt,Rt))
+      for (size_t j=0; j<a.numel(); ++j)
+      if (_approx_scalar(a.getvalue(i,j), val, u,Tt,Rt))
         onearray = false;
       out.insert(onearray, i);
     } break;
@@ -553,6 +563,10 @@ template<typename T> ArrayVector<bool> ArrayVector<T>::is_approx(const Comp expr
   }
   return out;
 }
+template<typename T> ArrayVector<bool> ArrayVector<T>::is_approx(const Comp expr, const T val, const size_t n) const{
+  size_t upto = (n>0 && n<=this->size()) ? n : this->size();
+  return arrayvector_is_approx(*this, expr, val, upto);
+}
 template<typename T> ArrayVector<bool> ArrayVector<T>::is_approx(const Comp expr, const std::vector<T>& vals) const{
   size_t n = vals.size();
   size_t upto = (n>0 && n<=this->size()) ? n : this->size();
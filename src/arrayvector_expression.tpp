@@ -0,0 +1,225 @@
+/* Copyright 2020 Greg Tucker
+//
+// This file is part of brille.
+//
+// brille is free software: you can redistribute it and/or modify it under the
+// terms of the GNU Affero General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// brille is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with brille. If not, see <https://www.gnu.org/licenses/>.            */
+
+/*------------------------------------------------------------------------------
+|                 Lazily-evaluated ArrayVector expressions                     |
+|------------------------------------------------------------------------------|
+|  Expressions like `dot(normals, x - points).all_approx(Comp::le, 0.)`        |
+|  allocate a new ArrayVector for every intermediate result. Wrapping the      |
+|  first operand with `lazy` instead produces expression objects which only    |
+|  record the operation to be performed; the element-wise work is then done in |
+|  a single fused loop when the expression is reduced, compared, or converted  |
+|  to an ArrayVector, e.g.,                                                    |
+|      dot(normals, lazy(x.view(i)) - points).all_approx(Comp::le, 0.)        |
+|  allocates nothing at all.                                                   |
+|                                                                              |
+|  Expressions hold references to the ArrayVector data they were built from,  |
+|  so they must be consumed before that data is modified or goes out of scope.|
+|  Single-array and single-element (scalar) operands are broadcast following  |
+|  the same rules as the eager ArrayVector operators.                          |
+|-----------------------------------------------------------------------------*/
+
+/*! \brief CRTP base for lazily-evaluated ArrayVector expressions
+
+Every expression provides `size()`, `numel()`, and `getvalue(i,j)`. This base
+adds evaluation into a new ArrayVector and the approximate comparisons used
+to consume expressions without evaluating them.
+*/
+template<class E> class ArrayVectorExpression{
+public:
+  const E& expression() const {return static_cast<const E&>(*this);}
+  //! Evaluate the expression in one loop, storing the result in a new ArrayVector
+  auto eval() const {
+    const E& e = this->expression();
+    ArrayVector<typename E::value_type> out(e.numel(), e.size());
+    for (size_t i=0; i<e.size(); ++i) for (size_t j=0; j<e.numel(); ++j)
+      out.insert(e.getvalue(i,j), i, j);
+    return out;
+  }
+  //! Implicit conversion to an ArrayVector for existing interfaces
+  template<class S> operator ArrayVector<S>() const {
+    const E& e = this->expression();
+    ArrayVector<S> out(e.numel(), e.size());
+    for (size_t i=0; i<e.size(); ++i) for (size_t j=0; j<e.numel(); ++j)
+      out.insert(static_cast<S>(e.getvalue(i,j)), i, j);
+    return out;
+  }
+  template<class T> bool all_approx(const Comp expr, const T val) const {
+    return arrayvector_all_approx(this->expression(), expr, val, this->expression().size());
+  }
+  template<class T> bool any_approx(const Comp expr, const T val) const {
+    return arrayvector_any_approx(this->expression(), expr, val, this->expression().size());
+  }
+  template<class T> bool none_approx(const T val) const {
+    return arrayvector_none_approx(this->expression(), val, this->expression().size());
+  }
+  template<class T> ArrayVector<bool> is_approx(const Comp expr, const T val) const {
+    return arrayvector_is_approx(this->expression(), expr, val, this->expression().size());
+  }
+};
+
+//! Determine if a type is a lazy ArrayVector expression
+template<class E> struct is_arrayvector_expression: std::is_base_of<ArrayVectorExpression<E>, E> {};
+
+/*! \brief An ArrayVector expression leaf referencing existing data
+
+Constructed from an ArrayVector (or any subclass) or an ArrayVectorView.
+No data is copied.
+*/
+template<class T> class ArrayVectorTerminal: public ArrayVectorExpression<ArrayVectorTerminal<T>>{
+  const T* data_;
+  size_t m_;
+  size_t n_;
+  size_t stride_;
+public:
+  typedef T value_type;
+  ArrayVectorTerminal(const ArrayVector<T>& a):
+    data_(a.size() && a.numel() ? a.data() : nullptr), m_(a.numel()), n_(a.size()), stride_(a.numel()) {}
+  ArrayVectorTerminal(const ArrayVectorView<T>& a):
+    data_(a.size() && a.numel() ? a.data() : nullptr), m_(a.numel()), n_(a.size()), stride_(a.stride()) {}
+  size_t size() const {return n_;}
+  size_t numel() const {return m_;}
+  T getvalue(const size_t i, const size_t j) const {return data_[i*stride_+j];}
+};
+
+/*! \brief A scalar broadcast to every element of an ArrayVector expression */
+template<class T> class ArrayVectorScalar: public ArrayVectorExpression<ArrayVectorScalar<T>>{
+  T value_;
+public:
+  typedef T value_type;
+  ArrayVectorScalar(const T v): value_(v) {}
+  size_t size() const {return 1u;}
+  size_t numel() const {return 1u;}
+  T getvalue(const size_t, const size_t) const {return value_;}
+};
+
+//! The element-wise operations available to lazy ArrayVector expressions
+struct ArrayVectorPlus  { template<class A, class B> static auto apply(const A a, const B b) {return a+b;} };
+struct ArrayVectorMinus { template<class A, class B> static auto apply(const A a, const B b) {return a-b;} };
+struct ArrayVectorTimes { template<class A, class B> static auto apply(const A a, const B b) {return a*b;} };
+struct ArrayVectorDivide{ template<class A, class B> static auto apply(const A a, const B b) {return a/b;} };
+
+/*! \brief A lazy element-wise binary operation between two expressions
+
+The operands are held by value; terminals are a pointer and three sizes, so
+copying them is cheap.
+*/
+template<class Op, class L, class R> class ArrayVectorBinary: public ArrayVectorExpression<ArrayVectorBinary<Op,L,R>>{
+  L l_;
+  R r_;
+  size_t n_;
+  size_t m_;
+public:
+  typedef typename std::common_type<typename L::value_type, typename R::value_type>::type value_type;
+  ArrayVectorBinary(const L& l, const R& r): l_(l), r_(r) {
+    if (l.numel()!=r.numel() && l.numel()!=1u && r.numel()!=1u)
+      throw std::runtime_error("binary operation(a,b) requires a.numel()==b.numel() or one numel()==1");
+    if (l.size()!=r.size() && l.size()!=1u && r.size()!=1u)
+      throw std::runtime_error("binary operation(a,b) requires a.size()==b.size() or one size()==1");
+    n_ = l.size()==1u ? r.size() : l.size();
+    m_ = l.numel()==1u ? r.numel() : l.numel();
+  }
+  size_t size() const {return n_;}
+  size_t numel() const {return m_;}
+  value_type getvalue(const size_t i, const size_t j) const {
+    return Op::apply(
+      l_.getvalue(l_.size()==1u ? 0 : i, l_.numel()==1u ? 0 : j),
+      r_.getvalue(r_.size()==1u ? 0 : i, r_.numel()==1u ? 0 : j));
+  }
+};
+
+/*! \brief A lazy row-wise dot product of two expressions, with numel()==1 */
+template<class L, class R> class ArrayVectorDot: public ArrayVectorExpression<ArrayVectorDot<L,R>>{
+  L l_;
+  R r_;
+  size_t n_;
+public:
+  typedef typename std::common_type<typename L::value_type, typename R::value_type>::type value_type;
+  ArrayVectorDot(const L& l, const R& r): l_(l), r_(r) {
+    if (l.numel()!=r.numel())
+      throw std::runtime_error("ArrayVector dot requires equal numel()");
+    if (l.size()!=r.size() && l.size()!=1u && r.size()!=1u)
+      throw std::runtime_error("ArrayVector dot requires a.size()==b.size() or one size()==1");
+    n_ = l.size()==1u ? r.size() : l.size();
+  }
+  size_t size() const {return n_;}
+  size_t numel() const {return 1u;}
+  value_type getvalue(const size_t i, const size_t) const {
+    size_t li = l_.size()==1u ? 0 : i, ri = r_.size()==1u ? 0 : i;
+    value_type d{0};
+    for (size_t j=0; j<l_.numel(); ++j) d += l_.getvalue(li,j)*r_.getvalue(ri,j);
+    return d;
+  }
+};
+
+/*! \brief A lazy row-wise Euclidean norm of an expression, with numel()==1 */
+template<class E> class ArrayVectorNorm: public ArrayVectorExpression<ArrayVectorNorm<E>>{
+  E e_;
+public:
+  typedef double value_type;
+  ArrayVectorNorm(const E& e): e_(e) {}
+  size_t size() const {return e_.size();}
+  size_t numel() const {return 1u;}
+  double getvalue(const size_t i, const size_t) const {
+    double d{0};
+    for (size_t j=0; j<e_.numel(); ++j) d += static_cast<double>(e_.getvalue(i,j)*e_.getvalue(i,j));
+    return std::sqrt(d);
+  }
+};
+
+//! Start a lazy expression from an ArrayVector or one of its subclasses
+template<class T> ArrayVectorTerminal<T> lazy(const ArrayVector<T>& a){ return ArrayVectorTerminal<T>(a); }
+//! Start a lazy expression from an ArrayVectorView
+template<class T> ArrayVectorTerminal<T> lazy(const ArrayVectorView<T>& a){ return ArrayVectorTerminal<T>(a); }
+
+// Promote any operand of a lazy expression to an expression
+template<class E> const E& as_arrayvector_expression(const ArrayVectorExpression<E>& e){ return e.expression(); }
+template<class T> ArrayVectorTerminal<T> as_arrayvector_expression(const ArrayVector<T>& a){ return ArrayVectorTerminal<T>(a); }
+template<class T> ArrayVectorTerminal<T> as_arrayvector_expression(const ArrayVectorView<T>& a){ return ArrayVectorTerminal<T>(a); }
+template<class T, typename=typename std::enable_if<std::is_arithmetic<T>::value>::type>
+ArrayVectorScalar<T> as_arrayvector_expression(const T a){ return ArrayVectorScalar<T>(a); }
+
+template<class T> using arrayvector_expression_t = typename std::decay<decltype(as_arrayvector_expression(std::declval<const T&>()))>::type;
+
+// At least one operand must already be a lazy expression, so that the eager
+// ArrayVector operators are unaffected.
+#define LAZY_ARRAYVECTOR_OPERATOR(X,OP) \
+template<class A, class B, typename=typename std::enable_if<is_arrayvector_expression<A>::value||is_arrayvector_expression<B>::value>::type> \
+ArrayVectorBinary<OP, arrayvector_expression_t<A>, arrayvector_expression_t<B>> operator X (const A& a, const B& b){ \
+  return ArrayVectorBinary<OP, arrayvector_expression_t<A>, arrayvector_expression_t<B>>(as_arrayvector_expression(a), as_arrayvector_expression(b)); \
+}
+LAZY_ARRAYVECTOR_OPERATOR(+,ArrayVectorPlus)
+LAZY_ARRAYVECTOR_OPERATOR(-,ArrayVectorMinus)
+LAZY_ARRAYVECTOR_OPERATOR(*,ArrayVectorTimes)
+LAZY_ARRAYVECTOR_OPERATOR(/,ArrayVectorDivide)
+#undef LAZY_ARRAYVECTOR_OPERATOR
+
+/*! \brief Lazy row-wise dot product where one or both operands are expressions
+
+Lattice vectors carry a metric which a plain expression does not, so they are
+excluded here; see the LatVec overload in latvec.tpp.
+*/
+template<class A, class B, typename=typename std::enable_if<
+  (is_arrayvector_expression<A>::value||is_arrayvector_expression<B>::value)
+  && !std::is_base_of<LatVec,A>::value && !std::is_base_of<LatVec,B>::value>::type>
+ArrayVectorDot<arrayvector_expression_t<A>, arrayvector_expression_t<B>> dot(const A& a, const B& b){
+  return ArrayVectorDot<arrayvector_expression_t<A>, arrayvector_expression_t<B>>(as_arrayvector_expression(a), as_arrayvector_expression(b));
+}
+//! Lazy row-wise Euclidean norm of an expression
+template<class E> ArrayVectorNorm<E> norm(const ArrayVectorExpression<E>& e){
+  return ArrayVectorNorm<E>(e.expression());
+}
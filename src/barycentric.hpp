@@ -0,0 +1,133 @@
+/* Copyright 2020 Greg Tucker
+//
+// This file is part of brille.
+//
+// brille is free software: you can redistribute it and/or modify it under the
+// terms of the GNU Affero General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// brille is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with brille. If not, see <https://www.gnu.org/licenses/>.            */
+
+#ifndef _BARYCENTRIC_H_
+#define _BARYCENTRIC_H_
+#include <array>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include "predicates.hpp"
+
+/*! \brief The barycentric weights of a point in a tetrahedron via `orient3d`
+
+Each weight is the signed volume of the tetrahedron with one vertex replaced
+by x, relative to the tetrahedron volume. This requires four (filtered)
+`orient3d` calls.
+
+@param a the first tetrahedron vertex
+@param b the second tetrahedron vertex
+@param c the third tetrahedron vertex
+@param d the fourth tetrahedron vertex
+@param x the point
+@param vol6 six times the (positive) volume of the tetrahedron
+@param[out] w the barycentric weights of x
+*/
+inline void orient3d_weights(const double* a, const double* b, const double* c,
+  const double* d, const double* x, const double vol6, std::array<double,4>& w
+){
+  w[0] = orient3d_filtered(x, b, c, d)/vol6;
+  w[1] = orient3d_filtered(a, x, c, d)/vol6;
+  w[2] = orient3d_filtered(a, b, x, d)/vol6;
+  w[3] = orient3d_filtered(a, b, c, x)/vol6;
+}
+
+/*! \brief A precomputed transformation to tetrahedron barycentric coordinates
+
+For a tetrahedron with vertices (a, b, c, d) the barycentric weights of a
+point x satisfy x - a = [b-a, c-a, d-a] (w₁, w₂, w₃)ᵀ and w₀ = 1 - w₁ - w₂ - w₃.
+Storing the first vertex and the inverse of the 3×3 edge matrix turns finding
+the weights into one matrix-vector product, instead of four `orient3d` calls.
+
+The product is not exact, so a weight within a guard band of zero – whose
+width is set by the conditioning of the edge matrix – can not be trusted to
+have the right sign. In that case, and for degenerate tetrahedra, `weights`
+reports that the exact `orient3d_weights` must be used instead.
+
+Each transform occupies `sizeof(BarycentricTransform)` (112) bytes, compared to
+the 32 bytes of vertex indices and 32 bytes of circumsphere information stored
+for every tetrahedron, so precomputing them roughly doubles the tetrahedral
+storage of a Nest or PolyhedronTrellis. Both can be constructed without them,
+and then use `orient3d_weights` for every point-in-tetrahedron test.
+*/
+class BarycentricTransform{
+  std::array<double,3> origin_;
+  std::array<double,9> inverse_; //!< row-ordered inverse of the edge matrix
+  double guard_;                  //!< the weight magnitude below which the sign is uncertain
+  bool valid_;
+public:
+  BarycentricTransform(): origin_({{0,0,0}}), inverse_({{0,0,0,0,0,0,0,0,0}}), guard_(0), valid_(false) {}
+  BarycentricTransform(const double* a, const double* b, const double* c, const double* d)
+  : origin_({{a[0],a[1],a[2]}}), guard_(0), valid_(false) {
+    // the edge matrix has columns b-a, c-a, d-a
+    std::array<double,9> m;
+    for (int i=0; i<3; ++i){
+      m[3*i  ] = b[i]-a[i];
+      m[3*i+1] = c[i]-a[i];
+      m[3*i+2] = d[i]-a[i];
+    }
+    double det = m[0]*(m[4]*m[8]-m[5]*m[7]) - m[1]*(m[3]*m[8]-m[5]*m[6]) + m[2]*(m[3]*m[7]-m[4]*m[6]);
+    double norm_m{0}, norm_i{0};
+    for (int i=0; i<3; ++i) norm_m = std::max(norm_m, std::abs(m[3*i])+std::abs(m[3*i+1])+std::abs(m[3*i+2]));
+    if (!(std::abs(det) > std::numeric_limits<double>::epsilon()*norm_m*norm_m*norm_m)) return;
+    inverse_[0] = (m[4]*m[8]-m[5]*m[7])/det;
+    inverse_[1] = (m[2]*m[7]-m[1]*m[8])/det;
+    inverse_[2] = (m[1]*m[5]-m[2]*m[4])/det;
+    inverse_[3] = (m[5]*m[6]-m[3]*m[8])/det;
+    inverse_[4] = (m[0]*m[8]-m[2]*m[6])/det;
+    inverse_[5] = (m[2]*m[3]-m[0]*m[5])/det;
+    inverse_[6] = (m[3]*m[7]-m[4]*m[6])/det;
+    inverse_[7] = (m[1]*m[6]-m[0]*m[7])/det;
+    inverse_[8] = (m[0]*m[4]-m[1]*m[3])/det;
+    for (int i=0; i<3; ++i) norm_i = std::max(norm_i, std::abs(inverse_[3*i])+std::abs(inverse_[3*i+1])+std::abs(inverse_[3*i+2]));
+    // a generous multiple of the rounding error expected for this conditioning
+    guard_ = 1024*std::numeric_limits<double>::epsilon()*norm_m*norm_i;
+    valid_ = true;
+  }
+  bool valid() const {return valid_;}
+  /*! \brief Find the barycentric weights of a point
+
+  @param x the point
+  @param[out] w the barycentric weights of x
+  @returns true if the sign of every weight is certain, otherwise w should be
+           recalculated by `orient3d_weights`
+  */
+  bool weights(const double* x, std::array<double,4>& w) const {
+    if (!valid_) return false;
+    double r[3]{x[0]-origin_[0], x[1]-origin_[1], x[2]-origin_[2]};
+    w[0] = 1;
+    for (int i=0; i<3; ++i){
+      w[i+1] = inverse_[3*i]*r[0] + inverse_[3*i+1]*r[1] + inverse_[3*i+2]*r[2];
+      w[0] -= w[i+1];
+    }
+    return std::none_of(w.begin(), w.end(), [this](double z){return std::abs(z) < guard_;});
+  }
+};
+
+/*! \brief The barycentric weights of a point in a tetrahedron
+
+Uses the precomputed transform if it can determine the weight signs, and
+`orient3d` otherwise.
+*/
+inline void barycentric_weights(const BarycentricTransform& t,
+  const double* a, const double* b, const double* c, const double* d,
+  const double* x, const double vol6, std::array<double,4>& w
+){
+  if (!t.weights(x, w)) orient3d_weights(a, b, c, d, x, vol6, w);
+}
+
+#endif
@@ -23,6 +23,7 @@
 
 #include "symmetry.hpp"
 #include "utilities.hpp"
+#include "serialize.hpp"
 
 class Basis{
 public:
@@ -101,6 +102,21 @@ public:
             + std::to_string(positions_[i][2])  + " )\n";
     return repr;
   }
+  //! Write the atom positions and types to a BinaryWriter
+  void serialize(BinaryWriter& w) const {
+    w.write(positions_);
+    w.write(types_);
+  }
+  //! Read a Basis written by `serialize`
+  static Basis deserialize(BinaryReader& r){
+    std::vector<point> pos;
+    std::vector<index> typ;
+    r.read(pos);
+    r.read(typ);
+    if (pos.size() != typ.size())
+      throw std::runtime_error("Serialized Basis positions and types differ in number");
+    return Basis(pos, typ);
+  }
 };
 
 
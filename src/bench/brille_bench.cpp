@@ -0,0 +1,356 @@
+/* Copyright 2020 Greg Tucker
+//
+// This file is part of brille.
+//
+// brille is free software: you can redistribute it and/or modify it under the
+// terms of the GNU Affero General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// brille is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with brille. If not, see <https://www.gnu.org/licenses/>.            */
+
+/*! \file
+\brief Microbenchmarks of the construction and query paths of brille
+
+Synthetic fixtures -- cubic, hexagonal and monoclinic lattices, a range of
+interpolator densities and of branch counts per point -- are built and queried
+at one or more thread counts. Convex hulls are built by quickhull and, for
+Brillouin zone sized inputs, by the previous exhaustive plane search. Every
+timing is written as one JSON record so that runs can be compared to find
+regressions or to check parallel scaling.
+The records go to a file, since some construction steps report to stdout:
+
+    brille_bench --threads=1,2,4,8 --output=bench.json
+
+Run `brille_bench --help` for the available options.
+*/
+#include <omp.h>
+#include <algorithm>
+#include <chrono>
+#include <complex>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "bz_trellis.hpp"
+#include "bz_nest.hpp"
+#include "bz_mesh.hpp"
+#include "bz_grid.hpp"
+
+using vec_t = std::complex<double>;
+using Trellis = BrillouinZoneTrellis3<double,vec_t>;
+using NestQ = BrillouinZoneNest3<double,vec_t>;
+using MeshQ = BrillouinZoneMesh3<double,vec_t>;
+using GridQ = BrillouinZoneGrid3<double,vec_t>;
+
+// The convex hull found by the exhaustive plane search used before quickhull
+class PlaneSearchPolyhedron: public Polyhedron {
+public:
+  PlaneSearchPolyhedron(const ArrayVector<double>& v): Polyhedron() {
+    this->vertices = v;
+    this->keep_unique_vertices();
+    this->find_convex_hull_planes();
+    this->find_all_faces_per_vertex();
+    this->polygon_vertices_per_face();
+    this->purge_central_polygon_vertices();
+    this->sort_polygons();
+    this->purge_extra_vertices();
+  }
+};
+
+//! The options controlling which cases are run
+struct Options{
+  std::vector<int> threads;
+  std::vector<std::string> lattices{"cubic", "hexagonal", "monoclinic"};
+  std::vector<size_t> densities{100, 1000, 10000}; //!< tetrahedra per irreducible Brillouin zone
+  std::vector<size_t> branches{1, 12, 120, 500};
+  size_t query_density{1000};    //!< the density at which queries are timed
+  size_t points{10000};          //!< the number of Q points per query
+  size_t sort_max_branches{120}; //!< sorting larger payloads takes minutes
+  int repeats{5};
+  std::string output{"brille_bench.json"};
+};
+
+//! One timed case, written as a JSON record
+struct Record{
+  std::string stage;
+  std::string structure;
+  std::string lattice;
+  size_t density;
+  size_t size;     //!< the number of interpolation points of the structure, or vertices of a hull
+  size_t branches;
+  size_t points;   //!< the number of Q points queried
+  int threads;
+  std::vector<double> seconds;
+};
+
+static std::vector<double> time_repeats(const int repeats, const bool warm_up, const std::function<void()>& f){
+  if (warm_up) f();
+  std::vector<double> seconds;
+  for (int i=0; i<repeats; ++i){
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto stop = std::chrono::steady_clock::now();
+    seconds.push_back(std::chrono::duration<double>(stop - start).count());
+  }
+  return seconds;
+}
+
+static std::string json_record(const Record& r){
+  std::vector<double> s = r.seconds;
+  std::sort(s.begin(), s.end());
+  double mean = std::accumulate(s.begin(), s.end(), 0.)/static_cast<double>(s.size());
+  double median = s.size() % 2 ? s[s.size()/2] : (s[s.size()/2-1] + s[s.size()/2])/2;
+  std::ostringstream o;
+  o.precision(9);
+  o << "{\"stage\": \"" << r.stage << "\", \"structure\": \"" << r.structure
+    << "\", \"lattice\": \"" << r.lattice << "\", \"density\": " << r.density
+    << ", \"size\": " << r.size << ", \"branches\": " << r.branches
+    << ", \"points\": " << r.points << ", \"threads\": " << r.threads
+    << ", \"repeats\": " << s.size() << ", \"min_s\": " << s.front()
+    << ", \"median_s\": " << median << ", \"mean_s\": " << mean
+    << ", \"max_s\": " << s.back() << "}";
+  return o.str();
+}
+
+class Bench{
+  Options opt_;
+  std::vector<Record> records_;
+public:
+  Bench(const Options& opt): opt_(opt) {}
+  void run(){
+    for (const auto& name: opt_.lattices) this->run_lattice(name);
+  }
+  void write(std::ostream& os) const {
+    os << "{\n  \"benchmark\": \"brille_bench\",\n  \"max_threads\": " << omp_get_max_threads()
+       << ",\n  \"repeats\": " << opt_.repeats << ",\n  \"results\": [\n";
+    for (size_t i=0; i<records_.size(); ++i)
+      os << "    " << json_record(records_[i]) << (i+1 < records_.size() ? ",\n" : "\n");
+    os << "  ]\n}\n";
+  }
+private:
+  void add(Record r){
+    std::cerr << r.lattice << " " << r.structure << " " << r.stage << " density=" << r.density
+              << " branches=" << r.branches << " threads=" << r.threads
+              << ": " << *std::min_element(r.seconds.begin(), r.seconds.end()) << " s\n";
+    records_.push_back(std::move(r));
+  }
+  void time(const std::string& stage, const std::string& structure, const std::string& lattice,
+            const size_t density, const size_t size, const size_t branches, const size_t points,
+            const int threads, const bool warm_up, const std::function<void()>& f){
+    omp_set_num_threads(threads);
+    this->add({stage, structure, lattice, density, size, branches, points, threads, time_repeats(opt_.repeats, warm_up, f)});
+  }
+  static Direct fixture_lattice(const std::string& name){
+    if ("cubic" == name) return Direct(3.2598, 3.2598, 3.2598, PI/2, PI/2, PI/2, 529); // Im-3m, e.g. Nb
+    if ("hexagonal" == name) return Direct(4.85235, 4.85235, 5.350305, PI/2, PI/2, 2*PI/3, 443); // P3₁21, e.g. quartz
+    if ("monoclinic" == name) return Direct(5.2, 6.1, 7.3, PI/2, 1.78, PI/2, 57); // P2/m
+    throw std::runtime_error("Unknown lattice " + name);
+  }
+  LQVec<double> random_points(const Reciprocal& r) const {
+    std::mt19937 gen(1);
+    std::uniform_real_distribution<double> dist(-1., 1.);
+    LQVec<double> Q(r, opt_.points);
+    for (size_t i=0; i<Q.size(); ++i) for (size_t j=0; j<3u; ++j) Q.insert(dist(gen), i, j);
+    return Q;
+  }
+  // Fill with one scalar and one (complex) reciprocal-space 3-vector per branch
+  template<class I> static void fill(I& obj, const ArrayVector<double>& xyz, const size_t branches){
+    ArrayVector<double> vals(branches, xyz.size());
+    ArrayVector<vec_t> vecs(3u*branches, xyz.size());
+    for (size_t i=0; i<xyz.size(); ++i) for (size_t b=0; b<branches; ++b){
+      const double* x = xyz.data(i);
+      vals.insert(x[0]*x[0] + x[1]*x[1] + x[2]*x[2] + static_cast<double>(b), i, b);
+      for (size_t j=0; j<3u; ++j) vecs.insert(vec_t(x[j], static_cast<double>(b)), i, 3u*b+j);
+    }
+    std::array<element_t,3> val_el{{1,0,0}}, vec_el{{0,3,0}};
+    obj.replace_value_data(vals, std::vector<size_t>({xyz.size(), branches, 1u}), val_el);
+    obj.replace_vector_data(vecs, std::vector<size_t>({xyz.size(), branches, 3u}), vec_el, RotatesLike::Reciprocal);
+  }
+  void run_lattice(const std::string& name){
+    Reciprocal r = fixture_lattice(name).star();
+    this->time("construct", "BrillouinZone", name, 0, 0, 0, 0, 1, false, [&](){BrillouinZone bz(r);});
+    BrillouinZone bz(r);
+    const double ir_volume = bz.get_ir_polyhedron().get_volume();
+    LQVec<double> Q = this->random_points(r);
+    const size_t nQ = Q.size();
+    // convex hulls of a Brillouin zone sized point set, as in its mirroring
+    // fix-up, and of all query points, which the plane search can not handle
+    Polyhedron fbz = bz.get_polyhedron();
+    const ArrayVector<double> bz_points = cat(fbz.get_vertices(), fbz.get_points());
+    const ArrayVector<double> Q_xyz = Q.get_xyz();
+    this->time("hull", "quickhull", name, 0, Polyhedron(bz_points).num_vertices(), 0, bz_points.size(), 1, true,
+               [&](){Polyhedron p(bz_points);});
+    this->time("hull", "plane_search", name, 0, PlaneSearchPolyhedron(bz_points).num_vertices(), 0, bz_points.size(), 1, true,
+               [&](){PlaneSearchPolyhedron p(bz_points);});
+    this->time("hull", "quickhull", name, 0, Polyhedron(Q_xyz).num_vertices(), 0, nQ, 1, true,
+               [&](){Polyhedron p(Q_xyz);});
+    // construction of each interpolator at every density
+    for (size_t density: opt_.densities){
+      const double max_volume = ir_volume/static_cast<double>(density);
+      const size_t half = static_cast<size_t>(std::cbrt(static_cast<double>(density))/2) + 1u;
+      const size_t halfN[3]{half, half, half};
+      for (int nth: opt_.threads){
+        this->time("build", "trellis", name, density, Trellis(bz, max_volume).vertices().size(), 0, 0, nth, false,
+                   [&](){Trellis t(bz, max_volume);});
+        this->time("build", "nest", name, density, NestQ(bz, max_volume).vertices().size(), 0, 0, nth, false,
+                   [&](){NestQ n(bz, max_volume);});
+        this->time("build", "mesh", name, density, MeshQ(bz, max_volume).size(), 0, 0, nth, false,
+                   [&](){MeshQ m(bz, max_volume);});
+        this->time("build", "grid", name, density, GridQ(bz, halfN).get_mapped_hkl().size(), 0, 0, nth, false,
+                   [&](){GridQ g(bz, halfN);});
+      }
+    }
+    // moving points into the first and irreducible Brillouin zones
+    for (int nth: opt_.threads){
+      LQVec<double> q(r, nQ);
+      LQVec<int> tau(r, nQ);
+      std::vector<size_t> rot(nQ, 0u), invrot(nQ, 0u);
+      this->time("moveinto", "BrillouinZone", name, 0, 0, 0, nQ, nth, true,
+                 [&](){bz.moveinto(Q, q, tau, nth);});
+      this->time("ir_moveinto", "BrillouinZone", name, 0, 0, 0, nQ, nth, true,
+                 [&](){bz.ir_moveinto(Q, q, tau, rot, invrot, nth);});
+    }
+    // queries at one density for every payload size
+    const size_t density = opt_.query_density;
+    const double max_volume = ir_volume/static_cast<double>(density);
+    const size_t half = static_cast<size_t>(std::cbrt(static_cast<double>(density))/2) + 1u;
+    const size_t halfN[3]{half, half, half};
+    Trellis trellis(bz, max_volume);
+    NestQ nest(bz, max_volume);
+    MeshQ mesh(bz, max_volume);
+    GridQ grid(bz, halfN);
+    LQVec<double> ir_q(r, nQ);
+    LQVec<int> tau(r, nQ);
+    std::vector<size_t> rot(nQ, 0u), invrot(nQ, 0u);
+    bz.ir_moveinto(Q, ir_q, tau, rot, invrot);
+    const ArrayVector<double> ir_xyz = ir_q.get_xyz();
+    const std::vector<double> masses{1.};
+    for (size_t branches: opt_.branches){
+      fill(trellis, trellis.get_xyz(), branches);
+      fill(nest, nest.get_xyz(), branches);
+      fill(mesh, mesh.get_mesh_xyz(), branches);
+      fill(grid, grid.get_mapped_xyz(), branches);
+      const size_t nt = trellis.vertices().size();
+      for (int nth: opt_.threads){
+        this->time("locate", "trellis", name, density, nt, branches, nQ, nth, true, [&](){
+          #pragma omp parallel for num_threads(nth) schedule(dynamic)
+          for (long long i=0; i<static_cast<long long>(nQ); ++i){
+            std::vector<index_t> indices;
+            std::vector<double> weights;
+            trellis.indices_weights(ir_xyz.view(static_cast<size_t>(i)), indices, weights);
+          }
+        });
+        ArrayVector<double> vals;
+        ArrayVector<vec_t> vecs;
+        this->time("interpolate", "trellis", name, density, nt, branches, nQ, nth, true, [&](){
+          std::tie(vals, vecs) = trellis.PolyhedronTrellis<double,vec_t>::interpolate_at(ir_xyz, nth);
+        });
+        const PointSymmetry& psym = bz.get_pointgroup_symmetry();
+        const GammaTable pgt;
+        this->time("rotate", "trellis", name, density, nt, branches, nQ, nth, true, [&](){
+          ArrayVector<double> rvals(vals);
+          ArrayVector<vec_t> rvecs(vecs);
+          trellis.data().values().rotate_in_place(rvals, ir_q, pgt, psym, rot, invrot, nth);
+          trellis.data().vectors().rotate_in_place(rvecs, ir_q, pgt, psym, rot, invrot, nth);
+        });
+        this->time("debye_waller", "trellis", name, density, nt, branches, nQ, nth, true, [&](){
+          trellis.debye_waller(Q, masses, 10.);
+        });
+        this->time("ir_interpolate_at", "trellis", name, density, nt, branches, nQ, nth, true,
+                   [&](){trellis.ir_interpolate_at(Q, nth);});
+        this->time("ir_interpolate_at", "nest", name, density, nest.vertices().size(), branches, nQ, nth, true,
+                   [&](){nest.ir_interpolate_at(Q, nth);});
+        this->time("ir_interpolate_at", "mesh", name, density, mesh.size(), branches, nQ, nth, true,
+                   [&](){mesh.ir_interpolate_at(Q, nth);});
+        this->time("ir_interpolate_at", "grid", name, density, grid.get_mapped_xyz().size(), branches, nQ, nth, true,
+                   [&](){grid.ir_interpolate_at(Q, nth);});
+      }
+      // sorting is serial
+      if (branches <= opt_.sort_max_branches)
+        this->time("sort", "trellis", name, density, nt, branches, 0, 1, false,
+                   [&](){trellis.multi_sort_perm(1., 1., 1., 0);});
+    }
+  }
+};
+
+template<class T> static std::vector<T> parse_list(const std::string& s){
+  std::vector<T> out;
+  std::istringstream stream(s);
+  std::string item;
+  while (std::getline(stream, item, ',')){
+    std::istringstream is(item);
+    T v;
+    if (!(is >> v)) throw std::runtime_error("Could not parse list item '" + item + "'");
+    out.push_back(v);
+  }
+  return out;
+}
+
+static const char* usage =
+"brille_bench [options]\n"
+"  --threads=1,2,4         thread counts (default: powers of two up to the OpenMP maximum)\n"
+"  --lattices=cubic,...    any of cubic, hexagonal, monoclinic (default: all)\n"
+"  --densities=100,...     tetrahedra per irreducible Brillouin zone (default: 100,1000,10000)\n"
+"  --branches=1,12,...     branches per interpolation point (default: 1,12,120,500)\n"
+"  --query-density=N       the density at which queries are timed (default: 1000)\n"
+"  --points=N              Q points per query (default: 10000)\n"
+"  --sort-max-branches=N   skip sorting larger payloads (default: 120)\n"
+"  --repeats=N             timed repeats of every case (default: 5)\n"
+"  --quick                 a fast smoke run of every stage\n"
+"  --output=FILE           write the JSON results to FILE (default: brille_bench.json)\n";
+
+int main(int argc, char* argv[]){
+  Options opt;
+  for (int i=1; i<argc; ++i){
+    std::string arg(argv[i]);
+    size_t eq = arg.find('=');
+    std::string key = arg.substr(0, eq);
+    std::string value = eq == std::string::npos ? "" : arg.substr(eq+1);
+    if ("--help" == key || "-h" == key) {std::cout << usage; return 0;}
+    else if ("--threads" == key) opt.threads = parse_list<int>(value);
+    else if ("--lattices" == key) opt.lattices = parse_list<std::string>(value);
+    else if ("--densities" == key) opt.densities = parse_list<size_t>(value);
+    else if ("--branches" == key) opt.branches = parse_list<size_t>(value);
+    else if ("--query-density" == key) opt.query_density = parse_list<size_t>(value).at(0);
+    else if ("--points" == key) opt.points = parse_list<size_t>(value).at(0);
+    else if ("--sort-max-branches" == key) opt.sort_max_branches = parse_list<size_t>(value).at(0);
+    else if ("--repeats" == key) opt.repeats = parse_list<int>(value).at(0);
+    else if ("--output" == key) opt.output = value;
+    else if ("--quick" == key){
+      opt.densities = {100};
+      opt.query_density = 100;
+      opt.branches = {1, 12};
+      opt.points = 1000;
+      opt.repeats = 1;
+    } else {
+      std::cerr << "Unknown option " << arg << "\n" << usage;
+      return 1;
+    }
+  }
+  if (opt.threads.empty())
+    for (int n=1; n<=omp_get_max_threads(); n*=2) opt.threads.push_back(n);
+  if (opt.repeats < 1 || opt.points < 1 || std::any_of(opt.threads.begin(), opt.threads.end(), [](int n){return n < 1;})){
+    std::cerr << "Thread counts, repeats and points must be positive\n";
+    return 1;
+  }
+  Bench bench(opt);
+  bench.run();
+  std::ofstream file(opt.output);
+  bench.write(file);
+  if (!file){
+    std::cerr << "Writing " << opt.output << " failed\n";
+    return 1;
+  }
+  return 0;
+}
@@ -129,7 +129,7 @@ Polyhedron BrillouinZone::get_ir_polyhedron(const bool true_ir) const {
 }
 bool BrillouinZone::check_ir_polyhedron(void){
   this->check_if_mirroring_needed(); // move this to end of wedge_brute_force?
-  PointSymmetry fullps = this->outerlattice.get_pointgroup_symmetry(this->time_reversal?1:0);
+  const PointSymmetry& fullps = this->outerlattice.get_pointgroup_symmetry(this->time_reversal?1:0);
   double volume_goal = this->polyhedron.get_volume() / static_cast<double>(fullps.size());
   Polyhedron irbz = this->get_ir_polyhedron(), rotated;
   if (!approx_scalar(irbz.get_volume(), volume_goal)){
@@ -897,7 +897,7 @@ template<typename T> ArrayVector<bool> BrillouinZone::isinside(const LQVec<T>& p
     normals = this->get_primitive_normals();
   }
   for (size_t i=0; i<p.size(); ++i)
-    out.insert( dot(normals, p.get(i)-points).all_approx(Comp::le,0.), i );
+    out.insert( dot(normals, lazy(p.view(i))-points).all_approx(Comp::le,0.), i );
   return out;
 }
 template<typename T> std::vector<bool> BrillouinZone::isinside_std(const LQVec<T>& p) const {
@@ -915,7 +915,7 @@ template<typename T> std::vector<bool> BrillouinZone::isinside_std(const LQVec<T
     normals = this->get_primitive_normals();
   }
   for (size_t i=0; i<p.size(); ++i)
-    out[i] = dot(normals, p.get(i)-points).all_approx(Comp::le, 0.);
+    out[i] = dot(normals, lazy(p.view(i))-points).all_approx(Comp::le, 0.);
   return out;
 }
 
@@ -984,8 +984,20 @@ template<typename T> std::vector<bool> BrillouinZone::isinside_wedge_std(const L
 }
 
 bool BrillouinZone::moveinto(const LQVec<double>& Q, LQVec<double>& q, LQVec<int>& tau, const int threads) const {
+  std::vector<PointStatus> status;
+  if (!this->moveinto(Q, q, tau, status, threads)){
+    auto failed = std::find_if(status.begin(), status.end(), [](PointStatus s){return !point_ok(s);});
+    size_t i = static_cast<size_t>(std::distance(status.begin(), failed));
+    std::string msg = "Not all points inside Brillouin zone";
+    msg += " : Q = " + Q.to_string(i) + " , tau = " + tau.to_string(i) + " , q = " + q.to_string(i);
+    throw std::runtime_error(msg);
+  }
+  return true;
+}
+bool BrillouinZone::moveinto(const LQVec<double>& Q, LQVec<double>& q, LQVec<int>& tau, std::vector<PointStatus>& status, const int threads) const {
   verbose_update("BrillouinZone::moveinto called with ",threads," threads");
-  omp_set_num_threads( (threads > 0) ? threads : omp_get_max_threads() );
+  ProfileTimer timer(ProfileStage::moveinto);
+  const int nth = (threads > 0) ? threads : omp_get_max_threads();
   bool already_same = this->lattice.issame(Q.get_lattice());
   LQVec<double> Qprim(this->lattice), qprim(this->lattice);
   LQVec<int> tauprim(this->lattice);
@@ -1010,7 +1022,7 @@ bool BrillouinZone::moveinto(const LQVec<double>& Q, LQVec<double>& q, LQVec<int
   qsl.resize(Qsl.size());
   tausl.resize(Qsl.size());
   long long snQ = unsigned_to_signed<long long, size_t>(Qsl.size());
-#pragma omp parallel for default(none)\
+#pragma omp parallel for num_threads(nth) default(none)\
 shared(Qsl, tausl, qsl, points, normals, taus, taulen, snQ, max_count)\
 schedule(dynamic)
   for (long long si=0; si<snQ; si++){
@@ -1019,7 +1031,7 @@ schedule(dynamic)
     LQVec<double> qi = Qsl.get(i) - taui;
     LQVec<int> last_shift = taui;
     size_t count{0};
-    while (count++ < max_count && dot(normals, qi-points).any_approx(Comp::gt,0.)){
+    while (count++ < max_count && dot(normals, lazy(qi)-points).any_approx(Comp::gt,0.)){
       auto qi_dot_normals = dot(qi , normals);
       auto Nhkl = (qi_dot_normals/taulen).round().to_std();
       auto qidn = qi_dot_normals.to_std();
@@ -1044,29 +1056,46 @@ schedule(dynamic)
     tau = transform_from_primitive(this->outerlattice,tausl);
   }
   ArrayVector<bool> allinside = this->isinside(q);
-  if (!allinside.all_true()){
-    for (size_t i=0; i<Q.size(); ++i) if (!allinside.getvalue(i)){
-      info_update("Q  =",Q.to_string(i)  ," tau  =",tau.to_string(i)  ," q  =",q.to_string(i));
-      info_update("Qsl=",Qsl.to_string(i)," tausl=",tausl.to_string(i)," qsl=",qsl.to_string(i),"\n");
-    }
-    throw std::runtime_error("Not all points inside Brillouin zone");
-    // return false;
-  }
-  return true; // otherwise an error has been thrown
+  prepare_status(status, Q.size());
+  bool all_inside{true};
+  for (size_t i=0; i<Q.size(); ++i) if (!allinside.getvalue(i)){
+    verbose_update("Q  =",Q.to_string(i)  ," tau  =",tau.to_string(i)  ," q  =",q.to_string(i));
+    verbose_update("Qsl=",Qsl.to_string(i)," tausl=",tausl.to_string(i)," qsl=",qsl.to_string(i),"\n");
+    status[i] = PointStatus::fold_failed;
+    all_inside = false;
+  }
+  return all_inside;
 }
 bool BrillouinZone::ir_moveinto(
   const LQVec<double>& Q, LQVec<double>& q, LQVec<int>& tau,
   std::vector<size_t>& Ridx, std::vector<size_t>& invRidx, const int threads
+) const {
+  std::vector<PointStatus> status;
+  if (!this->ir_moveinto(Q, q, tau, Ridx, invRidx, status, threads)){
+    auto failed = std::find_if(status.begin(), status.end(), [](PointStatus s){return !point_ok(s);});
+    size_t i = static_cast<size_t>(std::distance(status.begin(), failed));
+    std::string msg = "Q = " + Q.to_string(i);
+    msg += " is outside of the irreducible BrillouinZone ";
+    msg += " : tau = " + tau.to_string(i) + " , q = " + q.to_string(i);
+    throw std::runtime_error(msg);
+  }
+  return true;
+}
+bool BrillouinZone::ir_moveinto(
+  const LQVec<double>& Q, LQVec<double>& q, LQVec<int>& tau,
+  std::vector<size_t>& Ridx, std::vector<size_t>& invRidx,
+  std::vector<PointStatus>& status, const int threads
 ) const {
   verbose_update("BrillouinZone::ir_moveinto called with ",threads," threads");
-  omp_set_num_threads( (threads > 0) ? threads : omp_get_max_threads() );
+  ProfileTimer timer(ProfileStage::ir_moveinto);
+  const int nth = (threads > 0) ? threads : omp_get_max_threads();
   /* The Pointgroup symmetry information comes from, effectively, spglib which
   has all rotation matrices defined in the conventional unit cell -- which is
   our `outerlattice`. Consequently we must work in the outerlattice here.  */
   if (!this->outerlattice.issame(Q.get_lattice()))
     throw std::runtime_error("Q points provided to ir_moveinto must be in the standard lattice used to define the BrillouinZone object");
   // get the PointSymmetry object, containing all operations
-  PointSymmetry psym = this->get_pointgroup_symmetry();
+  const PointSymmetry& psym = this->get_pointgroup_symmetry();
   // ensure q, tau, and Rm can hold one for each Q.
   size_t nQ = Q.size();
   q.resize(nQ);
@@ -1075,15 +1104,17 @@ bool BrillouinZone::ir_moveinto(
   invRidx.resize(nQ);
   // find q₁ₛₜ in the first Brillouin zone and τ ∈ [reciprocal lattice vectors]
   // such that Q = q₁ₛₜ + τ
-  this->moveinto(Q, q, tau, threads);
+  // any point which can not be moved is marked as failed in status
+  bool all_ok = this->moveinto(Q, q, tau, status, threads);
   // by chance some first Bz points are likely already in the IR-Bz:
   std::vector<bool> in_ir = this->isinside_wedge_std(q);
   //LQVec<double> qj(Q.get_lattice(), 1u);
   auto lat = Q.get_lattice();
+  const size_t identity = psym.find_index({1,0,0, 0,1,0, 0,0,1});
   // OpenMP 2 (VS) doesn't like unsigned loop counters
   size_t n_outside{0};
   long long snQ = unsigned_to_signed<long long, size_t>(nQ);
-  #pragma omp parallel for default(none) shared(psym, Ridx, invRidx, q, in_ir, lat, snQ) reduction(+:n_outside) schedule(dynamic)
+  #pragma omp parallel for num_threads(nth) default(none) shared(psym, Ridx, invRidx, q, in_ir, lat, snQ, status) firstprivate(identity) reduction(+:n_outside) schedule(dynamic)
   for (long long si=0; si<snQ; ++si){
     size_t i = signed_to_unsigned<size_t, long long>(si);
     // any q already in the irreducible zone need no rotation → identity, but we need to find the index of E
@@ -1104,31 +1135,26 @@ bool BrillouinZone::ir_moveinto(
         }
       }
     } else {
-      invRidx[i] = Ridx[i] = psym.find_index({1,0,0, 0,1,0, 0,0,1});
+      invRidx[i] = Ridx[i] = identity;
     }
     if (outside) {
       ++n_outside;
-      in_ir[i] = false;
+      // leave the point unrotated, it will be skipped by later stages
+      invRidx[i] = Ridx[i] = identity;
+      status[i] = PointStatus::fold_failed;
     }
   }
-  if (n_outside > 0) for (size_t i=0; i<nQ; ++i) if (!in_ir[i]){
-    std::string msg = "Q = " + Q.to_string(i);
-    msg += " is outside of the irreducible BrillouinZone ";
-    msg += " : tau = " + tau.to_string(i) + " , q = " + q.to_string(i);
-    throw std::runtime_error(msg);
-    return false;
-  }
-  return true; // otherwise we hit the runtime error above
+  return all_ok && 0 == n_outside;
 }
 bool BrillouinZone::ir_moveinto_wedge(const LQVec<double>& Q, LQVec<double>& q, std::vector<std::array<int,9>>& R, const int threads) const {
-  omp_set_num_threads( (threads > 0) ? threads : omp_get_max_threads() );
+  const int nth = (threads > 0) ? threads : omp_get_max_threads();
   /* The Pointgroup symmetry information comes from, effectively, spglib which
   has all rotation matrices defined in the conventional unit cell -- which is
   our `outerlattice`. Consequently we must work in the outerlattice here.  */
   if (!this->outerlattice.issame(Q.get_lattice()))
     throw std::runtime_error("Q points provided to ir_moveinto must be in the standard lattice used to define the BrillouinZone object");
   // get the PointSymmetry object, containing all operations
-  PointSymmetry psym = this->outerlattice.get_pointgroup_symmetry(this->time_reversal);
+  const PointSymmetry& psym = this->outerlattice.get_pointgroup_symmetry(this->time_reversal);
   // ensure q and R can hold one for each Q.
   size_t nQ = Q.size();
   q.resize(nQ);
@@ -1140,7 +1166,7 @@ bool BrillouinZone::ir_moveinto_wedge(const LQVec<double>& Q, LQVec<double>& q,
   // OpenMP 2 (VS) doesn't like unsigned loop counters
   size_t n_outside{0};
   long long snQ = unsigned_to_signed<long long, size_t>(nQ);
-  #pragma omp parallel for default(none) shared(psym, R, q, Q, in_ir, lat, snQ) reduction(+:n_outside) schedule(dynamic)
+  #pragma omp parallel for num_threads(nth) default(none) shared(psym, R, q, Q, in_ir, lat, snQ) reduction(+:n_outside) schedule(dynamic)
   for (long long si=0; si<snQ; ++si){
     size_t i = signed_to_unsigned<size_t, long long>(si);
     // any q already in the irreducible zone need no rotation → identity
@@ -27,6 +27,8 @@
 #include "polyhedron.hpp"
 // #include "debug.hpp"
 #include "phonon.hpp"
+#include "profiling.hpp"
+#include "point_status.hpp"
 
 /*! \brief An object to hold information about the first Brillouin zone of a Reciprocal lattice
 
@@ -48,6 +50,8 @@ class BrillouinZone {
   bool has_inversion; //!< A computed flag indicating if the pointgroup has space inversion symmetry or if time reversal symmetry has been requested
   bool is_primitive; //!< A computed flag indicating if the primitive version of a conventional lattice is in use
   bool no_ir_mirroring;
+  //! An empty BrillouinZone, to be filled by `deserialize`
+  BrillouinZone(): time_reversal(false), has_inversion(false), is_primitive(false), no_ir_mirroring(true) {}
 public:
   /*!
   @param lat A Reciprocal lattice
@@ -101,7 +105,7 @@ public:
   void check_if_mirroring_needed(void){
     this->no_ir_mirroring = true;
     if (!this->has_inversion){
-      PointSymmetry ps = this->outerlattice.get_pointgroup_symmetry(this->time_reversal?1:0);
+      const PointSymmetry& ps = this->outerlattice.get_pointgroup_symmetry(this->time_reversal?1:0);
       double goal = this->polyhedron.get_volume() / static_cast<double>(ps.size());
       double found = this->ir_polyhedron.get_volume();
       if (approx_scalar(goal, 2.0*found)){
@@ -146,6 +150,32 @@ public:
 
   bool check_ir_polyhedron(void);
   bool wedge_explicit(void);
+  //! Write the lattices, polyhedra, and flags to a BinaryWriter
+  void serialize(BinaryWriter& w) const {
+    lattice.serialize(w);
+    outerlattice.serialize(w);
+    polyhedron.serialize(w);
+    ir_polyhedron.serialize(w);
+    w.write(ir_wedge_normals);
+    w.write(time_reversal);
+    w.write(has_inversion);
+    w.write(is_primitive);
+    w.write(no_ir_mirroring);
+  }
+  //! Read a BrillouinZone written by `serialize` without repeating the vertex and wedge searches
+  static BrillouinZone deserialize(BinaryReader& r){
+    BrillouinZone bz;
+    bz.lattice = Reciprocal::deserialize(r);
+    bz.outerlattice = Reciprocal::deserialize(r);
+    bz.polyhedron = Polyhedron::deserialize(r);
+    bz.ir_polyhedron = Polyhedron::deserialize(r);
+    bz.ir_wedge_normals = r.read_arrayvector<double>();
+    r.read(bz.time_reversal);
+    r.read(bz.has_inversion);
+    r.read(bz.is_primitive);
+    r.read(bz.no_ir_mirroring);
+    return bz;
+  }
   //! Returns the lattice passed in at construction
   const Reciprocal get_lattice() const { return this->outerlattice;};
   //! Returns the lattice actually used to find the Brillouin zone vertices,
@@ -295,6 +325,16 @@ public:
     @param[out] tau The reciprocal lattice zone centres
   */
   bool moveinto(const LQVec<double>& Q, LQVec<double>& q, LQVec<int>& tau, int nthreads=0) const;
+  /*! \brief Find q and τ such that Q=q+τ, marking points which can not be moved
+    @param[in] Q A reference to LQVec list of Q points
+    @param[out] q The reduced reciprocal lattice vectors
+    @param[out] tau The reciprocal lattice zone centres
+    @param[in,out] status Set to PointStatus::fold_failed for each point which
+                          is not inside the first Brillouin zone afterwards
+    @param[in] nthreads An optional number of OpenMP threads to use
+    @returns Whether all points were moved into the first Brillouin zone
+  */
+  bool moveinto(const LQVec<double>& Q, LQVec<double>& q, LQVec<int>& tau, std::vector<PointStatus>& status, int nthreads=0) const;
   /*! \brief Find q, τ, and R∈G such that Q = Rᵀq + τ, where τ is a reciprocal
              lattice vector and R is a pointgroup symmetry operation of the
              conventional unit cell pointgroup, G.
@@ -307,9 +347,17 @@ public:
     @note R and invR index the PointSymmetry object accessible via BrillouinZone::get_pointgroup_symmetry();
   */
   bool ir_moveinto(const LQVec<double>& Q, LQVec<double>& q, LQVec<int>& tau, std::vector<size_t>& Rm, std::vector<size_t>& invRm, int nthreads=0) const ;
+  /*! \brief As `ir_moveinto` but marking, rather than throwing for, failed points
+
+    Points which can not be moved into the irreducible Brillouin zone have their
+    `status` set to PointStatus::fold_failed and are given the identity
+    operation for R and invR.
+    @returns Whether all points were moved into the irreducible Brillouin zone
+  */
+  bool ir_moveinto(const LQVec<double>& Q, LQVec<double>& q, LQVec<int>& tau, std::vector<size_t>& Rm, std::vector<size_t>& invRm, std::vector<PointStatus>& status, int nthreads=0) const ;
   bool ir_moveinto_wedge(const LQVec<double>& Q, LQVec<double>& q, std::vector<std::array<int,9>>& R, int threads=0) const;
   //! \brief Get the PointSymmetry object used by this BrillouinZone object internally
-  PointSymmetry get_pointgroup_symmetry() const{
+  const PointSymmetry& get_pointgroup_symmetry() const{
     return this->outerlattice.get_pointgroup_symmetry(this->time_reversal);
   }
   //! \brief Accessor for whether the BrillouinZone was constructed with additional time reversal symmetry
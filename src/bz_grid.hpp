@@ -23,6 +23,8 @@ typedef long slong; // ssize_t is only defined for gcc?
 #include "bz.hpp"
 #include "grid.hpp"
 #include "grid4.hpp"
+#include "prepared_q.hpp"
+#include "interpolation_cache.hpp"
 
 // #include "triangulation.hpp"
 
@@ -36,6 +38,7 @@ typedef long slong; // ssize_t is only defined for gcc?
 template<class T, class R> class BrillouinZoneGrid3: public InterpolateGrid3<T,R>{
 protected:
   BrillouinZone brillouinzone;
+  mutable InterpolationCache<T,R> cache_;
 public:
   /*! Construct using step sizes
     @param bz The BrillouinZone object
@@ -54,6 +57,20 @@ public:
           or N[i] = 1 if n[i]==0
   */
   BrillouinZoneGrid3(const BrillouinZone& bz, const size_t *n): brillouinzone(bz) { this->determine_map_step(n); }
+  //! Combine an existing grid with the BrillouinZone it covers
+  BrillouinZoneGrid3(InterpolateGrid3<T,R>&& g, const BrillouinZone& bz): InterpolateGrid3<T,R>(std::move(g)), brillouinzone(bz) {}
+  //! Write the BrillouinZone and grid to a BinaryWriter, after an identifying header
+  void serialize(BinaryWriter& w) const {
+    w.write_header("BrillouinZoneGrid3");
+    brillouinzone.serialize(w);
+    this->InterpolateGrid3<T,R>::serialize(w);
+  }
+  //! Read a BrillouinZoneGrid3 written by `serialize`, see BrillouinZoneTrellis3::deserialize
+  static BrillouinZoneGrid3<T,R> deserialize(BinaryReader& r, const bool borrow=false){
+    r.read_header("BrillouinZoneGrid3");
+    BrillouinZone bz = BrillouinZone::deserialize(r);
+    return BrillouinZoneGrid3<T,R>(InterpolateGrid3<T,R>::deserialize(r, borrow), bz);
+  }
   /*! Construct using a maximum tetrahedron volume -- makes a tetrahedron mesh
       instead of a orthogonal grid.
       @param bz The BrillouinZone object
@@ -108,33 +125,57 @@ public:
   }
   template<typename S>
   std::tuple<ArrayVector<T>,ArrayVector<R>>
-  ir_interpolate_at(const LQVec<S>& x, const int nthreads, const bool no_move=false) const{
-    LQVec<S> ir_q(x.get_lattice(), x.size());
-    LQVec<int> tau(x.get_lattice(), x.size());
-    std::vector<size_t> rot(x.size(),0u), invrot(x.size(),0u);
-    if (no_move){
-      ir_q = x;
-    } else if (!brillouinzone.ir_moveinto(x, ir_q, tau, rot, invrot, nthreads)){
-      std::string msg;
-      msg = "Moving all points into the irreducible Brillouin zone failed.";
-      throw std::runtime_error(msg);
-    }
+  ir_interpolate_at(const LQVec<S>& x, const int nthreads, const bool no_move=false, const bool dedupe=false) const{
+    profile_call(x.size());
+    PreparedQ prepared(brillouinzone, x, nthreads, false, no_move, dedupe);
+    return this->ir_interpolate_prepared(prepared, nthreads);
+  }
+  //! Interpolate at points already moved into the irreducible Brillouin zone
+  std::tuple<ArrayVector<T>,ArrayVector<R>>
+  ir_interpolate_at(const PreparedQ& prepared, const int nthreads) const{
+    profile_call(prepared.size());
+    prepared.check(brillouinzone);
+    return this->ir_interpolate_prepared(prepared, nthreads);
+  }
+  /*! \brief Keep the results for up to `capacity` irreducible points for reuse, see InterpolationCache
+
+  @param capacity The maximum number of points to keep, zero to disable the cache
+  @param resolution Points closer than about this, in inverse angstrom, share results
+  */
+  void set_cache(const size_t capacity, const double resolution=1e-10) {cache_.configure(capacity, resolution);}
+  //! Drop all cached results and zero the cache statistics
+  void clear_cache() {cache_.clear();}
+  CacheStatistics cache_statistics() const {return cache_.statistics();}
+  //! The memory held by the interpolator, with any cached results counted as auxiliary
+  MemoryUsage memory_usage() const {
+    MemoryUsage m = this->InterpolateGrid3<T,R>::memory_usage();
+    m.auxiliary += cache_.statistics().bytes;
+    return m;
+  }
+private:
+  // interpolate at points within the irreducible zone, via the cache if it is enabled
+  std::tuple<ArrayVector<T>,ArrayVector<R>>
+  ir_interpolate_irreducible(const ArrayVector<double>& x, std::vector<PointStatus>& status, const int nthreads) const{
+    // every point is found, since failures throw before interpolating
+    auto interpolate = [&](const ArrayVector<double>& p, std::vector<PointStatus>&){
+      return (nthreads > 1) ? this->InterpolateGrid3<T,R>::parallel_linear_interpolate_at(p, nthreads)
+                            : this->InterpolateGrid3<T,R>::linear_interpolate_at(p);
+    };
+    if (cache_.enabled()) return cache_.interpolate_at(this->data(), x, status, interpolate);
+    return interpolate(x, status);
+  }
+  std::tuple<ArrayVector<T>,ArrayVector<R>>
+  ir_interpolate_prepared(const PreparedQ& prepared, const int nthreads) const{
+    throw_if_failed(prepared.status(), "BrillouinZoneGrid3::ir_interpolate_at");
     // perform the interpolation within the irreducible Brillouin zone
     ArrayVector<T> vals;
     ArrayVector<R> vecs;
-    std::tie(vals,vecs) =
-      (nthreads > 1) ? this->InterpolateGrid3<T,R>::parallel_linear_interpolate_at(ir_q.get_xyz(), nthreads)
-                     : this->InterpolateGrid3<T,R>::linear_interpolate_at(ir_q.get_xyz());
-    // we always need the pointgroup operations to 'rotate'
-    PointSymmetry psym = brillouinzone.get_pointgroup_symmetry();
-    // and might need the Phonon Gamma table
-    GammaTable pgt{GammaTable()};
-    if (RotatesLike::Gamma == this->data().vectors().rotateslike()){
-      pgt.construct(brillouinzone.get_lattice().star(), brillouinzone.add_time_reversal());
-    }
+    std::vector<PointStatus> status{prepared.unique_status()};
+    std::tie(vals, vecs) = this->ir_interpolate_irreducible(prepared.unique_ir_q().get_xyz(), status, nthreads);
+    // copy results to symmetry-equivalent points, if deduplicated
+    prepared.expand(vals, vecs);
     // actually perform the rotation to Q
-    this->data().values() .rotate_in_place(vals, ir_q, pgt, psym, rot, invrot, nthreads);
-    this->data().vectors().rotate_in_place(vecs, ir_q, pgt, psym, rot, invrot, nthreads);
+    prepared.rotate(this->data(), vals, vecs, brillouinzone, nthreads);
     // we're done so bundle the output
     return std::make_tuple(vals, vecs);
   }
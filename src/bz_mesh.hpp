@@ -22,10 +22,13 @@ typedef long slong;
 
 #include "bz.hpp"
 #include "mesh.hpp"
+#include "prepared_q.hpp"
+#include "interpolation_cache.hpp"
 
 template<class T, class S> class BrillouinZoneMesh3: public Mesh3<T,S>{
 protected:
   BrillouinZone brillouinzone;
+  mutable InterpolationCache<T,S> cache_;
 public:
   /*! Construct using a maximum tetrahedron volume -- makes a tetrahedron mesh
       instead of a orthogonal grid.
@@ -43,6 +46,21 @@ public:
   BrillouinZoneMesh3(const BrillouinZone& bz, A... args):
     Mesh3<T,S>(bz.get_ir_vertices().get_xyz(), bz.get_ir_vertices_per_face(), args...),
     brillouinzone(bz) {}
+  //! Combine an existing Mesh3 with the BrillouinZone whose irreducible polyhedron it fills
+  BrillouinZoneMesh3(Mesh3<T,S>&& m, const BrillouinZone& bz):
+    Mesh3<T,S>(std::move(m)), brillouinzone(bz) {}
+  //! Write the BrillouinZone and Mesh3 to a BinaryWriter, after an identifying header
+  void serialize(BinaryWriter& w) const {
+    w.write_header("BrillouinZoneMesh3");
+    brillouinzone.serialize(w);
+    this->Mesh3<T,S>::serialize(w);
+  }
+  //! Read a BrillouinZoneMesh3 written by `serialize`, see BrillouinZoneTrellis3::deserialize
+  static BrillouinZoneMesh3<T,S> deserialize(BinaryReader& r, const bool borrow=false){
+    r.read_header("BrillouinZoneMesh3");
+    BrillouinZone bz = BrillouinZone::deserialize(r);
+    return BrillouinZoneMesh3<T,S>(Mesh3<T,S>::deserialize(r, borrow), bz);
+  }
   // get the BrillouinZone object
   BrillouinZone get_brillouinzone(void) const {return this->brillouinzone;}
   // get the mesh vertices in relative lattice units
@@ -59,33 +77,78 @@ public:
 
   template<typename R>
   std::tuple<ArrayVector<T>,ArrayVector<S>>
-  ir_interpolate_at(const LQVec<R>& x, const int nthreads, const bool no_move=false) const{
-    LQVec<R> ir_q(x.get_lattice(), x.size());
-    LQVec<int> tau(x.get_lattice(), x.size());
-    std::vector<size_t> rot(x.size(),0u), invrot(x.size(),0u);
-    if (no_move){
-      ir_q = x;
-    } else if (!brillouinzone.ir_moveinto(x, ir_q, tau, rot, invrot, nthreads)){
-      std::string msg;
-      msg = "Moving all points into the irreducible Brillouin zone failed.";
-      throw std::runtime_error(msg);
-    }
+  ir_interpolate_at(const LQVec<R>& x, const int nthreads, const bool no_move=false, const bool dedupe=false) const{
+    profile_call(x.size());
+    PreparedQ prepared(brillouinzone, x, nthreads, false, no_move, dedupe);
+    return this->ir_interpolate_prepared(prepared, nthreads);
+  }
+  //! Interpolate at points already moved into the irreducible Brillouin zone
+  std::tuple<ArrayVector<T>,ArrayVector<S>>
+  ir_interpolate_at(const PreparedQ& prepared, const int nthreads) const{
+    profile_call(prepared.size());
+    prepared.check(brillouinzone);
+    return this->ir_interpolate_prepared(prepared, nthreads);
+  }
+  //! Locate prepared points once, for repeated interpolation while only the data changes, see InterpolationPlan
+  InterpolationPlan ir_plan(const PreparedQ& prepared, const int nthreads, const bool with_permutations=false) const{
+    prepared.check(brillouinzone);
+    return this->Mesh3<T,S>::plan(prepared.unique_ir_q().get_xyz(), nthreads > 1 ? nthreads : 1, with_permutations, prepared.unique_status());
+  }
+  //! Interpolate the current data at the points of an `ir_plan`, and rotate them to the prepared Q
+  std::tuple<ArrayVector<T>,ArrayVector<S>>
+  ir_execute(const PreparedQ& prepared, const InterpolationPlan& plan, const int nthreads) const{
+    profile_call(prepared.size());
+    prepared.check(brillouinzone);
+    if (plan.size() != prepared.unique_count())
+      throw std::runtime_error("The interpolation plan and prepared points differ in number");
+    throw_if_failed(plan.status(), "BrillouinZoneMesh3::ir_execute");
+    ArrayVector<T> vals;
+    ArrayVector<S> vecs;
+    std::tie(vals, vecs) = this->Mesh3<T,S>::execute(plan, nthreads > 1 ? nthreads : 1);
+    // copy results to symmetry-equivalent points, if deduplicated
+    prepared.expand(vals, vecs);
+    prepared.rotate(this->data(), vals, vecs, brillouinzone, nthreads);
+    return std::make_tuple(vals, vecs);
+  }
+  /*! \brief Keep the results for up to `capacity` irreducible points for reuse, see InterpolationCache
+
+  @param capacity The maximum number of points to keep, zero to disable the cache
+  @param resolution Points closer than about this, in inverse angstrom, share results
+  */
+  void set_cache(const size_t capacity, const double resolution=1e-10) {cache_.configure(capacity, resolution);}
+  //! Drop all cached results and zero the cache statistics
+  void clear_cache() {cache_.clear();}
+  CacheStatistics cache_statistics() const {return cache_.statistics();}
+  //! The memory held by the interpolator, with any cached results counted as auxiliary
+  MemoryUsage memory_usage() const {
+    MemoryUsage m = this->Mesh3<T,S>::memory_usage();
+    m.auxiliary += cache_.statistics().bytes;
+    return m;
+  }
+private:
+  // interpolate at points within the irreducible zone, via the cache if it is enabled
+  std::tuple<ArrayVector<T>,ArrayVector<S>>
+  ir_interpolate_irreducible(const ArrayVector<double>& x, std::vector<PointStatus>& status, const int nthreads) const{
+    // every point is found, since failures throw before interpolating
+    auto interpolate = [&](const ArrayVector<double>& p, std::vector<PointStatus>&){
+      return (nthreads > 1) ? this->Mesh3<T,S>::parallel_interpolate_at(p, nthreads)
+                            : this->Mesh3<T,S>::interpolate_at(p);
+    };
+    if (cache_.enabled()) return cache_.interpolate_at(this->data(), x, status, interpolate);
+    return interpolate(x, status);
+  }
+  std::tuple<ArrayVector<T>,ArrayVector<S>>
+  ir_interpolate_prepared(const PreparedQ& prepared, const int nthreads) const{
+    throw_if_failed(prepared.status(), "BrillouinZoneMesh3::ir_interpolate_at");
     // perform the interpolation within the irreducible Brillouin zone
     ArrayVector<T> vals;
     ArrayVector<S> vecs;
-    std::tie(vals,vecs) = (nthreads > 1)
-        ? this->Mesh3<T,S>::parallel_interpolate_at(ir_q.get_xyz(), nthreads)
-        : this->Mesh3<T,S>::interpolate_at(ir_q.get_xyz());
-    // we always need the pointgroup operations to 'rotate'
-    PointSymmetry psym = brillouinzone.get_pointgroup_symmetry();
-    // and might need the Phonon Gamma table
-    GammaTable pgt{GammaTable()};
-    if (RotatesLike::Gamma == this->data().vectors().rotateslike()){
-      pgt.construct(brillouinzone.get_lattice().star(), brillouinzone.add_time_reversal());
-    }
+    std::vector<PointStatus> status{prepared.unique_status()};
+    std::tie(vals, vecs) = this->ir_interpolate_irreducible(prepared.unique_ir_q().get_xyz(), status, nthreads);
+    // copy results to symmetry-equivalent points, if deduplicated
+    prepared.expand(vals, vecs);
     // actually perform the rotation to Q
-    this->data().values() .rotate_in_place(vals, ir_q, pgt, psym, rot, invrot, nthreads);
-    this->data().vectors().rotate_in_place(vecs, ir_q, pgt, psym, rot, invrot, nthreads);
+    prepared.rotate(this->data(), vals, vecs, brillouinzone, nthreads);
     // we're done so bundle the output
     return std::make_tuple(vals, vecs);
   }
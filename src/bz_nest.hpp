@@ -23,14 +23,32 @@ typedef long slong;
 #include <tuple>
 #include "bz.hpp"
 #include "nest.hpp"
+#include "prepared_q.hpp"
+#include "interpolation_cache.hpp"
 
 template<class T, class S> class BrillouinZoneNest3: public Nest<T,S>{
   BrillouinZone brillouinzone;
+  mutable InterpolationCache<T,S> cache_;
 public:
   template<typename... A>
   BrillouinZoneNest3(const BrillouinZone& bz, A... args):
     Nest<T,S>(bz.get_ir_polyhedron(), args...),
     brillouinzone(bz) {}
+  //! Combine an existing Nest with the BrillouinZone whose irreducible polyhedron it fills
+  BrillouinZoneNest3(Nest<T,S>&& n, const BrillouinZone& bz):
+    Nest<T,S>(std::move(n)), brillouinzone(bz) {}
+  //! Write the BrillouinZone and Nest to a BinaryWriter, after an identifying header
+  void serialize(BinaryWriter& w) const {
+    w.write_header("BrillouinZoneNest3");
+    brillouinzone.serialize(w);
+    this->Nest<T,S>::serialize(w);
+  }
+  //! Read a BrillouinZoneNest3 written by `serialize`, see BrillouinZoneTrellis3::deserialize
+  static BrillouinZoneNest3<T,S> deserialize(BinaryReader& r, const bool borrow=false){
+    r.read_header("BrillouinZoneNest3");
+    BrillouinZone bz = BrillouinZone::deserialize(r);
+    return BrillouinZoneNest3<T,S>(Nest<T,S>::deserialize(r, borrow), bz);
+  }
   //! get the BrillouinZone object
   BrillouinZone get_brillouinzone(void) const {return this->brillouinzone;}
   //! get the vertices of the leaf vertices in inverse Angstrom
@@ -46,33 +64,100 @@ public:
 
   template<typename R>
   std::tuple<ArrayVector<T>,ArrayVector<S>>
-  ir_interpolate_at(const LQVec<R>& x, const int nth, const bool no_move=false) const{
-    LQVec<R> ir_q(x.get_lattice(), x.size());
-    LQVec<int> tau(x.get_lattice(), x.size());
-    std::vector<size_t> rot(x.size(),0u), invrot(x.size(),0u);
-    if (no_move){
-      ir_q = x;
-    } else if (!brillouinzone.ir_moveinto(x, ir_q, tau, rot, invrot, nth)){
-      std::string msg;
-      msg = "Moving all points into the irreducible Brillouin zone failed.";
-      throw std::runtime_error(msg);
-    }
+  ir_interpolate_at(const LQVec<R>& x, const int nth, const bool no_move=false, const bool dedupe=false) const{
+    std::vector<PointStatus> status;
+    auto out = this->ir_interpolate_at(x, status, nth, no_move, dedupe);
+    throw_if_failed(status, "BrillouinZoneNest3::ir_interpolate_at");
+    return out;
+  }
+  //! Interpolate at every point which can be handled, see BrillouinZoneTrellis3::ir_interpolate_at
+  template<typename R>
+  std::tuple<ArrayVector<T>,ArrayVector<S>>
+  ir_interpolate_at(const LQVec<R>& x, std::vector<PointStatus>& status, const int nth, const bool no_move=false, const bool dedupe=false) const{
+    profile_call(x.size());
+    PreparedQ prepared(brillouinzone, x, nth, false, no_move, dedupe);
+    return this->ir_interpolate_prepared(prepared, status, nth);
+  }
+  //! Interpolate at points already moved into the irreducible Brillouin zone
+  std::tuple<ArrayVector<T>,ArrayVector<S>>
+  ir_interpolate_at(const PreparedQ& prepared, const int nth) const{
+    std::vector<PointStatus> status;
+    auto out = this->ir_interpolate_at(prepared, status, nth);
+    throw_if_failed(status, "BrillouinZoneNest3::ir_interpolate_at");
+    return out;
+  }
+  //! Interpolate at prepared points, recording the outcome for each
+  std::tuple<ArrayVector<T>,ArrayVector<S>>
+  ir_interpolate_at(const PreparedQ& prepared, std::vector<PointStatus>& status, const int nth) const{
+    profile_call(prepared.size());
+    prepared.check(brillouinzone);
+    return this->ir_interpolate_prepared(prepared, status, nth);
+  }
+  /*! \brief Keep the results for up to `capacity` irreducible points for reuse, see InterpolationCache
+
+  @param capacity The maximum number of points to keep, zero to disable the cache
+  @param resolution Points closer than about this, in inverse angstrom, share results
+  */
+  void set_cache(const size_t capacity, const double resolution=1e-10) {cache_.configure(capacity, resolution);}
+  //! Drop all cached results and zero the cache statistics
+  void clear_cache() {cache_.clear();}
+  CacheStatistics cache_statistics() const {return cache_.statistics();}
+  //! The memory held by the interpolator, with any cached results counted as auxiliary
+  MemoryUsage memory_usage() const {
+    MemoryUsage m = this->Nest<T,S>::memory_usage();
+    m.auxiliary += cache_.statistics().bytes;
+    return m;
+  }
+  //! Locate prepared points once, for repeated interpolation while only the data changes, see InterpolationPlan
+  InterpolationPlan ir_plan(const PreparedQ& prepared, const int nth, const bool with_permutations=false) const{
+    prepared.check(brillouinzone);
+    return this->Nest<T,S>::plan(prepared.unique_ir_q().get_xyz(), nth > 1 ? nth : 1, with_permutations, prepared.unique_status());
+  }
+  //! Interpolate the current data at the points of an `ir_plan`, and rotate them to the prepared Q
+  std::tuple<ArrayVector<T>,ArrayVector<S>>
+  ir_execute(const PreparedQ& prepared, const InterpolationPlan& plan, const int nth) const{
+    std::vector<PointStatus> status;
+    auto out = this->ir_execute(prepared, plan, status, nth);
+    throw_if_failed(status, "BrillouinZoneNest3::ir_execute");
+    return out;
+  }
+  //! As `ir_execute`, recording the outcome for each point
+  std::tuple<ArrayVector<T>,ArrayVector<S>>
+  ir_execute(const PreparedQ& prepared, const InterpolationPlan& plan, std::vector<PointStatus>& status, const int nth) const{
+    profile_call(prepared.size());
+    prepared.check(brillouinzone);
+    if (plan.size() != prepared.unique_count())
+      throw std::runtime_error("The interpolation plan and prepared points differ in number");
+    status = plan.status();
+    ArrayVector<T> vals;
+    ArrayVector<S> vecs;
+    std::tie(vals, vecs) = this->Nest<T,S>::execute(plan, nth > 1 ? nth : 1);
+    // copy results to symmetry-equivalent points, if deduplicated
+    prepared.expand(vals, vecs, status);
+    prepared.rotate(this->data(), vals, vecs, brillouinzone, nth);
+    return std::make_tuple(vals, vecs);
+  }
+private:
+  // interpolate at points within the irreducible zone, via the cache if it is enabled
+  std::tuple<ArrayVector<T>,ArrayVector<S>>
+  ir_interpolate_irreducible(const ArrayVector<double>& x, std::vector<PointStatus>& status, const int nth) const{
+    auto interpolate = [&](const ArrayVector<double>& p, std::vector<PointStatus>& s){
+      return this->Nest<T,S>::interpolate_at(p, s, nth > 1 ? nth : 1);
+    };
+    if (cache_.enabled()) return cache_.interpolate_at(this->data(), x, status, interpolate);
+    return interpolate(x, status);
+  }
+  std::tuple<ArrayVector<T>,ArrayVector<S>>
+  ir_interpolate_prepared(const PreparedQ& prepared, std::vector<PointStatus>& status, const int nth) const{
+    status = prepared.unique_status();
     // perform the interpolation within the irreducible Brillouin zone
     ArrayVector<T> vals;
     ArrayVector<S> vecs;
-    std::tie(vals,vecs) = (nth > 1)
-        ? this->Nest<T,S>::interpolate_at(ir_q.get_xyz(), nth)
-        : this->Nest<T,S>::interpolate_at(ir_q.get_xyz());
-    // we always need the pointgroup operations to 'rotate'
-    PointSymmetry psym = brillouinzone.get_pointgroup_symmetry();
-    // and might need the Phonon Gamma table
-    GammaTable pgt{GammaTable()};
-    if (RotatesLike::Gamma == this->data().vectors().rotateslike()){
-      pgt.construct(brillouinzone.get_lattice().star(), brillouinzone.add_time_reversal());
-    }
+    std::tie(vals, vecs) = this->ir_interpolate_irreducible(prepared.unique_ir_q().get_xyz(), status, nth);
+    // copy results to symmetry-equivalent points, if deduplicated
+    prepared.expand(vals, vecs, status);
     // actually perform the rotation to Q
-    this->data().values().rotate_in_place(vals, ir_q, pgt, psym, rot, invrot, nth);
-    this->data().vectors().rotate_in_place(vecs, ir_q, pgt, psym, rot, invrot, nth);
+    prepared.rotate(this->data(), vals, vecs, brillouinzone, nth);
     // we're done so bundle the output
     return std::make_tuple(vals, vecs);
   }
@@ -23,14 +23,38 @@ typedef long slong;
 #include "bz.hpp"
 #include "trellis.hpp"
 #include "phonon.hpp"
+#include "prepared_q.hpp"
+#include "interpolation_cache.hpp"
 
 template<class T, class R> class BrillouinZoneTrellis3: public PolyhedronTrellis<T,R>{
   BrillouinZone brillouinzone;
+  mutable InterpolationCache<T,R> cache_;
 public:
   template<typename... A>
   BrillouinZoneTrellis3(const BrillouinZone& bz, A... args):
     PolyhedronTrellis<T,R>(bz.get_ir_polyhedron(), args...),
     brillouinzone(bz) {}
+  //! Combine an existing trellis with the BrillouinZone whose irreducible polyhedron it fills
+  BrillouinZoneTrellis3(PolyhedronTrellis<T,R>&& pt, const BrillouinZone& bz):
+    PolyhedronTrellis<T,R>(std::move(pt)), brillouinzone(bz) {}
+  //! Write the BrillouinZone and trellis to a BinaryWriter, after an identifying header
+  void serialize(BinaryWriter& w) const {
+    w.write_header("BrillouinZoneTrellis3");
+    brillouinzone.serialize(w);
+    this->PolyhedronTrellis<T,R>::serialize(w);
+  }
+  /*! \brief Read a BrillouinZoneTrellis3 written by `serialize`
+
+  Nothing is recomputed, so this is limited by the speed of copying the
+  geometry. With `borrow` true the (typically much larger) interpolation data
+  is not copied but references the reader's buffer, which must outlive the
+  returned object and must not be modified while it is in use.
+  */
+  static BrillouinZoneTrellis3<T,R> deserialize(BinaryReader& r, const bool borrow=false){
+    r.read_header("BrillouinZoneTrellis3");
+    BrillouinZone bz = BrillouinZone::deserialize(r);
+    return BrillouinZoneTrellis3<T,R>(PolyhedronTrellis<T,R>::deserialize(r, borrow), bz);
+  }
   //! get the BrillouinZone object
   BrillouinZone get_brillouinzone(void) const {return this->brillouinzone;}
   //! get the vertices of the trellis in absolute units
@@ -51,55 +75,135 @@ public:
   template<typename S>
   std::tuple<ArrayVector<T>,ArrayVector<R>>
   interpolate_at(const LQVec<S>& x, const int nth, const bool no_move=false) const{
+    std::vector<PointStatus> status;
+    auto out = this->interpolate_at(x, status, nth, no_move);
+    throw_if_failed(status, "BrillouinZoneTrellis3::interpolate_at");
+    return out;
+  }
+  /*! \brief Interpolate at every point which can be handled, recording the outcome for each
+
+  The call always completes: points which can not be moved into the first
+  Brillouin zone or found in the trellis are marked in `status` and their
+  results are zero.
+  */
+  template<typename S>
+  std::tuple<ArrayVector<T>,ArrayVector<R>>
+  interpolate_at(const LQVec<S>& x, std::vector<PointStatus>& status, const int nth, const bool no_move=false) const{
+    profile_call(x.size());
     LQVec<S> q(x.get_lattice(), x.size());
     LQVec<int> tau(x.get_lattice(), x.size());
+    status.assign(x.size(), PointStatus::found);
     if (no_move){
       // Special mode for testing where no specified points are moved
       // IT IS IMPERITIVE THAT THE PROVIDED POINTS ARE *INSIDE* THE IRREDUCIBLE
       // POLYHEDRON otherwise the interpolation will fail or give garbage back.
       q = x;
-    } else if (!brillouinzone.moveinto(x, q, tau, nth)){
-      std::string msg;
-      msg = "Moving all points into the first Brillouin zone failed.";
-      throw std::runtime_error(msg);
+    } else {
+      brillouinzone.moveinto(x, q, tau, status, nth);
     }
-    if (nth < 2)
-      return this->PolyhedronTrellis<T,R>::interpolate_at(q.get_xyz());
-    return this->PolyhedronTrellis<T,R>::interpolate_at(q.get_xyz(), nth);
+    return this->PolyhedronTrellis<T,R>::interpolate_at(q.get_xyz(), status, nth > 1 ? nth : 1);
   }
 
   template<typename S>
   std::tuple<ArrayVector<T>,ArrayVector<R>>
-  ir_interpolate_at(const LQVec<S>& x, const int nth, const bool no_move=false) const{
+  ir_interpolate_at(const LQVec<S>& x, const int nth, const bool no_move=false, const bool dedupe=false) const{
+    std::vector<PointStatus> status;
+    auto out = this->ir_interpolate_at(x, status, nth, no_move, dedupe);
+    throw_if_failed(status, "BrillouinZoneTrellis3::ir_interpolate_at");
+    return out;
+  }
+  //! As `interpolate_at` with status, but via the irreducible Brillouin zone
+  template<typename S>
+  std::tuple<ArrayVector<T>,ArrayVector<R>>
+  ir_interpolate_at(const LQVec<S>& x, std::vector<PointStatus>& status, const int nth, const bool no_move=false, const bool dedupe=false) const{
+    profile_call(x.size());
     verbose_update("BZTrellisQ::ir_interpoalte_at called with ",nth," threads");
-    LQVec<S> ir_q(x.get_lattice(), x.size());
-    LQVec<int> tau(x.get_lattice(), x.size());
-    std::vector<size_t> rot(x.size(),0u), invrot(x.size(),0u);
-    if (no_move){
-      // Special mode for testing where no specified points are moved
-      // IT IS IMPERITIVE THAT THE PROVIDED POINTS ARE *INSIDE* THE IRREDUCIBLE
-      // POLYHEDRON otherwise the interpolation will fail or give garbage back.
-      ir_q = x;
-    } else if (!brillouinzone.ir_moveinto(x, ir_q, tau, rot, invrot, nth)){
-      std::string msg;
-      msg = "Moving all points into the irreducible Brillouin zone failed.";
-      throw std::runtime_error(msg);
-    }
+    // Special mode for testing where no specified points are moved
+    // IT IS IMPERITIVE THAT THE PROVIDED POINTS ARE *INSIDE* THE IRREDUCIBLE
+    // POLYHEDRON otherwise the interpolation will fail or give garbage back.
+    PreparedQ prepared(brillouinzone, x, nth, false, no_move, dedupe);
+    return this->ir_interpolate_prepared(prepared, status, nth);
+  }
+  //! Interpolate at points already moved into the irreducible Brillouin zone
+  std::tuple<ArrayVector<T>,ArrayVector<R>>
+  ir_interpolate_at(const PreparedQ& prepared, const int nth) const{
+    std::vector<PointStatus> status;
+    auto out = this->ir_interpolate_at(prepared, status, nth);
+    throw_if_failed(status, "BrillouinZoneTrellis3::ir_interpolate_at");
+    return out;
+  }
+  //! Interpolate at prepared points, recording the outcome for each
+  std::tuple<ArrayVector<T>,ArrayVector<R>>
+  ir_interpolate_at(const PreparedQ& prepared, std::vector<PointStatus>& status, const int nth) const{
+    profile_call(prepared.size());
+    prepared.check(brillouinzone);
+    return this->ir_interpolate_prepared(prepared, status, nth);
+  }
+  /*! \brief Keep the results for up to `capacity` irreducible points for reuse, see InterpolationCache
+
+  @param capacity The maximum number of points to keep, zero to disable the cache
+  @param resolution Points closer than about this, in inverse angstrom, share results
+  */
+  void set_cache(const size_t capacity, const double resolution=1e-10) {cache_.configure(capacity, resolution);}
+  //! Drop all cached results and zero the cache statistics
+  void clear_cache() {cache_.clear();}
+  CacheStatistics cache_statistics() const {return cache_.statistics();}
+  //! The memory held by the interpolator, with any cached results counted as auxiliary
+  MemoryUsage memory_usage() const {
+    MemoryUsage m = this->PolyhedronTrellis<T,R>::memory_usage();
+    m.auxiliary += cache_.statistics().bytes;
+    return m;
+  }
+  //! Locate prepared points once, for repeated interpolation while only the data changes, see InterpolationPlan
+  InterpolationPlan ir_plan(const PreparedQ& prepared, const int nth, const bool with_permutations=false) const{
+    prepared.check(brillouinzone);
+    return this->PolyhedronTrellis<T,R>::plan(prepared.unique_ir_q().get_xyz(), nth > 1 ? nth : 1, with_permutations, prepared.unique_status());
+  }
+  //! Interpolate the current data at the points of an `ir_plan`, and rotate them to the prepared Q
+  std::tuple<ArrayVector<T>,ArrayVector<R>>
+  ir_execute(const PreparedQ& prepared, const InterpolationPlan& plan, const int nth) const{
+    std::vector<PointStatus> status;
+    auto out = this->ir_execute(prepared, plan, status, nth);
+    throw_if_failed(status, "BrillouinZoneTrellis3::ir_execute");
+    return out;
+  }
+  //! As `ir_execute`, recording the outcome for each point
+  std::tuple<ArrayVector<T>,ArrayVector<R>>
+  ir_execute(const PreparedQ& prepared, const InterpolationPlan& plan, std::vector<PointStatus>& status, const int nth) const{
+    profile_call(prepared.size());
+    prepared.check(brillouinzone);
+    if (plan.size() != prepared.unique_count())
+      throw std::runtime_error("The interpolation plan and prepared points differ in number");
+    status = plan.status();
     ArrayVector<T> vals;
     ArrayVector<R> vecs;
-    std::tie(vals, vecs) = (nth>1)
-        ? this->PolyhedronTrellis<T,R>::interpolate_at(ir_q.get_xyz(), nth)
-        : this->PolyhedronTrellis<T,R>::interpolate_at(ir_q.get_xyz());
-    // we always need the pointgroup operations to 'rotate'
-    PointSymmetry psym = brillouinzone.get_pointgroup_symmetry();
-    // and might need the Phonon Gamma table
-    GammaTable pgt{GammaTable()};
-    if (RotatesLike::Gamma == this->data().vectors().rotateslike()){
-      pgt.construct(brillouinzone.get_lattice().star(), brillouinzone.add_time_reversal());
-    }
+    std::tie(vals, vecs) = this->PolyhedronTrellis<T,R>::execute(plan, nth > 1 ? nth : 1);
+    // copy results to symmetry-equivalent points, if deduplicated
+    prepared.expand(vals, vecs, status);
+    prepared.rotate(this->data(), vals, vecs, brillouinzone, nth);
+    return std::make_tuple(vals, vecs);
+  }
+private:
+  // interpolate at points within the irreducible zone, via the cache if it is enabled
+  std::tuple<ArrayVector<T>,ArrayVector<R>>
+  ir_interpolate_irreducible(const ArrayVector<double>& x, std::vector<PointStatus>& status, const int nth) const{
+    auto interpolate = [&](const ArrayVector<double>& p, std::vector<PointStatus>& s){
+      return this->PolyhedronTrellis<T,R>::interpolate_at(p, s, nth > 1 ? nth : 1);
+    };
+    if (cache_.enabled()) return cache_.interpolate_at(this->data(), x, status, interpolate);
+    return interpolate(x, status);
+  }
+  std::tuple<ArrayVector<T>,ArrayVector<R>>
+  ir_interpolate_prepared(const PreparedQ& prepared, std::vector<PointStatus>& status, const int nth) const{
+    // points which could not be moved into the irreducible zone are skipped
+    status = prepared.unique_status();
+    ArrayVector<T> vals;
+    ArrayVector<R> vecs;
+    std::tie(vals, vecs) = this->ir_interpolate_irreducible(prepared.unique_ir_q().get_xyz(), status, nth);
+    // copy results to symmetry-equivalent points, if deduplicated
+    prepared.expand(vals, vecs, status);
     // actually perform the rotation to Q
-    this->data().values() .rotate_in_place(vals, ir_q, pgt, psym, rot, invrot, nth);
-    this->data().vectors().rotate_in_place(vecs, ir_q, pgt, psym, rot, invrot, nth);
+    prepared.rotate(this->data(), vals, vecs, brillouinzone, nth);
     // we're done so bundle the output
     return std::make_tuple(vals, vecs);
   }
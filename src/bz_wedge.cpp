@@ -20,7 +20,7 @@
 void BrillouinZone::wedge_search(const bool pbv, const bool pok){
   debug_exec(std::string update_msg;)
   // Get the full pointgroup symmetry information
-  PointSymmetry fullps = this->outerlattice.get_pointgroup_symmetry(this->time_reversal);
+  const PointSymmetry& fullps = this->outerlattice.get_pointgroup_symmetry(this->time_reversal);
   // And use it to find only the highest-order rotation operation along each
   // unique stationary axis.
   // PointSymmetry rotps = fullps.nfolds(1); // 1 to request only orders>1
@@ -217,7 +217,7 @@ void BrillouinZone::wedge_brute_force(const bool special_2_folds, const bool spe
   LQVec<double> special = cat(this->get_points(), this->get_vertices(), this->get_half_edges());
 
   // Grab the pointgroup symmetry operations
-  PointSymmetry fullps = this->outerlattice.get_pointgroup_symmetry(this->time_reversal);
+  const PointSymmetry& fullps = this->outerlattice.get_pointgroup_symmetry(this->time_reversal);
   // Now restrict the symmetry operations to those with order > 1.
   PointSymmetry ps = fullps.higher(1);
   std::vector<size_t> perm(ps.size());
@@ -26,6 +26,7 @@
 #include <vector>
 #include <complex>
 #include <chrono>
+#include <mutex>
 
 // #define VERBOSE_DEBUG
 // #define DEBUG // comment-out for no debugging output
@@ -113,11 +114,14 @@ template<typename T> static enable_if_t<is_container<T>::value, size_t> max_elem
   return l;
 }
 
+//! Serialises output so that messages from concurrent callers are not interleaved
 class DebugPrinter{
   std::string last_function; // replace this with the stack?
+  std::mutex mutex_;
 public:
   DebugPrinter(const std::string& s): last_function(s) {};
   template<typename... L> void print(const std::string& fnc, L... l){
+    std::lock_guard<std::mutex> lock(mutex_);
     if (last_function.compare(fnc)){
       last_function = fnc;
       std::cout << fnc << std::endl;
@@ -125,6 +129,7 @@ public:
     this->inner_print(l...);
   }
   template<typename... L> void println(const std::string& fnc, L... l){
+    std::lock_guard<std::mutex> lock(mutex_);
     if (last_function.compare(fnc)){
       last_function = fnc;
       std::cout << fnc << std::endl;
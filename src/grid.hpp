@@ -60,6 +60,16 @@ public:
     for (size_t i=0; i<other.numel(); i++) this->map[i] = other.map[i];
     this->data_ = other.data();
   }
+  // move constructor
+  MapGrid3(MapGrid3<T,R>&& other): map(other.map), data_(std::move(other.data_)) {
+    for (size_t i=0; i<3u; ++i){
+      N[i] = other.N[i];
+      span[i] = other.span[i];
+      other.N[i] = 0u;
+      other.span[i] = 0u;
+    }
+    other.map = nullptr;
+  }
   // destructor
   ~MapGrid3(){
     if ( numel()>0 && map!=nullptr) delete[] map;
@@ -74,6 +84,22 @@ public:
     }
     return *this;
   }
+  // Move assignment operator:
+  MapGrid3<T,R>& operator=(MapGrid3<T,R>&& other) {
+    if (this != &other){
+      if (map != nullptr) delete[] map;
+      map = other.map;
+      other.map = nullptr;
+      for (size_t i=0; i<3u; ++i){
+        N[i] = other.N[i];
+        span[i] = other.span[i];
+        other.N[i] = 0u;
+        other.span[i] = 0u;
+      }
+      data_ = std::move(other.data_);
+    }
+    return *this;
+  }
   //! Print the number of points along each axis to the console
   void print_N(const bool nl=false) const;
   //! Print the span along each axis to the console
@@ -114,8 +140,8 @@ public:
   //! Determine if `map` is consistent with `data`
   int check_map(void) const;
   //! Replace the data stored in the object
-  template<typename... A> int replace_value_data(A... args) { data_.replace_value_data(args...); return this->check_map(); }
-  template<typename... A> int replace_vector_data(A... args) { data_.replace_vector_data(args...); return this->check_map(); }
+  template<typename... A> int replace_value_data(A&&... args) { data_.replace_value_data(std::forward<A>(args)...); return this->check_map(); }
+  template<typename... A> int replace_vector_data(A&&... args) { data_.replace_vector_data(std::forward<A>(args)...); return this->check_map(); }
   //! Calculate the linear index of a point given its three subscripted indices
   size_t sub2lin(const size_t i, const size_t j, const size_t k) const;
   /*! Calculate the linear index of a point given an array of its three subscripted indices
@@ -184,6 +210,38 @@ public:
   size_t resize(const size_t *n);
   // Get a constant reference to the stored data
   const InterpolationData<T,R>& data(void) const {return data_;}
+  //! The bytes held by the mapping grid and data; grid vertex positions are implicit
+  MemoryUsage memory_usage() const {
+    MemoryUsage m = data_.memory_usage();
+    if (map) m.nodes = N[0]*N[1]*N[2]*sizeof(slong);
+    return m;
+  }
+  //! Write the grid size, mapping grid, and data to a BinaryWriter
+  void serialize(BinaryWriter& w) const {
+    for (size_t i=0; i<3u; ++i) w.write(static_cast<uint64_t>(N[i]));
+    w.align();
+    if (this->numel()) w.write_bytes(map, this->numel()*sizeof(slong));
+    data_.serialize(w);
+  }
+  /*! \brief Read a MapGrid3 written by `serialize`
+
+  @param r the reader
+  @param borrow if true the interpolation data references the reader's buffer,
+                which must then outlive the grid; the mapping grid is always copied
+  */
+  static MapGrid3<T,R> deserialize(BinaryReader& r, const bool borrow=false){
+    size_t n[3];
+    for (size_t i=0; i<3u; ++i) n[i] = static_cast<size_t>(r.read<uint64_t>());
+    r.align();
+    if (n[0] && n[1] && n[2] && n[0]*n[1] > r.remaining()/sizeof(slong)/n[2])
+      throw std::runtime_error("BinaryReader source buffer is truncated");
+    MapGrid3<T,R> g(n);
+    if (g.numel()) r.read_bytes(g.map, g.numel()*sizeof(slong));
+    g.data_ = InterpolationData<T,R>::deserialize(r, borrow);
+    if (g.data_.size() && g.check_map())
+      throw std::runtime_error("Serialized MapGrid3 map and data are inconsistent");
+    return g;
+  }
   //! Return the three sizes of the mapping grid as an ArrayVector
   ArrayVector<size_t> get_N(void) const;
   /*! Determine the neighbouring grid points of a given grid linear index
@@ -359,6 +417,10 @@ const double default_zero[3] = {0.,0.,0.};
 const double default_step[3] = {1.,1.,1.};
 
 /*! \brief Extends the MapGrid3 class to have positions of each grid point enabling interpolation between mapped points
+
+Interpolation only reads the grid and its data, so any number of threads may
+call `interpolate_at` on one object at the same time. Replacing the held data
+must not overlap with those calls.
 */
 template<class T,class R> class InterpolateGrid3: public MapGrid3<T,R>{
   double zero[3]; //!< the 3-vector position of `map[0]`
@@ -367,6 +429,22 @@ public:
   InterpolateGrid3(const size_t *n=default_n, const double *z=default_zero, const double *s=default_step): MapGrid3<T,R>(n) { this->set_zero(z); this->set_step(s); }
   InterpolateGrid3(const size_t *n, const ArrayVector<T>& av, const double *z=default_zero, const double *s=default_step): MapGrid3<T,R>(n,av){ this->set_zero(z); this->set_step(s); }
   InterpolateGrid3(const size_t *n, const slong* inmap, const ArrayVector<T>& av, const double *z=default_zero, const double *s=default_step): MapGrid3<T,R>(n,inmap,av){ this->set_zero(z); this->set_step(s); }
+  //! Position an existing mapping grid
+  InterpolateGrid3(MapGrid3<T,R>&& m, const double *z, const double *s): MapGrid3<T,R>(std::move(m)){ this->set_zero(z); this->set_step(s); }
+  //! Write the mapping grid, data, and grid position to a BinaryWriter
+  void serialize(BinaryWriter& w) const {
+    this->MapGrid3<T,R>::serialize(w);
+    w.write(zero);
+    w.write(step);
+  }
+  //! Read an InterpolateGrid3 written by `serialize`, see MapGrid3::deserialize
+  static InterpolateGrid3<T,R> deserialize(BinaryReader& r, const bool borrow=false){
+    MapGrid3<T,R> m = MapGrid3<T,R>::deserialize(r, borrow);
+    double z[3], s[3];
+    r.read(z);
+    r.read(s);
+    return InterpolateGrid3<T,R>(std::move(m), z, s);
+  }
 
 
   void set_zero(const double *newzero){ for(int i=0;i<3;i++) this->zero[i] = newzero[i]; }
@@ -663,6 +741,7 @@ public:
         oob = corners_and_weights(this,this->zero,this->step,ijk,x.data(i),corners.data(),weights.data(),3u,dirs);
         cnt = corner_count[dirs.size()];
         if (oob){
+          Profile::count(ProfileCounter::not_found);
           std::string msg = "Point " + std::to_string(i) + " with x = " + x.to_string(i) + " has " + std::to_string(oob) + " corners out of bounds!";
           throw std::runtime_error(msg);
         }
@@ -708,7 +787,7 @@ public:
     ArrayVector<T> valout(this->data_.values().numel(), x.size());
     ArrayVector<R> vecout(this->data_.vectors().numel(), x.size());
 
-    (threads>0) ? omp_set_num_threads(threads) : omp_set_num_threads(omp_get_max_threads());
+    const int nth = (threads > 0) ? threads : omp_get_max_threads();
     std::vector<size_t> corners(8,0);
     std::vector<double> weights(8,0.);
     size_t ijk[3], cnt=0u;
@@ -717,7 +796,7 @@ public:
     slong xsize = unsigned_to_signed<slong,size_t>(x.size());
     std::vector<size_t> dirs, corner_count={1u,2u,4u,8u};
     size_t n_oob{0};
-#pragma omp parallel for default(none) shared(x,valout,vecout,corner_count,mask) firstprivate(corners,ijk,weights,xsize) private(flg,oob,cnt,dirs) reduction(+:n_oob) schedule(dynamic)
+#pragma omp parallel for num_threads(nth) default(none) shared(x,valout,vecout,corner_count,mask) firstprivate(corners,ijk,weights,xsize) private(flg,oob,cnt,dirs) reduction(+:n_oob) schedule(dynamic)
     for (slong si=0; si<xsize; si++){
       size_t i = signed_to_unsigned<size_t,slong>(si);
       corners.resize(8u);
@@ -759,6 +838,7 @@ public:
         ++n_oob;
       }
     }
+    Profile::count(ProfileCounter::not_found, n_oob);
     if (n_oob > 0){
       std::string msg = "parallel_linear_interpolate_at failed with ";
       msg += std::to_string(n_oob) + " out of bounds points.";
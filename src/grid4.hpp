@@ -44,15 +44,25 @@ public:
   MapGrid4(const size_t *n=default_n4): map(nullptr)
     { this->set_size(n); }
   MapGrid4(const size_t *n, const ArrayVector<T>& av): map(nullptr)
-    { this->set_size(n); this->replace_data(av); }
+    { this->set_size(n); this->replace_value_data(av); }
   MapGrid4(const size_t *n, const slong *inmap, const ArrayVector<T>& av): map(nullptr)
-    { this->set_size(n); this->replace_data(av); this->set_map(inmap,n,4u); }
+    { this->set_size(n); this->replace_value_data(av); this->set_map(inmap,n,4u); }
   // copy constructor
   MapGrid4(const MapGrid4<T,S>& other): map(nullptr) {
     this->resize(other.size(0),other.size(1),other.size(2),other.size(3)); // sets N, calculates span, frees/allocates map memory if necessary
     for (size_t i=0; i<other.numel(); i++) this->map[i] = other.map[i];
     this->data_ = other.data_;
   }
+  // move constructor
+  MapGrid4(MapGrid4<T,S>&& other): map(other.map), data_(std::move(other.data_)) {
+    for (size_t i=0; i<4u; ++i){
+      N[i] = other.N[i];
+      span[i] = other.span[i];
+      other.N[i] = 0u;
+      other.span[i] = 0u;
+    }
+    other.map = nullptr;
+  }
   // destructor
   ~MapGrid4(){
     if ( numel()>0 && map!=nullptr) delete[] map;
@@ -67,6 +77,22 @@ public:
     }
     return *this;
   }
+  // Move assignment operator:
+  MapGrid4<T,S>& operator=(MapGrid4<T,S>&& other) {
+    if (this != &other){
+      if (map != nullptr) delete[] map;
+      map = other.map;
+      other.map = nullptr;
+      for (size_t i=0; i<4u; ++i){
+        N[i] = other.N[i];
+        span[i] = other.span[i];
+        other.N[i] = 0u;
+        other.span[i] = 0u;
+      }
+      data_ = std::move(other.data_);
+    }
+    return *this;
+  }
   //! Print the number of points along each axis to the console
   void print_N(const bool nl=false) const;
   //! Print the span along each axis to the console
@@ -108,8 +134,8 @@ public:
   // Get a constant reference to the stored data
   const InterpolationData<T,S>& data(void) const {return data_;}
   // Replace the data stored in the object
-  template<typename... A> void replace_value_data(A... args) { data_.values().replace_data(args...); }
-  template<typename... A> void replace_vector_data(A... args) { data_.vectors().replace_data(args...); }
+  template<typename... A> int replace_value_data(A&&... args) { data_.replace_value_data(std::forward<A>(args)...); return this->check_map(); }
+  template<typename... A> int replace_vector_data(A&&... args) { data_.replace_vector_data(std::forward<A>(args)...); return this->check_map(); }
   //
   //! Calculate the linear index of a point given its four subscripted indices
   size_t sub2lin(const size_t i, const size_t j, const size_t k, const size_t l) const;
@@ -302,13 +328,13 @@ public:
     return out;
   }
   //! Perform sanity checks before attempting to interpolate
-  template<typename R> int check_before_interpolating(const ArrayVector<R>& x){
+  template<typename R> int check_before_interpolating(const ArrayVector<R>& x) const {
     if (this->size(0)<2||this->size(1)<2||this->size(2)<2||this->size(3)<2)
       throw std::runtime_error("Interpolation is only possible on grids with at least two elements in each dimension");
     if (this->data_.size()==0)
       throw std::runtime_error("The grid must be filled before interpolating!");
-    if (x.numel()!=3u)
-      throw std::runtime_error("InterpolateGrid4 requires x values which are three-vectors.");
+    if (x.numel()!=4u)
+      throw std::runtime_error("InterpolateGrid4 requires x values which are four-vectors.");
     return 0;
   }
   /*! Perform linear interpolation at the specified points expressed in an orthonormal frame
@@ -324,72 +350,30 @@ public:
   */
   template<typename R>
   std::tuple<ArrayVector<T>,ArrayVector<S>>
-  linear_interpolate_at(const ArrayVector<R>& x){
+  linear_interpolate_at(const ArrayVector<R>& x) const {
     this->check_before_interpolating(x);
     ArrayVector<T> vals(this->data_.values().numel(), x.size());
     ArrayVector<S> vecs(this->data_.vectors().numel(), x.size());
-    std::vector<size_t> corners;
-    std::vector<double> weights;
-    size_t ijk[4];
-    int oob;
-    std::vector<size_t> dirs, corner_count={1u,2u,4u,8u,16u};
-    //TODO: switch this to an omp for loop
+    std::vector<size_t> corners(16u,0);
+    std::vector<double> weights(16u,0.);
+    size_t cnt{0};
     for (size_t i=0; i<x.size(); i++){
-      corners.resize(16);
-      weights.resize(16);
-      // find the closest grid subscripted indices to x[i]
-      unsigned int flg = this->nearest_index(x.data(i), ijk );
-      size_t cnt = 1u;
-      if (flg > 16){
-        std::string msg_flg = "Unsure what to do with flg = " + std::to_string(flg);
-        throw std::runtime_error(msg_flg);
-      }
-      if (15==flg)/*++++*/{
-        this->sub2map(ijk,corners[0]);
-        weights[0]=1.0;
-      } else {
-        if (0==flg)/*xxxx*/{
-          dirs.resize(4);
-          dirs[0]=0u; dirs[1]=1u; dirs[2]=2u; dirs[3]=3u;
-        }
-        if ( 1==flg|| 2==flg|| 4==flg|| 8==flg) dirs.resize(3);
-        if ( 1==flg)/*+xxx*/{ dirs[0]=1u; dirs[1]=2u; dirs[2]=3u; }
-        if ( 2==flg)/*x+xx*/{ dirs[0]=0u; dirs[1]=2u; dirs[2]=3u; }
-        if ( 4==flg)/*xx+x*/{ dirs[0]=0u; dirs[1]=1u; dirs[2]=3u; }
-        if ( 8==flg)/*xxx+*/{ dirs[0]=0u; dirs[1]=1u; dirs[2]=2u; }
-
-        if ( 3==flg|| 5==flg|| 9==flg|| 6==flg|| 10==flg|| 12==flg) dirs.resize(2);
-        if ( 3==flg)/*++xx*/{ dirs[0]=2u; dirs[1]=3u; }
-        if ( 5==flg)/*+x+x*/{ dirs[0]=1u; dirs[1]=3u; }
-        if ( 9==flg)/*+xx+*/{ dirs[0]=1u; dirs[1]=2u; }
-        if ( 6==flg)/*x++x*/{ dirs[0]=0u; dirs[1]=3u; }
-        if (10==flg)/*x+x+*/{ dirs[0]=0u; dirs[1]=2u; }
-        if (12==flg)/*xx++*/{ dirs[0]=0u; dirs[1]=1u; }
-
-        if ( 7==flg|| 11==flg || 13==flg || 14==flg) dirs.resize(1);
-        if ( 7==flg)/*+++x*/ dirs[0]=3u;
-        if (11==flg)/*++x+*/ dirs[0]=2u;
-        if (13==flg)/*+x++*/ dirs[0]=1u;
-        if (14==flg)/*x+++*/ dirs[0]=0u;
-
-        // determine the linear indices for the (up to) 16 grid points
-        // surrounding x[i] plus their linear-interpolation weights.
-        oob = corners_and_weights(this,this->zero,this->step,ijk,x.data(i),corners.data(),weights.data(),4u,dirs);
-        cnt = corner_count[dirs.size()];
-        if (oob) {
-          std::string msg = "Point " + std::to_string(i) + " with x = " + x.to_string(i) + " has " + std::to_string(oob) + " corners out of bounds!";
-          throw std::runtime_error(msg);
-        }
+      corners.resize(16u);
+      weights.resize(16u);
+      int oob = this->interpolation_corners(x.data(i), corners.data(), weights.data(), cnt);
+      if (oob) {
+        std::string msg = "Point " + std::to_string(i) + " with x = " + x.to_string(i) + " has " + std::to_string(oob) + " corners out of bounds!";
+        throw std::runtime_error(msg);
       }
       corners.resize(cnt);
       weights.resize(cnt);
-      this->data_.values().interpolate_at(corners,weights,vals,i);
-      this->data_.vectors().interpolate_at(corners, weights, vecs, i);
+      this->data_.interpolate_at(corners, weights, vals, vecs, i);
     }
     return std::make_tuple(vals, vecs);
   }
   /*! Perform linear interpolation in parallel at the specified points expressed in an orthonormal frame
   @param x The coordinates to interpolate at expressed in the same orthonormal frame as the mapping grid
+  @param threads The number of OpenMP threads to use, `omp_get_max_threads()` if `threads`≤0
   @returns An ArrayVector of the itnerpolated values
   @note In the event that one or more coordinates of a vector in `x` is an exact
         match for a grid point this routine will perform a lower-dimensional
@@ -401,76 +385,33 @@ public:
   */
   template<typename R>
   std::tuple<ArrayVector<T>,ArrayVector<S>>
-  parallel_linear_interpolate_at(const ArrayVector<R>& x,const int threads){
+  parallel_linear_interpolate_at(const ArrayVector<R>& x, const int threads) const {
     this->check_before_interpolating(x);
     ArrayVector<T> vals(this->data_.values().numel(), x.size());
     ArrayVector<S> vecs(this->data_.vectors().numel(), x.size());
-    std::vector<size_t> corners;
-    std::vector<double> weights;
-    size_t ijk[4];
-    int oob;
-    std::vector<size_t> dirs, corner_count={1u,2u,4u,8u,16u};
-    size_t n_oob{0};
-    (threads > 0 ) ? omp_set_num_threads(threads) : omp_set_num_threads(omp_get_max_threads());
+    std::vector<size_t> corners(16u,0);
+    std::vector<double> weights(16u,0.);
+    size_t cnt{0}, n_oob{0};
+    const int nth = (threads > 0) ? threads : omp_get_max_threads();
     slong xsize = unsigned_to_signed<slong,size_t>(x.size());
-#pragma omp parallel for default(none) shared(x,vals,vecs,corner_count) firstprivate(corners,ijk,weights,xsize) private(oob,dirs) reduction(+:n_oob) schedule(dynamic)
+#pragma omp parallel for num_threads(nth) default(none) shared(x,vals,vecs) firstprivate(corners,weights,xsize) private(cnt) reduction(+:n_oob) schedule(dynamic)
     for (slong si=0; si<xsize; si++){
-      corners.resize(16);
-      weights.resize(16);
       size_t i = signed_to_unsigned<size_t,slong>(si);
-      // find the closest grid subscripted indices to x[i]
-      unsigned int flg = this->nearest_index(x.data(i), ijk );
-      size_t cnt = 1u;
-      oob = 0;
-      if (flg < 16){
-        if (15==flg)/*++++*/{
-          this->sub2map(ijk,corners[0]);
-          weights[0]=1.0;
-        } else {
-          if (0==flg)/*xxxx*/{
-            dirs.resize(4);
-            dirs[0]=0u; dirs[1]=1u; dirs[2]=2u; dirs[3]=3u;
-          }
-          if ( 1==flg|| 2==flg|| 4==flg|| 8==flg) dirs.resize(3);
-          if ( 1==flg)/*+xxx*/{ dirs[0]=1u; dirs[1]=2u; dirs[2]=3u; }
-          if ( 2==flg)/*x+xx*/{ dirs[0]=0u; dirs[1]=2u; dirs[2]=3u; }
-          if ( 4==flg)/*xx+x*/{ dirs[0]=0u; dirs[1]=1u; dirs[2]=3u; }
-          if ( 8==flg)/*xxx+*/{ dirs[0]=0u; dirs[1]=1u; dirs[2]=2u; }
-
-          if ( 3==flg|| 5==flg|| 9==flg|| 6==flg|| 10==flg|| 12==flg) dirs.resize(2);
-          if ( 3==flg)/*++xx*/{ dirs[0]=2u; dirs[1]=3u; }
-          if ( 5==flg)/*+x+x*/{ dirs[0]=1u; dirs[1]=3u; }
-          if ( 9==flg)/*+xx+*/{ dirs[0]=1u; dirs[1]=2u; }
-          if ( 6==flg)/*x++x*/{ dirs[0]=0u; dirs[1]=3u; }
-          if (10==flg)/*x+x+*/{ dirs[0]=0u; dirs[1]=2u; }
-          if (12==flg)/*xx++*/{ dirs[0]=0u; dirs[1]=1u; }
-
-          if ( 7==flg|| 11==flg || 13==flg || 14==flg) dirs.resize(1);
-          if ( 7==flg)/*+++x*/ dirs[0]=3u;
-          if (11==flg)/*++x+*/ dirs[0]=2u;
-          if (13==flg)/*+x++*/ dirs[0]=1u;
-          if (14==flg)/*x+++*/ dirs[0]=0u;
-
-          oob = corners_and_weights(this,this->zero,this->step,ijk,x.data(i),corners.data(),weights.data(),4u,dirs);
-          cnt = corner_count[dirs.size()];
-        }
-        if (!oob){
-          corners.resize(cnt);
-          weights.resize(cnt);
-          this->data_.values().interpolate_at(corners,weights,vals,i);
-          this->data_.vectors().interpolate_at(corners, weights, vecs, i);
-        } else {
-          ++n_oob;
-        }
-    } else {
-      ++n_oob;
+      corners.resize(16u);
+      weights.resize(16u);
+      if (this->interpolation_corners(x.data(i), corners.data(), weights.data(), cnt)){
+        ++n_oob;
+      } else {
+        corners.resize(cnt);
+        weights.resize(cnt);
+        this->data_.interpolate_at(corners, weights, vals, vecs, i);
+      }
+    }
+    if (n_oob > 0){
+      std::string msg = "parallel_linear_interpolate_at failed with ";
+      msg += std::to_string(n_oob) + " out of bounds points.";
+      throw std::runtime_error(msg);
     }
-  }
-  if (n_oob > 0){
-    std::string msg = "parallel_linear_interpolate_at failed with ";
-    msg += std::to_string(n_oob) + " out of bounds points.";
-    throw std::runtime_error(msg);
-  }
     return std::make_tuple(vals,vecs);
   }
   /*! Get the size information about the first three components of the grid,
@@ -493,6 +434,33 @@ public:
     ArrayVector<double> out(1u,3u,spec);
     return out;
   }
+private:
+  /*! Find the mapped corners and weights required to interpolate at one point
+  @param x The 4-vector position of the interpolation point
+  @param[out] c Storage for up to 16 mapped linear indices
+  @param[out] w Storage for up to 16 interpolation weights
+  @param[out] cnt The number of corners actually required
+  @returns A non-zero integer if `x` or any required corner is out of bounds
+  @note No memory is allocated, so this is safe to call from within an OpenMP
+        parallel region on an otherwise-unmodified grid.
+  */
+  int interpolation_corners(const double* x, size_t* c, double* w, size_t& cnt) const {
+    size_t ijkl[4], dirs[4];
+    unsigned int flg = this->nearest_index(x, ijkl);
+    cnt = 1u;
+    if (flg > 15) return 1; // x is outside of the grid along at least one axis
+    // interpolate along every axis which is not an exact match
+    size_t ndirs{0};
+    for (size_t i=0; i<4u; ++i) if (!(flg & (1u<<i))) dirs[ndirs++] = i;
+    cnt <<= ndirs;
+    switch (ndirs){
+      case 0: w[0] = 1.0; return this->sub2map(ijkl, c[0]);
+      case 1: return corners_and_weights<1,4>(this,this->zero,this->step,ijkl,x,c,w,dirs);
+      case 2: return corners_and_weights<2,4>(this,this->zero,this->step,ijkl,x,c,w,dirs);
+      case 3: return corners_and_weights<3,4>(this,this->zero,this->step,ijkl,x,c,w,dirs);
+      default: return corners_and_weights<4,4>(this,this->zero,this->step,ijkl,x,c,w,dirs);
+    }
+  }
 protected:
   /*! Determine the neighbouring grid points of a given grid linear index
   @param centre The linear index to a point in the mapping grid
@@ -89,7 +89,7 @@ template<class T, class S> int MapGrid4<T,S>::check_map(const ArrayVector<T>& da
   return ( this->maximum_mapping() < data2check.size() ) ? 0 : 1;
 }
 template<class T, class S> int MapGrid4<T,S>::check_map(void) const {
-  return this->check_map(this->data_.data());
+  return ( this->maximum_mapping() < this->data_.size() ) ? 0 : 1;
 }
 //
 template<class T, class S> size_t MapGrid4<T,S>::sub2lin(const size_t i0, const size_t i1, const size_t i2, const size_t i3) const {
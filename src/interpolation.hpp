@@ -20,6 +20,7 @@
 
 #include <iostream>
 #include <vector>
+#include <array>
 #include <cmath>
 
 /*! \brief Find the linear index and weights of interpolation points for a given position
@@ -80,14 +81,14 @@ int corners_and_weights(const T<R,S>* that, const double* zero, const double* st
       t[dirs[0]] += d[0]; oob +=    32*that->sub2map(t.data(),c[ 5u]); w[5] = p[0]*p[1]*p[2]*m[3]; // (1110)
       t[dirs[1]] -= d[1]; oob +=    64*that->sub2map(t.data(),c[ 6u]); w[6] = p[0]*m[1]*p[2]*m[3]; // (1010)
       t[dirs[0]] -= d[0]; oob +=   128*that->sub2map(t.data(),c[ 7u]); w[7] = m[0]*m[1]*p[2]*m[3]; // (0010)
-      t[dirs[3]] += d[3]; oob +=   256*that->sub2map(t.data(),c[ 8u]); w[0] = m[0]*m[1]*p[2]*p[3]; // (0011)
-      t[dirs[0]] += d[0]; oob +=   512*that->sub2map(t.data(),c[ 9u]); w[1] = p[0]*m[1]*p[2]*p[3]; // (1011)
-      t[dirs[1]] += d[1]; oob +=  1024*that->sub2map(t.data(),c[10u]); w[2] = p[0]*p[1]*p[2]*p[3]; // (1111)
-      t[dirs[0]] -= d[0]; oob +=  2048*that->sub2map(t.data(),c[11u]); w[3] = m[0]*p[1]*p[2]*p[3]; // (0111)
-      t[dirs[2]] -= d[2]; oob +=  4096*that->sub2map(t.data(),c[12u]); w[4] = m[0]*p[1]*m[2]*p[3]; // (0101)
-      t[dirs[0]] += d[0]; oob +=  8192*that->sub2map(t.data(),c[13u]); w[5] = p[0]*p[1]*m[2]*p[3]; // (1101)
-      t[dirs[1]] -= d[1]; oob += 16384*that->sub2map(t.data(),c[14u]); w[6] = p[0]*m[1]*m[2]*p[3]; // (1001)
-      t[dirs[0]] -= d[0]; oob += 32768*that->sub2map(t.data(),c[15u]); w[7] = m[0]*m[1]*m[2]*p[3]; // (0001)
+      t[dirs[3]] += d[3]; oob +=   256*that->sub2map(t.data(),c[ 8u]); w[8] = m[0]*m[1]*p[2]*p[3]; // (0011)
+      t[dirs[0]] += d[0]; oob +=   512*that->sub2map(t.data(),c[ 9u]); w[9] = p[0]*m[1]*p[2]*p[3]; // (1011)
+      t[dirs[1]] += d[1]; oob +=  1024*that->sub2map(t.data(),c[10u]); w[10] = p[0]*p[1]*p[2]*p[3]; // (1111)
+      t[dirs[0]] -= d[0]; oob +=  2048*that->sub2map(t.data(),c[11u]); w[11] = m[0]*p[1]*p[2]*p[3]; // (0111)
+      t[dirs[2]] -= d[2]; oob +=  4096*that->sub2map(t.data(),c[12u]); w[12] = m[0]*p[1]*m[2]*p[3]; // (0101)
+      t[dirs[0]] += d[0]; oob +=  8192*that->sub2map(t.data(),c[13u]); w[13] = p[0]*p[1]*m[2]*p[3]; // (1101)
+      t[dirs[1]] -= d[1]; oob += 16384*that->sub2map(t.data(),c[14u]); w[14] = p[0]*m[1]*m[2]*p[3]; // (1001)
+      t[dirs[0]] -= d[0]; oob += 32768*that->sub2map(t.data(),c[15u]); w[15] = m[0]*m[1]*m[2]*p[3]; // (0001)
       break;
       case 3:
                           oob +=       that->sub2map(t.data(),c[ 0u]); w[0] = m[0]*m[1]*m[2]; // (000)
@@ -118,6 +119,56 @@ int corners_and_weights(const T<R,S>* that, const double* zero, const double* st
 
 /*! \brief Find the linear index and weights of interpolation points for a given position
 
+An allocation-free alternative to the runtime-dimensioned `corners_and_weights`
+suitable for use within tight, possibly multi-threaded, loops. The number of
+interpolation directions, D, and the dimensionality of the gridded space, N,
+are template parameters so that all temporary storage lives on the stack.
+
+@param that A pointer to an object with a `sub2map(const size_t*, size_t&)`
+            method, e.g., InterpolateGrid3 or InterpolateGrid4
+@param      zero  Pointer to the zero-point values of the grid, with N elements
+@param      step  Pointer to the step-size values of the grid, with N elements
+@param      ijk   Pointer to the nearest grid subscripted index to the
+                  interpolation point, with N elements
+@param      x     Pointer to the coordinates of the interpolation point,
+                  with N elements
+@param[out] c     Pointer where the linear indices will be stored,
+                  with 2ᴰ elements
+@param[out] w     Pointer where the weights will be stored, with 2ᴰ elements
+@param      dirs  Pointer to the D directions in the gridded space over which
+                  interpolation is to be performed
+@returns An integer with bit k set if the kᵗʰ corner is out of bounds, where
+         bit b of k indicates that the corner is displaced along `dirs[b]`
+*/
+template<size_t D, size_t N, class G>
+int corners_and_weights(const G* that, const double* zero, const double* step, const size_t *ijk, const double *x, size_t *c, double *w, const size_t *dirs){
+  static_assert(D>0 && D<=N, "Interpolation requires 1≤D≤N directions");
+  std::array<double,D> p, m;
+  std::array<int,D> d;
+  for (size_t i=0; i<D; ++i){
+    double tmp = (x[dirs[i]]-(zero[dirs[i]]+ijk[dirs[i]]*step[dirs[i]]))/step[dirs[i]];
+    d[i] = tmp < 0 ? -1 : 1;
+    p[i] = std::abs(tmp);
+    m[i] = 1.0 - p[i];
+  }
+  std::array<size_t,N> t;
+  int oob=0;
+  for (size_t k=0; k < (1u<<D); ++k){
+    for (size_t i=0; i<N; ++i) t[i] = ijk[i];
+    w[k] = 1.0;
+    for (size_t b=0; b<D; ++b) if (k & (1u<<b)){
+      t[dirs[b]] += d[b];
+      w[k] *= p[b];
+    } else {
+      w[k] *= m[b];
+    }
+    oob += (1<<k)*that->sub2map(t.data(), c[k]);
+  }
+  return oob;
+}
+
+/*! \brief Find the linear index and weights of interpolation points for a given position
+
 Linear interpolation in D dimensions requires 2ᴰ points surrounding the position
 where an interpolated value is to be determined. The value at each of the 2ᴰ
 points contributes in proportion to how close it is to the interpolation point.
@@ -175,14 +226,14 @@ int floor_corners_and_weights(const T<R,S>* that, const double* zero, const doub
       t[dirs[0]] += 1; oob +=    32*that->sub2map(t.data(),c[ 5u]); w[5] = p[0]*p[1]*p[2]*m[3]; // (1110)
       t[dirs[1]] -= 1; oob +=    64*that->sub2map(t.data(),c[ 6u]); w[6] = p[0]*m[1]*p[2]*m[3]; // (1010)
       t[dirs[0]] -= 1; oob +=   128*that->sub2map(t.data(),c[ 7u]); w[7] = m[0]*m[1]*p[2]*m[3]; // (0010)
-      t[dirs[3]] += 1; oob +=   256*that->sub2map(t.data(),c[ 8u]); w[0] = m[0]*m[1]*p[2]*p[3]; // (0011)
-      t[dirs[0]] += 1; oob +=   512*that->sub2map(t.data(),c[ 9u]); w[1] = p[0]*m[1]*p[2]*p[3]; // (1011)
-      t[dirs[1]] += 1; oob +=  1024*that->sub2map(t.data(),c[10u]); w[2] = p[0]*p[1]*p[2]*p[3]; // (1111)
-      t[dirs[0]] -= 1; oob +=  2048*that->sub2map(t.data(),c[11u]); w[3] = m[0]*p[1]*p[2]*p[3]; // (0111)
-      t[dirs[2]] -= 1; oob +=  4096*that->sub2map(t.data(),c[12u]); w[4] = m[0]*p[1]*m[2]*p[3]; // (0101)
-      t[dirs[0]] += 1; oob +=  8192*that->sub2map(t.data(),c[13u]); w[5] = p[0]*p[1]*m[2]*p[3]; // (1101)
-      t[dirs[1]] -= 1; oob += 16384*that->sub2map(t.data(),c[14u]); w[6] = p[0]*m[1]*m[2]*p[3]; // (1001)
-      t[dirs[0]] -= 1; oob += 32768*that->sub2map(t.data(),c[15u]); w[7] = m[0]*m[1]*m[2]*p[3]; // (0001)
+      t[dirs[3]] += 1; oob +=   256*that->sub2map(t.data(),c[ 8u]); w[8] = m[0]*m[1]*p[2]*p[3]; // (0011)
+      t[dirs[0]] += 1; oob +=   512*that->sub2map(t.data(),c[ 9u]); w[9] = p[0]*m[1]*p[2]*p[3]; // (1011)
+      t[dirs[1]] += 1; oob +=  1024*that->sub2map(t.data(),c[10u]); w[10] = p[0]*p[1]*p[2]*p[3]; // (1111)
+      t[dirs[0]] -= 1; oob +=  2048*that->sub2map(t.data(),c[11u]); w[11] = m[0]*p[1]*p[2]*p[3]; // (0111)
+      t[dirs[2]] -= 1; oob +=  4096*that->sub2map(t.data(),c[12u]); w[12] = m[0]*p[1]*m[2]*p[3]; // (0101)
+      t[dirs[0]] += 1; oob +=  8192*that->sub2map(t.data(),c[13u]); w[13] = p[0]*p[1]*m[2]*p[3]; // (1101)
+      t[dirs[1]] -= 1; oob += 16384*that->sub2map(t.data(),c[14u]); w[14] = p[0]*m[1]*m[2]*p[3]; // (1001)
+      t[dirs[0]] -= 1; oob += 32768*that->sub2map(t.data(),c[15u]); w[15] = m[0]*m[1]*m[2]*p[3]; // (0001)
       break;
       case 3:
                        oob +=       that->sub2map(t.data(),c[ 0u]); w[0] = m[0]*m[1]*m[2]; // (000)
@@ -0,0 +1,228 @@
+/* Copyright 2020 Greg Tucker
+//
+// This file is part of brille.
+//
+// brille is free software: you can redistribute it and/or modify it under the
+// terms of the GNU Affero General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// brille is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with brille. If not, see <https://www.gnu.org/licenses/>.            */
+
+/*! \file */
+#ifndef _INTERPOLATION_CACHE_H_
+#define _INTERPOLATION_CACHE_H_
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <list>
+#include <mutex>
+#include <stdexcept>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+#include "arrayvector.hpp"
+#include "point_status.hpp"
+#include "interpolation_data.hpp"
+
+//! Counters and the current size of an InterpolationCache
+struct CacheStatistics{
+  size_t hits{0};          //!< points whose results were found in the cache
+  size_t misses{0};        //!< points which had to be interpolated
+  size_t evictions{0};     //!< entries dropped to stay within the capacity
+  size_t invalidations{0}; //!< times all entries were dropped because the data changed
+  size_t size{0};          //!< the number of stored entries
+  size_t capacity{0};      //!< the maximum number of stored entries, zero if disabled
+  size_t bytes{0};         //!< the heap bytes held by the stored entries
+};
+
+/*! \brief A bounded least-recently-used cache of interpolated results
+
+Interactive use often interpolates overlapping sets of points again and again
+while the interpolation data is unchanged. The cache stores the unrotated
+results for points within the irreducible Brillouin zone, keyed by their
+Cartesian coordinates divided by `resolution` and rounded to integers, so that
+points within about `resolution` of a cached point reuse its results.
+
+Entries are tied to the InterpolationData::generation of the data they were
+interpolated from and are all dropped as soon as that changes. The cache is
+disabled, and free, while its capacity is zero.
+
+All access is serialised by a mutex, held only while looking up or storing
+results and never while interpolating, so one cache may be shared by
+concurrent const queries of its interpolator. Copies start empty.
+*/
+template<class T, class R> class InterpolationCache{
+public:
+  typedef std::array<long long,3> key_t;
+private:
+  struct KeyHash{
+    size_t operator()(const key_t& k) const {
+      // large odd multipliers, as for VertexWelder
+      size_t h = static_cast<size_t>(k[0]) * 73856093u;
+      h ^= static_cast<size_t>(k[1]) * 19349663u;
+      h ^= static_cast<size_t>(k[2]) * 83492791u;
+      return h;
+    }
+  };
+  struct Entry{
+    key_t key;
+    std::vector<T> values;
+    std::vector<R> vectors;
+  };
+  typedef std::list<Entry> list_t;
+  size_t capacity_{0};
+  double resolution_{1e-10};
+  unsigned long long generation_{0};
+  list_t entries_;                //!< most recently used first
+  std::unordered_map<key_t, typename list_t::iterator, KeyHash> index_;
+  CacheStatistics stats_;
+  mutable std::mutex mutex_;
+public:
+  InterpolationCache() = default;
+  InterpolationCache(const InterpolationCache& o): capacity_(o.capacity()), resolution_(o.resolution()) {}
+  InterpolationCache& operator=(const InterpolationCache& o){
+    if (this != &o){
+      size_t capacity = o.capacity();
+      double resolution = o.resolution();
+      std::lock_guard<std::mutex> lock(mutex_);
+      this->drop();
+      capacity_ = capacity;
+      resolution_ = resolution;
+    }
+    return *this;
+  }
+  size_t capacity() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return capacity_;
+  }
+  double resolution() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return resolution_;
+  }
+  bool enabled() const {return this->capacity() > 0u;}
+  /*! \brief Set the maximum number of entries and the key resolution
+
+  @param capacity The maximum number of points to store, zero to disable
+  @param resolution The key quantization step, in inverse angstrom
+  */
+  void configure(const size_t capacity, const double resolution){
+    if (!(resolution > 0.))
+      throw std::runtime_error("The cache resolution must be positive");
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (resolution != resolution_) this->drop();
+    capacity_ = capacity;
+    resolution_ = resolution;
+    this->trim();
+  }
+  //! Drop all entries and zero the counters
+  void clear(){
+    std::lock_guard<std::mutex> lock(mutex_);
+    this->drop();
+    stats_ = CacheStatistics();
+  }
+  CacheStatistics statistics() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    CacheStatistics s{stats_};
+    s.size = entries_.size();
+    s.capacity = capacity_;
+    s.bytes = entries_.size()*sizeof(Entry) + index_.bucket_count()*sizeof(void*);
+    for (const auto& e: entries_) s.bytes += memory_bytes(e.values) + memory_bytes(e.vectors);
+    return s;
+  }
+  /*! \brief Interpolate at points, reusing and storing cached results
+
+  @param data The data which `interpolate` uses
+  @param x The (N,3) Cartesian points, within the irreducible Brillouin zone
+  @param status The status of each point; points which are not ok are skipped
+                and the outcome for the others is recorded
+  @param interpolate A callable taking an (M,3) `ArrayVector<double>` of
+                     missed points and their `std::vector<PointStatus>&`,
+                     returning a `std::tuple<ArrayVector<T>,ArrayVector<R>>`
+  @returns the unrotated values and vectors for all N points
+  */
+  template<class F>
+  std::tuple<ArrayVector<T>,ArrayVector<R>>
+  interpolate_at(const InterpolationData<T,R>& data, const ArrayVector<double>& x, std::vector<PointStatus>& status, F interpolate){
+    prepare_status(status, x.size());
+    size_t nv = data.values().numel(), nr = data.vectors().numel();
+    ArrayVector<T> vals(nv, x.size());
+    ArrayVector<R> vecs(nr, x.size());
+    std::vector<key_t> keys(x.size());
+    std::vector<size_t> missed;
+    double resolution;
+    unsigned long long generation;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (generation_ != data.generation()){
+        if (!entries_.empty()) ++stats_.invalidations;
+        this->drop();
+        generation_ = data.generation();
+      }
+      resolution = resolution_;
+      generation = generation_;
+      for (size_t i=0; i<x.size(); ++i) if (point_ok(status[i])){
+        keys[i] = this->key(x.data(i));
+        auto itr = index_.find(keys[i]);
+        if (itr == index_.end()){
+          missed.push_back(i);
+          continue;
+        }
+        // mark as most recently used
+        entries_.splice(entries_.begin(), entries_, itr->second);
+        std::copy(itr->second->values.begin(), itr->second->values.end(), vals.data(i));
+        std::copy(itr->second->vectors.begin(), itr->second->vectors.end(), vecs.data(i));
+        ++stats_.hits;
+      }
+      stats_.misses += missed.size();
+    }
+    if (missed.empty()) return std::make_tuple(vals, vecs);
+    std::vector<PointStatus> missed_status;
+    missed_status.reserve(missed.size());
+    for (auto i: missed) missed_status.push_back(status[i]);
+    ArrayVector<T> mvals;
+    ArrayVector<R> mvecs;
+    std::tie(mvals, mvecs) = interpolate(x.extract(missed), missed_status);
+    std::lock_guard<std::mutex> lock(mutex_);
+    // the keys are only valid if no reconfiguration or newer data intervened
+    bool store = capacity_ && resolution == resolution_ && generation == generation_;
+    for (size_t j=0; j<missed.size(); ++j){
+      size_t i = missed[j];
+      status[i] = missed_status[j];
+      std::copy(mvals.data(j), mvals.data(j)+nv, vals.data(i));
+      std::copy(mvecs.data(j), mvecs.data(j)+nr, vecs.data(i));
+      if (store && point_ok(status[i]) && index_.find(keys[i]) == index_.end()){
+        entries_.push_front({keys[i], std::vector<T>(mvals.data(j), mvals.data(j)+nv), std::vector<R>(mvecs.data(j), mvecs.data(j)+nr)});
+        index_[keys[i]] = entries_.begin();
+      }
+    }
+    this->trim();
+    return std::make_tuple(vals, vecs);
+  }
+private:
+  key_t key(const double* x) const {
+    key_t k;
+    for (int i=0; i<3; ++i) k[i] = static_cast<long long>(std::llround(x[i]/resolution_));
+    return k;
+  }
+  // the following require that mutex_ is held
+  void drop(){
+    entries_.clear();
+    index_.clear();
+  }
+  void trim(){
+    while (entries_.size() > capacity_){
+      index_.erase(entries_.back().key);
+      entries_.pop_back();
+      ++stats_.evictions;
+    }
+  }
+};
+
+#endif
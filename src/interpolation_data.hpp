@@ -16,6 +16,8 @@
 // along with brille. If not, see <https://www.gnu.org/licenses/>.            */
 #include <vector>
 #include <array>
+#include <atomic>
+#include <tuple>
 #include <utility>
 #include <cassert>
 #include <functional>
@@ -24,6 +26,10 @@
 #include "latvec.hpp"
 #include "phonon.hpp"
 #include "permutation.hpp"
+#include "serialize.hpp"
+#include "profiling.hpp"
+#include "memory_usage.hpp"
+#include "interpolation_plan.hpp"
 
 #ifndef _INTERPOLATION_DATA_H_
 #define _INTERPOLATION_DATA_H_
@@ -40,6 +46,12 @@ template<class T> struct is_complex {enum{value = false};};
 template<class T> struct is_complex<std::complex<T>> {enum {value=true};};
 template<bool C, typename T> using enable_if_t = typename std::enable_if<C,T>::type;
 
+//! A process-wide unique stamp for each state of InterpolationData, see InterpolationData::generation
+inline unsigned long long next_interpolation_data_generation(){
+  static std::atomic<unsigned long long> generation{0};
+  return ++generation;
+}
+
 enum class RotatesLike {
   Real, Reciprocal, Axial, Gamma
 };
@@ -53,6 +65,8 @@ template<class T> class InnerInterpolationData{
   ElementsCost costs_;    //!< The cost assigned to each type for equivalent mode assignment
   CostFunction<T> scalar_cost_function;
   CostFunction<T> vector_cost_function;
+  int scalar_cost_type_{0}; //!< The `set_cost_info` scalar cost function selector, or -1 if user provided
+  int vector_cost_type_{0}; //!< The `set_cost_info` vector cost function selector, or -1 if user provided
 public:
   explicit InnerInterpolationData(size_t scf_type=0, size_t vcf_type=0):
   data_({0,0}), shape_({0,0}), elements_({{0,0,0}}), branches_(0),
@@ -61,7 +75,8 @@ public:
   };
   InnerInterpolationData(CostFunction<T> scf, CostFunction<T> vcf):
     data_({0,0}), shape_({0,0}), elements_({{0,0,0}}), branches_(0),
-    rotlike_{RotatesLike::Real}, costs_({{1,1,1}}), scalar_cost_function(scf), vector_cost_function(vcf){};
+    rotlike_{RotatesLike::Real}, costs_({{1,1,1}}), scalar_cost_function(scf), vector_cost_function(vcf),
+    scalar_cost_type_(-1), vector_cost_type_(-1) {};
   //
   void setup_fake(const size_t sz, const element_t br){
     data_.refresh(br, sz);
@@ -71,6 +86,8 @@ public:
   }
   //
   void set_cost_info(const int scf, const int vcf){
+    scalar_cost_type_ = scf;
+    vector_cost_type_ = vcf;
     switch (scf){
       default:
       this->scalar_cost_function = [](element_t n, T* i, T* j){
@@ -116,12 +133,56 @@ public:
   const ShapeType& shape(void) const {return shape_;}
   const ElementsType& elements(void) const {return elements_;}
   element_t branches(void) const {return branches_;}
+  //! The bytes held, or borrowed, by the stored data
+  size_t data_bytes(void) const {return memory_bytes(data_);}
+  //! The bytes held by the data shape
+  size_t auxiliary_bytes(void) const {return memory_bytes(shape_);}
+  //! Write the data and its description to a BinaryWriter
+  void serialize(BinaryWriter& w) const {
+    if (scalar_cost_type_ < 0 || vector_cost_type_ < 0)
+      throw std::runtime_error("Interpolation data with user-provided cost functions can not be serialized");
+    w.write(static_cast<uint32_t>(sizeof(T)));
+    w.write(static_cast<bool>(is_complex<T>::value));
+    w.write(shape_);
+    w.write(elements_);
+    w.write(branches_);
+    w.write(rotlike_);
+    w.write(costs_);
+    w.write(scalar_cost_type_);
+    w.write(vector_cost_type_);
+    w.write(data_);
+  }
+  /*! \brief Read interpolation data written by `serialize`
+
+  @param r the reader
+  @param borrow if true the data array references the reader's buffer, which
+                must then outlive this object
+  */
+  static InnerInterpolationData<T> deserialize(BinaryReader& r, const bool borrow=false){
+    if (r.read<uint32_t>() != sizeof(T) || r.read<bool>() != static_cast<bool>(is_complex<T>::value))
+      throw std::runtime_error("Serialized interpolation data has a different element type");
+    InnerInterpolationData<T> d;
+    r.read(d.shape_);
+    r.read(d.elements_);
+    r.read(d.branches_);
+    r.read(d.rotlike_);
+    ElementsCost costs;
+    int scf, vcf;
+    r.read(costs);
+    r.read(scf);
+    r.read(vcf);
+    d.set_cost_info(scf, vcf, costs);
+    d.data_ = r.read_arrayvector<T>(borrow);
+    return d;
+  }
   //
   template<typename I, typename=std::enable_if_t<std::is_integral<I>::value> >
   void interpolate_at(const std::vector<std::vector<int>>&, const std::vector<I>&, const std::vector<double>&, ArrayVector<T>&, const size_t, const bool) const;
   //
   template<typename I, typename=std::enable_if_t<std::is_integral<I>::value> >
   void interpolate_at(const std::vector<std::vector<int>>&, const std::vector<std::pair<I,double>>&, ArrayVector<T>&, const size_t, const bool) const;
+  //! Interpolate from `n` vertices whose permutations are stored contiguously, `branches()` per vertex
+  void interpolate_at(const int*, const size_t*, const double*, const size_t, ArrayVector<T>&, const size_t, const bool) const;
   //
   template<class R, class RotT>
   bool rotate_in_place(ArrayVector<T>& x,
@@ -131,6 +192,7 @@ public:
                        const std::vector<size_t>& r,
                        const std::vector<size_t>& invr,
                        const int nth) const {
+    ProfileTimer timer(ProfileStage::rotate);
     switch (rotlike_){
       case RotatesLike::Real: return this->rip_real(x, ps, r, invr, nth);
       case RotatesLike::Axial: return this->rip_axial(x, ps, r, invr, nth);
@@ -146,18 +208,22 @@ public:
     rotlike_ = a;
     return rotlike_;
   }
-  // Replace the data within this object.
+  /*! \brief Replace the data within this object
+
+  The new data is taken by value so that callers which no longer need their
+  ArrayVector can move it in without a copy, in which case a borrowed block
+  (see `ArrayVector::borrow`) remains borrowed. Nothing is modified if the
+  shape and elements are inconsistent.
+  */
   template<typename I> void replace_data(
-      const ArrayVector<T>& nd,
+      ArrayVector<T> nd,
       const ShapeType& ns,
       const std::array<I,3>& ne,
       const RotatesLike rl = RotatesLike::Real
     ){
-    data_ = nd;
-    shape_ = ns;
-    rotlike_ = rl;
     // convert the elements datatype as necessary
-    for (size_t i=0; i<3u; ++i) elements_[i] = static_cast<element_t>(ne[i]);
+    ElementsType el;
+    for (size_t i=0; i<3u; ++i) el[i] = static_cast<element_t>(ne[i]);
     if (ne[1]%3)
       throw std::logic_error("Vectors must have 3N elements per branch");
     if (ne[2]%9)
@@ -166,36 +232,42 @@ public:
     element_t total_elements = 1u;
     // scalar + eigenvector + vector + matrix*matrix elements
     element_t known_elements = this->branch_span(ne);
+    element_t branches;
     // no matter what, shape[0] should be the number of gridded points
     if (ns.size()>2){
       // if the number of dimensions of the shape array is greater than two,
       // the second element is the number of modes per point                    */
-      branches_ = static_cast<element_t>(ns[1]);
+      branches = static_cast<element_t>(ns[1]);
       for (size_t i=2u; i<ns.size(); ++i) total_elements *= static_cast<element_t>(ns[i]);
     } else {
       // shape is [n_points, n_elements] or [n_points,], so there is only one mode
-      branches_ = 1u;
+      branches = 1u;
       total_elements = static_cast<element_t>( ns.size() > 1 ? ns[1] : 1u );
     }
-    if (0 == known_elements) elements_[0] = total_elements;
+    if (0 == known_elements) el[0] = total_elements;
     if (known_elements && known_elements != total_elements){
       std::string msg;
       msg = "Inconsistent elements: " + std::to_string(known_elements) + " = ";
-      msg += std::to_string(elements_[0]) + "+" + std::to_string(elements_[1]) + "+";
-      msg += std::to_string(elements_[2]) + " ≠ ";
+      msg += std::to_string(el[0]) + "+" + std::to_string(el[1]) + "+";
+      msg += std::to_string(el[2]) + " ≠ ";
       msg += std::to_string(total_elements);
       throw std::runtime_error(msg);
     }
+    data_ = std::move(nd);
+    shape_ = ns;
+    elements_ = el;
+    branches_ = branches;
+    rotlike_ = rl;
   }
   // Replace the data in this object without specifying the data shape
-  template<typename I> void replace_data(const ArrayVector<T>& nd, const std::array<I,3>& ne){
+  template<typename I> void replace_data(ArrayVector<T> nd, const std::array<I,3>& ne){
     ShapeType ns{nd.size(), nd.numel()};
-    return this->replace_data(nd, ns, ne);
+    return this->replace_data(std::move(nd), ns, ne);
   }
   // Replace the data in this object without specifying the data shape or its elements
   // this variant is necessary since the template specialization above can not have a default value for the elements
-  void replace_data(const ArrayVector<T>& nd){
-    return this->replace_data(nd, ElementsType({{0,0,0}}));
+  void replace_data(ArrayVector<T> nd){
+    return this->replace_data(std::move(nd), ElementsType({{0,0,0}}));
   }
   element_t branch_span() const { return this->branch_span(elements_);}
   //
@@ -399,6 +471,31 @@ void InnerInterpolationData<T>::interpolate_at(
   }
 }
 
+template<typename T>
+void InnerInterpolationData<T>::interpolate_at(
+  const int* permutations,
+  const size_t* indices,
+  const double* weights,
+  const size_t n,
+  ArrayVector<T>& out,
+  const size_t to,
+  const bool arbitrary_phase_allowed
+) const {
+  if (n==0)
+    throw std::logic_error("Interpolation requires input data!");
+  T *out_to = out.data(to), *ptr0 = data_.data(indices[0]);
+  element_t span = this->branch_span();
+  for (size_t x=0; x<n; ++x){
+    const T *ptrX = data_.data(indices[x]);
+    const int *perm = permutations + x*branches_;
+    for (element_t b=0; b < branches_; ++b){
+      element_t p = static_cast<element_t>(perm[b]);
+      T eith = arbitrary_phase_allowed ? antiphase(span, ptr0+b*span, ptrX+p*span) : T(1);
+      for (size_t s=0; s<span; ++s) out_to[b*span+s] += weights[x]*eith*ptrX[p*span+s];
+    }
+  }
+}
+
 //
 // template<typename T> template<typename I, typename>
 // void InnerInterpolationData<T>::interpolate_at(
@@ -450,7 +547,7 @@ template<typename T>
 bool InnerInterpolationData<T>::rip_recip(
   ArrayVector<T>& x, const PointSymmetry& ptsym, const std::vector<size_t>& r, const std::vector<size_t>& invR, const int nthreads
 ) const {
-  omp_set_num_threads( (nthreads>0) ? nthreads : omp_get_max_threads() );
+  const int nth = (nthreads > 0) ? nthreads : omp_get_max_threads();
   ElementsType no = this->count_scalars_vectors_matrices();
   if (!std::any_of(no.begin()+1, no.end(), [](element_t n){return n>0;}))
     return false;
@@ -459,7 +556,7 @@ bool InnerInterpolationData<T>::rip_recip(
   std::array<int,9> ident = {1,0,0, 0,1,0, 0,0,1};
   // OpenMP < v3.0 (VS uses v2.0) requires signed indexes for omp parallel
   long long xsize = unsigned_to_signed<long long, size_t>(x.size());
-#pragma omp parallel for default(none) shared(x,ptsym,r,invR) private(offset, tmp_v, tmp_m) firstprivate(ident,no, sp, xsize) schedule(static)
+#pragma omp parallel for num_threads(nth) default(none) shared(x,ptsym,r,invR) private(offset, tmp_v, tmp_m) firstprivate(ident,no, sp, xsize) schedule(static)
   for (long long si=0; si<xsize; ++si){
     size_t i = signed_to_unsigned<size_t, long long>(si);
     if (!approx_matrix(3, ident.data(), ptsym.get(r[i]).data()))
@@ -488,7 +585,7 @@ template<typename T>
 bool InnerInterpolationData<T>::rip_real(
   ArrayVector<T>& x, const PointSymmetry& ptsym, const std::vector<size_t>& r, const std::vector<size_t>& invR, const int nthreads
 ) const {
-  omp_set_num_threads( (nthreads>0) ? nthreads : omp_get_max_threads() );
+  const int nth = (nthreads > 0) ? nthreads : omp_get_max_threads();
   ElementsType no = this->count_scalars_vectors_matrices();
   if (!std::any_of(no.begin()+1, no.end(), [](element_t n){return n>0;}))
     return false;
@@ -497,7 +594,7 @@ bool InnerInterpolationData<T>::rip_real(
   std::array<int,9> ident = {1,0,0, 0,1,0, 0,0,1};
   // OpenMP < v3.0 (VS uses v2.0) requires signed indexes for omp parallel
   long long xsize = unsigned_to_signed<long long, size_t>(x.size());
-#pragma omp parallel for default(none) shared(x,ptsym,r,invR) private(offset, tmp_v, tmp_m) firstprivate(ident, no, sp, xsize) schedule(static)
+#pragma omp parallel for num_threads(nth) default(none) shared(x,ptsym,r,invR) private(offset, tmp_v, tmp_m) firstprivate(ident, no, sp, xsize) schedule(static)
   for (long long si=0; si<xsize; ++si){
     size_t i = signed_to_unsigned<size_t, long long>(si);
     if (!approx_matrix(3, ident.data(), ptsym.get(r[i]).data()))
@@ -526,7 +623,7 @@ template<typename T>
 bool InnerInterpolationData<T>::rip_axial(
   ArrayVector<T>& x, const PointSymmetry& ptsym, const std::vector<size_t>& r, const std::vector<size_t>& invR, const int nthreads
 ) const {
-  omp_set_num_threads((nthreads > 0) ? nthreads : omp_get_max_threads());
+  const int nth = (nthreads > 0) ? nthreads : omp_get_max_threads();
   ElementsType no = this->count_scalars_vectors_matrices();
   if (!std::any_of(no.begin() + 1, no.end(), [](element_t n) {return n > 0; }))
       return false;
@@ -539,7 +636,7 @@ bool InnerInterpolationData<T>::rip_axial(
   std::array<int,9> ident = {1,0,0, 0,1,0, 0,0,1};
   // OpenMP < v3.0 (VS uses v2.0) requires signed indexes for omp parallel
   long long xsize = unsigned_to_signed<long long, size_t>(x.size());
-#pragma omp parallel for default(none) shared(x,ptsym,r,invR,detR) private(offset, tmp_v, tmp_m) firstprivate(ident, no, sp, xsize) schedule(static)
+#pragma omp parallel for num_threads(nth) default(none) shared(x,ptsym,r,invR,detR) private(offset, tmp_v, tmp_m) firstprivate(ident, no, sp, xsize) schedule(static)
   for (long long si = 0; si < xsize; ++si) {
     size_t i = signed_to_unsigned<size_t, long long>(si);
     if (!approx_matrix(3, ident.data(), ptsym.get(r[i]).data()))
@@ -594,7 +691,7 @@ bool InnerInterpolationData<T>::rip_gamma_complex(
   if (! pgt.lattice().isstar(q.get_lattice()))
     throw std::runtime_error("The q points and GammaTable must be in mutually reciprocal lattices");
   verbose_update("InnerInterpolationData::rip_gamma_complex called with ",threads," threads");
-  omp_set_num_threads( (nthreads>0) ? nthreads : omp_get_max_threads() );
+  const int nth = (nthreads > 0) ? nthreads : omp_get_max_threads();
   ElementsType no = this->count_scalars_vectors_matrices();
   if (!std::any_of(no.begin()+1, no.end(), [](element_t n){return n>0;}))
     return false;
@@ -607,7 +704,7 @@ bool InnerInterpolationData<T>::rip_gamma_complex(
   element_t sp = this->branch_span();
   // OpenMP < v3.0 (VS uses v2.0) requires signed indexes for omp parallel
   long long xsize = unsigned_to_signed<long long, size_t>(x.size());
-#pragma omp parallel for default(none) \
+#pragma omp parallel for num_threads(nth) default(none) \
                          shared(x, q, pgt, ptsym, ridx, invRidx, e_iqd_gt) \
                          firstprivate(no, Nmat, sp, xsize) \
                          schedule(static)
@@ -673,8 +770,9 @@ bool InnerInterpolationData<T>::rip_gamma_complex(
 template<class T, class R> class InterpolationData{
   InnerInterpolationData<T> values_;
   InnerInterpolationData<R> vectors_;
+  unsigned long long generation_;
 public:
-  InterpolationData(): values_(), vectors_() {};
+  InterpolationData(): values_(), vectors_(), generation_(next_interpolation_data_generation()) {};
   //
   void validate_values() {
     if (values_.size()!=vectors_.size() || values_.branches()!=vectors_.branches())
@@ -691,6 +789,22 @@ public:
   }
   const InnerInterpolationData<T>& values() const {return this->values_;}
   const InnerInterpolationData<R>& vectors() const {return this->vectors_;}
+  /*! \brief A stamp which changes whenever the data, or its permutation costs, change
+
+  Copies share the stamp of their source, while any other two objects differ,
+  so interpolated results can be cached against it, see InterpolationCache.
+  */
+  unsigned long long generation() const {return generation_;}
+  //! The bytes held by the values and vectors, and how many of them are borrowed
+  MemoryUsage memory_usage() const {
+    MemoryUsage m;
+    m.values = values_.data_bytes();
+    m.vectors = vectors_.data_bytes();
+    m.auxiliary = values_.auxiliary_bytes() + vectors_.auxiliary_bytes();
+    if (values_.data().is_borrowed()) m.borrowed += m.values;
+    if (vectors_.data().is_borrowed()) m.borrowed += m.vectors;
+    return m;
+  }
   element_t branches() const {
     assert(values_.branches() == vectors_.branches());
     return values_.branches();
@@ -706,6 +820,8 @@ public:
   void interpolate_at(const std::vector<I>&, const std::vector<double>&, ArrayVector<T>&, ArrayVector<R>&, const size_t) const;
   template<typename I, typename=std::enable_if_t<std::is_integral<I>::value> >
   void interpolate_at(const std::vector<std::pair<I,double>>&, ArrayVector<T>&, ArrayVector<R>&, const size_t) const;
+  //! Execute an interpolation plan, gathering and summing the current data
+  std::tuple<ArrayVector<T>, ArrayVector<R>> interpolate_at(const InterpolationPlan&, const int) const;
   //
   template<typename I, typename=std::enable_if_t<std::is_integral<I>::value> >
   std::vector<std::vector<int>> get_permutations(const std::vector<I>&) const;
@@ -720,20 +836,36 @@ public:
 //  }
   //
   // Replace the data within this object.
-  template<typename... A> void replace_value_data(A... args) {
-    values_.replace_data(args...);
+  template<typename... A> void replace_value_data(A&&... args) {
+    values_.replace_data(std::forward<A>(args)...);
     this->validate_vectors();
+    generation_ = next_interpolation_data_generation();
   }
-  template<typename... A> void replace_vector_data(A... args) {
-    vectors_.replace_data(args...);
+  template<typename... A> void replace_vector_data(A&&... args) {
+    vectors_.replace_data(std::forward<A>(args)...);
     this->validate_values();
+    generation_ = next_interpolation_data_generation();
   }
   //
   void set_value_cost_info(const int csf, const int cvf, const ElementsCost& elcost){
     values_.set_cost_info(csf, cvf, elcost);
+    generation_ = next_interpolation_data_generation();
   }
   void set_vector_cost_info(const int csf, const int cvf, const ElementsCost& elcost){
     vectors_.set_cost_info(csf, cvf, elcost);
+    generation_ = next_interpolation_data_generation();
+  }
+  //! Write the values and vectors to a BinaryWriter
+  void serialize(BinaryWriter& w) const {
+    values_.serialize(w);
+    vectors_.serialize(w);
+  }
+  //! Read InterpolationData written by `serialize`, optionally referencing the reader's buffer
+  static InterpolationData<T,R> deserialize(BinaryReader& r, const bool borrow=false){
+    InterpolationData<T,R> d;
+    d.values_ = InnerInterpolationData<T>::deserialize(r, borrow);
+    d.vectors_ = InnerInterpolationData<R>::deserialize(r, borrow);
+    return d;
   }
   // create a string representation of the values and vectors
   std::string to_string() const {
@@ -824,7 +956,12 @@ InterpolationData<T,R>::interpolate_at(
   ArrayVector<R>& vectors_out,
   const size_t to
 ) const {
-  std::vector<std::vector<int>> permutations = this->get_permutations(indices);
+  std::vector<std::vector<int>> permutations;
+  {
+    ProfileTimer timer(ProfileStage::permute);
+    permutations = this->get_permutations(indices);
+  }
+  ProfileTimer timer(ProfileStage::sum);
   values_.interpolate_at(permutations, indices, weights, values_out, to, false);
   vectors_.interpolate_at(permutations, indices, weights, vectors_out, to, true);
 }
@@ -837,11 +974,48 @@ InterpolationData<T,R>::interpolate_at(
   ArrayVector<R>& vectors_out,
   const size_t to
 ) const {
-  std::vector<std::vector<int>> permutations = this->get_permutations(indices_weights);
+  std::vector<std::vector<int>> permutations;
+  {
+    ProfileTimer timer(ProfileStage::permute);
+    permutations = this->get_permutations(indices_weights);
+  }
+  ProfileTimer timer(ProfileStage::sum);
   values_.interpolate_at(permutations, indices_weights, values_out, to, false);
   vectors_.interpolate_at(permutations, indices_weights, vectors_out, to, true);
 }
 
+template<class T, class R>
+std::tuple<ArrayVector<T>, ArrayVector<R>>
+InterpolationData<T,R>::interpolate_at(const InterpolationPlan& plan, const int threads) const {
+  plan.check(this->size(), this->branches());
+  const int nth = (threads > 0) ? threads : omp_get_max_threads();
+  ArrayVector<T> values_out(values_.numel(), plan.size());
+  ArrayVector<R> vectors_out(vectors_.numel(), plan.size());
+  const bool stored = plan.has_permutations();
+  // private to each thread, only used if the permutations are not stored
+  std::vector<int> solved;
+  long long snp = unsigned_to_signed<long long, size_t>(plan.size());
+#pragma omp parallel for num_threads(nth) default(none) shared(plan, values_out, vectors_out, snp, stored) private(solved) schedule(dynamic)
+  for (long long si=0; si<snp; ++si){
+    size_t i = signed_to_unsigned<size_t, long long>(si);
+    if (!point_ok(plan.status()[i])) continue;
+    const size_t n = plan.count(i);
+    const size_t *indices = plan.indices(i);
+    const int *permutations = plan.permutations(i);
+    if (!stored){
+      ProfileTimer timer(ProfileStage::permute);
+      solved.clear();
+      for (const auto& perm: this->get_permutations(std::vector<size_t>(indices, indices+n)))
+        solved.insert(solved.end(), perm.begin(), perm.end());
+      permutations = solved.data();
+    }
+    ProfileTimer timer(ProfileStage::sum);
+    values_.interpolate_at(permutations, indices, plan.weights(i), n, values_out, i, false);
+    vectors_.interpolate_at(permutations, indices, plan.weights(i), n, vectors_out, i, true);
+  }
+  return std::make_tuple(values_out, vectors_out);
+}
+
 template<class T, class R> template<typename I, typename>
 std::vector<std::vector<int>>
 InterpolationData<T,R>::get_permutations(const std::vector<I>& indices) const{
@@ -849,6 +1023,7 @@ InterpolationData<T,R>::get_permutations(const std::vector<I>& indices) const{
   const I pvt{indices[0]};
   for (const I idx: indices)
     permutations.push_back(jv_permutation(this->cost_matrix(pvt, idx)));
+  Profile::count(ProfileCounter::permutation_solves, indices.size());
   return permutations;
 }
 template<class T, class R> template<typename I, typename>
@@ -858,6 +1033,7 @@ InterpolationData<T,R>::get_permutations(const std::vector<std::pair<I,double>>&
   const I pvt{iw[0].first};
   for (const auto pidx: iw)
     permutations.push_back(jv_permutation(this->cost_matrix(pvt, pidx.first)));
+  Profile::count(ProfileCounter::permutation_solves, iw.size());
   return permutations;
 }
 
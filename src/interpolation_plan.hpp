@@ -0,0 +1,134 @@
+/* Copyright 2020 Greg Tucker
+//
+// This file is part of brille.
+//
+// brille is free software: you can redistribute it and/or modify it under the
+// terms of the GNU Affero General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// brille is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with brille. If not, see <https://www.gnu.org/licenses/>.            */
+
+/*! \file */
+#ifndef _INTERPOLATION_PLAN_H_
+#define _INTERPOLATION_PLAN_H_
+#include <omp.h>
+#include <stdexcept>
+#include <vector>
+#include "point_status.hpp"
+#include "memory_usage.hpp"
+#include "utilities.hpp"
+
+/*! \brief The located vertices and weights, and optionally the branch
+           permutations, for a fixed set of points
+
+Locating the points within an interpolator and finding their weights depends
+only on the geometry, so a plan remains valid while the interpolation data is
+replaced. Executing a plan then only gathers and sums the data, see
+InterpolationData::interpolate_at.
+
+The branch permutations depend on the data; stored in the plan they fix the
+branch assignment found for the data present when planning, which is only
+appropriate while that assignment remains correct (e.g., for small changes to
+already-sorted data). Without them each execution solves the permutations for
+the current data.
+
+The vertex indices, weights, and permutations for all points are held in flat
+arrays, with the entries of point `i` starting at `offset(i)`.
+*/
+class InterpolationPlan{
+  size_t vertex_count_{0};           //!< the number of vertices of the planning interpolator
+  size_t branches_{0};               //!< the number of branches per stored permutation, zero if none
+  std::vector<size_t> offsets_;      //!< the first entry of each point, plus the total
+  std::vector<size_t> indices_;      //!< vertex indices for all points
+  std::vector<double> weights_;      //!< vertex weights for all points
+  std::vector<int> permutations_;    //!< `branches_` permutation entries per vertex index
+  std::vector<PointStatus> status_;  //!< the outcome of locating each point
+public:
+  InterpolationPlan() = default;
+  /*! \brief Locate points and pack their vertices, weights and permutations
+
+    @param vertex_count The number of vertices of the interpolator
+    @param n The number of points
+    @param status The status of each point on entry, see prepare_status
+    @param locate A callable `PointStatus(size_t i, std::vector<I>& indices, std::vector<double>& weights)`
+    @param permute A callable returning the permutations, as a
+                   `std::vector<std::vector<int>>`, for a `std::vector<I>` of indices
+    @param branches The number of branches per permutation, or zero to not
+                    store permutations in which case `permute` is not called
+    @param threads The number of OpenMP threads to use
+  */
+  template<class I, class L, class P>
+  static InterpolationPlan build(
+    const size_t vertex_count, const size_t n, std::vector<PointStatus> status,
+    L locate, P permute, size_t branches, const int threads
+  ){
+    const int nth = (threads > 0) ? threads : omp_get_max_threads();
+    prepare_status(status, n);
+    // find each point's vertices, weights, and permutations independently
+    std::vector<std::vector<size_t>> p_indices(n);
+    std::vector<std::vector<double>> p_weights(n);
+    std::vector<std::vector<int>> p_perms(n);
+    std::vector<I> indices;
+    std::vector<double> weights;
+    long long sn = unsigned_to_signed<long long, size_t>(n);
+  #pragma omp parallel for num_threads(nth) default(none) shared(status, p_indices, p_weights, p_perms, locate, permute, sn, branches) private(indices, weights) schedule(dynamic)
+    for (long long si=0; si<sn; ++si){
+      size_t i = signed_to_unsigned<size_t, long long>(si);
+      if (!point_ok(status[i])) continue;
+      status[i] = locate(i, indices, weights);
+      if (!point_ok(status[i])) continue;
+      p_indices[i].assign(indices.begin(), indices.end());
+      p_weights[i] = weights;
+      if (branches) for (const auto& perm: permute(indices))
+        p_perms[i].insert(p_perms[i].end(), perm.begin(), perm.end());
+    }
+    // and pack them into the flat arrays
+    InterpolationPlan plan;
+    plan.vertex_count_ = vertex_count;
+    plan.branches_ = branches;
+    plan.offsets_.resize(n+1, 0u);
+    for (size_t i=0; i<n; ++i) plan.offsets_[i+1] = plan.offsets_[i] + p_indices[i].size();
+    plan.indices_.reserve(plan.offsets_[n]);
+    plan.weights_.reserve(plan.offsets_[n]);
+    plan.permutations_.reserve(branches*plan.offsets_[n]);
+    for (size_t i=0; i<n; ++i){
+      plan.indices_.insert(plan.indices_.end(), p_indices[i].begin(), p_indices[i].end());
+      plan.weights_.insert(plan.weights_.end(), p_weights[i].begin(), p_weights[i].end());
+      plan.permutations_.insert(plan.permutations_.end(), p_perms[i].begin(), p_perms[i].end());
+    }
+    plan.status_ = std::move(status);
+    return plan;
+  }
+  //! The number of points
+  size_t size() const {return status_.size();}
+  size_t vertex_count() const {return vertex_count_;}
+  size_t branches() const {return branches_;}
+  bool has_permutations() const {return branches_ > 0u;}
+  const std::vector<PointStatus>& status() const {return status_;}
+  //! The number of vertices used for point `i`
+  size_t count(const size_t i) const {return offsets_[i+1] - offsets_[i];}
+  const size_t* indices(const size_t i) const {return indices_.data() + offsets_[i];}
+  const double* weights(const size_t i) const {return weights_.data() + offsets_[i];}
+  const int* permutations(const size_t i) const {return permutations_.data() + branches_*offsets_[i];}
+  //! The bytes held by the plan
+  size_t memory_bytes() const {
+    return ::memory_bytes(offsets_) + ::memory_bytes(indices_) + ::memory_bytes(weights_)
+         + ::memory_bytes(permutations_) + ::memory_bytes(status_);
+  }
+  //! Ensure the plan was made for an interpolator with `vertex_count` vertices and `branches` branches
+  void check(const size_t vertex_count, const size_t branches) const {
+    if (vertex_count != vertex_count_)
+      throw std::runtime_error("The interpolation plan was made for an interpolator with a different number of vertices");
+    if (branches_ && branches != branches_)
+      throw std::runtime_error("The interpolation plan permutations are for a different number of branches");
+  }
+};
+
+#endif
@@ -17,6 +17,155 @@
 
 #include "lattice.hpp"
 #include "hall_symbol.hpp"
+#include <map>
+#include <mutex>
+
+static Symmetry add_space_inversion(const Symmetry& spgsym){
+  Symmetry gens = spgsym.generators();
+  Motion<int,double> space_inversion({{-1,0,0, 0,-1,0, 0,0,-1}},{{0.,0.,0.}});
+  gens.add(space_inversion);
+  return gens.generate();
+}
+static PointSymmetry add_space_inversion(const PointSymmetry& ptgsym){
+  // time_reversal == space_inversion. requested but not present
+  // get the generators of the pointgroup
+  PointSymmetry gens = ptgsym.generators();
+  // add time-reversal/space-inversion
+  std::array<int,9> trsi{{-1,0,0, 0,-1,0, 0,0,-1}};
+  gens.add(trsi);
+  // generate the new pointgroup
+  return gens.generate();
+}
+
+// Fill entry [1] of the symmetry operations from entry [0]
+static void add_time_reversal(LatticeSymmetry& sym){
+  sym.spgsym[1] = sym.spgsym[0]->has_space_inversion() ? sym.spgsym[0]
+                : std::make_shared<const Symmetry>(add_space_inversion(*sym.spgsym[0]));
+  sym.ptgsym[1] = sym.ptgsym[0]->has_space_inversion() ? sym.ptgsym[0]
+                : std::make_shared<const PointSymmetry>(add_space_inversion(*sym.ptgsym[0]));
+}
+// The process-wide table of symmetry information, indexed by Hall number.
+static std::shared_ptr<const LatticeSymmetry> interned_symmetry(const int hall_number){
+  static std::mutex table_mutex;
+  static std::map<int, std::shared_ptr<const LatticeSymmetry>> table;
+  std::lock_guard<std::mutex> lock(table_mutex);
+  auto itr = table.find(hall_number);
+  if (itr != table.end()) return itr->second;
+  // invalid Hall numbers throw here, leaving the table unchanged
+  auto entry = std::make_shared<LatticeSymmetry>();
+  entry->spg = Spacegroup(hall_number);
+  entry->ptg = entry->spg.get_pointgroup();
+  entry->spgsym[0] = std::make_shared<const Symmetry>(entry->spg.get_spacegroup_symmetry());
+  entry->ptgsym[0] = std::make_shared<const PointSymmetry>(entry->spg.get_pointgroup_symmetry());
+  add_time_reversal(*entry);
+  table.emplace(hall_number, entry);
+  return entry;
+}
+std::shared_ptr<const Symmetry> interned_spacegroup_symmetry(const int hall_number, const int time_reversal){
+  return interned_symmetry(hall_number)->spgsym[time_reversal ? 1 : 0];
+}
+std::shared_ptr<const PointSymmetry> interned_pointgroup_symmetry(const int hall_number, const int time_reversal){
+  return interned_symmetry(hall_number)->ptgsym[time_reversal ? 1 : 0];
+}
+
+static double lattice_volume(const std::array<double,3>& l, const std::array<double,3>& a){
+  // we could replace this by l[0]*l[1]*l[2]*this->unitvolume()
+  double tmp=1;
+  tmp *= sin(( a[0] +a[1] +a[2])/2.0);
+  tmp *= sin((-a[0] +a[1] +a[2])/2.0);
+  tmp *= sin(( a[0] -a[1] +a[2])/2.0);
+  tmp *= sin(( a[0] +a[1] -a[2])/2.0);
+  tmp = sqrt(tmp);
+  tmp *= 2*l[0]*l[1]*l[2];
+  return tmp;
+}
+static void star_parameters(const std::array<double,3>& l, const std::array<double,3>& a, const double volume, std::array<double,3>& sl, std::array<double,3>& sa){
+  sl[0] = 2*PI*l[1]*l[2]*sin(a[0])/volume;
+  sl[1] = 2*PI*l[2]*l[0]*sin(a[1])/volume;
+  sl[2] = 2*PI*l[0]*l[1]*sin(a[2])/volume;
+  double cosa, cosb, cosc, sina, sinb, sinc;
+  cosa = cos(a[0]);
+  cosb = cos(a[1]);
+  cosc = cos(a[2]);
+  sina = sin(a[0]);
+  sinb = sin(a[1]);
+  sinc = sin(a[2]);
+  sa[0] = acos( (cosb*cosc-cosa)/(sinb*sinc) );
+  sa[1] = acos( (cosc*cosa-cosb)/(sinc*sina) );
+  sa[2] = acos( (cosa*cosb-cosc)/(sina*sinb) );
+}
+static void metric_tensor(const std::array<double,3>& l, const std::array<double,3>& a, double* mt){
+  double cosa, cosb, cosc;
+  cosa = cos(a[0]);
+  cosb = cos(a[1]);
+  cosc = cos(a[2]);
+
+  mt[0] = l[0]*l[0];
+  mt[1] = l[1]*l[0]*cosc;
+  mt[2] = l[2]*l[0]*cosb;
+
+  mt[3] = l[0]*l[1]*cosc;
+  mt[4] = l[1]*l[1];
+  mt[5] = l[2]*l[1]*cosa;
+
+  mt[6] = l[0]*l[2]*cosb;
+  mt[7] = l[1]*l[2]*cosa;
+  mt[8] = l[2]*l[2];
+}
+// The B matrix of the reciprocal lattice (l,a) with inverse lattice (dl,da)
+static void b_matrix(const std::array<double,3>& l, const std::array<double,3>& a, const std::array<double,3>& dl, const std::array<double,3>& da, double* B){
+  //Calculate the B-matrix as in Acta Cryst. (1967). 22, 457
+  // http://dx.doi.org/10.1107/S0365110X67000970
+  double asb, asg;
+  asb = sin(a[1]);
+  if (asb<0) asb*=-1.0;
+  asg = sin(a[2]);
+  if (asg<0) asg*=-1.0;
+  // Be careful about indexing B. Make sure each vector goes in as a column, not a row!
+  // if you mix this up, you'll only notice for non-orthogonal space groups
+
+  // a-star along x -- first column
+  B[0] = l[0];
+  B[3] = 0.0;
+  B[6] = 0.0;
+  // b-star in the x-y plane -- second column
+  B[1] = l[1]*cos(a[2]);
+  B[4] = l[1]*asg;
+  B[7] = 0.0;
+  // and c-star -- third column
+  B[2] = l[2]*cos(a[1]);
+  B[5] = -1.0*l[2]*asb*cos(da[0]);
+  B[8] = 2*PI/dl[2];
+}
+std::shared_ptr<const LatticeMetric> interned_lattice_metric(const std::array<double,3>& len, const std::array<double,3>& ang, const double volume){
+  static std::mutex table_mutex;
+  static std::map<std::array<double,6>, std::weak_ptr<const LatticeMetric>> table;
+  static size_t swept_size{16};
+  std::array<double,6> key{{len[0],len[1],len[2],ang[0],ang[1],ang[2]}};
+  std::lock_guard<std::mutex> lock(table_mutex);
+  auto itr = table.find(key);
+  if (itr != table.end()){
+    auto existing = itr->second.lock();
+    if (existing) return existing;
+  }
+  auto m = std::make_shared<LatticeMetric>();
+  metric_tensor(len, ang, m->covariant.data());
+  matrix_inverse(m->contravariant.data(), m->covariant.data());
+  // the inverse lattice, and its inverse, as calculated by Lattice::star()
+  std::array<double,3> ssl, ssa;
+  star_parameters(len, ang, volume, m->star_len, m->star_ang);
+  m->star_volume = lattice_volume(m->star_len, m->star_ang);
+  star_parameters(m->star_len, m->star_ang, m->star_volume, ssl, ssa);
+  b_matrix(len, ang, m->star_len, m->star_ang, m->B.data());
+  b_matrix(m->star_len, m->star_ang, ssl, ssa, m->star_B.data());
+  table[key] = m;
+  // drop the entries of lattices which no longer exist
+  if (table.size() > 2*swept_size){
+    for (auto i = table.begin(); i != table.end();) i = i->second.expired() ? table.erase(i) : std::next(i);
+    swept_size = (std::max)(table.size(), static_cast<size_t>(16));
+  }
+  return m;
+}
 
 Lattice::Lattice(const double* latmat, const int h){
   double l[3]={0,0,0}, a[3]={0,0,0};
@@ -91,24 +240,23 @@ void Lattice::check_ang(const AngleUnit angle_unit){
   }
 }
 void Lattice::check_hall_number(const int h){
-  this->spg = Spacegroup(h); // if h is invalid the next three lines might fail`
-  this->ptg = this->spg.get_pointgroup();
-  this->spgsym = this->spg.get_spacegroup_symmetry();
-  this->ptgsym = this->spg.get_pointgroup_symmetry();
+  this->symmetry = interned_symmetry(h); // throws if h is invalid
 }
 void Lattice::check_IT_name(const std::string& itname, const std::string& choice){
   int hall_number = string_to_hall_number(itname, choice);
   if (hall_number > 0 && hall_number < 531){
     this->check_hall_number(hall_number);
   } else {
+    Spacegroup spg;
+    Symmetry fullsym;
     // maybe itname is actually a non-standard Hall symbol?
     // possibly leave Spacegroup and Pointgroup (partially) unset
     HallSymbol hs(itname);
     if (hs.validate()){
       Symmetry generators = hs.get_generators();
-      this->spgsym = generators.generate();
-      this->spg.set_hall_symbol(hs.to_ascii()); // use a standardized form
-      this->spg.set_bravais_type(hs.getl());
+      fullsym = generators.generate();
+      spg.set_hall_symbol(hs.to_ascii()); // use a standardized form
+      spg.set_bravais_type(hs.getl());
     } else {
       // last-ditch effort: maybe x,y,z notation Seitz matrices were passed?
       std::istringstream stream(itname);
@@ -117,11 +265,20 @@ void Lattice::check_IT_name(const std::string& itname, const std::string& choice
       Symmetry mgens(motions);
       Motion<int,double> mone; // initalised to {𝟙|0}
       if (!mgens.has(mone)) mgens.add(mone); // make sure {𝟙|0}≡E is present
-      this->spgsym = mgens.generate();
+      fullsym = mgens.generate();
     }
-    this->ptgsym = PointSymmetry(get_unique_rotations(this->spgsym.getallr(),0));
+    this->set_nonstandard_symmetry(fullsym, spg);
   }
 }
+void Lattice::set_nonstandard_symmetry(const Symmetry& fullsym, const Spacegroup& spg){
+  // non-standard symmetries are not interned, but are still shared by copies
+  auto sym = std::make_shared<LatticeSymmetry>();
+  sym->spg = spg;
+  sym->spgsym[0] = std::make_shared<const Symmetry>(fullsym);
+  sym->ptgsym[0] = std::make_shared<const PointSymmetry>(get_unique_rotations(fullsym.getallr(),0));
+  add_time_reversal(*sym);
+  this->symmetry = sym;
+}
 double Lattice::unitvolume() const{
   // The volume of a parallelpiped with unit length sides and our body angles
   double c[3];
@@ -134,18 +291,11 @@ double Lattice::unitvolume() const{
   return std::sqrt( 1 - sos + prd );
 }
 double Lattice::calculatevolume(){
-  // we could replace this by l[0]*l[1]*l[2]*this->unitvolume()
-  double tmp=1;
-  double *a = this->ang.data();
-  double *l = this->len.data();
-  tmp *= sin(( a[0] +a[1] +a[2])/2.0);
-  tmp *= sin((-a[0] +a[1] +a[2])/2.0);
-  tmp *= sin(( a[0] -a[1] +a[2])/2.0);
-  tmp *= sin(( a[0] +a[1] -a[2])/2.0);
-  tmp = sqrt(tmp);
-  tmp *= 2*l[0]*l[1]*l[2];
+  double tmp = lattice_volume(this->len, this->ang);
   this->volume = tmp;
   if (std::isnan(tmp)){
+    double *a = this->ang.data();
+    double *l = this->len.data();
     std::string msg = "Invalid lattice unit cell ";
     if (std::isnan(this->unitvolume())){
       msg += "angles [";
@@ -158,68 +308,40 @@ double Lattice::calculatevolume(){
     }
     throw std::domain_error(msg);
   }
+  this->metric = interned_lattice_metric(this->len, this->ang, tmp);
   return tmp;
 }
 Lattice Lattice::inner_star() const {
-  const double *a = this->ang.data();
-  const double *l = this->len.data();
-
-  double sas, sbs, scs;
-  sas = 2*PI*l[1]*l[2]*sin(a[0])/this->volume;
-  sbs = 2*PI*l[2]*l[0]*sin(a[1])/this->volume;
-  scs = 2*PI*l[0]*l[1]*sin(a[2])/this->volume;
-
-  double cosa, cosb, cosc, sina, sinb, sinc;
-  cosa = cos(a[0]);
-  cosb = cos(a[1]);
-  cosc = cos(a[2]);
-  sina = sin(a[0]);
-  sinb = sin(a[1]);
-  sinc = sin(a[2]);
-  double saa, sbb, scc;
-  saa = acos( (cosb*cosc-cosa)/(sinb*sinc) );
-  sbb = acos( (cosc*cosa-cosb)/(sinc*sina) );
-  scc = acos( (cosa*cosb-cosc)/(sina*sinb) );
-
-  Lattice out(sas, sbs, scs, saa, sbb, scc, this->get_hall());
-  out.set_basis(this->get_basis());
+  // the inverse lattice shares the symmetry and basis of this lattice
+  Lattice out(*this);
+  out.len = this->metric->star_len;
+  out.ang = this->metric->star_ang;
+  out.volume = this->metric->star_volume;
+  out.metric = interned_lattice_metric(out.len, out.ang, out.volume);
   return out;
 }
 void Lattice::get_metric_tensor(double * mt) const {
-  const double *a = this->ang.data();
-  const double *l = this->len.data();
-
-  double cosa, cosb, cosc;
-  cosa = cos(a[0]);
-  cosb = cos(a[1]);
-  cosc = cos(a[2]);
-
-  mt[0] = l[0]*l[0];
-  mt[1] = l[1]*l[0]*cosc;
-  mt[2] = l[2]*l[0]*cosb;
-
-  mt[3] = l[0]*l[1]*cosc;
-  mt[4] = l[1]*l[1];
-  mt[5] = l[2]*l[1]*cosa;
-
-  mt[6] = l[0]*l[2]*cosb;
-  mt[7] = l[1]*l[2]*cosa;
-  mt[8] = l[2]*l[2];
+  std::copy(this->metric->covariant.begin(), this->metric->covariant.end(), mt);
 }
 void Lattice::get_covariant_metric_tensor(double *mt) const {
   this->get_metric_tensor(mt);
 }
 void Lattice::get_contravariant_metric_tensor(double *mt) const {
-  double *tmp = nullptr;
-  tmp = new double[9]();
-  this->get_metric_tensor(tmp);
-  matrix_inverse(mt,tmp);
-  delete[] tmp;
+  std::copy(this->metric->contravariant.begin(), this->metric->contravariant.end(), mt);
 }
 
 bool Lattice::issame(const Lattice& lat) const{
+  // interned metrics are shared by lattices with identical parameters
+  if (this->metric == lat.metric) return true;
   return approx_vector(3, this->ang.data(), lat.ang.data()) && approx_vector(3, this->len.data(), lat.len.data());
 }
+// Determine if the inverse of either this lattice or lat is the other lattice
+bool Lattice::star_issame(const Lattice& lat) const{
+  // we need to check both ways in case rounding errors in the inversion cause a problem
+  const LatticeMetric& m{*this->metric}, & o{*lat.metric};
+  return (approx_vector(3, m.star_ang.data(), lat.ang.data()) && approx_vector(3, m.star_len.data(), lat.len.data()))
+      || (approx_vector(3, o.star_ang.data(), this->ang.data()) && approx_vector(3, o.star_len.data(), this->len.data()));
+}
 
 bool Lattice::isapprox(const Lattice& lat) const {
   return this->ispermutation(lat)==0 ? false : true;
@@ -305,8 +427,8 @@ void Direct::get_xyz_transform(double *toxyz, const size_t c, const size_t r) co
   // there are infinite possibilities for your choice of axes.
   // the original spglib used x along a and y in the (a,b) plane
   // here we're going with x along astar and y in the (astar, bstar) plane -- this is the "B-matrix"
-  double B[9], t[9];
-  this->star().get_B_matrix(B, 3u, 1u);
+  double t[9];
+  const double* B = this->metric->star_B.data();
   // we want toxyz to be 2*pi*transpose(inverse(B));
   // use t as a buffer
   matrix_inverse(t,B);
@@ -350,28 +472,7 @@ template<class I> void Reciprocal::get_B_matrix(double* B, std::vector<I>& strid
 void Reciprocal::get_B_matrix(double *B, const size_t c, const size_t r) const {
   //Calculate the B-matrix as in Acta Cryst. (1967). 22, 457
   // http://dx.doi.org/10.1107/S0365110X67000970
-  Direct d = this->star();
-
-  double asb, asg;
-  asb = sin(this->get_beta());
-  if (asb<0) asb*=-1.0;
-  asg = sin(this->get_gamma());
-  if (asg<0) asg*=-1.0;
-  // Be careful about indexing B. Make sure each vector goes in as a column, not a row!
-  // if you mix this up, you'll only notice for non-orthogonal space groups
-
-  // a-star along x -- first column (constant row index = 0)
-  B[0*c+0*r] = this->get_a();
-  B[1*c+0*r] = 0.0;
-  B[2*c+0*r] = 0.0;
-  // b-star in the x-y plane -- second column
-  B[0*c+1*r] = this->get_b()*cos(this->get_gamma());
-  B[1*c+1*r] = this->get_b()*asg;
-  B[2*c+1*r] = 0.0;
-  // and c-star -- third column
-  B[0*c+2*r] = this->get_c()*cos(this->get_beta());
-  B[1*c+2*r] = -1.0*(this->get_c())*asb*cos(d.get_alpha());
-  B[2*c+2*r] = 2*PI/d.get_c();
+  for (size_t i=0; i<3u; ++i) for (size_t j=0; j<3u; ++j) B[i*c+j*r] = this->metric->B[3*i+j];
 }
 void Reciprocal::get_xyz_transform(double *toxyz) const { this->get_xyz_transform(toxyz, 3u, 1u); }
 template<class I> void Reciprocal::get_xyz_transform(double* toxyz, std::vector<I>& strides) const {
@@ -400,13 +501,11 @@ void Reciprocal::get_inverse_xyz_transform(double *fromxyz, const size_t c, cons
 // We have to define these separately from Lattice since Lattice.star() doesn't exist.
 bool Direct::isstar(const Reciprocal& latt) const{
   // two lattices are the star of each other if the star of one is the same as the other
-  // we need to check both ways in case rounding errors in the inversion cause a problem
-  return ( this->issame( latt.star() ) || latt.issame( this->star() ) );
+  return this->star_issame(latt);
 }
 bool Reciprocal::isstar(const Direct& latt) const{
   // two lattices are the star of each other if the star of one is the same as the other
-  // we need to check both ways in case rounding errors in the inversion cause a problem
-  return ( this->issame( latt.star() ) || latt.issame( this->star() ) );
+  return this->star_issame(latt);
 }
 
 //bool Direct::issame(const Reciprocal) const {printf("call to Direct::issame(Reciprocal)\n"); return false;}
@@ -425,7 +524,7 @@ void Reciprocal::print(){
 
 
 Direct Direct::primitive(void) const{
-  PrimitiveTransform P(this->spg.get_bravais_type());
+  PrimitiveTransform P(this->symmetry->spg.get_bravais_type());
   if (P.does_anything()){
     double plm[9], lm[9];
     this->get_lattice_matrix(lm); // now returns *row* vectors!
@@ -445,3 +544,44 @@ Reciprocal Reciprocal::primitive(void) const{
   // of the reciprocal of this lattice.
   return this->star().primitive().star();
 }
+
+void Lattice::serialize(BinaryWriter& w) const {
+  w.write(this->len);
+  w.write(this->ang);
+  w.write(this->get_hall());
+  if (0 == this->get_hall()){
+    // a non-standard symmetry can not be recovered from its Hall number
+    const Symmetry& fullsym{this->get_spacegroup_symmetry()};
+    w.write(this->symmetry->spg.get_hall_symbol());
+    w.write(this->symmetry->spg.get_bravais_type());
+    w.write(fullsym.getallr());
+    w.write(fullsym.getallt());
+  }
+  this->basis->serialize(w);
+}
+template<class L> L Lattice::deserialize_lattice(BinaryReader& r){
+  std::array<double,3> l, a;
+  r.read(l);
+  r.read(a);
+  int h = r.read<int>();
+  // the stored angles are in radian, and the metric is re-interned from them
+  L lat(l.data(), a.data(), h ? h : 1, AngleUnit::radian);
+  if (0 == h){
+    Spacegroup spg;
+    spg.set_hall_symbol(r.read<std::string>());
+    spg.set_bravais_type(r.read<Bravais>());
+    Matrices<int> rot;
+    Vectors<double> tra;
+    r.read(rot);
+    r.read(tra);
+    if (rot.size() != tra.size())
+      throw std::runtime_error("Inconsistent serialized symmetry operations");
+    Symmetry fullsym;
+    for (size_t i=0; i<rot.size(); ++i) fullsym.add(rot[i], tra[i]);
+    lat.set_nonstandard_symmetry(fullsym, spg);
+  }
+  lat.set_basis(Basis::deserialize(r));
+  return lat;
+}
+Direct Direct::deserialize(BinaryReader& r){ return deserialize_lattice<Direct>(r); }
+Reciprocal Reciprocal::deserialize(BinaryReader& r){ return deserialize_lattice<Reciprocal>(r); }
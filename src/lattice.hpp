@@ -20,6 +20,7 @@
 
 #include <assert.h>
 #include <vector>
+#include <memory>
 // #include "utilities.hpp"
 #include "primitive.hpp"
 #include "basis.hpp"
@@ -32,6 +33,56 @@ class Reciprocal;
 
 enum class AngleUnit { not_provided, radian, degree, pi };
 
+/*! \brief The shared spacegroup symmetry operations for a Hall number
+
+Each (Hall number, time_reversal) pair is generated once per process and the
+same immutable object is returned by every subsequent call, from any thread.
+If time_reversal is non-zero and the spacegroup lacks space inversion it is
+added to the generators before the full group is generated.
+*/
+std::shared_ptr<const Symmetry> interned_spacegroup_symmetry(const int hall_number, const int time_reversal=0);
+/*! \brief The shared pointgroup symmetry operations for a Hall number
+
+As `interned_spacegroup_symmetry` but for the pointgroup rotations.
+*/
+std::shared_ptr<const PointSymmetry> interned_pointgroup_symmetry(const int hall_number, const int time_reversal=0);
+
+/*! \brief The symmetry information shared by Lattice objects
+
+Entry [0] of each array holds the symmetry operations of the spacegroup and
+entry [1] those with time-reversal symmetry added; [1] is the same object as
+[0] if the group already has space inversion.
+*/
+struct LatticeSymmetry{
+  Spacegroup spg; //!< Spacegroup information
+  Pointgroup ptg; //!< Pointgroup information
+  std::array<std::shared_ptr<const Symmetry>,2> spgsym; //!< Spacegroup symmetry operators
+  std::array<std::shared_ptr<const PointSymmetry>,2> ptgsym; //!< Pointgroup symmetry operators
+};
+
+/*! \brief Quantities derived from the lengths and angles of a Lattice
+
+Every Lattice with bitwise-identical basis vector lengths and angles shares
+one immutable LatticeMetric, so two lattices with the same metric pointer are
+certainly the same space-spanning lattice and lattice vector compatibility
+checks reduce to a pointer comparison.
+*/
+struct LatticeMetric{
+  std::array<double,9> covariant;     //!< the metric tensor
+  std::array<double,9> contravariant; //!< the inverse of the metric tensor
+  std::array<double,3> star_len;      //!< the basis vector lengths of the inverse lattice
+  std::array<double,3> star_ang;      //!< the basis vector angles of the inverse lattice
+  double star_volume;                 //!< the unit cell volume of the inverse lattice
+  std::array<double,9> B;             //!< the row-ordered B matrix of this lattice as a reciprocal lattice
+  std::array<double,9> star_B;        //!< the row-ordered B matrix of the inverse lattice
+};
+/*! \brief The shared LatticeMetric for a set of lattice parameters
+
+Lattices which are alive at the same time and have bitwise-identical
+parameters receive the same object.
+*/
+std::shared_ptr<const LatticeMetric> interned_lattice_metric(const std::array<double,3>& len, const std::array<double,3>& ang, const double volume);
+
 template<class T, class I> void latmat_to_lenang(const T* latmat, const I c, const I r, T* len, T* ang){
   T n[9];
   // compute the dot product of each row with itself
@@ -62,14 +113,13 @@ protected:
   std::array<double,3> len; //!< basis vector lengths
   std::array<double,3> ang; //!< basis vector angles ordered θ₁₂, θ₀₂, θ₀₁, in radian
   double volume; //!< volume of the unit cell formed by the basis vectors
-  Spacegroup spg; //!< Spacegroup information
-  Symmetry spgsym; //!< Spacegroup symmetry operators
-  Pointgroup ptg; //!< Pointgroup information
-  PointSymmetry ptgsym; //!< Pointgroup symmetry operators
-  Basis basis; //!< The positions of all atoms within the unit cell
+  std::shared_ptr<const LatticeMetric> metric; //!< Interned quantities derived from len and ang
+  std::shared_ptr<const LatticeSymmetry> symmetry; //!< Spacegroup and pointgroup information, shared between lattices
+  std::shared_ptr<const Basis> basis = std::make_shared<const Basis>(); //!< The positions of all atoms within the unit cell
 protected:
   double unitvolume() const;
   Lattice inner_star() const;
+  bool star_issame(const Lattice&) const;
   template<class I>
   void set_len_pointer(const double *lvec, const I span){
     for (int i=0;i<3;i++) this->len[i] = lvec[i*span];
@@ -97,6 +147,8 @@ protected:
   void check_ang(const AngleUnit);
   void check_hall_number(const int h);
   void check_IT_name(const std::string& itname, const std::string& choice="");
+  void set_nonstandard_symmetry(const Symmetry& fullsym, const Spacegroup& spg=Spacegroup());
+  template<class L> static L deserialize_lattice(BinaryReader&);
 public:
   //! Construct the Lattice from a matrix of the basis vectors
   Lattice(const double *, const int h=1);
@@ -176,7 +228,9 @@ public:
   double get_gamma () const {return ang[2];}
   //! Return the volume of the parallelpiped unit cell formed by the basis vectors
   double get_volume() const {return volume;}
-  //! Calculate and return the unit cell volume
+  //! Return the interned quantities derived from the basis vector lengths and angles
+  const std::shared_ptr<const LatticeMetric>& get_metric() const {return metric;}
+  //! Calculate and return the unit cell volume, and find the shared LatticeMetric
   double calculatevolume();
   /*! Calculate the metric tensor of the Lattice
   @param[out] mt Pointer to memory which can store 9 doubles
@@ -222,50 +276,47 @@ public:
   //! Return a string representation of the basis vector lengths and angles
   virtual std::string string_repr();
   //! Return the Hall number of the Lattice
-  int get_hall() const {return spg.get_hall_number();}
+  int get_hall() const {return symmetry->spg.get_hall_number();}
   //! Set the symmetry of the Lattice by changing the Hall number
   int set_hall(const int h) { check_hall_number(h); return get_hall(); }
   //! Return the Spacegroup object of the Lattice
-  Spacegroup get_spacegroup_object() const { return spg; }
+  const Spacegroup& get_spacegroup_object() const { return symmetry->spg; }
   //! Return the Pointgroup object of the Lattice
-  Pointgroup get_pointgroup_object() const { return ptg; }
-  //! Return the Spacegroup symmetry operation object of the Lattice
-  Symmetry get_spacegroup_symmetry(const int time_reversal=0) const {
-    if (time_reversal && !spgsym.has_space_inversion()){
-      Symmetry gens = spgsym.generators();
-      Motion<int,double> space_inversion({{-1,0,0, 0,-1,0, 0,0,-1}},{{0.,0.,0.}});
-      gens.add(space_inversion);
-      return gens.generate();
-    }
-    return spgsym;
+  const Pointgroup& get_pointgroup_object() const { return symmetry->ptg; }
+  /*! \brief Return the Spacegroup symmetry operation object of the Lattice
+
+  The returned object is shared between all lattices with the same symmetry,
+  and is never modified.
+  */
+  const Symmetry& get_spacegroup_symmetry(const int time_reversal=0) const {
+    return *symmetry->spgsym[time_reversal ? 1 : 0];
   }
-  //! Return the Pointgroup Symmetry operation object of the Lattice
-  PointSymmetry get_pointgroup_symmetry(const int time_reversal=0) const {
-    if (time_reversal && !ptgsym.has_space_inversion()){
-      // time_reversal == space_inversion. requested but not present
-      // get the generators of the pointgroup
-      PointSymmetry gens = ptgsym.generators();
-      // add time-reversal/space-inversion
-      std::array<int,9> trsi{{-1,0,0, 0,-1,0, 0,0,-1}};
-      gens.add(trsi);
-      // generate the new pointgroup
-      return gens.generate();
-    } else {
-      return ptgsym;
-    }
+  /*! \brief Return the Pointgroup Symmetry operation object of the Lattice
+
+  The returned object is shared between all lattices with the same symmetry,
+  and is never modified.
+  */
+  const PointSymmetry& get_pointgroup_symmetry(const int time_reversal=0) const {
+    return *symmetry->ptgsym[time_reversal ? 1 : 0];
   }
   //! Check whether the pointgroup has the space-inversion operator, ̄1.
-  bool has_space_inversion() const { return ptgsym.has_space_inversion(); }
-  Basis get_basis() const {return basis; }
+  bool has_space_inversion() const { return symmetry->ptgsym[0]->has_space_inversion(); }
+  const Basis& get_basis() const {return *basis; }
   //template <class R, class II>
   Basis set_basis(const std::vector<std::array<double,3>>& pos, const std::vector<unsigned long>& typ) {
-    this->basis = Basis(pos, typ);
+    this->basis = std::make_shared<const Basis>(pos, typ);
     return this->get_basis();
   }
   Basis set_basis(const Basis& b) {
-    this->basis = b;
+    this->basis = std::make_shared<const Basis>(b);
     return this->get_basis();
   }
+  /*! \brief Write the lengths, angles, symmetry, and basis to a BinaryWriter
+
+  Symmetries without a standard Hall number are written as their full set of
+  symmetry operations.
+  */
+  void serialize(BinaryWriter&) const;
 };
 
 /*! \brief A space-spanning Lattice that exists in real space
@@ -300,6 +351,8 @@ public:
   std::string string_repr() override;
   //! For non-Primitive Direct lattices, return the equivalent Primitive lattice
   Direct primitive(void) const;
+  //! Read a Direct lattice written by `serialize`
+  static Direct deserialize(BinaryReader&);
 };
 /*! \brief A space-spanning Lattice that exists in reciprocal space
 
@@ -337,6 +390,8 @@ public:
   std::string string_repr() override;
   //! For non-Primitive Reciprocal lattices, return the equivalent Primitive Reciprocal lattice
   Reciprocal primitive(void) const;
+  //! Read a Reciprocal lattice written by `serialize`
+  static Reciprocal deserialize(BinaryReader&);
 };
 
 /*! \brief Type information for Lattice and LatVec objects
@@ -18,6 +18,7 @@
 #ifndef _LATVEC_CLASS_H_
 #define _LATVEC_CLASS_H_
 
+#include <array>
 #include <typeinfo> // for std::bad_cast
 #include <exception>
 #include "lattice.hpp"
@@ -56,6 +57,8 @@ public:
   }
   //! Copy constructor, optionally verifying that only 3-element arrays are provided.
   LDVec(const Direct& lat, const ArrayVector<T>& vec, const int flag=1): ArrayVector<T>(vec), lattice(lat){ this->check_arrayvector(flag); }
+  //! Move constructor from an ArrayVector, optionally verifying that only 3-element arrays are provided.
+  LDVec(const Direct& lat, ArrayVector<T>&& vec, const int flag=1): ArrayVector<T>(std::move(vec)), lattice(lat){ this->check_arrayvector(flag); }
   //! [Optional type conversion] copy constructor
   template<class R> LDVec(const LDVec<R>& vec): ArrayVector<T>(vec.numel(),vec.size(),vec.data()), lattice(vec.get_lattice()) {}
   //! std::vector<std::array<T,3>> copy constructor
@@ -63,6 +66,8 @@ public:
   //! Explicit copy constructor
   // required in gcc 9+ since we define our own operator= below:
   LDVec(const LDVec<T>& other): ArrayVector<T>(3u,other.size(),other.data()), lattice(other.get_lattice()) {}
+  //! Move constructor, taking the data block of `other`
+  LDVec(LDVec<T>&& other): ArrayVector<T>(std::move(other)), lattice(std::move(other.lattice)) {}
   //! Assignment operator reusing data if we can
   LDVec<T>& operator=(const LDVec<T>& other){
     if (this != &other){ // do nothing if called by, e.g., a = a;
@@ -79,6 +84,14 @@ public:
     }
     return *this;
   }
+  //! Move assignment operator, taking the data block of `other`
+  LDVec<T>& operator=(LDVec<T>&& other) {
+    if (this != &other){
+      this->lattice = std::move(other.lattice);
+      this->ArrayVector<T>::operator=(std::move(other));
+    }
+    return *this;
+  }
   //! Extract the 3-vector with index `i`
   const LDVec<T> operator[](const size_t i) const{
     bool isok = i < this->size();
@@ -87,7 +100,7 @@ public:
     return out;
   }
 
-  Direct get_lattice() const { return lattice; }
+  const Direct& get_lattice() const { return lattice; }
   template<typename R> bool samelattice(const LDVec<R> *vec) const { return lattice.issame(vec->get_lattice()); }
   template<typename R> bool samelattice(const LQVec<R> *)    const { return false; }
   template<typename R> bool starlattice(const LDVec<R> *)    const { return false; }
@@ -196,6 +209,8 @@ public:
   }
   //! Copy constructor, optionally verifying that only 3-element arrays are provided.
   LQVec(const Reciprocal& lat, const ArrayVector<T>& vec, const int flag=1): ArrayVector<T>(vec), lattice(lat){  this->check_arrayvector(flag); }
+  //! Move constructor from an ArrayVector, optionally verifying that only 3-element arrays are provided.
+  LQVec(const Reciprocal& lat, ArrayVector<T>&& vec, const int flag=1): ArrayVector<T>(std::move(vec)), lattice(lat){ this->check_arrayvector(flag); }
   //! [Optional type conversion] copy constructor
   template<class R> LQVec(const LQVec<R>& vec): ArrayVector<T>(vec.numel(),vec.size(),vec.data()), lattice(vec.get_lattice()) {}
   //! std::vector<std::array<T,3>> copy constructor
@@ -203,6 +218,8 @@ public:
   //! Explicit copy constructor
   // required in gcc 9+ since we define our own operator= below:
   LQVec(const LQVec<T>& other): ArrayVector<T>(3u,other.size(),other.data()), lattice(other.get_lattice()) {}
+  //! Move constructor, taking the data block of `other`
+  LQVec(LQVec<T>&& other): ArrayVector<T>(std::move(other)), lattice(std::move(other.lattice)) {}
   //! Assignment operator reusing data if we can
   LQVec<T>& operator=(const LQVec<T>& other){
     if (this != &other){ // do nothing if called by, e.g., a = a;
@@ -219,6 +236,14 @@ public:
     }
     return *this;
   }
+  //! Move assignment operator, taking the data block of `other`
+  LQVec<T>& operator=(LQVec<T>&& other) {
+    if (this != &other){
+      this->lattice = std::move(other.lattice);
+      this->ArrayVector<T>::operator=(std::move(other));
+    }
+    return *this;
+  }
   //! Extract the 3-vector with index `i`
   const LQVec<T> operator[](const size_t i) const{
     bool isok = i < this->size();
@@ -227,7 +252,7 @@ public:
     return out;
   }
 
-  Reciprocal get_lattice() const { return lattice; }
+  const Reciprocal& get_lattice() const { return lattice; }
   template<typename R> bool samelattice(const LQVec<R> *vec) const { return lattice.issame(vec->get_lattice()); }
   template<typename R> bool samelattice(const LDVec<R> *)    const { return false; }
   template<typename R> bool starlattice(const LQVec<R> *)    const { return false; }
@@ -41,24 +41,12 @@ ArrayVector<double> norm(const L<T> &a){
   return out;
 }
 
-template<typename T,typename R> double same_lattice_dot(const R* x, const T* y, const double* len, const double* ang){
-  double out = double(x[0])*double(y[0])*len[0]*len[0]
-             + double(x[1])*double(y[1])*len[1]*len[1]
-             + double(x[2])*double(y[2])*len[2]*len[2]
-             + (double(x[0])*double(y[1])+double(x[1])*double(y[0]))*len[0]*len[1]*cos(ang[2])
-             + (double(x[1])*double(y[2])+double(x[2])*double(y[1]))*len[1]*len[2]*cos(ang[0])
-             + (double(x[2])*double(y[0])+double(x[0])*double(y[2]))*len[2]*len[0]*cos(ang[1]);
+//! The dot product of two lattice vectors using the (covariant) metric tensor
+template<typename T,typename R> double metric_dot(const R* x, const T* y, const double* mt){
+  double out{0};
+  for (size_t i=0; i<3u; ++i) for (size_t j=0; j<3u; ++j) out += double(x[i])*mt[3*i+j]*double(y[j]);
   return out;
 }
-// template<typename T,typename R> double same_lattice_dot(const R& x, const T& y, const double* len, const double* ang){
-//   double out = double(x[0])*double(y[0])*len[0]*len[0]
-//              + double(x[1])*double(y[1])*len[1]*len[1]
-//              + double(x[2])*double(y[2])*len[2]*len[2]
-//              + (double(x[0])*double(y[1])+double(x[1])*double(y[0]))*len[0]*len[1]*cos(ang[2])
-//              + (double(x[1])*double(y[2])+double(x[2])*double(y[1]))*len[1]*len[2]*cos(ang[0])
-//              + (double(x[2])*double(y[0])+double(x[0])*double(y[2]))*len[2]*len[0]*cos(ang[1]);
-//   return out;
-// }
 
 // cross (LatVec × LatVec)
 template<class T, class R, template<class> class L,
@@ -68,7 +56,7 @@ L<double> cross(const L<T>& a, const L<R>& b) {
   assert( a.samelattice(b) );
   AVSizeInfo si = a.consistency_check(b);
   if (si.m != 3u) throw std::runtime_error("cross product is only defined for three vectors");
-  typename LatticeTraits<L<T>>::type lat = a.get_lattice();
+  const typename LatticeTraits<L<T>>::type& lat = a.get_lattice();
   typename LatVecTraits<L<T>,double>::star tmp( lat.star(), si.n);
   for (size_t i=0; i<si.n; i++)
     vector_cross<double,T,R,3>(tmp.data(i), a.data(si.oneveca?0:i), b.data(si.onevecb?0:i));
@@ -92,11 +80,9 @@ ArrayVector<double> dot(const L1<T> &a, const L2<R> &b){
   if (si.scalara||si.scalarb) throw std::runtime_error("Lattice dot product requires two three-vectors");
   ArrayVector<double> out(1,si.n);
   if (issame){
-    typename LatticeTraits<L1<T>>::type lat = a.get_lattice();
-    double len[3] = {lat.get_a(),lat.get_b(),lat.get_c()};
-    double ang[3] = {lat.get_alpha(),lat.get_beta(),lat.get_gamma()};
+    const double* mt = a.get_lattice().get_metric()->covariant.data();
     for (size_t i=0; i<si.n; i++)
-      out.insert( same_lattice_dot( a.data(si.oneveca?0:i), b.data(si.onevecb?0:i), len, ang), i);
+      out.insert( metric_dot( a.data(si.oneveca?0:i), b.data(si.onevecb?0:i), mt), i);
   } else {
     double tmp=0;
     for (size_t i=0; i<si.n; i++) {
@@ -107,6 +93,48 @@ ArrayVector<double> dot(const L1<T> &a, const L2<R> &b){
   return out;
 }
 
+// [LatVec] lazy dot
+/*! \brief A lazy row-wise dot product between lattice vectors and an expression
+
+The expression carries no lattice information so its elements are taken to be
+coordinates in the lattice of the lattice vectors, e.g., for
+`dot(normals, lazy(q.view(i)) - points)` with `normals`, `q`, and `points` all
+in the same reciprocal lattice.
+*/
+template<class T, class E> class ArrayVectorLatticeDot: public ArrayVectorExpression<ArrayVectorLatticeDot<T,E>>{
+  ArrayVectorTerminal<T> a_;
+  E e_;
+  size_t n_;
+  std::shared_ptr<const LatticeMetric> metric_; //!< the interned metric of the lattice of a
+public:
+  typedef double value_type;
+  template<class L> ArrayVectorLatticeDot(const L& a, const E& e): a_(a), e_(e) {
+    if (a.numel()!=3u || e.numel()!=3u)
+      throw std::runtime_error("Lattice dot product is only defined for three vectors");
+    if (a.size()!=e.size() && a.size()!=1u && e.size()!=1u)
+      throw std::runtime_error("Lattice dot product requires a.size()==b.size() or one size()==1");
+    n_ = a.size()==1u ? e.size() : a.size();
+    metric_ = a.get_lattice().get_metric();
+  }
+  size_t size() const {return n_;}
+  size_t numel() const {return 1u;}
+  double getvalue(const size_t i, const size_t) const {
+    size_t ai = a_.size()==1u ? 0 : i, ei = e_.size()==1u ? 0 : i;
+    std::array<T,3> x, y;
+    for (size_t j=0; j<3u; ++j){
+      x[j] = a_.getvalue(ai,j);
+      y[j] = static_cast<T>(e_.getvalue(ei,j));
+    }
+    return metric_dot(x.data(), y.data(), metric_->covariant.data());
+  }
+};
+template<class T, template<class> class L, class E,
+         typename=typename std::enable_if<std::is_base_of<LatVec,L<T>>::value && is_arrayvector_expression<E>::value>::type
+        >
+ArrayVectorLatticeDot<T,E> dot(const L<T>& a, const E& e){
+  return ArrayVectorLatticeDot<T,E>(a, e);
+}
+
 // // [LatVec] norm
 // template<class T, template<class> class L,
 //          typename=typename std::enable_if<std::is_base_of<LatVec,L<T>>::value>::type
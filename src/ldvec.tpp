@@ -114,7 +114,7 @@ template<typename T> LDVec<double> LDVec<T>::cross(const size_t i, const size_t
     double rlucross[9];
     vector_cross<double,T,T,3>(rlucross, this->data(i), this->data(j));
 
-    Direct dlat = this->get_lattice();
+    const Direct& dlat = this->get_lattice();
     LQVec<double> lqv( dlat.star(), 1u, rlucross);
     lqv *= dlat.get_volume()/2.0/PI;
     out =  lqv.star();
@@ -125,10 +125,7 @@ template<typename T> LDVec<double> LDVec<T>::cross(const size_t i, const size_t
 template<typename T> double LDVec<T>::dot(const size_t i, const size_t j) const {
   if (i>=this->size() || j>=this->size())
     throw std::out_of_range("attempted out of bounds access by dot");
-  Direct lat = this->get_lattice();
-  double len[3] = {lat.get_a(),lat.get_b(),lat.get_c()};
-  double ang[3] = {lat.get_alpha(),lat.get_beta(),lat.get_gamma()};
-  return same_lattice_dot(this->data(i),this->data(j),len,ang);
+  return metric_dot(this->data(i), this->data(j), this->get_lattice().get_metric()->covariant.data());
 }
 
 template<typename T> LDVec<T>& LDVec<T>:: operator+=(const LDVec<T>& av){
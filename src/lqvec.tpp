@@ -93,7 +93,7 @@ template<typename T> ArrayVector<T> LQVec<T>::get_hkl() const {
 }
 template<typename T> ArrayVector<double> LQVec<T>::get_xyz() const {
   double toxyz[9];
-  Reciprocal lat = this->get_lattice();
+  const Reciprocal& lat = this->get_lattice();
   lat.get_xyz_transform(toxyz);
   ArrayVector<double> xyz(this->numel(),this->size());
   for (size_t i=0; i<this->size(); i++) multiply_matrix_vector(xyz.data(i), toxyz, this->data(i));
@@ -123,7 +123,7 @@ template<typename T> LQVec<double> LQVec<T>::cross(const size_t i, const size_t
     double rlucross[3];
     vector_cross<double,T,T,3>(rlucross, this->data(i), this->data(j));
 
-    Reciprocal rlat = this->get_lattice();
+    const Reciprocal& rlat = this->get_lattice();
     LDVec<double> ldv( rlat.star(), 1u, rlucross);
     ldv *= rlat.get_volume()/2.0/PI;
     out =  ldv.star();
@@ -134,10 +134,7 @@ template<typename T> LQVec<double> LQVec<T>::cross(const size_t i, const size_t
 template<typename T> double LQVec<T>::dot(const size_t i, const size_t j) const {
   if (i>=this->size() || j>=this->size())
     throw std::out_of_range("attempted out of bounds access by dot");
-  Reciprocal lat = this->get_lattice();
-  double len[3] = {lat.get_a(),lat.get_b(),lat.get_c()};
-  double ang[3] = {lat.get_alpha(),lat.get_beta(),lat.get_gamma()};
-  return same_lattice_dot(this->data(i),this->data(j),len,ang);
+  return metric_dot(this->data(i), this->data(j), this->get_lattice().get_metric()->covariant.data());
 }
 
 template<typename T> LQVec<T>& LQVec<T>:: operator+=(const LQVec<T>& av){
@@ -0,0 +1,78 @@
+/* Copyright 2020 Greg Tucker
+//
+// This file is part of brille.
+//
+// brille is free software: you can redistribute it and/or modify it under the
+// terms of the GNU Affero General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// brille is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with brille. If not, see <https://www.gnu.org/licenses/>.            */
+
+/*! \file */
+#ifndef _MATRIX_INDEX_H_
+#define _MATRIX_INDEX_H_
+#include <array>
+#include <memory>
+#include <unordered_map>
+
+//! Hash an integer 3×3 matrix stored in row order
+struct MatrixIntHash{
+  size_t operator()(const std::array<int,9>& m) const {
+    size_t h{0};
+    for (auto x: m) h = h*31u + static_cast<size_t>(x + 8);
+    return h;
+  }
+};
+
+/*! \brief A lazily-built hash table from integer 3×3 matrices to their index
+
+Used by `PointSymmetry` and `Symmetry` to replace the linear search for a
+rotation matrix. The table is built on the first lookup and published
+atomically, so concurrent lookups on a shared (const) object are safe; two
+threads racing to build it each produce the same table.
+
+The owning object must call `reset` whenever its matrices change. Copies
+start without a table, since the source table may be built concurrently.
+*/
+class MatrixIndex{
+public:
+  using map_t = std::unordered_map<std::array<int,9>, size_t, MatrixIntHash>;
+private:
+  mutable std::shared_ptr<const map_t> index_;
+public:
+  MatrixIndex() {}
+  MatrixIndex(const MatrixIndex&) {}
+  MatrixIndex& operator=(const MatrixIndex&) { index_.reset(); return *this; }
+  //! Discard the table after the indexed matrices have been modified
+  void reset() { index_.reset(); }
+  /*! \brief Find the index of the first matrix equal to m
+
+  @param m the matrix to find
+  @param n the number of indexed matrices
+  @param getter a callable returning the matrix at an index
+  @returns the index of m, or n if m is not present
+  */
+  template<class F>
+  size_t find(const std::array<int,9>& m, const size_t n, F getter) const {
+    std::shared_ptr<const map_t> idx = std::atomic_load(&index_);
+    if (!idx){
+      auto built = std::make_shared<map_t>();
+      built->reserve(n);
+      // emplace keeps the first of any repeated matrix, as a linear scan would
+      for (size_t i=0; i<n; ++i) built->emplace(getter(i), i);
+      idx = built;
+      std::atomic_store(&index_, idx);
+    }
+    auto itr = idx->find(m);
+    return itr == idx->end() ? n : itr->second;
+  }
+};
+
+#endif
@@ -0,0 +1,70 @@
+/* Copyright 2020 Greg Tucker
+//
+// This file is part of brille.
+//
+// brille is free software: you can redistribute it and/or modify it under the
+// terms of the GNU Affero General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// brille is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with brille. If not, see <https://www.gnu.org/licenses/>.            */
+
+/*! \file */
+#ifndef _MEMORY_USAGE_H_
+#define _MEMORY_USAGE_H_
+#include <cstddef>
+#include <vector>
+
+template<class T> class ArrayVector;
+
+/*! \brief The bytes held by an interpolator, by category
+
+Only heap storage which grows with the interpolator is counted; the fixed size
+of the objects themselves is ignored. Interpolation data borrowed from an
+external buffer, e.g., shared memory, is counted in `values` and `vectors` and
+also reported separately as `borrowed`, since it is not owned by this process.
+*/
+struct MemoryUsage{
+  size_t vertices{0};      //!< vertex positions
+  size_t nodes{0};         //!< node, tetrahedra and connectivity tables
+  size_t circumspheres{0}; //!< tetrahedra circumsphere centres and radii
+  size_t values{0};        //!< interpolation eigenvalue-like data
+  size_t vectors{0};       //!< interpolation eigenvector-like data
+  size_t auxiliary{0};     //!< bin boundaries, barycentric transforms, bounding polyhedra, shapes, costs and cached results
+  size_t borrowed{0};      //!< the part of `values` and `vectors` referencing an external buffer
+  //! The total number of bytes, including any borrowed data
+  size_t total() const {return vertices + nodes + circumspheres + values + vectors + auxiliary;}
+  MemoryUsage& operator+=(const MemoryUsage& o){
+    vertices += o.vertices;
+    nodes += o.nodes;
+    circumspheres += o.circumspheres;
+    values += o.values;
+    vectors += o.vectors;
+    auxiliary += o.auxiliary;
+    borrowed += o.borrowed;
+    return *this;
+  }
+};
+
+//! The heap bytes held by a std::vector
+template<class T> size_t memory_bytes(const std::vector<T>& v){
+  return v.capacity()*sizeof(T);
+}
+//! The heap bytes held by a std::vector of std::vectors
+template<class T> size_t memory_bytes(const std::vector<std::vector<T>>& v){
+  size_t bytes = v.capacity()*sizeof(std::vector<T>);
+  for (const auto& x: v) bytes += memory_bytes(x);
+  return bytes;
+}
+//! The heap bytes held, or borrowed, by an ArrayVector
+template<class T> size_t memory_bytes(const ArrayVector<T>& a){
+  return a.numel()*a.size()*sizeof(T);
+}
+
+#endif
@@ -30,6 +30,10 @@
 #include "triangulation_layers.hpp"
 
 
+/*! \brief A tetrahedral mesh with data at its vertices
+
+Const queries may run concurrently from multiple threads on one object.
+*/
 template<class T, class S> class Mesh3{
 protected:
   TetTri mesh;
@@ -49,6 +53,7 @@ public:
     this->mesh = other.mesh;
     this->data_ = other.data_;
   }
+  Mesh3(Mesh3<T,S>&&) = default;
   Mesh3<T,S>& operator=(const Mesh3<T,S>& other){
     this->mesh = other.mesh;
     this->data_ = other.data_;
@@ -62,10 +67,35 @@ public:
   const ArrayVector<size_t>& get_mesh_tetrehedra() const{ return this->mesh.get_vertices_per_tetrahedron();}
   // Get a constant reference to the stored data
   const InterpolationData<T,S>& data(void) const {return data_;}
+  //! The bytes held by the triangulation and data
+  MemoryUsage memory_usage() const {
+    MemoryUsage m = data_.memory_usage();
+    m += mesh.memory_usage();
+    return m;
+  }
+  //! Write the triangulation and data to a BinaryWriter
+  void serialize(BinaryWriter& w) const {
+    mesh.serialize(w);
+    data_.serialize(w);
+  }
+  /*! \brief Read a Mesh3 written by `serialize`
+
+  @param r the reader
+  @param borrow if true the interpolation data references the reader's buffer,
+                which must then outlive the Mesh3; the triangulation is always copied
+  */
+  static Mesh3<T,S> deserialize(BinaryReader& r, const bool borrow=false){
+    Mesh3<T,S> m;
+    m.mesh = TetTri::deserialize(r);
+    m.data_ = InterpolationData<T,S>::deserialize(r, borrow);
+    if (m.data_.size() && m.data_.size() != m.size())
+      throw std::runtime_error("Serialized Mesh3 vertices and data are inconsistent");
+    return m;
+  }
   // Replace the data stored in the object
   // template<typename... A> void replace_data(A... args) { data_.replace_data(args...); }
-  template<typename... A> void replace_value_data(A... args) { data_.replace_value_data(args...); }
-  template<typename... A> void replace_vector_data(A... args) { data_.replace_vector_data(args...); }
+  template<typename... A> void replace_value_data(A&&... args) { data_.replace_value_data(std::forward<A>(args)...); }
+  template<typename... A> void replace_vector_data(A&&... args) { data_.replace_vector_data(std::forward<A>(args)...); }
   // Calculate the Debye-Waller factor for the provided Q points and ion masses
   template<template<class> class A>
   ArrayVector<double> debye_waller(const A<double>& Q, const std::vector<double>& M, const double t_K) const{
@@ -85,6 +115,16 @@ public:
   template<typename R>
   std::tuple<ArrayVector<T>,ArrayVector<S>>
   parallel_interpolate_at(const ArrayVector<R>& x, const int nthreads) const;
+  //! Locate points once, for repeated interpolation, see PolyhedronTrellis::plan
+  template<typename R>
+  InterpolationPlan plan(const ArrayVector<R>& x, const int nthreads, const bool with_permutations=false, const std::vector<PointStatus>& status=std::vector<PointStatus>()) const;
+  //! Interpolate the current data at the points of a plan made by `plan`
+  std::tuple<ArrayVector<T>,ArrayVector<S>>
+  execute(const InterpolationPlan& plan, const int nthreads) const {
+    if (data_.size()==0)
+      throw std::runtime_error("The mesh must be filled before interpolating!");
+    return data_.interpolate_at(plan, nthreads);
+  }
   //! Return the neighbours for which a passed boolean array holds true
   template<typename R> std::vector<size_t> which_neighbours(const std::vector<R>& t, const R value, const size_t idx) const;
   //! Sort the values stored in the mesh by already-sorted neighbour consensus
@@ -102,6 +142,8 @@ public:
     return str;
   }
 private:
+  //! An empty Mesh3, to be filled by `deserialize`
+  Mesh3() {}
 };
 
 #include "mesh.tpp"
@@ -38,10 +38,15 @@ Mesh3<T,S>::interpolate_at(const ArrayVector<R>& x) const{
   size_t found_tet, max_valid_tet = this->mesh.number_of_tetrahedra()-1;
   for (size_t i=0; i<x.size(); ++i){
     verbose_update("Locating ",x.to_string(i));
-    found_tet = this->mesh.locate(x.extract(i), vertices, weights);
+    {
+      ProfileTimer timer(ProfileStage::locate);
+      found_tet = this->mesh.locate(x.extract(i), vertices, weights);
+    }
     debug_update_if(found_tet > max_valid_tet,"Point ",x.to_string(i)," not found in tetrahedra!");
-    if (found_tet > max_valid_tet)
+    if (found_tet > max_valid_tet){
+      Profile::count(ProfileCounter::not_found);
       throw std::runtime_error("Point not found in tetrahedral mesh");
+    }
     verbose_update("Interpolate between vertices ", vertices," with weights ",weights);
     data_.interpolate_at(vertices, weights, vals, vecs, i);
   }
@@ -50,7 +55,7 @@ Mesh3<T,S>::interpolate_at(const ArrayVector<R>& x) const{
 template<class T, class S> template<typename R>
 std::tuple<ArrayVector<T>,ArrayVector<S>>
 Mesh3<T,S>::parallel_interpolate_at(const ArrayVector<R>& x, const int threads) const{
-  omp_set_num_threads( (threads > 0) ? threads : omp_get_max_threads() );
+  const int nth = (threads > 0) ? threads : omp_get_max_threads();
   this->check_before_interpolating(x);
   // shared between threads
   ArrayVector<T> vals(data_.values().numel(), x.size());
@@ -60,15 +65,36 @@ Mesh3<T,S>::parallel_interpolate_at(const ArrayVector<R>& x, const int threads)
   std::vector<double> weights;
   // OpenMP < v3.0 (VS uses v2.0) requires signed indexes for omp parallel
   long xsize = unsigned_to_signed<long, size_t>(x.size());
-#pragma omp parallel for default(none) shared(x, vals, vecs, xsize) private(indexes, weights) schedule(dynamic)
+#pragma omp parallel for num_threads(nth) default(none) shared(x, vals, vecs, xsize) private(indexes, weights) schedule(dynamic)
   for (long si=0; si<xsize; ++si){
     size_t i = signed_to_unsigned<size_t, long>(si);
-    this->mesh.locate(x.extract(i), indexes, weights);
+    {
+      ProfileTimer timer(ProfileStage::locate);
+      this->mesh.locate(x.extract(i), indexes, weights);
+    }
     data_.interpolate_at(indexes, weights, vals, vecs, i);
   }
   return std::make_tuple(vals, vecs);
 }
 
+template<class T, class S> template<typename R>
+InterpolationPlan
+Mesh3<T,S>::plan(const ArrayVector<R>& x, const int threads, const bool with_permutations, const std::vector<PointStatus>& status) const{
+  this->check_before_interpolating(x);
+  size_t max_valid_tet = this->mesh.number_of_tetrahedra()-1;
+  return InterpolationPlan::build<size_t>(data_.size(), x.size(), status,
+    [&](const size_t i, std::vector<size_t>& vertices, std::vector<double>& weights){
+      size_t found_tet;
+      {
+        ProfileTimer timer(ProfileStage::locate);
+        found_tet = this->mesh.locate(x.extract(i), vertices, weights);
+      }
+      return found_tet > max_valid_tet ? PointStatus::not_found : PointStatus::found;
+    },
+    [&](const std::vector<size_t>& vertices){return data_.get_permutations(vertices);},
+    with_permutations ? data_.branches() : 0u, threads);
+}
+
 template<class T, class S> template<typename R>
 std::vector<size_t>
 Mesh3<T,S>::which_neighbours(const std::vector<R>& t, const R value, const size_t v) const{
@@ -27,7 +27,11 @@
 #include "utilities.hpp"
 #include "debug.hpp"
 #include "triangulation_simple.hpp"
+#include "barycentric.hpp"
 #include "interpolation_data.hpp"
+#include "vertex_welder.hpp"
+#include "serialize.hpp"
+#include "point_status.hpp"
 
 #ifndef _NEST_H_
 #define _NEST_H_
@@ -52,36 +56,27 @@ public:
   ): vi(vit), centre_radius(ci), volume_(vol) {}
   //
   const std::array<size_t,4>& vertices(void) const { return vi;}
+  //! Replace the vertex indices by map[index]
+  void remap(const std::vector<size_t>& map) { for (auto& i: vi) i = map[i]; }
   //
   double volume(void) const {return volume_;}
   // double volume(const ArrayVector<double>& v) const {
     // return orient3d(v.data(vi[0]), v.data(vi[1]), v.data(vi[2]), v.data(vi[3]))/6.0;
   // }
   //
-  std::array<double,4> weights(const ArrayVector<double>& v, const ArrayVector<double>& x) const {
+  std::array<double,4> weights(const ArrayVector<double>& v, const ArrayVectorView<double>& x, const BarycentricTransform* t=nullptr) const {
     std::array<double,4> w{{-1,-1,-1,-1}};
-    if (this->might_contain(x)){
-      // double vol6 = this->volume(v)*6.0;
-      double vol6 = volume_*6.0;
-      w[0] = orient3d(x.data()     , v.data(vi[1]), v.data(vi[2]), v.data(vi[3])) / vol6;
-      w[1] = orient3d(v.data(vi[0]), x.data()     , v.data(vi[2]), v.data(vi[3])) / vol6;
-      w[2] = orient3d(v.data(vi[0]), v.data(vi[1]), x.data()     , v.data(vi[3])) / vol6;
-      w[3] = orient3d(v.data(vi[0]), v.data(vi[1]), v.data(vi[2]), x.data()     ) / vol6;
-    }
+    if (this->might_contain(x)) this->barycentric(v, x, w, t);
     return w;
   }
   bool contains(
     const ArrayVector<double>& v,
-    const ArrayVector<double>& x,
-    std::array<double,4>& w
+    const ArrayVectorView<double>& x,
+    std::array<double,4>& w,
+    const BarycentricTransform* t=nullptr
   ) const {
     if (this->might_contain(x)){
-      // double vol6 = this->volume(v)*6.0;
-      double vol6 = volume_*6.0;
-      w[0] = orient3d(x.data()     , v.data(vi[1]), v.data(vi[2]), v.data(vi[3])) / vol6;
-      w[1] = orient3d(v.data(vi[0]), x.data()     , v.data(vi[2]), v.data(vi[3])) / vol6;
-      w[2] = orient3d(v.data(vi[0]), v.data(vi[1]), x.data()     , v.data(vi[3])) / vol6;
-      w[3] = orient3d(v.data(vi[0]), v.data(vi[1]), v.data(vi[2]), x.data()     ) / vol6;
+      this->barycentric(v, x, w, t);
       return none_negative(w);
     }
     return false;
@@ -94,7 +89,12 @@ public:
     return msg;
   }
 private:
-  bool might_contain(const ArrayVector<double>& x) const {
+  void barycentric(const ArrayVector<double>& v, const ArrayVectorView<double>& x, std::array<double,4>& w, const BarycentricTransform* t) const {
+    // use the precomputed transform if it is present and conclusive
+    if (t == nullptr || !t->weights(x.data(), w))
+      orient3d_weights(v.data(vi[0]), v.data(vi[1]), v.data(vi[2]), v.data(vi[3]), x.data(), volume_*6.0, w);
+  }
+  bool might_contain(const ArrayVectorView<double>& x) const {
     std::array<double,3> d;
     for (size_t i=0; i<3u; ++i) d[i] = x.getvalue(0,i) - centre_radius[i];
     double d2{0}, r2 = centre_radius[3]*centre_radius[3];
@@ -109,6 +109,7 @@ class NestNode{
   bool is_root_;
   NestLeaf boundary_;
   std::vector<NestNode> branches_;
+  std::vector<BarycentricTransform> transforms_; //!< (optional) precomputed barycentric transformation per branch
 public:
   explicit NestNode(bool ir=false): is_root_(ir), boundary_() {}
   explicit NestNode(const NestLeaf& b): is_root_(false), boundary_(b) {}
@@ -122,19 +123,61 @@ public:
   const NestLeaf& boundary(void) const {return boundary_;}
   const std::vector<NestNode>& branches(void) const {return branches_;}
   std::vector<NestNode>& branches(void) {return branches_;}
+  //! Add a branch without a precomputed barycentric transform
+  void add_branch(const NestNode& b){ branches_.push_back(b); }
+  //! Add a branch and its precomputed barycentric transform
+  void add_branch(const NestNode& b, const BarycentricTransform& bt){
+    transforms_.resize(branches_.size());
+    transforms_.push_back(bt);
+    branches_.push_back(b);
+  }
   // double volume(const ArrayVector<double>& v) const {return boundary_.volume(v);}
   double volume(void) const {return boundary_.volume();}
-  template<typename... A> bool contains(A... args) {return boundary_.contains(args...);}
-  template<typename... A> std::array<double,4> weights(A... args) {return boundary_.weights(args...);}
+  template<typename... A> bool contains(A&&... args) const {return boundary_.contains(std::forward<A>(args)...);}
+  template<typename... A> std::array<double,4> weights(A&&... args) const {return boundary_.weights(std::forward<A>(args)...);}
   std::vector<std::pair<size_t,double>> indices_weights(
     const ArrayVector<double>& v,
     // const std::vector<size_t>& m,
-    const ArrayVector<double>& x
+    const ArrayVectorView<double>& x
   ) const {
     std::array<double,4> w;
     // return __indices_weights(v,m,x,w);
     return __indices_weights(v,x,w);
   }
+  //! Replace the vertex indices of this node and all of its branches by map[index]
+  void remap(const std::vector<size_t>& map) {
+    if (!is_root_) boundary_.remap(map);
+    for (auto& b: branches_) b.remap(map);
+  }
+  //! The bytes held by the branches of this node and, recursively, their branches
+  MemoryUsage memory_usage() const {
+    MemoryUsage m;
+    // each branch holds its tetrahedron and circumsphere
+    m.nodes = memory_bytes(branches_);
+    m.circumspheres = branches_.size()*sizeof(std::array<double,4>);
+    m.nodes -= m.circumspheres;
+    m.auxiliary = memory_bytes(transforms_);
+    for (const auto& b: branches_) m += b.memory_usage();
+    return m;
+  }
+  //! Write this node and, recursively, all of its branches to a BinaryWriter
+  void serialize(BinaryWriter& w) const {
+    w.write(is_root_);
+    w.write(boundary_);
+    w.write(static_cast<uint64_t>(branches_.size()));
+    for (const auto& b: branches_) b.serialize(w);
+    w.write(transforms_);
+  }
+  //! Read a node and its branches written by `serialize`
+  static NestNode deserialize(BinaryReader& r){
+    NestNode n;
+    r.read(n.is_root_);
+    r.read(n.boundary_);
+    uint64_t count = r.read<uint64_t>();
+    for (uint64_t i=0; i<count; ++i) n.branches_.push_back(NestNode::deserialize(r));
+    r.read(n.transforms_);
+    return n;
+  }
   std::vector<std::array<size_t,4>> tetrahedra(void) const {
     std::vector<std::array<size_t,4>> out;
     if (this->is_leaf()) out.push_back(boundary_.vertices());
@@ -154,7 +197,7 @@ protected:
   std::vector<std::pair<size_t,double>> __indices_weights(
     const ArrayVector<double>& v,
     // const std::vector<size_t>& m,
-    const ArrayVector<double>& x,
+    const ArrayVectorView<double>& x,
     std::array<double,4>& w
   ) const {
     // This node is either the root (in which case it contains all tetrahedra)
@@ -169,8 +212,9 @@ protected:
       return iw;
     }
     // This is not a leaf node. So continue down the tree
-    for (auto b: branches_){
-      w = b.weights(v,x);
+    for (size_t i=0; i<branches_.size(); ++i){
+      const NestNode& b{branches_[i]};
+      w = b.weights(v, x, i < transforms_.size() ? &transforms_[i] : nullptr);
       // if (none_negative(w)) return b.__indices_weights(v,m,x,w);
       if (none_negative(w)) return b.__indices_weights(v,x,w);
     }
@@ -178,29 +222,37 @@ protected:
     return empty;
   }
 };
+/*! \brief A hierarchy of tetrahedral meshes with data at their vertices
+
+As with PolyhedronTrellis, concurrent const queries of one Nest are safe
+while modifying its data during a query is not.
+*/
 template<class T, class S>
 class Nest{
   NestNode root_;
   ArrayVector<double> vertices_;
   InterpolationData<T,S> data_;
   // std::vector<size_t> map_; // vertices holds *all* vertices but data_ only holds information for terminal vertices!
+  //! An empty Nest, to be filled by `deserialize`
+  Nest(): root_(true), vertices_({3u,0u}) {}
 public:
   std::string tree_string(void) const {
     std::string tree = root_.to_string("",false);
     return tree;
   }
-  // Build using maximum leaf volume
-  Nest(const Polyhedron& p, const double vol, const size_t nb=5u):
+  // Build using maximum leaf volume; with precompute a 112 byte
+  // BarycentricTransform is stored per branch to speed up point location
+  Nest(const Polyhedron& p, const double vol, const size_t nb=5u, const bool precompute=true):
     root_(true), vertices_({3u,0u})
   {
-    this->construct(p, nb, vol);
+    this->construct(p, nb, vol, precompute);
     // this->make_all_to_terminal_map();
   }
   // Build using desired leaf number density
-  Nest(const Polyhedron& p, const size_t rho, const size_t nb=5u):
+  Nest(const Polyhedron& p, const size_t rho, const size_t nb=5u, const bool precompute=true):
     root_(true), vertices_({3u,0u})
   {
-    this->construct(p, nb, p.get_volume()/static_cast<double>(rho));
+    this->construct(p, nb, p.get_volume()/static_cast<double>(rho), precompute);
     // this->make_all_to_terminal_map();
   }
   std::vector<bool> vertex_is_leaf(void) const {
@@ -234,52 +286,112 @@ public:
   }
   std::tuple<ArrayVector<T>, ArrayVector<S>>
   interpolate_at(const ArrayVector<double>& x) const {
-    this->check_before_interpolating(x);
-    ArrayVector<T> vals(data_.values().numel(), x.size());
-    ArrayVector<S> vecs(data_.vectors().numel(), x.size());
-    for (size_t i=0; i<x.size(); ++i){
-      // auto iw = root_.indices_weights(vertices_, map_, x.extract(i));
-      auto iw = root_.indices_weights(vertices_, x.extract(i));
-      data_.interpolate_at(iw, vals, vecs, i);
-    }
-    return std::make_tuple(vals, vecs);
+    return this->interpolate_at(x, 1);
   }
   std::tuple<ArrayVector<T>, ArrayVector<S>>
   interpolate_at(const ArrayVector<double>& x, const int threads) const {
+    std::vector<PointStatus> status;
+    auto out = this->interpolate_at(x, status, threads);
+    throw_if_failed(status, "Nest::interpolate_at");
+    return out;
+  }
+  //! Interpolate at every point which can be found, see PolyhedronTrellis::interpolate_at
+  std::tuple<ArrayVector<T>, ArrayVector<S>>
+  interpolate_at(const ArrayVector<double>& x, std::vector<PointStatus>& status, const int threads) const {
     this->check_before_interpolating(x);
-    omp_set_num_threads( (threads > 0) ? threads : omp_get_max_threads() );
+    const int nth = (threads > 0) ? threads : omp_get_max_threads();
+    prepare_status(status, x.size());
     // shared between threads
     ArrayVector<T> vals(data_.values().numel(), x.size());
     ArrayVector<S> vecs(data_.vectors().numel(), x.size());
     // OpenMP < v3.0 (VS uses v2.0) requires signed indexes for omp parallel
     size_t unfound=0;
     long xsize = unsigned_to_signed<long, size_t>(x.size());
-  #pragma omp parallel for default(none) shared(x, vals, vecs) reduction(+:unfound) firstprivate(xsize) schedule(dynamic)
+  #pragma omp parallel for num_threads(nth) default(none) shared(x, vals, vecs, status) reduction(+:unfound) firstprivate(xsize) schedule(dynamic)
     for (long si=0; si<xsize; ++si){
       size_t i = signed_to_unsigned<size_t, long>(si);
+      if (!point_ok(status[i])) continue;
       // auto iw = root_.indices_weights(vertices_, map_, x.extract(i));
-      auto iw = root_.indices_weights(vertices_, x.extract(i));
+      std::vector<std::pair<size_t,double>> iw;
+      {
+        ProfileTimer timer(ProfileStage::locate);
+        iw = root_.indices_weights(vertices_, x.view(i));
+      }
       if (iw.size()){
         data_.interpolate_at(iw, vals, vecs, i);
       } else {
+        status[i] = PointStatus::not_found;
         ++unfound;
       }
     }
-    if (unfound > 0){
-      std::string msg = std::to_string(unfound) + " points not found in Nest";
-      throw std::runtime_error(msg);
-    }
+    Profile::count(ProfileCounter::not_found, unfound);
     return std::make_tuple(vals, vecs);
   }
+  //! Locate points once, for repeated interpolation, see PolyhedronTrellis::plan
+  InterpolationPlan plan(const ArrayVector<double>& x, const int threads, const bool with_permutations=false, const std::vector<PointStatus>& status=std::vector<PointStatus>()) const {
+    this->check_before_interpolating(x);
+    return InterpolationPlan::build<size_t>(data_.size(), x.size(), status,
+      [&](const size_t i, std::vector<size_t>& indices, std::vector<double>& weights){
+        std::vector<std::pair<size_t,double>> iw;
+        {
+          ProfileTimer timer(ProfileStage::locate);
+          iw = root_.indices_weights(vertices_, x.view(i));
+        }
+        indices.clear();
+        weights.clear();
+        for (const auto& p: iw){
+          indices.push_back(p.first);
+          weights.push_back(p.second);
+        }
+        return iw.empty() ? PointStatus::not_found : PointStatus::found;
+      },
+      [&](const std::vector<size_t>& indices){return data_.get_permutations(indices);},
+      with_permutations ? data_.branches() : 0u, threads);
+  }
+  //! Interpolate the current data at the points of a plan made by `plan`
+  std::tuple<ArrayVector<T>, ArrayVector<S>>
+  execute(const InterpolationPlan& plan, const int threads) const {
+    if (this->data_.size()==0)
+      throw std::runtime_error("The trellis must be filled before interpolating!");
+    return data_.interpolate_at(plan, threads);
+  }
   const InterpolationData<T,S>& data(void) const {return data_;}  
-  template<typename... A> void replace_value_data(A... args) { data_.replace_value_data(args...); }
-  template<typename... A> void replace_vector_data(A... args) { data_.replace_vector_data(args...); }
+  //! The bytes held by the vertices, tree, and data
+  MemoryUsage memory_usage() const {
+    MemoryUsage m = data_.memory_usage();
+    m += root_.memory_usage();
+    m.vertices += memory_bytes(vertices_);
+    return m;
+  }
+  //! Write the tree, vertices, and data to a BinaryWriter
+  void serialize(BinaryWriter& w) const {
+    root_.serialize(w);
+    w.write(vertices_);
+    data_.serialize(w);
+  }
+  /*! \brief Read a Nest written by `serialize`
+
+  @param r the reader
+  @param borrow if true the interpolation data references the reader's buffer,
+                which must then outlive the Nest; the tree is always copied
+  */
+  static Nest<T,S> deserialize(BinaryReader& r, const bool borrow=false){
+    Nest<T,S> n;
+    n.root_ = NestNode::deserialize(r);
+    n.vertices_ = r.read_arrayvector<double>();
+    n.data_ = InterpolationData<T,S>::deserialize(r, borrow);
+    if (!n.root_.is_root() || n.vertices_.numel() != 3u || (n.data_.size() && n.data_.size() != n.vertices_.size()))
+      throw std::runtime_error("Serialized Nest tree, vertices, and data are inconsistent");
+    return n;
+  }
+  template<typename... A> void replace_value_data(A&&... args) { data_.replace_value_data(std::forward<A>(args)...); }
+  template<typename... A> void replace_vector_data(A&&... args) { data_.replace_vector_data(std::forward<A>(args)...); }
   template<template<class> class A>
   ArrayVector<double> debye_waller(const A<double>& Q, const std::vector<double>& M, const double t_K) const{
     return data_.debye_waller(Q,M,t_K);
   }
 private:
-  void construct(const Polyhedron&, const size_t, const double);
+  void construct(const Polyhedron&, const size_t, const double, const bool);
   // void make_all_to_terminal_map(void) {
   //   std::vector<bool> vit = this->vertex_is_leaf();
   //   size_t nTerminal = std::count(vit.begin(), vit.end(), true);
@@ -289,7 +401,7 @@ private:
   //   if (idx != nTerminal)
   //     throw std::runtime_error("This shouldn't happen");
   // }
-  void subdivide(NestNode&, const size_t, const size_t, const double, const double, size_t&);
+  void subdivide(NestNode&, const size_t, const size_t, const double, const double, const bool, VertexWelder<double>&, const bool recurse=true, const VertexWelder<double>* shared=nullptr);
 };
 
 #include "nest.tpp"
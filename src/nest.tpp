@@ -16,7 +16,7 @@
 // along with brille. If not, see <https://www.gnu.org/licenses/>.            */
 
 template<class T, class S>
-void Nest<T,S>::construct(const Polyhedron& poly, const size_t max_branchings, const double max_volume){
+void Nest<T,S>::construct(const Polyhedron& poly, const size_t max_branchings, const double max_volume, const bool precompute){
   SimpleTet root_tet(poly);
   double exponent;
   exponent = std::log(root_tet.maximum_volume()/max_volume)/std::log(static_cast<double>(max_branchings));
@@ -26,12 +26,14 @@ void Nest<T,S>::construct(const Polyhedron& poly, const size_t max_branchings, c
     exponent = std::log(root_tet.maximum_volume()/max_volume)/std::log(static_cast<double>(max_branchings));
   }
   verbose_update("Largest root tetrahedron ",root_tet.maximum_volume()," and maximum leaf tetrahedron ",max_volume," give exponent ",exponent);
-  // copy-over the vertices of the root node
-  vertices_ = root_tet.get_vertices();
+  // copy-over the vertices of the root node, keeping a spatial hash of all
+  // vertices to efficiently identify those shared between tetrahedra
+  VertexWelder<double> welder(std::cbrt(max_volume));
   // we need to make a guess about how many vertices we'll need:
   size_t number_density = static_cast<size_t>(poly.get_volume()/max_volume); // shockingly, this is about right for total number of vertices!
-  size_t nVerts = vertices_.size();
-  vertices_.resize(number_density + nVerts);
+  welder.reserve(number_density + root_tet.number_of_vertices());
+  const ArrayVector<double>& rtv{root_tet.get_vertices()};
+  for (size_t i=0; i<rtv.size(); ++i) welder.insert(rtv.data(i));
   // copy over the per-tetrahedron vertex indices to the root's branches
   const ArrayVector<size_t>& tvi{root_tet.get_vertices_per_tetrahedron()};
   for (size_t i=0; i<tvi.size(); ++i){
@@ -39,42 +41,92 @@ void Nest<T,S>::construct(const Polyhedron& poly, const size_t max_branchings, c
     for (size_t j=0; j<4u; ++j) single[j] = tvi.getvalue(i,j); // no need to adjust indices at this stage
     // create a branch for this tetrahedron
     NestNode branch(single, root_tet.circumsphere_info(i), root_tet.volume(i));
-    // and subdivide it if necessary
-    if (max_branchings > 0 && branch.volume() > max_volume)
-      this->subdivide(branch, 1u, max_branchings, max_volume, exponent, nVerts);
-    // storing the resulting branch/leaf at this root
-    root_.branches().push_back(branch);
+    if (precompute) root_.add_branch(branch, root_tet.barycentric_transform(i));
+    else root_.add_branch(branch);
   }
-  // ensure that we only keep actual vertices:
-  if (vertices_.size() > nVerts) vertices_.resize(nVerts);
+  /* The subtrees below each root branch are independent, apart from vertices
+  shared along their common faces, so they can be subdivided in parallel.
+  To keep enough independent work for all threads when there are few root
+  tetrahedra, the shallowest subtrees are split serially, one level at a time,
+  until there are at least nest_work_units of them. This number does not
+  depend on the number of threads so that the resulting vertex order is the
+  same no matter how many threads perform the construction.
+  */
+  const size_t nest_work_units{64};
+  // Each unit of work is a (node, branching level) pair
+  std::vector<std::pair<NestNode*,size_t>> work;
+  for (auto& b: root_.branches()) work.emplace_back(&b, 1u);
+  auto needs_subdividing = [&](const std::pair<NestNode*,size_t>& w){
+    return w.second <= max_branchings && w.first->volume() > max_volume;
+  };
+  while (work.size() < nest_work_units && std::any_of(work.begin(), work.end(), needs_subdividing)){
+    std::vector<std::pair<NestNode*,size_t>> next;
+    for (auto& w: work) if (needs_subdividing(w)) {
+      this->subdivide(*w.first, w.second, max_branchings, max_volume, exponent, precompute, welder, false);
+      for (auto& b: w.first->branches()) next.emplace_back(&b, w.second+1u);
+    } else {
+      next.push_back(w);
+    }
+    work = next;
+  }
+  // Each work unit stores the vertices it finds in its own, initially empty,
+  // spatial hash; indexed after the vertices found so far, which are only read
+  size_t n_shared = welder.size();
+  std::vector<VertexWelder<double>> local(work.size(), VertexWelder<double>(std::cbrt(max_volume)));
+  std::vector<std::string> errors(work.size());
+  // OpenMP < v3.0 (VS uses v2.0) requires signed indexes for omp parallel
+  long nwork = unsigned_to_signed<long, size_t>(work.size());
+#pragma omp parallel for default(none) shared(work, local, errors, welder, needs_subdividing) firstprivate(nwork, max_branchings, max_volume, exponent, precompute) schedule(dynamic)
+  for (long si=0; si<nwork; ++si){
+    size_t i = signed_to_unsigned<size_t, long>(si);
+    if (needs_subdividing(work[i])){
+      // exceptions can not propagate out of an OpenMP parallel region
+      try {
+        this->subdivide(*work[i].first, work[i].second, max_branchings, max_volume, exponent, precompute, local[i], true, &welder);
+      } catch (const std::exception& e) {
+        errors[i] = e.what();
+      }
+    }
+  }
+  for (auto& e: errors) if (e.size()) throw std::runtime_error(e);
+  // Merge the new vertices from each work unit, in order, into the shared
+  // spatial hash (which removes duplicates along shared faces) and update
+  // the vertex indices of each subtree
+  for (size_t i=0; i<work.size(); ++i) if (local[i].size()) {
+    std::vector<size_t> map(n_shared + local[i].size());
+    for (size_t j=0; j<n_shared; ++j) map[j] = j;
+    for (size_t j=0; j<local[i].size(); ++j) map[n_shared+j] = welder.weld(local[i].data(j)).first;
+    work[i].first->remap(map);
+  }
+  // keep only the unique vertices
+  vertices_ = welder.vertices();
 }
 
 template<class T,class S>
 void Nest<T,S>::subdivide(
   NestNode& node, const size_t nBr, const size_t maxBr,
-  const double max_volume, const double exp, size_t& nVerts
+  const double max_volume, const double exp, const bool precompute, VertexWelder<double>& welder,
+  const bool recurse, const VertexWelder<double>* shared
 ){
   if (!node.is_leaf()) return; // return node; // we can only branch un-branched nodes
-  Polyhedron poly(vertices_.extract(node.boundary().vertices()));
+  // indices below n_shared refer to the (read-only) shared vertices, the rest
+  // are offset indices into welder
+  const size_t n_shared = shared ? shared->size() : 0u;
+  const auto& bvi{node.boundary().vertices()};
+  ArrayVector<double> bv(3u, bvi.size());
+  for (size_t i=0; i<bvi.size(); ++i)
+    bv.set(i, bvi[i] < n_shared ? (*shared)[bvi[i]] : welder[bvi[i]-n_shared]);
+  Polyhedron poly(bv);
   double mult = (maxBr > nBr) ? std::pow(static_cast<double>(maxBr-nBr),exp) : 1.0;
+  // a node is a single tetrahedron, so only tetgen's volume-limited quality
+  // refinement can split it into useful branches
   SimpleTet node_tet(poly, max_volume*mult);
   // add any new vertices to the object's array, keep a mapping for all:
   std::vector<size_t> map;
   const ArrayVector<double>& ntv{node_tet.get_vertices()};
   for (size_t i=0; i<ntv.size(); ++i){
-    const ArrayVector<double> vi{ntv.extract(i)};
-    // If we're clever we can possibly simplify this
-    std::vector<size_t> idx = find(norm(vertices_.first(nVerts)-vi).is_approx(Comp::eq,0.));
-    if (idx.size()>1)
-      throw std::runtime_error("Multiple matching vertices?!");
-    if (idx.size()==1){
-      map.push_back(idx[0]);
-    } else {
-      // new vertex. make sure we have room to store it:
-      if (vertices_.size() < nVerts+1) vertices_.resize(nVerts*2);
-      vertices_.set(nVerts, vi);
-      map.push_back(nVerts++);
-    }
+    size_t idx = n_shared ? shared->find(ntv.data(i)) : 0u;
+    map.push_back(idx < n_shared ? idx : n_shared + welder.weld(ntv.data(i)).first);
   }
   // copy over the per-tetrahedron vertex indices, applying the mapping as we go
   const ArrayVector<size_t>& tvi{node_tet.get_vertices_per_tetrahedron()};
@@ -84,9 +136,10 @@ void Nest<T,S>::subdivide(
     // create a branch for this tetrahedron
     NestNode branch(single, node_tet.circumsphere_info(i), node_tet.volume(i));
     // and subdivide it if necessary
-    if (nBr < maxBr && branch.volume() > max_volume)
-      this->subdivide(branch, nBr+1u, maxBr, max_volume, exp, nVerts);
+    if (recurse && nBr < maxBr && branch.volume() > max_volume)
+      this->subdivide(branch, nBr+1u, maxBr, max_volume, exp, precompute, welder, true, shared);
     // storing the resulting branch/leaf at this node
-    node.branches().push_back(branch);
+    if (precompute) node.add_branch(branch, node_tet.barycentric_transform(i));
+    else node.add_branch(branch);
   }
 }
@@ -21,6 +21,7 @@
 #include <array>
 #include <tuple>
 #include "latvec.hpp"
+#include "vertex_welder.hpp"
 
 /*! \brief A superclass for all rotation-required tabulated information
 
@@ -91,8 +92,8 @@ public:
   }
   bool construct(const Direct& dlat, const int time_reversal=0){
     lattice_ = dlat;
-    PointSymmetry ps = dlat.get_pointgroup_symmetry(time_reversal);
-    Symmetry spgsym = dlat.get_spacegroup_symmetry(time_reversal);
+    const PointSymmetry& ps = dlat.get_pointgroup_symmetry(time_reversal);
+    const Symmetry& spgsym = dlat.get_spacegroup_symmetry(time_reversal);
     Basis bs = dlat.get_basis();
     // resize all vectors/arrays
     n_atoms = bs.size();
@@ -100,7 +101,10 @@ public:
     point2space_.resize(n_sym_ops);
     l_mapping.resize(n_atoms*n_sym_ops);
     v_mapping.resize(n_atoms*n_sym_ops);
-    vectors_ = ArrayVector<double>(3u, n_atoms*n_sym_ops+1u, 0.); // always put (0,0,0) first
+    // keep the unique vectors in a spatial hash, always put (0,0,0) first
+    VertexWelder<double> unique_vectors;
+    unique_vectors.reserve(n_atoms*n_sym_ops+1u);
+    unique_vectors.insert(std::array<double,3>({{0.,0.,0.}}));
     // construct a mapping of pointgroup indices to spacegroup indices
     // -- this mapping is likely not invertable, but it shouldn't (doesn't?)
     //    matter. I think.
@@ -111,7 +115,6 @@ public:
         throw std::runtime_error("Something has gone wrong with the correspondence of spacegroup to pointgroup");
       }
     }
-    size_t count{1u}; // for (0,0,0)
     // fill in the mappings
     for (size_t k=0; k<bs.size(); ++k) for (size_t r=0; r<ps.size(); ++r){
       bool found;
@@ -126,16 +129,13 @@ public:
       std::array<double,3> vec = motion.inverse().move_point(bs.position(l));
       auto rk = bs.position(k);
       for (int i=0; i<3; ++i) vec[i] -= rk[i];
-      // check if this vector is in vectors_
-      // look for an equal vector within the first count vectors_ -- return its index, or count if none match
-      size_t v = norm(vectors_.first(count) - vec).is_approx(Comp::eq, 0.).first_true();
-      // store the vector if its not already present
-      if (count == v) vectors_.set(count++, vec);
+      // find the index of an equal stored vector, storing it if not present
+      size_t v = unique_vectors.weld(vec).first;
       size_t key = this->calc_key(k, r);
       l_mapping[key] = l;
       v_mapping[key] = v;
     }
-    vectors_.resize(count); // not really necessary memory copy?
+    vectors_ = unique_vectors.vertices();
     return true;
   }
   template<class Ik, class Ir>
@@ -0,0 +1,69 @@
+/* Copyright 2020 Greg Tucker
+//
+// This file is part of brille.
+//
+// brille is free software: you can redistribute it and/or modify it under the
+// terms of the GNU Affero General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// brille is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with brille. If not, see <https://www.gnu.org/licenses/>.            */
+
+/*! \file */
+#ifndef _POINT_STATUS_H_
+#define _POINT_STATUS_H_
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/*! \brief The outcome of a batch query for one point
+
+Batch methods which take a `std::vector<PointStatus>&` always complete: points
+which can not be handled are marked and their results left as zero, so that
+the caller can decide whether a partial result is acceptable.
+*/
+enum class PointStatus: uint8_t {
+  found=0,       //!< located and interpolated
+  nudged=1,      //!< located only after stepping across a bin boundary
+  not_found=2,   //!< no vertices were found for the point
+  fold_failed=3, //!< the point could not be moved into the (irreducible) Brillouin zone
+};
+
+//! Whether a point was successfully handled
+inline bool point_ok(const PointStatus s){
+  return PointStatus::found == s || PointStatus::nudged == s;
+}
+
+/*! \brief Ensure `status` holds one entry per point
+
+An existing status vector with `n` entries is kept, so that points which failed
+an earlier stage are skipped by later ones; otherwise every point is marked
+`found`.
+*/
+inline void prepare_status(std::vector<PointStatus>& status, const size_t n){
+  if (status.size() != n) status.assign(n, PointStatus::found);
+}
+
+//! Throw a std::runtime_error which counts the failures if any point was not handled
+inline void throw_if_failed(const std::vector<PointStatus>& status, const std::string& where){
+  size_t n_not_found{0}, n_fold_failed{0};
+  for (auto s: status){
+    if (PointStatus::not_found == s) ++n_not_found;
+    if (PointStatus::fold_failed == s) ++n_fold_failed;
+  }
+  if (n_not_found + n_fold_failed == 0u) return;
+  std::string msg = where + " failed for " + std::to_string(n_not_found + n_fold_failed)
+                  + " of " + std::to_string(status.size()) + " points";
+  if (n_fold_failed) msg += "; " + std::to_string(n_fold_failed) + " could not be moved into the Brillouin zone";
+  if (n_not_found) msg += "; " + std::to_string(n_not_found) + " were not found";
+  throw std::runtime_error(msg);
+}
+
+#endif
@@ -30,6 +30,7 @@ size_t PointSymmetry::add(const int *r){
   return this->add(newR);
 }
 size_t PointSymmetry::add(const Matrix<int>& r){
+  this->index_.reset();
   this->R.push_back(r);
   return this->R.size();
 }
@@ -88,6 +89,7 @@ size_t PointSymmetry::add(const std::string& s){
 }
 bool PointSymmetry::set(const size_t i, const int *r){
   if ( i>=this->size() ) return false;
+  this->index_.reset();
   for(size_t j=0; j<9; j++) this->R[i][j] = r[j];
   return true;
 }
@@ -97,6 +99,8 @@ bool PointSymmetry::get(const size_t i, int *r) const {
   return true;
 }
 int * PointSymmetry::data(const size_t i) {
+  // the caller may modify the matrix through the returned pointer
+  this->index_.reset();
   return (i<this->size()) ? this->R[i].data() : nullptr;
 }
 const int * PointSymmetry::data(const size_t i) const {
@@ -138,9 +142,7 @@ size_t PointSymmetry::get_inverse_index(const size_t i) const {
   throw std::runtime_error("Incomplete pointgroup. Missing inverse of operation.");
 }
 size_t PointSymmetry::find_index(const Matrix<int>& a) const {
-  auto iseq = [ap=a.data()](const Matrix<int>& r){ return approx_matrix(3,ap,r.data());};
-  auto itr = std::find_if(this->R.begin(), this->R.end(), iseq);
-  return std::distance(this->R.begin(), itr);
+  return this->index_.find(a, this->R.size(), [this](const size_t i){return this->R[i];});
 }
 // const Matrix<int>& PointSymmetry::get(const size_t i) const {
 //   if (i>=this->size())
@@ -148,6 +150,7 @@ size_t PointSymmetry::find_index(const Matrix<int>& a) const {
 //   return this->R[i];
 // }
 size_t PointSymmetry::resize(const size_t newsize){
+  this->index_.reset();
   this->R.resize(newsize);
   return this->R.size();
 }
@@ -168,6 +171,7 @@ void PointSymmetry::sort(const int mode) {
   auto odw = [](Matrix<int> a, Matrix<int> b){ return rotation_order(a.data()) > rotation_order(b.data());};
   auto iup = [](Matrix<int> a, Matrix<int> b){ return isometry_value(a.data()) < isometry_value(b.data());};
   auto idw = [](Matrix<int> a, Matrix<int> b){ return isometry_value(a.data()) > isometry_value(b.data());};
+  this->index_.reset();
   switch(mode){
     // sort by isometry, decreasing
     case -2: std::sort(this->R.begin(),this->R.end(),idw); break;
@@ -194,6 +198,7 @@ void PointSymmetry::permute(const std::vector<size_t>& p){
     msg += " ] was expected.";
     throw std::runtime_error(msg);
   }
+  this->index_.reset();
   // swapping requires we have the inverse permutation
   for (size_t i=0; i<p.size(); ++i) s[p[i]] = i;
   // perform the actual element swapping
@@ -250,6 +255,7 @@ Matrix<int> PointSymmetry::pop(const size_t i) {
 size_t PointSymmetry::erase(const size_t i){
   if (i>=this->size())
     throw std::out_of_range("The requested symmetry operation is out of range");
+  this->index_.reset();
   this->R.erase(this->R.begin()+i);
   return this->size();
 }
@@ -24,6 +24,7 @@
 #include <algorithm>
 // #include <numeric>
 #include "utilities.hpp"
+#include "matrix_index.hpp"
 
 template<class T> using Matrix = std::array<T,9>;
 template<class T> using Vector = std::array<T,3>;
@@ -44,6 +45,7 @@ template<class T> using Vectors = std::vector<Vector<T>>;
 \*****************************************************************************/
 class PointSymmetry{
   Matrices<int> R;
+  MatrixIndex index_; //!< hash lookup for find_index
 public:
   PointSymmetry(size_t n=0): R(n) { R.resize(n);}
   PointSymmetry(const Matrices<int>& rots): R(rots){ this->sort(); }
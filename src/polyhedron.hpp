@@ -21,10 +21,14 @@
 #include <random>
 #include <chrono>
 #include <vector>
+#include <map>
+#include <functional>
 #include "arrayvector.hpp"
 #include "latvec.hpp"
 #include "debug.hpp"
 #include "utilities.hpp"
+#include "serialize.hpp"
+#include "memory_usage.hpp"
 
 template<typename T> static std::vector<T> unique(const std::vector<T>& x){
     std::vector<T> out;
@@ -191,6 +195,11 @@ protected:
   std::vector<std::vector<int>> faces_per_vertex;
   std::vector<std::vector<int>> vertices_per_face;
 public:
+  //! The heap bytes held by the Polyhedron
+  size_t memory_bytes() const {
+    return ::memory_bytes(vertices) + ::memory_bytes(points) + ::memory_bytes(normals)
+         + ::memory_bytes(faces_per_vertex) + ::memory_bytes(vertices_per_face);
+  }
   // empty initializer
   Polyhedron(): vertices(ArrayVector<double>(3u, 0u)),
                 points(ArrayVector<double>(3u, 0u)),
@@ -201,12 +210,17 @@ public:
   Polyhedron(const ArrayVector<double>& v): vertices(v){
     this->keep_unique_vertices();
     if (vertices.size() > 3){
-      this->find_convex_hull();
-      this->find_all_faces_per_vertex();
-      this->polygon_vertices_per_face();
-      this->purge_central_polygon_vertices();
-      this->sort_polygons();
-      this->purge_extra_vertices();
+      if (this->find_convex_hull()){
+        this->purge_extra_vertices();
+      } else {
+        // degenerate (e.g., coplanar) points use the exhaustive plane search
+        this->find_convex_hull_planes();
+        this->find_all_faces_per_vertex();
+        this->polygon_vertices_per_face();
+        this->purge_central_polygon_vertices();
+        this->sort_polygons();
+        this->purge_extra_vertices();
+      }
     }
   }
   //! Build a Polyhedron from vertices and vectors pointing to face centres
@@ -288,6 +302,24 @@ public:
     this->vertices_per_face = other.get_vertices_per_face();
     return *this;
   }
+  //! Write the vertices, planes, and relational information to a BinaryWriter
+  void serialize(BinaryWriter& w) const {
+    w.write(vertices);
+    w.write(points);
+    w.write(normals);
+    w.write(faces_per_vertex);
+    w.write(vertices_per_face);
+  }
+  //! Read a Polyhedron written by `serialize`, without repeating any of its construction
+  static Polyhedron deserialize(BinaryReader& r){
+    Polyhedron p;
+    p.vertices = r.read_arrayvector<double>();
+    p.points = r.read_arrayvector<double>();
+    p.normals = r.read_arrayvector<double>();
+    r.read(p.faces_per_vertex);
+    r.read(p.vertices_per_face);
+    return p;
+  }
   Polyhedron mirror(void) const {
     return Polyhedron(-1*this->vertices, -1*this->points, -1*this->normals, this->faces_per_vertex, reverse_each(this->vertices_per_face));
     // return Polyhedron(-1*this->vertices, -1*this->points, -1*this->normals, this->faces_per_vertex, this->vertices_per_face);
@@ -448,8 +480,27 @@ protected:
     for (size_t i=0; i<vertices.size(); ++i) flg.push_back(true);
     int t = 3; // a tolerance multiplier tuning parameter, 3 seems to work OK.
     int n = static_cast<int>(vertices.numel());
-    for (size_t i=1; i<vertices.size(); ++i) for (size_t j=0; j<i; ++j)
-      if (flg[i]&&flg[j]) flg[i]=!approx_vector(n, vertices.data(i), vertices.data(j), t);
+    /* Equivalent vertices must have approximately equal first components, so
+       only vertices near each other when sorted by that component need to be
+       compared. The earliest of any equivalent vertices is kept, as before. */
+    bool c, u;
+    double tol, rtol;
+    std::tie(c, u, tol, rtol) = determine_tols<double,double>(t);
+    std::vector<size_t> order(vertices.size());
+    std::iota(order.begin(), order.end(), 0u);
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b){return vertices.getvalue(a,0) < vertices.getvalue(b,0);});
+    std::vector<size_t> position(vertices.size());
+    for (size_t k=0; k<order.size(); ++k) position[order[k]] = k;
+    auto near = [&](const size_t a, const size_t b){
+      double xa = vertices.getvalue(a,0), xb = vertices.getvalue(b,0);
+      return std::abs(xa-xb) <= tol*std::max(1., std::abs(xa)+std::abs(xb));
+    };
+    for (size_t i=1; i<vertices.size(); ++i){
+      for (size_t k=position[i]; flg[i] && k-- > 0 && near(i, order[k]);)
+        if (order[k] < i && flg[order[k]]) flg[i] = !approx_vector(n, vertices.data(i), vertices.data(order[k]), t);
+      for (size_t k=position[i]+1; flg[i] && k < order.size() && near(i, order[k]); ++k)
+        if (order[k] < i && flg[order[k]]) flg[i] = !approx_vector(n, vertices.data(i), vertices.data(order[k]), t);
+    }
     this->vertices = this->vertices.extract(flg);
   }
     void special_keep_unique_vertices(){
@@ -480,7 +531,218 @@ protected:
             this->vertices = this->vertices.extract(flg);
         }
     }
-  void find_convex_hull(void){
+  /*! \brief Find the convex hull of the vertices by quickhull
+
+  Starting from a tetrahedron of extremal vertices, the vertex farthest
+  outside of a hull face is repeatedly added, replacing all faces it can see
+  by a fan of triangles joining it to their horizon edges. Each added vertex
+  only needs to be compared against the points outside of the faces it
+  replaced, giving O(n log n) behaviour for typical inputs. Coplanar
+  adjacent triangles are then merged into outward-wound polygonal faces.
+
+  Points within the `approx_scalar` tolerance of a face plane are considered
+  to be on the face, so are never added to the hull.
+
+  On success the normals, points, vertices_per_face and faces_per_vertex are
+  all set but the vertices are not yet purged of points inside of the hull or
+  along the edges of its faces; see purge_extra_vertices.
+
+  @returns false if the vertices are degenerate (e.g., all coplanar)
+  */
+  bool find_convex_hull(void){
+    struct HullFace {
+      std::array<int,3> v;
+      std::array<double,3> n;
+      double d;
+      std::vector<int> outside;
+      bool alive;
+    };
+    const int nv = static_cast<int>(vertices.size());
+    auto distance = [&](const HullFace& f, const int i){
+      return vector_dot(f.n.data(), vertices.data(i)) - f.d;
+    };
+    auto is_outside = [](const double d){return d > 0. && !approx_scalar(d, 0.);};
+    std::vector<HullFace> faces;
+    std::map<std::pair<int,int>, int> edges; // directed half-edge to face index
+    auto add_face = [&](const int a, const int b, const int c){
+      HullFace f;
+      f.v = {{a, b, c}};
+      double ba[3], ca[3];
+      for (int j=0; j<3; ++j){
+        ba[j] = vertices.getvalue(b,j) - vertices.getvalue(a,j);
+        ca[j] = vertices.getvalue(c,j) - vertices.getvalue(a,j);
+      }
+      vector_cross(f.n.data(), ba, ca);
+      double len = std::sqrt(vector_dot(f.n.data(), f.n.data()));
+      for (int j=0; j<3; ++j) f.n[j] /= len;
+      f.d = vector_dot(f.n.data(), vertices.data(a));
+      f.alive = true;
+      int idx = static_cast<int>(faces.size());
+      for (int j=0; j<3; ++j) edges[std::make_pair(f.v[j], f.v[(j+1)%3])] = idx;
+      faces.push_back(f);
+      return idx;
+    };
+    // the initial tetrahedron: the extremal pair along the widest axis,
+    int i0{0}, i1{0};
+    double widest{-1};
+    for (int j=0; j<3; ++j){
+      int lo{0}, hi{0};
+      for (int i=1; i<nv; ++i){
+        if (vertices.getvalue(i,j) < vertices.getvalue(lo,j)) lo = i;
+        if (vertices.getvalue(i,j) > vertices.getvalue(hi,j)) hi = i;
+      }
+      if (vertices.getvalue(hi,j) - vertices.getvalue(lo,j) > widest){
+        widest = vertices.getvalue(hi,j) - vertices.getvalue(lo,j);
+        i0 = lo;
+        i1 = hi;
+      }
+    }
+    if (i0 == i1 || approx_scalar(widest, 0.)) return false;
+    // the vertex farthest from the line between them,
+    int i2{-1};
+    double farthest{0}, line[3], cross[3], diff[3];
+    for (int j=0; j<3; ++j) line[j] = (vertices.getvalue(i1,j) - vertices.getvalue(i0,j))/widest;
+    for (int i=0; i<nv; ++i){
+      for (int j=0; j<3; ++j) diff[j] = vertices.getvalue(i,j) - vertices.getvalue(i0,j);
+      vector_cross(cross, line, diff);
+      double dist = std::sqrt(vector_dot(cross, cross));
+      if (dist > farthest){
+        farthest = dist;
+        i2 = i;
+      }
+    }
+    if (i2 < 0 || approx_scalar(farthest, 0.)) return false;
+    // and the vertex farthest from the plane through all three
+    HullFace base;
+    add_face(i0, i1, i2);
+    base = faces.back();
+    faces.clear();
+    edges.clear();
+    int i3{-1};
+    farthest = 0;
+    for (int i=0; i<nv; ++i){
+      double dist = std::abs(distance(base, i));
+      if (dist > farthest){
+        farthest = dist;
+        i3 = i;
+      }
+    }
+    if (i3 < 0 || approx_scalar(farthest, 0.)) return false;
+    // orient all four faces so that the opposite vertex is inside
+    if (distance(base, i3) > 0) std::swap(i1, i2);
+    add_face(i0, i1, i2);
+    add_face(i0, i3, i1);
+    add_face(i1, i3, i2);
+    add_face(i2, i3, i0);
+    // assign every other point to the first face it is outside of
+    for (int i=0; i<nv; ++i){
+      if (i==i0 || i==i1 || i==i2 || i==i3) continue;
+      for (auto& f: faces) if (is_outside(distance(f, i))){
+        f.outside.push_back(i);
+        break;
+      }
+    }
+    std::vector<int> visible, orphans;
+    std::vector<std::pair<int,int>> horizon;
+    std::vector<char> is_visible;
+    for (size_t fi=0; fi<faces.size(); ++fi){
+      if (!faces[fi].alive || faces[fi].outside.empty()) continue;
+      // the eye point is the outside point farthest from this face
+      int eye = faces[fi].outside[0];
+      double eye_dist = distance(faces[fi], eye);
+      for (int i: faces[fi].outside) if (distance(faces[fi], i) > eye_dist){
+        eye = i;
+        eye_dist = distance(faces[fi], i);
+      }
+      // find all connected faces which the eye can see
+      is_visible.assign(faces.size(), 0);
+      visible.clear();
+      visible.push_back(static_cast<int>(fi));
+      is_visible[fi] = 1;
+      for (size_t k=0; k<visible.size(); ++k){
+        const HullFace& f{faces[visible[k]]};
+        for (int j=0; j<3; ++j){
+          int g = edges.at(std::make_pair(f.v[(j+1)%3], f.v[j]));
+          if (!is_visible[g] && is_outside(distance(faces[g], eye))){
+            is_visible[g] = 1;
+            visible.push_back(g);
+          }
+        }
+      }
+      // the horizon is formed by edges between visible and hidden faces
+      horizon.clear();
+      orphans.clear();
+      for (int vf: visible){
+        HullFace& f{faces[vf]};
+        for (int j=0; j<3; ++j){
+          auto twin = std::make_pair(f.v[(j+1)%3], f.v[j]);
+          if (!is_visible[edges.at(twin)]) horizon.push_back(std::make_pair(f.v[j], f.v[(j+1)%3]));
+        }
+        for (int i: f.outside) if (i != eye) orphans.push_back(i);
+        f.outside.clear();
+        f.alive = false;
+      }
+      for (int vf: visible) for (int j=0; j<3; ++j)
+        edges.erase(std::make_pair(faces[vf].v[j], faces[vf].v[(j+1)%3]));
+      // replace the visible faces by a fan from the horizon to the eye
+      size_t first_new = faces.size();
+      for (const auto& e: horizon) add_face(e.first, e.second, eye);
+      for (int i: orphans) for (size_t k=first_new; k<faces.size(); ++k)
+        if (is_outside(distance(faces[k], i))){
+          faces[k].outside.push_back(i);
+          break;
+        }
+    }
+    // merge adjacent coplanar triangles into polygons
+    std::vector<int> group(faces.size());
+    std::iota(group.begin(), group.end(), 0);
+    std::function<int(int)> root = [&](int i){ return group[i]==i ? i : (group[i] = root(group[i])); };
+    for (size_t fi=0; fi<faces.size(); ++fi) if (faces[fi].alive){
+      const HullFace& f{faces[fi]};
+      for (int j=0; j<3; ++j){
+        int g = edges.at(std::make_pair(f.v[(j+1)%3], f.v[j]));
+        const HullFace& h{faces[g]};
+        int opposite = h.v[0];
+        for (int k=0; k<3; ++k) if (h.v[k]!=f.v[j] && h.v[k]!=f.v[(j+1)%3]) opposite = h.v[k];
+        if (approx_scalar(distance(f, opposite), 0.)) group[root(g)] = root(static_cast<int>(fi));
+      }
+    }
+    std::map<int, std::map<int,int>> boundaries; // group root to next-vertex map
+    for (size_t fi=0; fi<faces.size(); ++fi) if (faces[fi].alive){
+      const HullFace& f{faces[fi]};
+      int r = root(static_cast<int>(fi));
+      for (int j=0; j<3; ++j){
+        int g = edges.at(std::make_pair(f.v[(j+1)%3], f.v[j]));
+        if (root(g) != r) boundaries[r][f.v[j]] = f.v[(j+1)%3];
+      }
+    }
+    std::vector<std::vector<int>> vpf;
+    ArrayVector<double> n(3u, boundaries.size()), p(3u, boundaries.size());
+    for (const auto& b: boundaries){
+      const std::map<int,int>& next{b.second};
+      std::vector<int> polygon{next.begin()->first};
+      while (polygon.size() <= next.size()){
+        auto found = next.find(polygon.back());
+        if (found == next.end()) return false;
+        if (found->second == polygon.front()) break;
+        polygon.push_back(found->second);
+      }
+      if (polygon.size() != next.size()) return false; // the boundary is not a single loop
+      std::array<double,3> centre{{0,0,0}};
+      for (int v: polygon) for (int j=0; j<3; ++j) centre[j] += vertices.getvalue(v,j)/static_cast<double>(polygon.size());
+      n.set(vpf.size(), faces[b.first].n);
+      p.set(vpf.size(), centre);
+      vpf.push_back(polygon);
+    }
+    std::vector<std::vector<int>> fpv(vertices.size());
+    for (size_t i=0; i<vpf.size(); ++i) for (int v: vpf[i]) fpv[v].push_back(static_cast<int>(i));
+    this->normals = n;
+    this->points = p;
+    this->vertices_per_face = vpf;
+    this->faces_per_vertex = fpv;
+    return true;
+  }
+  void find_convex_hull_planes(void){
     /* Find the set of planes which contain all vertices.
        The cross product between two vectors connecting three points defines a
        plane normal. If the plane passing through the three points partitions
@@ -510,9 +772,9 @@ protected:
           ab.cross(0, 1, nijk.data());
           // debug_update(i," ",j," ",k," ", ab.to_string(" x ")," = ",nijk.to_string(0));
           // increment the counter only if the new normal is not ⃗0 and partitions space
-          if (!approx_scalar(nijk.norm(0),0.) && dot(nijk, vertices - vi).all_approx(Comp::le_ge, 0.)){
+          if (!approx_scalar(nijk.norm(0),0.) && dot(nijk, lazy(vertices) - vi).all_approx(Comp::le_ge, 0.)){
             // verify that the normal points the right way:
-            if (dot(nijk, vertices - vi).all_approx(Comp::ge,0.))
+            if (dot(nijk, lazy(vertices) - vi).all_approx(Comp::ge,0.))
               nijk = -1*nijk;
             // normalize the cross product to ensure we can determine uniqueness later
             n.set(count, nijk/nijk.norm(0));
@@ -538,7 +800,7 @@ protected:
     std::vector<std::vector<int>> fpv(vertices.size());
     ArrayVector<bool> isonplane(1u, points.size());
     for (size_t i=0; i<vertices.size(); ++i){
-      isonplane = dot(normals, vertices.extract(i) - points).is_approx(Comp::eq,0.);
+      isonplane = dot(normals, lazy(vertices.view(i)) - points).is_approx(Comp::eq,0.);
       for (size_t j=0; j<points.size(); ++j) if (isonplane.getvalue(j)) fpv[i].push_back(static_cast<int>(j));
     }
     verbose_update("Found faces per vertex array\n",fpv);
@@ -753,7 +1015,7 @@ public:
     if (x.numel() != 3u) throw std::runtime_error("x must contain 3-vectors");
     ArrayVector<bool> out(1u, x.size(), false);
     for (size_t i=0; i<x.size(); ++i)
-      out.insert(dot(this->normals, x.extract(i)-this->points).all_approx(Comp::le,0.), i);
+      out.insert(dot(this->normals, lazy(x.view(i))-this->points).all_approx(Comp::le,0.), i);
     return out;
   }
   /* Since we have the machinery to bisect a Polyhedron by a series of planes,
@@ -814,15 +1076,15 @@ public:
     /* if the dot product is zero it means that a point is on the surface of the
        other polyhedron, which is fine. So we're using strictly less than zero. */
     for (size_t i=0; i<vertices.size(); ++i)
-      if (dot(other.normals, vertices.extract(i)-other.points).any_approx(Comp::lt, 0.)){
+      if (dot(other.normals, lazy(vertices.view(i))-other.points).any_approx(Comp::lt, 0.)){
         // for those of our vertices *in* the other polyhedron
         // ensure that they are not actually a shared vertex
-        if (norm(other.vertices - vertices.extract(i)).none_approx(0.)) return true;
+        if (norm(lazy(other.vertices) - vertices.view(i)).none_approx(0.)) return true;
       }
     // check if any of the other vertices are inside of our polyhedron
     for (size_t i=0; i<other.vertices.size(); ++i)
-      if (dot(normals, other.vertices.extract(i)-points).any_approx(Comp::lt, 0.))
-        if (norm(this->vertices - other.vertices.extract(i)).none_approx(0.)) return true;
+      if (dot(normals, lazy(other.vertices.view(i))-points).any_approx(Comp::lt, 0.))
+        if (norm(lazy(this->vertices) - other.vertices.view(i)).none_approx(0.)) return true;
     // check for intersecting planes :(
     return this->intersects(other);
   }
@@ -1068,4 +1330,165 @@ Polyhedron polyhedron_box(std::array<T,3>& xmin, std::array<T,3>& xmax){
   return Polyhedron(v, vpf);
 }
 
+//! The relationship between an axis-aligned box and a convex polyhedron
+enum class BoxOverlap {inside, outside, straddle};
+
+/*! \brief Classify an axis-aligned box relative to a convex polyhedron
+
+For each polyhedron face plane the box corners nearest to and farthest from
+the plane along its normal are found directly from the normal components.
+If the nearest corner is on or beyond any plane the box is outside, if the
+farthest corner is within every plane the box is inside, and otherwise the
+box (probably) straddles the polyhedron surface.
+The outside classification is conservative: some boxes classified as
+straddling may have no overlapping volume with the polyhedron.
+*/
+template<class T>
+BoxOverlap classify_box(const Polyhedron& poly, const std::array<T,3>& xmin, const std::array<T,3>& xmax){
+  const ArrayVector<double> normals = poly.get_normals();
+  const ArrayVector<double> points = poly.get_points();
+  bool inside{true};
+  for (size_t f=0; f<normals.size(); ++f){
+    const double* n = normals.data(f);
+    double near{0}, far{0};
+    for (int j=0; j<3; ++j){
+      double lo = n[j]*(xmin[j]-points.getvalue(f,j)), hi = n[j]*(xmax[j]-points.getvalue(f,j));
+      near += std::min(lo, hi);
+      far += std::max(lo, hi);
+    }
+    if (near > 0. || approx_scalar(near, 0.)) return BoxOverlap::outside;
+    if (far > 0. && !approx_scalar(far, 0.)) inside = false;
+  }
+  return inside ? BoxOverlap::inside : BoxOverlap::straddle;
+}
+
+/*! \brief Intersect an axis-aligned box with a convex polyhedron
+
+The box faces are clipped, Sutherland-Hodgman style, by each polyhedron face
+plane in turn. Vertices beyond a plane are discarded, new vertices are placed
+where box edges cross the plane (shared between the two faces meeting at the
+edge), and the crossing vertices are wound into a new face lying on the plane.
+This avoids the general bisection and face-vertex relation reconstruction
+performed by Polyhedron::intersection, since the winding and face membership
+of every vertex is known throughout.
+
+@param xmin the minimum corner of the box
+@param xmax the maximum corner of the box
+@param poly a convex polyhedron with outward-pointing face normals
+@returns the intersection, which is an empty Polyhedron if the two do not
+         share any volume
+*/
+template<class T>
+Polyhedron polyhedron_box_intersection(const std::array<T,3>& xmin, const std::array<T,3>& xmax, const Polyhedron& poly){
+  // box vertices and faces following polyhedron_box
+  std::vector<std::array<double,3>> verts{
+    {{xmin[0],xmin[1],xmin[2]}}, {{xmin[0],xmax[1],xmin[2]}}, {{xmin[0],xmax[1],xmax[2]}}, {{xmin[0],xmin[1],xmax[2]}},
+    {{xmax[0],xmin[1],xmin[2]}}, {{xmax[0],xmax[1],xmin[2]}}, {{xmax[0],xmax[1],xmax[2]}}, {{xmax[0],xmin[1],xmax[2]}}};
+  std::vector<std::vector<int>> faces{{3,0,4,7},{3,2,1,0},{0,1,5,4},{3,7,6,2},{7,4,5,6},{2,6,5,1}};
+  std::vector<std::array<double,3>> face_normals{{{0,-1,0}},{{-1,0,0}},{{0,0,-1}},{{0,0,1}},{{1,0,0}},{{0,1,0}}};
+  const ArrayVector<double> normals = poly.get_normals();
+  const ArrayVector<double> points = poly.get_points();
+  std::vector<double> dist;
+  std::vector<int> status;
+  std::map<std::pair<int,int>, int> crossings;
+  for (size_t f=0; f<normals.size(); ++f){
+    const double* n = normals.data(f);
+    // the signed distance of every vertex from the plane: <0 inside, >0 outside
+    dist.resize(verts.size());
+    status.resize(verts.size());
+    bool any_out{false}, any_in{false};
+    for (size_t i=0; i<verts.size(); ++i){
+      double d{0};
+      for (int j=0; j<3; ++j) d += n[j]*(verts[i][j]-points.getvalue(f,j));
+      dist[i] = d;
+      status[i] = approx_scalar(d, 0.) ? 0 : (d < 0. ? -1 : 1);
+      any_out |= status[i] > 0;
+      any_in |= status[i] < 0;
+    }
+    if (!any_out) continue; // this plane does not cut the remaining volume
+    if (!any_in) return Polyhedron(); // the remaining volume is beyond this plane
+    crossings.clear();
+    // vertices already on the plane are part of the new face, if still in use
+    std::vector<int> cap;
+    for (const auto& face: faces) for (int v: face)
+      if (status[v]==0 && std::find(cap.begin(), cap.end(), v)==cap.end()) cap.push_back(v);
+    std::vector<std::vector<int>> clipped_faces;
+    std::vector<std::array<double,3>> clipped_normals;
+    for (size_t k=0; k<faces.size(); ++k){
+      const std::vector<int>& face{faces[k]};
+      std::vector<int> clipped;
+      for (size_t e=0; e<face.size(); ++e){
+        int a = face[e], b = face[(e+1)%face.size()];
+        if (status[a] <= 0) clipped.push_back(a);
+        if (status[a]*status[b] < 0){
+          // the edge crosses the plane; both faces sharing it use one new vertex
+          auto key = std::make_pair(std::min(a,b), std::max(a,b));
+          auto found = crossings.find(key);
+          if (found == crossings.end()){
+            double t = dist[a]/(dist[a]-dist[b]);
+            std::array<double,3> v;
+            for (int j=0; j<3; ++j) v[j] = verts[a][j] + t*(verts[b][j]-verts[a][j]);
+            verts.push_back(v);
+            int idx = static_cast<int>(verts.size())-1;
+            found = crossings.emplace(key, idx).first;
+            cap.push_back(idx);
+          }
+          clipped.push_back(found->second);
+        }
+      }
+      if (clipped.size() > 2){
+        clipped_faces.push_back(clipped);
+        clipped_normals.push_back(face_normals[k]);
+      }
+    }
+    // wind the new face counter-clockwise when viewed along the plane normal
+    if (cap.size() > 2){
+      std::array<double,3> centre{{0,0,0}}, u, w, nf;
+      double nn = std::sqrt(n[0]*n[0]+n[1]*n[1]+n[2]*n[2]);
+      for (int j=0; j<3; ++j) nf[j] = n[j]/nn;
+      for (int c: cap) for (int j=0; j<3; ++j) centre[j] += verts[c][j]/static_cast<double>(cap.size());
+      for (int j=0; j<3; ++j) u[j] = verts[cap[0]][j] - centre[j];
+      vector_cross(w.data(), nf.data(), u.data());
+      std::vector<double> angle;
+      for (int c: cap){
+        double x{0}, y{0};
+        for (int j=0; j<3; ++j){
+          x += (verts[c][j]-centre[j])*u[j];
+          y += (verts[c][j]-centre[j])*w[j];
+        }
+        angle.push_back(std::atan2(y, x));
+      }
+      std::vector<size_t> perm(cap.size());
+      std::iota(perm.begin(), perm.end(), 0u);
+      std::sort(perm.begin(), perm.end(), [&](size_t a, size_t b){return angle[a] < angle[b];});
+      std::vector<int> wound;
+      for (size_t j: perm) wound.push_back(cap[j]);
+      clipped_faces.push_back(wound);
+      clipped_normals.push_back(nf);
+    }
+    faces = clipped_faces;
+    face_normals = clipped_normals;
+  }
+  if (faces.size() < 4) return Polyhedron();
+  // keep only the vertices which are on at least one face
+  std::vector<int> map(verts.size(), -1);
+  int count{0};
+  for (const auto& face: faces) for (int v: face) if (map[v] < 0) map[v] = count++;
+  ArrayVector<double> out_verts(3u, static_cast<size_t>(count));
+  for (size_t i=0; i<verts.size(); ++i) if (map[i] >= 0) out_verts.set(map[i], verts[i].data());
+  ArrayVector<double> out_points(3u, faces.size()), out_normals(3u, faces.size());
+  std::vector<std::vector<int>> fpv(count);
+  for (size_t k=0; k<faces.size(); ++k){
+    for (int& v: faces[k]) {
+      v = map[v];
+      fpv[v].push_back(static_cast<int>(k));
+    }
+    std::array<double,3> centre{{0,0,0}};
+    for (int v: faces[k]) for (int j=0; j<3; ++j) centre[j] += out_verts.getvalue(v,j)/static_cast<double>(faces[k].size());
+    out_points.set(k, centre.data());
+    out_normals.set(k, face_normals[k].data());
+  }
+  return Polyhedron(out_verts, out_points, out_normals, fpv, faces);
+}
+
 #endif // _POLYHEDRON_H_
@@ -0,0 +1,75 @@
+/* Copyright 2020 Greg Tucker
+//
+// This file is part of brille.
+//
+// brille is free software: you can redistribute it and/or modify it under the
+// terms of the GNU Affero General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// brille is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with brille. If not, see <https://www.gnu.org/licenses/>.            */
+
+#ifndef _PREDICATES_H_
+#define _PREDICATES_H_
+#include <cmath>
+#include <limits>
+#include <mutex>
+#include "tetgen.h"
+
+// Shewchuk's adaptive exact orient3d, exported but not declared by tetgen.h
+REAL orient3dadapt(REAL *pa, REAL *pb, REAL *pc, REAL *pd, REAL permanent);
+
+/*! \brief Initialise the error bounds of the exact predicates, once
+
+The adaptive predicates rely on constants (machine epsilon, the splitter and
+error bounds) which are otherwise only set when tetgen first runs. They are
+computed once, under `std::call_once`, and never change afterwards, so they
+can be read by any thread while tetgen runs on others.
+*/
+inline void initialise_exact_predicates(){
+  static std::once_flag once;
+  std::call_once(once, exactinitconstants);
+}
+
+/*! \brief A filtered three-dimensional orientation predicate
+
+Returns a positive value if d lies below the plane through a, b, and c –
+with a, b, and c appearing counterclockwise when viewed from above the
+plane – a negative value if d lies above the plane, and zero if the four
+points are coplanar. The magnitude is six times the volume of the
+tetrahedron (a, b, c, d), following the `orient3d` convention of the tetgen
+robust predicates.
+
+The determinant is first evaluated in plain double precision and accepted if
+its magnitude exceeds Shewchuk's forward error bound for that evaluation,
+which is computed from the machine epsilon alone. Only undecided cases, with
+the four points (nearly) coplanar, are passed to the adaptive exact
+`orient3dadapt`, bypassing the static filter of any tetgen run.
+*/
+inline double orient3d_filtered(const double* a, const double* b, const double* c, const double* d){
+  // Shewchuk's ε = 2⁻⁵³ and o3derrboundA = (7 + 56ε)ε
+  static constexpr double eps = std::numeric_limits<double>::epsilon()/2;
+  static constexpr double errbound_factor = (7.0 + 56.0*eps)*eps;
+  double adx = a[0]-d[0], bdx = b[0]-d[0], cdx = c[0]-d[0];
+  double ady = a[1]-d[1], bdy = b[1]-d[1], cdy = c[1]-d[1];
+  double adz = a[2]-d[2], bdz = b[2]-d[2], cdz = c[2]-d[2];
+  double bdxcdy = bdx*cdy, cdxbdy = cdx*bdy;
+  double cdxady = cdx*ady, adxcdy = adx*cdy;
+  double adxbdy = adx*bdy, bdxady = bdx*ady;
+  double det = adz*(bdxcdy-cdxbdy) + bdz*(cdxady-adxcdy) + cdz*(adxbdy-bdxady);
+  double permanent = (std::abs(bdxcdy)+std::abs(cdxbdy))*std::abs(adz)
+                   + (std::abs(cdxady)+std::abs(adxcdy))*std::abs(bdz)
+                   + (std::abs(adxbdy)+std::abs(bdxady))*std::abs(cdz);
+  if (std::abs(det) > errbound_factor*permanent) return det;
+  initialise_exact_predicates();
+  // the tetgen predicates do not modify their inputs but are not const-correct
+  return orient3dadapt(const_cast<double*>(a), const_cast<double*>(b), const_cast<double*>(c), const_cast<double*>(d), permanent);
+}
+
+#endif
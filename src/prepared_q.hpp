@@ -0,0 +1,189 @@
+/* Copyright 2020 Greg Tucker
+//
+// This file is part of brille.
+//
+// brille is free software: you can redistribute it and/or modify it under the
+// terms of the GNU Affero General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// brille is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with brille. If not, see <https://www.gnu.org/licenses/>.            */
+
+/*! \file */
+#ifndef _PREPARED_Q_H_
+#define _PREPARED_Q_H_
+#include <cmath>
+#include <tuple>
+#include <vector>
+#include "bz.hpp"
+#include "phonon.hpp"
+#include "point_status.hpp"
+#include "interpolation_data.hpp"
+#include "vertex_welder.hpp"
+
+/*! \brief Q points moved into the irreducible Brillouin zone once, for reuse
+
+`BrillouinZone::ir_moveinto` is often the largest single cost of an
+`ir_interpolate_at` call. A PreparedQ holds its results -- the irreducible
+points, their zone centres, the pointgroup operation indices, and the status of
+each point -- plus, optionally, the GammaTable needed to rotate phonon
+eigenvectors. The same points can then be interpolated by any number of
+BrillouinZone interpolators built on the same Brillouin zone, e.g., filled with
+data for different temperatures or isotopes.
+
+Many Q often fold to the same irreducible point, e.g., by symmetry in a regular
+grid. After `deduplicate` each distinct irreducible point is interpolated once
+and its results copied to every equivalent Q before rotation.
+*/
+class PreparedQ{
+  Reciprocal lattice_;
+  int time_reversal_;
+  double ir_volume_;
+  LQVec<double> ir_q_;
+  LQVec<int> tau_;
+  std::vector<size_t> rot_;
+  std::vector<size_t> invrot_;
+  std::vector<PointStatus> status_;
+  GammaTable gamma_;
+  bool has_gamma_;
+  bool deduplicated_{false};
+  LQVec<double> unique_q_;                //!< the distinct irreducible points, if deduplicated
+  std::vector<PointStatus> unique_status_;
+  std::vector<size_t> expand_;            //!< the index into `unique_q_` of each point
+public:
+  /*! \brief Move points into the irreducible Brillouin zone
+    @param bz The BrillouinZone shared by the interpolators which will use this
+    @param Q The points, in the standard reciprocal lattice of `bz`
+    @param nthreads An optional number of OpenMP threads to use
+    @param gamma_table Also construct the table needed to rotate vectors which
+                       rotate like phonon eigenvectors
+    @param no_move For testing, take `Q` as already within the irreducible
+                   Brillouin zone
+    @param dedupe Interpolate symmetry-equivalent points only once, see `deduplicate`
+    @note Points which can not be moved are marked PointStatus::fold_failed
+  */
+  template<class S>
+  PreparedQ(const BrillouinZone& bz, const LQVec<S>& Q, const int nthreads=0, const bool gamma_table=false, const bool no_move=false, const bool dedupe=false):
+  lattice_(bz.get_lattice()), time_reversal_(bz.add_time_reversal()),
+  ir_volume_(bz.get_ir_polyhedron().get_volume()),
+  ir_q_(Q.get_lattice(), Q.size()), tau_(Q.get_lattice(), Q.size()),
+  status_(Q.size(), PointStatus::found), has_gamma_(gamma_table)
+  {
+    if (no_move){
+      ir_q_ = Q;
+      size_t identity = bz.get_pointgroup_symmetry().find_index({1,0,0, 0,1,0, 0,0,1});
+      rot_.assign(Q.size(), identity);
+      invrot_.assign(Q.size(), identity);
+    } else {
+      bz.ir_moveinto(Q, ir_q_, tau_, rot_, invrot_, status_, nthreads);
+    }
+    if (has_gamma_) gamma_.construct(lattice_.star(), time_reversal_);
+    if (dedupe) this->deduplicate();
+  }
+  //! The number of points
+  size_t size() const {return ir_q_.size();}
+  //! The points within the irreducible Brillouin zone
+  const LQVec<double>& ir_q() const {return ir_q_;}
+  //! The zone centres of the points
+  const LQVec<int>& tau() const {return tau_;}
+  //! The pointgroup operation index taking each irreducible point to its Q
+  const std::vector<size_t>& rotations() const {return rot_;}
+  //! The index of the inverse of each pointgroup operation
+  const std::vector<size_t>& inverse_rotations() const {return invrot_;}
+  //! The status of each point after moving it into the irreducible zone
+  const std::vector<PointStatus>& status() const {return status_;}
+  bool has_gamma_table() const {return has_gamma_;}
+  /*! \brief Find the distinct irreducible points, to be interpolated only once
+
+  Irreducible points are equivalent if their separation is approximately zero,
+  as for vertices joined by a VertexWelder. Points which could not be moved
+  into the irreducible zone are never merged.
+
+  @returns the number of distinct points
+  */
+  size_t deduplicate(){
+    if (deduplicated_) return unique_status_.size();
+    ArrayVector<double> xyz = ir_q_.get_xyz();
+    // cells comparable to the mean spacing of the points in the irreducible zone
+    double cell = std::cbrt(ir_volume_/static_cast<double>(this->size() ? this->size() : 1u));
+    VertexWelder<double> welder(cell);
+    welder.reserve(this->size());
+    std::vector<size_t> first, welded;
+    expand_.resize(this->size());
+    for (size_t i=0; i<this->size(); ++i){
+      if (point_ok(status_[i])){
+        auto iw = welder.weld(xyz.data(i));
+        if (iw.second){
+          welded.push_back(first.size());
+          first.push_back(i);
+        }
+        expand_[i] = welded[iw.first];
+      } else {
+        expand_[i] = first.size();
+        first.push_back(i);
+      }
+    }
+    unique_q_ = ir_q_.extract(first.size(), first.data());
+    unique_status_.clear();
+    unique_status_.reserve(first.size());
+    for (auto i: first) unique_status_.push_back(status_[i]);
+    deduplicated_ = true;
+    return first.size();
+  }
+  bool is_deduplicated() const {return deduplicated_;}
+  //! The number of points which must be interpolated
+  size_t unique_count() const {return deduplicated_ ? unique_status_.size() : this->size();}
+  //! The points which must be interpolated, all of `ir_q` unless deduplicated
+  const LQVec<double>& unique_ir_q() const {return deduplicated_ ? unique_q_ : ir_q_;}
+  //! The status of the points which must be interpolated
+  const std::vector<PointStatus>& unique_status() const {return deduplicated_ ? unique_status_ : status_;}
+  //! Copy results for the `unique_ir_q` points to every equivalent point
+  template<class T, class R>
+  void expand(ArrayVector<T>& vals, ArrayVector<R>& vecs) const {
+    if (!deduplicated_) return;
+    vals = vals.extract(expand_);
+    vecs = vecs.extract(expand_);
+  }
+  //! As `expand`, including the status of each point
+  template<class T, class R>
+  void expand(ArrayVector<T>& vals, ArrayVector<R>& vecs, std::vector<PointStatus>& status) const {
+    if (!deduplicated_) return;
+    this->expand(vals, vecs);
+    std::vector<PointStatus> all(this->size());
+    for (size_t i=0; i<all.size(); ++i) all[i] = status[expand_[i]];
+    status = std::move(all);
+  }
+  //! Whether the points were prepared for this Brillouin zone
+  bool matches(const BrillouinZone& bz) const {
+    return time_reversal_ == bz.add_time_reversal()
+        && lattice_.issame(bz.get_lattice())
+        && approx_scalar(ir_volume_, bz.get_ir_polyhedron().get_volume());
+  }
+  void check(const BrillouinZone& bz) const {
+    if (!this->matches(bz))
+      throw std::runtime_error("The PreparedQ points were prepared for a different Brillouin zone");
+  }
+  /*! \brief Rotate interpolated results from the irreducible zone to each Q
+
+  Uses the prepared GammaTable if there is one, otherwise one is constructed if
+  the vectors rotate like phonon eigenvectors.
+  */
+  template<class T, class R>
+  void rotate(const InterpolationData<T,R>& data, ArrayVector<T>& vals, ArrayVector<R>& vecs, const BrillouinZone& bz, const int nthreads) const {
+    const PointSymmetry& psym = bz.get_pointgroup_symmetry();
+    GammaTable local{GammaTable()};
+    if (!has_gamma_ && RotatesLike::Gamma == data.vectors().rotateslike())
+      local.construct(bz.get_lattice().star(), bz.add_time_reversal());
+    const GammaTable& pgt = has_gamma_ ? gamma_ : local;
+    data.values() .rotate_in_place(vals, ir_q_, pgt, psym, rot_, invrot_, nthreads);
+    data.vectors().rotate_in_place(vecs, ir_q_, pgt, psym, rot_, invrot_, nthreads);
+  }
+};
+
+#endif
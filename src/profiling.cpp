@@ -0,0 +1,80 @@
+/* Copyright 2020 Greg Tucker
+//
+// This file is part of brille.
+//
+// brille is free software: you can redistribute it and/or modify it under the
+// terms of the GNU Affero General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// brille is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with brille. If not, see <https://www.gnu.org/licenses/>.            */
+#include <mutex>
+#include <stdexcept>
+#include "profiling.hpp"
+
+constexpr size_t Profile::n_stages;
+constexpr size_t Profile::n_counters;
+constexpr size_t Profile::n_slots;
+std::atomic<bool> Profile::enabled_{false};
+std::array<Profile::Slot, Profile::n_slots> Profile::slots_{};
+Profile::Snapshot Profile::total_{};
+
+// serialises folding the last-call record into the totals
+static std::mutex profile_mutex;
+
+void Profile::begin_call(const size_t points){
+  std::lock_guard<std::mutex> lock(profile_mutex);
+  for (auto& s: slots_){
+    for (size_t i=0; i<n_stages; ++i) total_.nanoseconds[i] += s.nanoseconds[i].exchange(0u, std::memory_order_relaxed);
+    for (size_t i=0; i<n_counters; ++i) total_.counts[i] += s.counts[i].exchange(0u, std::memory_order_relaxed);
+  }
+  add_count(ProfileCounter::points, points);
+}
+
+Profile::Snapshot Profile::snapshot(const bool cumulative){
+  std::lock_guard<std::mutex> lock(profile_mutex);
+  Snapshot out;
+  if (cumulative) out = total_;
+  for (const auto& s: slots_){
+    for (size_t i=0; i<n_stages; ++i) out.nanoseconds[i] += s.nanoseconds[i].load(std::memory_order_relaxed);
+    for (size_t i=0; i<n_counters; ++i) out.counts[i] += s.counts[i].load(std::memory_order_relaxed);
+  }
+  return out;
+}
+
+void Profile::reset(){
+  std::lock_guard<std::mutex> lock(profile_mutex);
+  total_ = Snapshot();
+  for (auto& s: slots_){
+    for (auto& x: s.nanoseconds) x.store(0u, std::memory_order_relaxed);
+    for (auto& x: s.counts) x.store(0u, std::memory_order_relaxed);
+  }
+}
+
+std::string Profile::name(const ProfileStage s){
+  switch (s){
+    case ProfileStage::moveinto: return "moveinto";
+    case ProfileStage::ir_moveinto: return "ir_moveinto";
+    case ProfileStage::locate: return "locate";
+    case ProfileStage::permute: return "permute";
+    case ProfileStage::sum: return "sum";
+    case ProfileStage::rotate: return "rotate";
+  }
+  throw std::runtime_error("Unknown profile stage");
+}
+
+std::string Profile::name(const ProfileCounter c){
+  switch (c){
+    case ProfileCounter::points: return "points";
+    case ProfileCounter::permutation_solves: return "permutation_solves";
+    case ProfileCounter::boundary_retries: return "boundary_retries";
+    case ProfileCounter::not_found: return "not_found";
+  }
+  throw std::runtime_error("Unknown profile counter");
+}
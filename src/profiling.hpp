@@ -0,0 +1,126 @@
+/* Copyright 2020 Greg Tucker
+//
+// This file is part of brille.
+//
+// brille is free software: you can redistribute it and/or modify it under the
+// terms of the GNU Affero General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// brille is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with brille. If not, see <https://www.gnu.org/licenses/>.            */
+
+/*! \file */
+#ifndef _PROFILING_H_
+#define _PROFILING_H_
+#include <omp.h>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+//! The timed stages of the interpolation pipeline
+enum class ProfileStage: int {
+  moveinto,    //!< `BrillouinZone::moveinto`
+  ir_moveinto, //!< `BrillouinZone::ir_moveinto`, which includes a `moveinto`
+  locate,      //!< finding the vertices and weights for each point
+  permute,     //!< solving for the branch permutations between vertices
+  sum,         //!< the weighted sum over vertices
+  rotate,      //!< rotating interpolated results from the irreducible wedge
+};
+//! The counted events of the interpolation pipeline
+enum class ProfileCounter: int {
+  points,             //!< points requested by the interpolating call
+  permutation_solves, //!< linear assignment problems solved
+  boundary_retries,   //!< trellis node lookups retried across a bin boundary
+  not_found,          //!< points for which no vertices were found
+};
+
+/*! \brief Runtime-toggleable timing and counting of the interpolation pipeline
+
+Disabled, each instrumented site costs one relaxed atomic load. Enabled, the
+stage times and counters are accumulated with relaxed atomic additions into
+per-thread slots (padded to avoid false sharing), so the totals include the
+work of every OpenMP thread: stage times are the sum over threads, not wall
+time, for stages run inside parallel regions.
+
+Each top-level interpolation call starts a new `last` record, whose contents
+are added to the cumulative totals when the next call starts. Concurrent
+top-level calls share one record.
+*/
+class Profile{
+public:
+  static constexpr size_t n_stages = 6u;
+  static constexpr size_t n_counters = 4u;
+  //! A read-out of the accumulated times and counts
+  struct Snapshot{
+    std::array<uint64_t, n_stages> nanoseconds{{}};
+    std::array<uint64_t, n_counters> counts{{}};
+  };
+private:
+  static constexpr size_t n_slots = 64u;
+  struct alignas(64) Slot{
+    std::array<std::atomic<uint64_t>, n_stages> nanoseconds;
+    std::array<std::atomic<uint64_t>, n_counters> counts;
+  };
+  static std::atomic<bool> enabled_;
+  static std::array<Slot, n_slots> slots_;
+  static Snapshot total_;
+  static Slot& slot(){
+    return slots_[static_cast<size_t>(omp_get_thread_num()) % n_slots];
+  }
+public:
+  static bool enabled() {return enabled_.load(std::memory_order_relaxed);}
+  static void enable(const bool e) {enabled_.store(e, std::memory_order_relaxed);}
+  static void add_time(const ProfileStage s, const uint64_t ns){
+    slot().nanoseconds[static_cast<size_t>(s)].fetch_add(ns, std::memory_order_relaxed);
+  }
+  static void add_count(const ProfileCounter c, const uint64_t n=1u){
+    slot().counts[static_cast<size_t>(c)].fetch_add(n, std::memory_order_relaxed);
+  }
+  //! Record one event if profiling is enabled
+  static void count(const ProfileCounter c, const uint64_t n=1u){
+    if (enabled() && n) add_count(c, n);
+  }
+  //! Fold the last call into the totals and start a new record for `points` points
+  static void begin_call(const size_t points);
+  //! The record of the last top-level call, or the cumulative totals
+  static Snapshot snapshot(const bool cumulative=false);
+  //! Zero the last-call record and the cumulative totals
+  static void reset();
+  static std::string name(const ProfileStage s);
+  static std::string name(const ProfileCounter c);
+};
+
+//! Adds the time between its construction and destruction to a stage, if profiling is enabled
+class ProfileTimer{
+  using clock = std::chrono::steady_clock;
+  ProfileStage stage_;
+  bool active_;
+  clock::time_point start_;
+public:
+  explicit ProfileTimer(const ProfileStage s): stage_(s), active_(Profile::enabled()) {
+    if (active_) start_ = clock::now();
+  }
+  ProfileTimer(const ProfileTimer&) = delete;
+  ProfileTimer& operator=(const ProfileTimer&) = delete;
+  ~ProfileTimer(){
+    if (active_){
+      auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start_).count();
+      Profile::add_time(stage_, static_cast<uint64_t>(ns));
+    }
+  }
+};
+
+//! Start a new profiling record for a top-level call with `points` points, if enabled
+inline void profile_call(const size_t points){
+  if (Profile::enabled()) Profile::begin_call(points);
+}
+
+#endif
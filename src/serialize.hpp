@@ -0,0 +1,193 @@
+/* Copyright 2020 Greg Tucker
+//
+// This file is part of brille.
+//
+// brille is free software: you can redistribute it and/or modify it under the
+// terms of the GNU Affero General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// brille is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with brille. If not, see <https://www.gnu.org/licenses/>.            */
+
+/*! \file */
+#ifndef _SERIALIZE_H_
+#define _SERIALIZE_H_
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+template<class T> class ArrayVector;
+
+//! The alignment, in bytes, of ArrayVector data within a serialized buffer
+static constexpr size_t serialize_alignment = 64u;
+//! The version of the binary layout written by BinaryWriter::write_header
+static constexpr uint32_t serialize_version = 2u;
+
+/*! \brief Write objects into a flat binary buffer
+
+Constructed without a destination the writer only counts the bytes that would
+be written, so that a buffer of the right size can be allocated before writing
+for real. Trivially-copyable values are stored as their bytes; vectors and
+strings are prefixed by their length. ArrayVector data starts at an offset
+which is a multiple of `serialize_alignment` from the start of the buffer, so
+that a BinaryReader of a suitably aligned buffer can reference it in place.
+*/
+class BinaryWriter{
+  unsigned char* dest_;
+  size_t capacity_;
+  size_t size_;
+public:
+  //! Count the bytes required without writing anything
+  BinaryWriter(): dest_(nullptr), capacity_(0), size_(0) {}
+  //! Write into `capacity` bytes starting at `dest`
+  BinaryWriter(unsigned char* dest, const size_t capacity): dest_(dest), capacity_(capacity), size_(0) {}
+  //! The number of bytes written (or counted) so far
+  size_t size() const {return size_;}
+  void write_bytes(const void* src, const size_t n){
+    if (dest_ && n){
+      if (size_ + n > capacity_) throw std::runtime_error("BinaryWriter destination buffer is too small");
+      std::memcpy(dest_ + size_, src, n);
+    }
+    size_ += n;
+  }
+  //! Pad with zeros up to the next multiple of `a` bytes from the buffer start
+  void align(const size_t a=serialize_alignment){
+    size_t pad = (a - size_ % a) % a;
+    if (dest_ && pad){
+      if (size_ + pad > capacity_) throw std::runtime_error("BinaryWriter destination buffer is too small");
+      std::memset(dest_ + size_, 0, pad);
+    }
+    size_ += pad;
+  }
+  template<class T> void write(const T& v){
+    static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable types can be written directly");
+    this->write_bytes(&v, sizeof(T));
+  }
+  template<class T> void write(const std::vector<T>& v){
+    static_assert(std::is_trivially_copyable<T>::value, "Only vectors of trivially copyable types can be written directly");
+    this->write(static_cast<uint64_t>(v.size()));
+    this->write_bytes(v.data(), v.size()*sizeof(T));
+  }
+  template<class T> void write(const std::vector<std::vector<T>>& v){
+    this->write(static_cast<uint64_t>(v.size()));
+    for (const auto& x: v) this->write(x);
+  }
+  void write(const std::string& s){
+    this->write(static_cast<uint64_t>(s.size()));
+    this->write_bytes(s.data(), s.size());
+  }
+  template<class T> void write(const ArrayVector<T>& a){
+    static_assert(std::is_trivially_copyable<T>::value, "Only ArrayVectors of trivially copyable types can be written");
+    this->write(static_cast<uint64_t>(a.numel()));
+    this->write(static_cast<uint64_t>(a.size()));
+    this->align();
+    if (a.numel() && a.size()) this->write_bytes(a.data(), a.numel()*a.size()*sizeof(T));
+  }
+  //! Identify the buffer contents as a `kind` object in the current layout
+  void write_header(const std::string& kind){
+    const char magic[8] = {'b','r','i','l','l','e',0,0};
+    this->write_bytes(magic, 8u);
+    this->write(serialize_version);
+    this->write(kind);
+  }
+};
+
+/*! \brief Read objects from a flat binary buffer written by BinaryWriter
+
+Every read is bounds checked and a truncated or foreign buffer causes a
+`std::runtime_error`. ArrayVectors can be read as copies or, if the data is
+suitably aligned, as borrowed views of the buffer which must then outlive
+them.
+*/
+class BinaryReader{
+  const unsigned char* src_;
+  size_t size_;
+  size_t pos_;
+  const unsigned char* take(const size_t n){
+    if (n > size_ - pos_) throw std::runtime_error("BinaryReader source buffer is truncated");
+    const unsigned char* at = src_ + pos_;
+    pos_ += n;
+    return at;
+  }
+public:
+  BinaryReader(const unsigned char* src, const size_t size): src_(src), size_(size), pos_(0) {}
+  //! The number of bytes read so far
+  size_t position() const {return pos_;}
+  //! The number of bytes left to read
+  size_t remaining() const {return size_ - pos_;}
+  void read_bytes(void* dest, const size_t n){
+    const unsigned char* at = this->take(n);
+    if (n) std::memcpy(dest, at, n);
+  }
+  //! Skip the padding written by BinaryWriter::align
+  void align(const size_t a=serialize_alignment){
+    this->take((a - pos_ % a) % a);
+  }
+  template<class T> void read(T& v){
+    static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable types can be read directly");
+    this->read_bytes(&v, sizeof(T));
+  }
+  template<class T> void read(std::vector<T>& v){
+    static_assert(std::is_trivially_copyable<T>::value, "Only vectors of trivially copyable types can be read directly");
+    uint64_t n = this->read<uint64_t>();
+    if (n > (size_ - pos_)/(sizeof(T) ? sizeof(T) : 1u)) throw std::runtime_error("BinaryReader source buffer is truncated");
+    v.resize(static_cast<size_t>(n));
+    this->read_bytes(v.data(), v.size()*sizeof(T));
+  }
+  template<class T> void read(std::vector<std::vector<T>>& v){
+    uint64_t n = this->read<uint64_t>();
+    if (n > size_ - pos_) throw std::runtime_error("BinaryReader source buffer is truncated");
+    v.resize(static_cast<size_t>(n));
+    for (auto& x: v) this->read(x);
+  }
+  void read(std::string& s){
+    uint64_t n = this->read<uint64_t>();
+    const unsigned char* at = this->take(static_cast<size_t>(n));
+    s.assign(reinterpret_cast<const char*>(at), static_cast<size_t>(n));
+  }
+  template<class T> T read(){
+    T v;
+    this->read(v);
+    return v;
+  }
+  /*! \brief Read an ArrayVector
+
+  @param borrow if true and the stored data is aligned for `T`, reference the
+                buffer rather than copying from it
+  */
+  template<class T> ArrayVector<T> read_arrayvector(const bool borrow=false){
+    size_t m = static_cast<size_t>(this->read<uint64_t>());
+    size_t n = static_cast<size_t>(this->read<uint64_t>());
+    this->align();
+    if (m && n > (size_ - pos_)/m/sizeof(T)) throw std::runtime_error("BinaryReader source buffer is truncated");
+    const unsigned char* at = this->take(m*n*sizeof(T));
+    if (borrow && m && n && reinterpret_cast<uintptr_t>(at) % alignof(T) == 0)
+      return ArrayVector<T>::borrow(reinterpret_cast<T*>(const_cast<unsigned char*>(at)), m, n);
+    ArrayVector<T> out(m, n);
+    if (m && n) std::memcpy(out.data(), at, m*n*sizeof(T));
+    return out;
+  }
+  //! Check that the buffer holds a `kind` object in a layout this reader understands
+  void read_header(const std::string& kind){
+    char magic[8];
+    this->read_bytes(magic, 8u);
+    if (std::memcmp(magic, "brille\0\0", 8u))
+      throw std::runtime_error("The buffer does not hold a serialized brille object");
+    if (this->read<uint32_t>() != serialize_version)
+      throw std::runtime_error("The serialized brille object was written by an incompatible version");
+    if (this->read<std::string>() != kind)
+      throw std::runtime_error("The buffer does not hold a serialized " + kind);
+  }
+};
+
+#endif
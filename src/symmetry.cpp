@@ -56,6 +56,7 @@ size_t Symmetry::add(const Matrix<int>& r, const Vector<double>& t){
   return this->add(Motion<int,double>(r,t));
 }
 size_t Symmetry::add(const Motion<int,double>& m){
+  this->index_.reset();
   this->M.push_back(m);
   return this->size();
 }
@@ -64,6 +65,7 @@ bool Symmetry::from_ascii(const std::string& s){
   std::vector<std::string> motions;
   std::istringstream stream(s);
   for (std::string m; std::getline(stream, m, ';'); ) motions.push_back(m);
+  this->index_.reset();
   this->M.resize(motions.size());
   for (size_t i=0; i<motions.size(); ++i) this->M[i].from_ascii(motions[i]);
   return true;
@@ -83,6 +85,7 @@ Motion<int,double> Symmetry::getm(const size_t i) const {
   return (i<this->size()) ? this->M[i] : Motion<int,double>();
 }
 size_t Symmetry::resize(const size_t newsize){
+  this->index_.reset();
   this->M.resize(newsize);
   return newsize;
 }
@@ -99,6 +102,7 @@ Motion<int,double> Symmetry::pop(const size_t i) {
 size_t  Symmetry::erase(const size_t i){
   if (i>=this->size())
     throw std::out_of_range("The requested symmetry operation is out of range");
+  this->index_.reset();
   this->M.erase(this->M.begin()+i);
   return this->size();
 }
@@ -178,6 +182,5 @@ bool Symmetry::has_space_inversion() const {
 }
 
 size_t Symmetry::find_matrix_index(const Matrix<int>& m) const {
-  auto itr = std::find_if(this->M.begin(), this->M.end(), [m](const Motion<int,double>& Mot){return Mot.equal_matrix(m);});
-  return std::distance(this->M.begin(), itr);
+  return this->index_.find(m, this->M.size(), [this](const size_t i){return this->M[i].getr();});
 }
@@ -24,6 +24,7 @@
 #include <algorithm>
 // #include <numeric>
 #include "utilities.hpp"
+#include "matrix_index.hpp"
 
 template<class T> using Matrix = std::array<T,9>;
 template<class T> using Vector = std::array<T,3>;
@@ -291,6 +292,7 @@ public:
   using Motions = std::vector<Motion<int,double>>;
 private:
   Motions M;
+  MatrixIndex index_; //!< hash lookup for find_matrix_index
 public:
   Symmetry(size_t n=0) { M.resize(n); }
   Symmetry(const Motions& m): M(m) {};
@@ -4,6 +4,8 @@
 #include <catch2/catch.hpp>
 
 #include "arrayvector.hpp"
+#include "lattice.hpp"
+#include "latvec.hpp"
 
 TEST_CASE("ArrayVector creation","[arrayvector]"){
   ArrayVector<double> novalues(3,3);
@@ -185,3 +187,106 @@ TEST_CASE("ArrayVector ArrayVector math operations","[arrayvector]"){
     }
 
 }
+
+TEST_CASE("ArrayVector move operations and views","[arrayvector]"){
+  double tmp[12] = {1,2,3,4,5,6,7,8,9,10,11,12};
+  ArrayVector<double> source(3,4,tmp);
+  double* block = source.data();
+
+  ArrayVector<double> moved(std::move(source));
+  REQUIRE( moved.numel() == 3);
+  REQUIRE( moved.size() == 4);
+  REQUIRE( moved.data() == block ); // the data block was taken, not copied
+  REQUIRE( source.size() == 0);
+
+  ArrayVector<double> move_assigned(2,2);
+  move_assigned = std::move(moved);
+  REQUIRE( move_assigned.numel() == 3);
+  REQUIRE( move_assigned.size() == 4);
+  REQUIRE( move_assigned.data() == block );
+  REQUIRE( moved.size() == 0);
+
+  ArrayVectorView<double> all = move_assigned.view();
+  REQUIRE( all.size() == 4);
+  REQUIRE( all.numel() == 3);
+  for (size_t i=0; i<all.size(); ++i){
+    ArrayVectorView<double> one = move_assigned.view(i);
+    REQUIRE( one.size() == 1);
+    REQUIRE( one.data() == move_assigned.data(i) );
+    for (size_t j=0; j<all.numel(); ++j){
+      REQUIRE( all.getvalue(i,j) == tmp[i*3+j] );
+      REQUIRE( one.getvalue(0,j) == tmp[i*3+j] );
+    }
+  }
+  REQUIRE_THROWS( move_assigned.view(4) );
+
+  // a strided view over the first two elements of every array
+  ArrayVectorView<double> strided(move_assigned.data(), 2u, 4u, 3u);
+  ArrayVector<double> copied(strided);
+  REQUIRE( copied.numel() == 2);
+  REQUIRE( copied.size() == 4);
+  for (size_t i=0; i<copied.size(); ++i)
+    for (size_t j=0; j<copied.numel(); ++j)
+      REQUIRE( copied.getvalue(i,j) == tmp[i*3+j] );
+}
+
+TEST_CASE("ArrayVector lazy expressions","[arrayvector]"){
+  double nv[12] = {1,0,0, 0,1,0, 0,0,1, -1,-1,-1};
+  double pv[12] = {0.5,0,0, 0,0.5,0, 0,0,0.5, -0.2,-0.2,-0.2};
+  double xv[6] = {0.1,0.2,0.3, 0.6,-0.3,0.1};
+  ArrayVector<double> normals(3,4,nv), points(3,4,pv), x(3,2,xv);
+
+  for (size_t i=0; i<x.size(); ++i){
+    ArrayVector<double> eager = dot(normals, x.extract(i)-points);
+    auto expr = dot(normals, lazy(x.view(i)) - points);
+    REQUIRE( expr.size() == eager.size() );
+    REQUIRE( expr.numel() == 1u );
+    ArrayVector<double> evaluated = expr.eval();
+    for (size_t j=0; j<eager.size(); ++j)
+      REQUIRE( evaluated.getvalue(j) == Approx(eager.getvalue(j)) );
+    REQUIRE( expr.all_approx(Comp::le, 0.) == eager.all_approx(Comp::le, 0.) );
+    REQUIRE( expr.any_approx(Comp::gt, 0.) == eager.any_approx(Comp::gt, 0.) );
+  }
+  // the first point is inside of all four planes, the second is not
+  REQUIRE( dot(normals, lazy(x.view(0)) - points).all_approx(Comp::le, 0.) );
+  REQUIRE( dot(normals, lazy(x.view(1)) - points).any_approx(Comp::gt, 0.) );
+
+  // scalars broadcast, and expressions convert to ArrayVectors when needed
+  ArrayVector<double> scaled = 2.0*lazy(points) + 1.0;
+  ArrayVector<double> eager_scaled = 2.0*points + 1.0;
+  REQUIRE( scaled.isapprox(eager_scaled) );
+  ArrayVector<double> lengths = norm(lazy(points) - points.extract(0));
+  ArrayVector<double> differences = points - points.extract(0);
+  for (size_t i=0; i<differences.size(); ++i)
+    REQUIRE( lengths.getvalue(i) == Approx(differences.norm(i)) );
+
+  REQUIRE_THROWS( lazy(points) - x );
+}
+
+TEST_CASE("ArrayVector borrowed data","[arrayvector]"){
+  double external[6] = {1,2,3, 4,5,6};
+  {
+    ArrayVector<double> view = ArrayVector<double>::borrow(external, 3u, 2u);
+    REQUIRE( view.is_borrowed() );
+    REQUIRE( view.data() == external );
+    REQUIRE( view.getvalue(1,2) == 6. );
+    // copies own their data
+    ArrayVector<double> copy(view);
+    REQUIRE( !copy.is_borrowed() );
+    REQUIRE( copy.data() != external );
+    // moving passes on the reference
+    ArrayVector<double> moved(std::move(view));
+    REQUIRE( moved.is_borrowed() );
+    REQUIRE( moved.data() == external );
+    // and reallocation replaces it with an owned block
+    moved.resize(3u);
+    REQUIRE( !moved.is_borrowed() );
+    REQUIRE( moved.getvalue(1,0) == 4. );
+    REQUIRE( moved.getvalue(2,0) == 0. );
+    // a lattice vector can reference the data too
+    LQVec<double> q(Reciprocal(1.,1.,1.,PI/2,PI/2,PI/2), ArrayVector<double>::borrow(external, 3u, 2u));
+    REQUIRE( q.data() == external );
+  }
+  // the external data is untouched once the borrowing objects are destroyed
+  for (size_t i=0; i<6u; ++i) REQUIRE( external[i] == static_cast<double>(i+1) );
+}
@@ -0,0 +1,82 @@
+#include <catch2/catch.hpp>
+#include <random>
+#include "barycentric.hpp"
+#include "polyhedron.hpp"
+#include "triangulation_simple.hpp"
+
+TEST_CASE("BarycentricTransform matches orient3d weights","[barycentric]"){
+  std::array<double,3> a{{0.1, 0.2, 0.3}}, b{{0.2, 1.1, 0.4}}, c{{1.3, 0.1, 0.2}}, d{{0.3, 0.2, 1.5}};
+  double vol6 = orient3d(a.data(), b.data(), c.data(), d.data());
+  REQUIRE( vol6 > 0. );
+  BarycentricTransform transform(a.data(), b.data(), c.data(), d.data());
+  REQUIRE( transform.valid() );
+  std::default_random_engine generator(2u);
+  std::uniform_real_distribution<double> distribution(-0.5, 2.);
+  std::array<double,4> fast, exact;
+  for (int i=0; i<100; ++i){
+    std::array<double,3> x{{distribution(generator), distribution(generator), distribution(generator)}};
+    orient3d_weights(a.data(), b.data(), c.data(), d.data(), x.data(), vol6, exact);
+    REQUIRE( transform.weights(x.data(), fast) );
+    for (int j=0; j<4; ++j) REQUIRE( fast[j] == Approx(exact[j]).margin(1e-12) );
+  }
+  // a point on a face can not be decided by the transform
+  std::array<double,3> on_face;
+  for (int j=0; j<3; ++j) on_face[j] = (a[j] + b[j] + c[j])/3.0;
+  REQUIRE_FALSE( transform.weights(on_face.data(), fast) );
+  barycentric_weights(transform, a.data(), b.data(), c.data(), d.data(), on_face.data(), vol6, fast);
+  REQUIRE( fast[3] == Approx(0.).margin(1e-14) );
+  // and degenerate tetrahedra are never decided by the transform
+  BarycentricTransform flat(a.data(), b.data(), c.data(), on_face.data());
+  REQUIRE_FALSE( flat.valid() );
+  REQUIRE_FALSE( flat.weights(a.data(), fast) );
+}
+
+TEST_CASE("Filtered orient3d agrees with the exact predicate","[barycentric]"){
+  std::default_random_engine generator(3u);
+  std::uniform_real_distribution<double> distribution(-1., 1.);
+  auto random_point = [&](){
+    return std::array<double,3>({{distribution(generator), distribution(generator), distribution(generator)}});
+  };
+  for (int i=0; i<100; ++i){
+    auto a = random_point(), b = random_point(), c = random_point(), d = random_point();
+    REQUIRE( orient3d_filtered(a.data(), b.data(), c.data(), d.data()) == Approx(orient3d(a.data(), b.data(), c.data(), d.data())) );
+  }
+  // (nearly) coplanar points are decided exactly: d is on the plane through
+  // a, b, and c, or displaced from it by much less than the rounding error
+  std::array<double,3> a{{0.1, 0.1, 0.}}, b{{0.7, 0.3, 0.}}, c{{0.2, 0.9, 0.}}, d{{1./3., 1./7., 0.}};
+  REQUIRE( orient3d_filtered(a.data(), b.data(), c.data(), d.data()) == 0. );
+  d[2] = 1e-300;
+  double above = orient3d_filtered(a.data(), b.data(), c.data(), d.data());
+  d[2] = -1e-300;
+  double below = orient3d_filtered(a.data(), b.data(), c.data(), d.data());
+  REQUIRE( above != 0. );
+  REQUIRE( below != 0. );
+  REQUIRE( std::signbit(above) != std::signbit(below) );
+}
+
+// Shewchuk's exact (non-adaptive) orient3d from the tetgen predicates
+REAL orient3dexact(REAL *pa, REAL *pb, REAL *pc, REAL *pd);
+
+TEST_CASE("Filtered orient3d ignores the last tetgen static filter","[barycentric]"){
+  // tetgen sets its orient3d static filter from the bounding box of its input,
+  // so a tiny box leaves a filter far below the rounding error of unit points
+  std::array<double,3> bmin{{0,0,0}}, bmax{{1e-4,1e-4,1e-4}};
+  SimpleTet tiny(polyhedron_box(bmin, bmax), 1e-13);
+  REQUIRE( tiny.number_of_tetrahedra() > 0u );
+  std::default_random_engine generator(4u);
+  std::uniform_real_distribution<double> distribution(-1., 1.);
+  auto random_point = [&](){
+    return std::array<double,3>({{distribution(generator), distribution(generator), distribution(generator)}});
+  };
+  for (int i=0; i<1000; ++i){
+    // d is on the plane through a, b, and c up to rounding
+    auto a = random_point(), b = random_point(), c = random_point();
+    double s = distribution(generator), t = distribution(generator);
+    std::array<double,3> d;
+    for (int j=0; j<3; ++j) d[j] = a[j] + s*(b[j]-a[j]) + t*(c[j]-a[j]);
+    double exact = orient3dexact(a.data(), b.data(), c.data(), d.data());
+    double filtered = orient3d_filtered(a.data(), b.data(), c.data(), d.data());
+    REQUIRE( (exact > 0) == (filtered > 0) );
+    REQUIRE( (exact < 0) == (filtered < 0) );
+  }
+}
@@ -30,3 +30,78 @@ TEST_CASE("BrillouinZoneGrid4 instantiation","[grid]"){
   BrillouinZoneGrid4<double,double> bzg(bz,spec,half);
 
 }
+
+TEST_CASE("InterpolateGrid4 linear interpolation","[grid]"){
+  size_t n[4]={3,4,3,5};
+  double zero[4]={-1.,-1.5,0.,0.}, step[4]={1.,1.,0.5,2.5};
+  InterpolateGrid4<double,double> grid(n, zero, step);
+  // a function which is linear in each grid direction is reproduced exactly
+  auto linear = [](const double* p){return 1.+2.*p[0]-3.*p[1]+0.5*p[2]+0.25*p[3];};
+  ArrayVector<double> xyzw = grid.get_grid_xyzw();
+  ArrayVector<double> data(1u, xyzw.size());
+  for (size_t i=0; i<xyzw.size(); ++i) data.insert(linear(xyzw.data(i)), i);
+  grid.replace_value_data(data);
+  REQUIRE(grid.set_map() == 0);
+  // points between grid points, on grid planes, and on grid points
+  std::vector<std::array<double,4>> pts{
+    {{0.3,-0.2,0.7,3.1}}, {{0.,0.1,0.2,1.}}, {{0.5,0.5,0.5,2.5}},
+    {{0.,0.5,0.5,2.5}}, {{-0.9,1.4,0.9,9.9}}, {{1.,1.5,1.,10.}}};
+  ArrayVector<double> x(4u, pts.size());
+  for (size_t i=0; i<pts.size(); ++i) x.set(i, pts[i]);
+  ArrayVector<double> serial, parallel, vecs;
+  std::tie(serial, vecs) = grid.linear_interpolate_at(x);
+  std::tie(parallel, vecs) = grid.parallel_linear_interpolate_at(x, 2);
+  REQUIRE(serial.size() == pts.size());
+  REQUIRE(parallel.size() == pts.size());
+  for (size_t i=0; i<pts.size(); ++i){
+    REQUIRE(serial.getvalue(i) == Approx(linear(pts[i].data())));
+    REQUIRE(parallel.getvalue(i) == Approx(serial.getvalue(i)));
+  }
+  // points outside of the grid can not be interpolated
+  ArrayVector<double> outside(4u, 1u);
+  outside.set(0, std::array<double,4>({{2.,0.,0.,0.}}));
+  REQUIRE_THROWS(grid.linear_interpolate_at(outside));
+  REQUIRE_THROWS(grid.parallel_linear_interpolate_at(outside, 2));
+}
+
+TEST_CASE("BrillouinZoneGrid3 serialization round trip","[grid][serialize]"){
+  Direct d(3.,3.,3.,PI/2,PI/2,2*PI/3);
+  Reciprocal r = d.star();
+  BrillouinZone bz(r);
+  size_t half[3]={2,2,2};
+  BrillouinZoneGrid3<double,double> bzg(bz,half);
+  ArrayVector<double> Qmap = bzg.get_mapped_hkl();
+  std::vector<size_t> shape{Qmap.size(), 3};
+  std::array<size_t,3> elements{0,3,0};
+  REQUIRE( 0 == bzg.replace_value_data(Qmap, shape, elements) );
+
+  BinaryWriter counter;
+  bzg.serialize(counter);
+  std::vector<unsigned char> buffer(counter.size());
+  BinaryWriter writer(buffer.data(), buffer.size());
+  bzg.serialize(writer);
+  BinaryReader reader(buffer.data(), buffer.size());
+  auto other = BrillouinZoneGrid3<double,double>::deserialize(reader, true);
+  REQUIRE( other.data().values().data().is_borrowed() );
+  REQUIRE( other.get_grid_hkl().isapprox(bzg.get_grid_hkl()) );
+  REQUIRE( other.get_mapped_hkl().isapprox(Qmap) );
+
+  LQVec<double> Q(r, Qmap);
+  REQUIRE( std::get<0>(other.ir_interpolate_at(Q,1,true)).isapprox(std::get<0>(bzg.ir_interpolate_at(Q,1,true))) );
+}
+
+TEST_CASE("BrillouinZoneGrid3 memory usage","[grid][memory]"){
+  Direct d(2.87,2.87,2.87,PI/2,PI/2,PI/2,529);
+  BrillouinZone bz(d.star());
+  size_t half[3]{2,2,2};
+  BrillouinZoneGrid3<double,double> bzg(bz,half);
+  auto m = bzg.memory_usage();
+  // the mapping grid holds one index per grid point
+  REQUIRE(m.nodes == bzg.get_grid_hkl().size()*sizeof(slong));
+  REQUIRE(m.vertices == 0u);
+  REQUIRE(m.values == 0u);
+  ArrayVector<double> Qmap = bzg.get_mapped_hkl();
+  std::array<element_t,3> elements{{0,3,0}};
+  bzg.replace_value_data(Qmap, std::vector<size_t>({Qmap.size(), 3u}), elements);
+  REQUIRE(bzg.memory_usage().values == Qmap.size()*3u*sizeof(double));
+}
@@ -8,3 +8,96 @@ TEST_CASE("Lattice and its subclasses are tested","[lattice]"){
   Reciprocal r(1,1,1,PI/2,PI/2,PI/2);
   REQUIRE(d.issame(r.star()));
 }
+
+TEST_CASE("Lattice symmetry operations are shared","[lattice]"){
+  // Hall number 1 is P 1, which lacks space inversion
+  Direct a(3.,3.,3.,PI/2,PI/2,PI/2,1), b(4.,5.,6.,PI/2,PI/2,PI/2,1);
+  REQUIRE(&a.get_pointgroup_symmetry() == &b.get_pointgroup_symmetry());
+  REQUIRE(&a.get_spacegroup_symmetry(1) == &b.get_spacegroup_symmetry(1));
+  REQUIRE(&a.get_pointgroup_symmetry(0) != &a.get_pointgroup_symmetry(1));
+  REQUIRE(a.get_pointgroup_symmetry(0).size() == 1u);
+  REQUIRE(a.get_pointgroup_symmetry(1).size() == 2u);
+  REQUIRE(a.get_pointgroup_symmetry(1).has_space_inversion());
+  // Hall number 2 is P -1 which already has space inversion
+  Direct c(3.,3.,3.,PI/2,PI/2,PI/2,2);
+  REQUIRE(&c.get_pointgroup_symmetry(0) == &c.get_pointgroup_symmetry(1));
+  REQUIRE(interned_pointgroup_symmetry(2).get() == &c.get_pointgroup_symmetry());
+  // a copied lattice shares its operations
+  Direct d(a);
+  REQUIRE(&d.get_spacegroup_symmetry() == &a.get_spacegroup_symmetry());
+}
+
+TEST_CASE("Symmetry matrix index lookups","[lattice]"){
+  // Hall number 485 is P 6/m m m
+  Direct d(3.,3.,5.,PI/2,PI/2,2*PI/3,485);
+  const PointSymmetry& ps = d.get_pointgroup_symmetry();
+  for (size_t i=0; i<ps.size(); ++i) REQUIRE(ps.find_index(ps.get(i)) == i);
+  REQUIRE(ps.find_index({2,0,0, 0,2,0, 0,0,2}) == ps.size());
+  const Symmetry& sym = d.get_spacegroup_symmetry();
+  for (size_t i=0; i<sym.size(); ++i)
+    REQUIRE(sym.getr(sym.find_matrix_index(sym.getr(i))) == sym.getr(i));
+  // modifying a copy updates its lookup table
+  PointSymmetry copy(ps);
+  Matrix<int> last = copy.get(copy.size()-1);
+  REQUIRE(copy.find_index(last) == copy.size()-1);
+  copy.erase(0);
+  REQUIRE(copy.find_index(last) == copy.size()-1);
+  REQUIRE(copy.find_index(ps.get(0)) == copy.size());
+}
+
+TEST_CASE("Lattice metric information is cached","[lattice]"){
+  Direct d(3.,4.,5.,PI/2,PI/2,2*PI/3,485);
+  Reciprocal r = d.star();
+  REQUIRE(r.isstar(d));
+  REQUIRE(d.isstar(r));
+  REQUIRE(!d.isstar(Reciprocal(3.,4.,5.,PI/2,PI/2,2*PI/3)));
+  // the inverse lattice keeps the symmetry
+  REQUIRE(r.get_hall() == 485);
+  REQUIRE(&r.get_pointgroup_symmetry() == &d.get_pointgroup_symmetry());
+  // the contravariant metric tensor is the inverse of the covariant one
+  double cov[9], con[9], prod[9];
+  d.get_covariant_metric_tensor(cov);
+  d.get_contravariant_metric_tensor(con);
+  multiply_matrix_matrix(prod, cov, con);
+  for (int i=0; i<3; ++i) for (int j=0; j<3; ++j) REQUIRE(prod[3*i+j] == Approx(i==j ? 1. : 0.).margin(1e-14));
+  // the B matrix transforms reciprocal lattice vectors to Cartesian vectors
+  // with the lengths of the reciprocal basis vectors
+  double B[9];
+  r.get_B_matrix(B);
+  for (int j=0; j<3; ++j){
+    double l{0};
+    for (int i=0; i<3; ++i) l += B[3*i+j]*B[3*i+j];
+    REQUIRE(std::sqrt(l) == Approx(j==0 ? r.get_a() : j==1 ? r.get_b() : r.get_c()));
+  }
+  // and the Direct xyz transform is consistent with it
+  double toxyz[9], BT[9];
+  d.get_xyz_transform(toxyz);
+  // toxyz = 2π B⁻ᵀ so Bᵀ toxyz = 2π 𝟙
+  for (int i=0; i<9; ++i) BT[i] = B[3*(i%3)+i/3];
+  multiply_matrix_matrix(prod, BT, toxyz);
+  for (int i=0; i<3; ++i) for (int j=0; j<3; ++j) REQUIRE(prod[3*i+j] == Approx(i==j ? 2*PI : 0.).margin(1e-12));
+}
+
+TEST_CASE("Lattice serialization keeps non-standard symmetry","[lattice][serialize]"){
+  double len[3]{3.,4.,5.}, ang[3]{90.,90.,120.};
+  // neither a standard Hall symbol nor an International Tables name
+  for (std::string itname: {"-x,-y,z;x,y,-z+1/2", "I 4x"}){
+    Direct d(len, ang, itname);
+    REQUIRE(d.get_hall() == 0);
+    BinaryWriter counter;
+    d.serialize(counter);
+    std::vector<unsigned char> buffer(counter.size());
+    BinaryWriter writer(buffer.data(), buffer.size());
+    d.serialize(writer);
+    BinaryReader reader(buffer.data(), buffer.size());
+    Direct other = Direct::deserialize(reader);
+    REQUIRE(reader.remaining() == 0u);
+    REQUIRE(other.issame(d));
+    REQUIRE(other.get_hall() == 0);
+    REQUIRE(other.get_spacegroup_object().get_hall_symbol() == d.get_spacegroup_object().get_hall_symbol());
+    REQUIRE(other.get_spacegroup_object().get_bravais_type() == d.get_spacegroup_object().get_bravais_type());
+    REQUIRE(other.get_spacegroup_symmetry() == d.get_spacegroup_symmetry());
+    REQUIRE(other.get_pointgroup_symmetry().size() == d.get_pointgroup_symmetry().size());
+    REQUIRE(other.get_spacegroup_symmetry(1).size() == d.get_spacegroup_symmetry(1).size());
+  }
+}
@@ -57,3 +57,37 @@ TEST_CASE("Lattice Vector tests","[latvec]"){
 // [+-/*](L[DQ]Vec,ArrayVector)                                               //
 // [+-/*](ArrayVector,L[DQ]Vec)                                               //
 ////////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("Lattice Vector lazy dot","[latvec]"){
+  Direct d(3.,4.,5.,PI/2,PI/2,2*PI/3);
+  Reciprocal r = d.star();
+  double nv[] = {1,0,0, 0,1,0, 1,1,0, 0,0,1};
+  double pv[] = {0.5,0,0, 0,0.5,0, 0.5,0.5,0, 0,0,0.5};
+  double xv[] = {0.1,0.2,0.3};
+  LQVec<double> normals(r,4,nv), points(r,4,pv), x(r,1,xv);
+  ArrayVector<double> eager = dot(normals, x-points);
+  ArrayVector<double> lazy_dot = dot(normals, lazy(x) - points);
+  REQUIRE( lazy_dot.size() == eager.size() );
+  for (size_t i=0; i<eager.size(); ++i)
+    REQUIRE( lazy_dot.getvalue(i) == Approx(eager.getvalue(i)) );
+  REQUIRE( dot(normals, lazy(x) - points).all_approx(Comp::le, 0.) == eager.all_approx(Comp::le, 0.) );
+}
+
+TEST_CASE("Lattice Vector dot products use the lattice metric","[latvec]"){
+  Direct d(3.,4.,5.,PI/3,PI/2.5,2*PI/3);
+  Reciprocal r = d.star();
+  double v[] = {1,0,0, 0.2,1,0.3, -0.5,0.4,1.2};
+  LDVec<double> x(d,3,v);
+  LQVec<double> q(r,3,v);
+  ArrayVector<double> xx = x.get_xyz(), qx = q.get_xyz();
+  for (size_t i=0; i<3u; ++i) for (size_t j=0; j<3u; ++j){
+    double dxyz{0}, qxyz{0};
+    for (size_t k=0; k<3u; ++k){
+      dxyz += xx.getvalue(i,k)*xx.getvalue(j,k);
+      qxyz += qx.getvalue(i,k)*qx.getvalue(j,k);
+    }
+    REQUIRE( x.dot(i,j) == Approx(dxyz) );
+    REQUIRE( q.dot(i,j) == Approx(qxyz) );
+    REQUIRE( dot(q[i], lazy(q.view(j))).getvalue(0,0) == Approx(qxyz) );
+  }
+}
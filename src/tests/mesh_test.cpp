@@ -74,3 +74,59 @@ TEST_CASE("BrillouinZoneMesh3 instantiation","[mesh]"){
 //   for (size_t j=0; j<diff.numel(); ++j)
 //   REQUIRE( abs(diff.getvalue(i,j))< 2E-14 );
 // }
+
+TEST_CASE("BrillouinZoneMesh3 serialization round trip","[mesh][serialize]"){
+  Direct d(3.2598, 3.2598, 3.2598, PI/2, PI/2, PI/2, 529);
+  Reciprocal r = d.star();
+  BrillouinZone bz(r);
+  BrillouinZoneMesh3<double,double> bzm(bz);
+  ArrayVector<double> Qmap = bzm.get_mesh_hkl();
+  std::vector<size_t> shape{Qmap.size(), 3};
+  std::array<size_t,3> elements{0,3,0};
+  bzm.replace_value_data(bzm.get_mesh_xyz(), shape, elements, RotatesLike::Reciprocal);
+
+  BinaryWriter counter;
+  bzm.serialize(counter);
+  std::vector<unsigned char> buffer(counter.size());
+  BinaryWriter writer(buffer.data(), buffer.size());
+  bzm.serialize(writer);
+  BinaryReader reader(buffer.data(), buffer.size());
+  auto other = BrillouinZoneMesh3<double,double>::deserialize(reader, true);
+  REQUIRE( other.data().values().data().is_borrowed() );
+  REQUIRE( other.get_mesh_xyz().isapprox(bzm.get_mesh_xyz()) );
+  REQUIRE( other.get_mesh_tetrehedra().isapprox(bzm.get_mesh_tetrehedra()) );
+
+  LQVec<double> Q(r, Qmap);
+  REQUIRE( std::get<0>(other.ir_interpolate_at(Q,1)).isapprox(std::get<0>(bzm.ir_interpolate_at(Q,1))) );
+}
+
+TEST_CASE("BrillouinZoneMesh3 memory usage","[mesh][memory]"){
+  Direct d(3.2598, 3.2598, 3.2598, PI/2, PI/2, PI/2, 529);
+  BrillouinZone bz(d.star());
+  BrillouinZoneMesh3<double,double> bzm(bz);
+  auto m = bzm.memory_usage();
+  // every layer stores its own vertices, so there are at least as many as in the mesh
+  REQUIRE(m.vertices >= bzm.get_mesh_xyz().size()*3u*sizeof(double));
+  REQUIRE(m.nodes > 0u);
+  REQUIRE(m.circumspheres > 0u);
+}
+
+TEST_CASE("BrillouinZoneMesh3 interpolation plan","[mesh][plan]"){
+  Direct d(3.2598, 3.2598, 3.2598, PI/2, PI/2, PI/2, 529);
+  BrillouinZone bz(d.star());
+  BrillouinZoneMesh3<double,double> bzm(bz);
+  ArrayVector<double> Qmap = bzm.get_mesh_hkl();
+  std::vector<size_t> shape{Qmap.size(), 3};
+  std::array<size_t,3> elements{0,3,0};
+  bzm.replace_value_data(bzm.get_mesh_xyz(), shape, elements, RotatesLike::Reciprocal);
+  // the mesh vertices themselves are inside of the irreducible zone
+  LQVec<double> Q(bz.get_lattice(), Qmap);
+  PreparedQ prepared(bz, Q, 2, false, true);
+  InterpolationPlan plan = bzm.ir_plan(prepared, 2, true);
+  ArrayVector<double> expected, planned, vecs;
+  std::tie(expected, vecs) = bzm.ir_interpolate_at(prepared, 2);
+  std::tie(planned, vecs) = bzm.ir_execute(prepared, plan, 2);
+  REQUIRE(expected.size() == planned.size());
+  for (size_t i=0; i<expected.size(); ++i) for (size_t j=0; j<3u; ++j)
+    REQUIRE(planned.getvalue(i, j) == Approx(expected.getvalue(i, j)));
+}
@@ -1,6 +1,7 @@
 #include <catch2/catch.hpp>
 #include <tuple>
 #include "bz_nest.hpp"
+#include "bz_trellis.hpp"
 
 TEST_CASE("BrillouinZoneNest3 instantiation","[nest]"){
   // The conventional cell for Nb
@@ -126,3 +127,83 @@ TEST_CASE("Random BrillouinZoneNest3 interpolation","[nest]"){
   for (size_t j=0; j<diff.numel(); ++j)
   REQUIRE( abs(diff.getvalue(i,j))< 2E-10 );
 }
+
+TEST_CASE("Nest construction is independent of thread count","[nest]"){
+  Direct d(3.2598, 3.2598, 3.2598, PI/2, PI/2, PI/2, 529);
+  BrillouinZone bz(d.star());
+  double max_volume = 0.001;
+  int max_threads = omp_get_max_threads();
+  omp_set_num_threads(1);
+  Nest<double,double> serial(bz.get_ir_polyhedron(), max_volume);
+  omp_set_num_threads(max_threads > 1 ? max_threads : 4);
+  Nest<double,double> parallel(bz.get_ir_polyhedron(), max_volume);
+  omp_set_num_threads(max_threads);
+  REQUIRE(serial.vertex_count() == parallel.vertex_count());
+  REQUIRE(serial.all_vertices().isapprox(parallel.all_vertices()));
+  auto serial_tets = serial.tetrahedra();
+  auto parallel_tets = parallel.tetrahedra();
+  REQUIRE(serial_tets.size() == parallel_tets.size());
+  for (size_t i=0; i<serial_tets.size(); ++i) REQUIRE(serial_tets[i] == parallel_tets[i]);
+  // every vertex must be unique
+  ArrayVector<double> v = serial.all_vertices();
+  for (size_t i=0; i<v.size(); ++i)
+    REQUIRE(find(norm(v - v.extract(i)).is_approx(Comp::eq, 0.)).size() == 1u);
+}
+
+TEST_CASE("BrillouinZoneNest3 serialization round trip","[nest][serialize]"){
+  Direct d(3.2598, 3.2598, 3.2598, PI/2, PI/2, PI/2, 529);
+  Reciprocal r = d.star();
+  BrillouinZone bz(r);
+  BrillouinZoneNest3<double,double> bzn(bz, 0.01, 5u);
+  ArrayVector<double> Qmap = bzn.get_hkl();
+  std::vector<size_t> shape{Qmap.size(), 3};
+  std::array<size_t,3> elements{0,3,0};
+  bzn.replace_value_data(bzn.get_xyz(), shape, elements, RotatesLike::Reciprocal);
+
+  BinaryWriter counter;
+  bzn.serialize(counter);
+  std::vector<unsigned char> buffer(counter.size());
+  BinaryWriter writer(buffer.data(), buffer.size());
+  bzn.serialize(writer);
+  BinaryReader reader(buffer.data(), buffer.size());
+  auto other = BrillouinZoneNest3<double,double>::deserialize(reader, true);
+  REQUIRE( other.data().values().data().is_borrowed() );
+  REQUIRE( other.tree_string() == bzn.tree_string() );
+
+  LQVec<double> Q(r, Qmap.size());
+  for (size_t i=0; i<Qmap.size(); ++i) Q.set(i, 0.5*Qmap.extract(i) + 0.5*Qmap.extract((i+1)%Qmap.size()));
+  REQUIRE( std::get<0>(other.ir_interpolate_at(Q,1)).isapprox(std::get<0>(bzn.ir_interpolate_at(Q,1))) );
+  BinaryReader wrong(buffer.data(), buffer.size());
+  REQUIRE_THROWS( BrillouinZoneTrellis3<double,double>::deserialize(wrong) );
+}
+
+TEST_CASE("BrillouinZoneNest3 memory usage","[nest][memory]"){
+  Direct d(3.2598, 3.2598, 3.2598, PI/2, PI/2, PI/2, 529);
+  BrillouinZone bz(d.star());
+  BrillouinZoneNest3<double,double> bzn(bz, 0.01);
+  auto m = bzn.memory_usage();
+  REQUIRE(m.vertices == bzn.get_xyz().size()*3u*sizeof(double));
+  REQUIRE(m.nodes > 0u);
+  REQUIRE(m.circumspheres > 0u);
+  REQUIRE(m.total() == m.vertices + m.nodes + m.circumspheres + m.auxiliary);
+}
+
+TEST_CASE("BrillouinZoneNest3 without precomputed barycentric transforms","[nest][barycentric]"){
+  Direct d(3.2598, 3.2598, 3.2598, PI/2, PI/2, PI/2, 529);
+  Reciprocal r = d.star();
+  BrillouinZone bz(r);
+  BrillouinZoneNest3<double,double> with(bz, 0.01, 5u);
+  BrillouinZoneNest3<double,double> without(bz, 0.01, 5u, false);
+  REQUIRE( with.memory_usage().auxiliary > without.memory_usage().auxiliary );
+  REQUIRE( without.memory_usage().total() < with.memory_usage().total() );
+  REQUIRE( without.tree_string() == with.tree_string() );
+
+  ArrayVector<double> Qmap = with.get_hkl();
+  std::vector<size_t> shape{Qmap.size(), 3};
+  std::array<size_t,3> elements{0,3,0};
+  with.replace_value_data(with.get_xyz(), shape, elements, RotatesLike::Reciprocal);
+  without.replace_value_data(without.get_xyz(), shape, elements, RotatesLike::Reciprocal);
+  LQVec<double> Q(r, Qmap.size());
+  for (size_t i=0; i<Qmap.size(); ++i) Q.set(i, 0.5*Qmap.extract(i) + 0.5*Qmap.extract((i+1)%Qmap.size()));
+  REQUIRE( std::get<0>(without.ir_interpolate_at(Q,1)).isapprox(std::get<0>(with.ir_interpolate_at(Q,1))) );
+}
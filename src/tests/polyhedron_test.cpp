@@ -2,6 +2,7 @@
 
 #include "arrayvector.hpp"
 #include "polyhedron.hpp"
+#include "triangulation_simple.hpp"
 
 TEST_CASE("Polyhedron instantiation","[polyhedron]"){
   std::vector<std::array<double,3>> va_verts{{1,1,0},{2,0,0},{1,1,1},{0,0,0}};
@@ -81,3 +82,146 @@ TEST_CASE("Polyhedron random point distribution","[polyhedron]"){
   r1 = poly.rand_rejection(npoints);
   REQUIRE(!(r1-r0).all_approx(0.));
 }
+
+TEST_CASE("Polyhedron axis-aligned box intersection","[polyhedron]"){
+  double a = 0.96373785;
+  std::vector<std::array<double,3>> verts{{a,a,0},{2*a,0,0},{a,a,a},{0,0,0}};
+  Polyhedron poly = Polyhedron(ArrayVector<double>(verts));
+  double x = 0.143963;
+  std::array<double,3> boxmin{2*x,0,0}, boxmax{3*x,x,x};
+  REQUIRE( classify_box(poly, boxmin, boxmax) == BoxOverlap::straddle );
+  Polyhedron box = polyhedron_box(boxmin, boxmax);
+  Polyhedron clipped = polyhedron_box_intersection(boxmin, boxmax, poly);
+  REQUIRE( clipped.get_volume() == Approx(box.get_volume()/2) );
+  REQUIRE( clipped.get_vertices().size() == 6u );
+  REQUIRE( clipped.get_vertices_per_face().size() == 5u );
+
+  // boxes which are wholly inside, wholly outside, or cut by several faces
+  std::array<double,3> inmin{0.9*a,0.2*a,0.05*a}, inmax{a,0.3*a,0.1*a};
+  REQUIRE( classify_box(poly, inmin, inmax) == BoxOverlap::inside );
+  REQUIRE( polyhedron_box_intersection(inmin, inmax, poly).get_volume() == Approx(polyhedron_box(inmin, inmax).get_volume()) );
+  std::array<double,3> outmin{-2*a,-2*a,-2*a}, outmax{-a,-a,-a};
+  REQUIRE( classify_box(poly, outmin, outmax) == BoxOverlap::outside );
+  REQUIRE( polyhedron_box_intersection(outmin, outmax, poly).get_vertices().size() == 0u );
+  std::array<double,3> bigmin{-a,-a,-a}, bigmax{3*a,3*a,3*a};
+  REQUIRE( polyhedron_box_intersection(bigmin, bigmax, poly).get_volume() == Approx(poly.get_volume()) );
+  std::array<double,3> cornermin{0.5*a,0.2*a,0.1*a}, cornermax{1.5*a,0.9*a,0.6*a};
+  Polyhedron corner_box = polyhedron_box(cornermin, cornermax);
+  REQUIRE( polyhedron_box_intersection(cornermin, cornermax, poly).get_volume() == Approx(corner_box.intersection(poly).get_volume()) );
+}
+
+TEST_CASE("Convex polyhedron tetrahedralization","[polyhedron]"){
+  double a = 0.96373785;
+  std::vector<std::array<double,3>> verts{{a,a,0},{2*a,0,0},{a,a,a},{0,0,0}};
+  Polyhedron poly = Polyhedron(ArrayVector<double>(verts));
+  std::array<double,3> cornermin{0.5*a,0.2*a,0.1*a}, cornermax{1.5*a,0.9*a,0.6*a};
+  Polyhedron cut = polyhedron_box_intersection(cornermin, cornermax, poly);
+  SimpleTet tets = convex_tetrahedralization(cut);
+  REQUIRE( tets.number_of_tetrahedra() > 0u );
+  REQUIRE( tets.number_of_vertices() == cut.get_vertices().size() );
+  double total{0};
+  for (size_t i=0; i<tets.number_of_tetrahedra(); ++i){
+    REQUIRE( tets.volume(i) > 0. );
+    total += tets.volume(i);
+  }
+  REQUIRE( total == Approx(cut.get_volume()) );
+
+  // a box around the origin gains the origin as a vertex
+  std::array<double,3> gmin{-1,-1,-1}, gmax{1,2,3};
+  Polyhedron box = polyhedron_box(gmin, gmax);
+  SimpleTet gamma_tets = convex_tetrahedralization(box, true);
+  REQUIRE( gamma_tets.number_of_vertices() == 9u );
+  REQUIRE( gamma_tets.number_of_tetrahedra() == 12u );
+  REQUIRE( norm(gamma_tets.get_vertices().extract(8)).getvalue(0) == Approx(0.) );
+}
+
+TEST_CASE("Polyhedron convex hull of many points","[polyhedron]"){
+  // the corners of a cube, points on a grid over each of its faces, and
+  // random points inside of it should produce a six-faced hull
+  std::vector<std::array<double,3>> pts;
+  for (int i=-2; i<3; ++i) for (int j=-2; j<3; ++j) for (int k=-2; k<3; ++k)
+    if (std::abs(i)==2 || std::abs(j)==2 || std::abs(k)==2) pts.push_back({{0.5*i, 0.5*j, 0.5*k}});
+  std::default_random_engine generator(1u);
+  std::uniform_real_distribution<double> distribution(-0.99, 0.99);
+  for (int i=0; i<1000; ++i)
+    pts.push_back({{distribution(generator), distribution(generator), distribution(generator)}});
+  Polyhedron cube = Polyhedron(ArrayVector<double>(pts));
+  REQUIRE( cube.get_vertices().size() == 8u );
+  REQUIRE( cube.get_vertices_per_face().size() == 6u );
+  for (auto face: cube.get_vertices_per_face()) REQUIRE( face.size() == 4u );
+  REQUIRE( cube.get_volume() == Approx(8.0) );
+  REQUIRE( cube.contains(ArrayVector<double>(pts)).count_true() == pts.size() );
+}
+
+// The convex hull found by the exhaustive plane search used before quickhull
+class PlaneSearchPolyhedron: public Polyhedron {
+public:
+  PlaneSearchPolyhedron(const ArrayVector<double>& v): Polyhedron() {
+    this->vertices = v;
+    this->keep_unique_vertices();
+    this->find_convex_hull_planes();
+    this->find_all_faces_per_vertex();
+    this->polygon_vertices_per_face();
+    this->purge_central_polygon_vertices();
+    this->sort_polygons();
+    this->purge_extra_vertices();
+  }
+};
+
+void require_same_hull(const std::vector<std::array<double,3>>& pts){
+  ArrayVector<double> v(pts);
+  Polyhedron quick(v);
+  PlaneSearchPolyhedron plane(v);
+  REQUIRE( quick.get_volume() == Approx(plane.get_volume()) );
+  REQUIRE( quick.get_vertices().size() == plane.get_vertices().size() );
+  auto qvpf = quick.get_vertices_per_face();
+  auto pvpf = plane.get_vertices_per_face();
+  REQUIRE( qvpf.size() == pvpf.size() );
+  // every face must have a matching normal and number of vertices
+  ArrayVector<double> qn = quick.get_normals(), pn = plane.get_normals();
+  for (size_t i=0; i<qvpf.size(); ++i){
+    size_t matches{0};
+    for (size_t j=0; j<pvpf.size(); ++j)
+      if (norm(qn.extract(i)-pn.extract(j)).all_approx(Comp::eq, 0.) && qvpf[i].size()==pvpf[j].size())
+        ++matches;
+    REQUIRE( matches == 1u );
+  }
+}
+
+TEST_CASE("Quickhull matches the exhaustive plane search","[polyhedron]"){
+  std::vector<std::array<double,3>> pts;
+  SECTION("Coplanar face, edge and corner points of a cube"){
+    for (int i=-1; i<2; ++i) for (int j=-1; j<2; ++j) for (int k=-1; k<2; ++k)
+      if (std::abs(i)==1 || std::abs(j)==1 || std::abs(k)==1) pts.push_back({{0.5*i, 0.5*j, 0.5*k}});
+    require_same_hull(pts);
+  }
+  SECTION("Truncated octahedron vertices with face centres"){
+    // all permutations of (0,±1,±2)
+    std::vector<std::array<int,3>> perms{{{0,1,2}},{{0,2,1}},{{1,0,2}},{{1,2,0}},{{2,0,1}},{{2,1,0}}};
+    for (auto p: perms) for (int s1: {-1,1}) for (int s2: {-1,1}){
+      std::array<double,3> x;
+      for (int j=0; j<3; ++j) x[j] = p[j]==0 ? 0. : (p[j]==1 ? s1*1. : s2*2.);
+      pts.push_back(x);
+    }
+    // the centres of the hexagonal and square faces
+    for (int i: {-1,1}) for (int j: {-1,1}) for (int k: {-1,1}) pts.push_back({{1.*i, 1.*j, 1.*k}});
+    for (int j=0; j<3; ++j) for (int s: {-1,1}){
+      std::array<double,3> x{{0,0,0}};
+      x[j] = 2.*s;
+      pts.push_back(x);
+    }
+    require_same_hull(pts);
+    REQUIRE( Polyhedron(ArrayVector<double>(pts)).get_vertices_per_face().size() == 14u );
+  }
+  SECTION("Near-duplicate points"){
+    std::vector<std::array<double,3>> corners{{{0,0,0}},{{1,0,0}},{{0,1,0}},{{1,1,0}},{{0,0,1}},{{1,0,1}},{{0,1,1}},{{1,1,1}}};
+    for (auto c: corners){
+      pts.push_back(c);
+      pts.push_back({{c[0]+1e-14, c[1]-1e-14, c[2]+1e-14}});
+    }
+    pts.push_back({{0.5,0.5,0.5}});
+    pts.push_back({{0.5,0.5,1e-14}});
+    require_same_hull(pts);
+    REQUIRE( Polyhedron(ArrayVector<double>(pts)).get_volume() == Approx(1.0) );
+  }
+}
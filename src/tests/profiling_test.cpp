@@ -0,0 +1,48 @@
+#include <catch2/catch.hpp>
+#include <complex>
+#include "bz_trellis.hpp"
+#include "profiling.hpp"
+
+TEST_CASE("Interpolation pipeline profiling","[profiling]"){
+  Direct d(3.2598, 3.2598, 3.2598, PI/2, PI/2, PI/2, 529);
+  BrillouinZone bz(d.star());
+  BrillouinZoneTrellis3<double,double> bzt(bz, 0.01);
+  ArrayVector<double> Qmap = bzt.get_hkl();
+  std::vector<size_t> shape{Qmap.size(), 3u, 1u};
+  std::array<element_t,3> elements{{1,0,0}};
+  bzt.replace_value_data(Qmap, shape, elements);
+
+  size_t nQ = 50;
+  LQVec<double> Q(bz.get_lattice(), nQ);
+  for (size_t i=0; i<nQ; ++i) for (size_t j=0; j<3u; ++j)
+    Q.insert(static_cast<double>((7*i+3*j)%11)/11.0 - 0.5, i, j);
+
+  Profile::reset();
+  SECTION("Disabled profiling records nothing"){
+    Profile::enable(false);
+    bzt.ir_interpolate_at(Q, 1);
+    auto snap = Profile::snapshot(true);
+    for (auto ns: snap.nanoseconds) REQUIRE(ns == 0u);
+    for (auto n: snap.counts) REQUIRE(n == 0u);
+  }
+  SECTION("Enabled profiling records every stage of a call"){
+    Profile::enable(true);
+    for (int threads: {1, 4}){
+      bzt.ir_interpolate_at(Q, threads);
+      auto last = Profile::snapshot();
+      REQUIRE(last.counts[static_cast<size_t>(ProfileCounter::points)] == nQ);
+      REQUIRE(last.counts[static_cast<size_t>(ProfileCounter::not_found)] == 0u);
+      // every point needs one permutation per vertex, of which there are at least four
+      REQUIRE(last.counts[static_cast<size_t>(ProfileCounter::permutation_solves)] >= 4u*nQ);
+      for (auto s: {ProfileStage::ir_moveinto, ProfileStage::locate, ProfileStage::permute, ProfileStage::sum, ProfileStage::rotate})
+        REQUIRE(last.nanoseconds[static_cast<size_t>(s)] > 0u);
+      // ir_moveinto first moves the points into the first Brillouin zone
+      REQUIRE(last.nanoseconds[static_cast<size_t>(ProfileStage::moveinto)] <= last.nanoseconds[static_cast<size_t>(ProfileStage::ir_moveinto)]);
+    }
+    auto total = Profile::snapshot(true);
+    REQUIRE(total.counts[static_cast<size_t>(ProfileCounter::points)] == 2u*nQ);
+    Profile::reset();
+    REQUIRE(Profile::snapshot(true).counts[static_cast<size_t>(ProfileCounter::points)] == 0u);
+    Profile::enable(false);
+  }
+}
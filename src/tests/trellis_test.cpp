@@ -2,9 +2,30 @@
 #include <tuple>
 #include <omp.h>
 #include <complex>
+#include <thread>
 #include "debug.hpp"
 #include "bz_trellis.hpp"
 
+// The conventional cell for Nb
+static BrillouinZone nb_zone(){
+  Direct d(3.2598, 3.2598, 3.2598, PI/2, PI/2, PI/2, 529);
+  return BrillouinZone(d.star());
+}
+// Fill a trellis with (a multiple of) the Q of its vertices, rotating like a reciprocal vector
+template<class T> static void fill_with_hkl(BrillouinZoneTrellis3<double,T>& bzt, const double scale=1.0){
+  ArrayVector<double> Qmap = bzt.get_hkl()*scale;
+  std::vector<size_t> shape{Qmap.size(), 3u};
+  std::array<element_t,3> elements{{0,3,0}};
+  bzt.replace_value_data(Qmap, shape, elements, RotatesLike::Reciprocal);
+}
+// Deterministic Q points spread over the first few Brillouin zones
+static LQVec<double> spread_q(const BrillouinZone& bz, const size_t n){
+  LQVec<double> Q(bz.get_lattice(), n);
+  for (size_t i=0; i<Q.size(); ++i) for (size_t j=0; j<3u; ++j)
+    Q.insert(static_cast<double>((5*i+7*j)%13)/3.0 - 2.0, i, j);
+  return Q;
+}
+
 TEST_CASE("BrillouinZoneTrellis3 instantiation","[trellis]"){
   // The conventional cell for Nb
   Direct d(3.2598, 3.2598, 3.2598, PI/2, PI/2, PI/2, 529);
@@ -133,6 +154,135 @@ TEST_CASE("BrillouinZoneTrellis3 interpolation timing","[.][trellis][timing]"){
   }
 }
 
+TEST_CASE("BrillouinZoneTrellis3 concurrent interpolation","[trellis]"){
+  Direct d(3.2598, 3.2598, 3.2598, PI/2, PI/2, PI/2, 529);
+  BrillouinZone bz(d.star());
+  BrillouinZoneTrellis3<double,double> bzt(bz, 0.01);
+  ArrayVector<double> Qmap = bzt.get_hkl();
+  ArrayVector<double> data(3u, Qmap.size());
+  for (size_t i=0; i<Qmap.size(); ++i) for (size_t j=0; j<3u; ++j)
+    data.insert(Qmap.getvalue(i,j), i, j);
+  std::vector<size_t> shape{Qmap.size(), 3u};
+  std::array<unsigned long,3> elements{{0,3,0}};
+  bzt.replace_value_data(data, shape, elements);
+
+  std::default_random_engine generator(1);
+  std::uniform_real_distribution<double> distribution(-2.,2.);
+  LQVec<double> Q(d.star(), 1000u);
+  for (size_t i=0; i<Q.size(); ++i) for (size_t j=0; j<3; ++j)
+    Q.insert(distribution(generator), i, j);
+
+  // the serial result is the reference for every concurrent reader
+  ArrayVector<double> expected = std::get<0>(bzt.ir_interpolate_at(Q, 1));
+  size_t nthreads{4};
+  std::vector<ArrayVector<double>> results(nthreads);
+  std::vector<std::thread> readers;
+  for (size_t t=0; t<nthreads; ++t)
+    readers.emplace_back([&,t](){ results[t] = std::get<0>(bzt.ir_interpolate_at(Q, 2)); });
+  for (auto& r: readers) r.join();
+  for (const auto& result: results){
+    REQUIRE(result.size() == expected.size());
+    REQUIRE(result.numel() == expected.numel());
+    for (size_t i=0; i<expected.size(); ++i) for (size_t j=0; j<expected.numel(); ++j)
+      REQUIRE(result.getvalue(i,j) == Approx(expected.getvalue(i,j)));
+  }
+}
+
+TEST_CASE("BrillouinZoneTrellis3 fill from borrowed data","[trellis]"){
+  Direct d(3.2598, 3.2598, 3.2598, PI/2, PI/2, PI/2, 529);
+  BrillouinZone bz(d.star());
+  BrillouinZoneTrellis3<double,double> bzt(bz, 0.01);
+  ArrayVector<double> Qmap = bzt.get_hkl();
+  // stands in for memory owned elsewhere, e.g., by a numpy array
+  std::vector<double> external(3u*Qmap.size());
+  for (size_t i=0; i<Qmap.size(); ++i) for (size_t j=0; j<3u; ++j)
+    external[3u*i+j] = Qmap.getvalue(i,j);
+  std::vector<size_t> shape{Qmap.size(), 3u};
+  std::array<unsigned long,3> elements{{0,3,0}};
+  bzt.replace_value_data(ArrayVector<double>::borrow(external.data(), 3u, Qmap.size()), shape, elements);
+  // the moved-in data is referenced, not copied
+  REQUIRE( bzt.data().values().data().is_borrowed() );
+  REQUIRE( bzt.data().values().data().data() == external.data() );
+  // a copied-in ArrayVector is owned, as before
+  ArrayVector<double> owned = ArrayVector<double>::borrow(external.data(), 3u, Qmap.size());
+  BrillouinZoneTrellis3<double,double> other(bz, 0.01);
+  other.replace_value_data(owned, shape, elements);
+  REQUIRE( !other.data().values().data().is_borrowed() );
+  // inconsistent elements are rejected without replacing the held data
+  std::array<unsigned long,3> wrong{{0,6,0}};
+  REQUIRE_THROWS( bzt.replace_value_data(ArrayVector<double>(3u, Qmap.size()), shape, wrong) );
+  REQUIRE( bzt.data().values().data().data() == external.data() );
+
+  LQVec<double> Q(d.star(), 3u);
+  for (size_t i=0; i<Q.size(); ++i) for (size_t j=0; j<3u; ++j) Q.insert(0.1*(i+1)*(j==i ? 1 : 0), i, j);
+  ArrayVector<double> from_borrowed = std::get<0>(bzt.ir_interpolate_at(Q, 1));
+  ArrayVector<double> from_owned = std::get<0>(other.ir_interpolate_at(Q, 1));
+  REQUIRE( from_borrowed.isapprox(from_owned) );
+}
+
+TEST_CASE("BrillouinZoneTrellis3 serialization round trip","[trellis][serialize]"){
+  // quartz, so that the lattice is not cubic and has non-trivial symmetry
+  Direct d(4.85235, 4.85235, 5.350305, PI/2, PI/2, 2*PI/3, 443);
+  BrillouinZone bz(d.star());
+  BrillouinZoneTrellis3<double,std::complex<double>> bzt(bz, 0.01);
+  ArrayVector<double> Qmap = bzt.get_hkl();
+  size_t n_modes{2u};
+  ArrayVector<double> vals(n_modes, Qmap.size());
+  ArrayVector<std::complex<double>> vecs(3u*n_modes, Qmap.size());
+  for (size_t i=0; i<Qmap.size(); ++i) for (size_t b=0; b<n_modes; ++b){
+    vals.insert(Qmap.getvalue(i,0) + static_cast<double>(b), i, b);
+    for (size_t j=0; j<3u; ++j) vecs.insert(std::complex<double>(Qmap.getvalue(i,j), static_cast<double>(b)), i, 3u*b+j);
+  }
+  std::vector<size_t> vals_sh{Qmap.size(), n_modes, 1u}, vecs_sh{Qmap.size(), n_modes, 3u};
+  std::array<unsigned long,3> vals_el{{1,0,0}}, vecs_el{{0,3,0}};
+  bzt.replace_value_data(vals, vals_sh, vals_el);
+  bzt.replace_vector_data(vecs, vecs_sh, vecs_el, RotatesLike::Reciprocal);
+
+  BinaryWriter counter;
+  bzt.serialize(counter);
+  std::vector<unsigned char> buffer(counter.size());
+  BinaryWriter writer(buffer.data(), buffer.size());
+  bzt.serialize(writer);
+  REQUIRE( writer.size() == buffer.size() );
+
+  BinaryReader copy_reader(buffer.data(), buffer.size());
+  auto copied = BrillouinZoneTrellis3<double,std::complex<double>>::deserialize(copy_reader);
+  BinaryReader borrow_reader(buffer.data(), buffer.size());
+  auto borrowed = BrillouinZoneTrellis3<double,std::complex<double>>::deserialize(borrow_reader, true);
+  REQUIRE( !copied.data().vectors().data().is_borrowed() );
+  REQUIRE( borrowed.data().vectors().data().is_borrowed() );
+  const unsigned char* vecs_at = reinterpret_cast<const unsigned char*>(borrowed.data().vectors().data().data());
+  REQUIRE( vecs_at >= buffer.data() );
+  REQUIRE( vecs_at < buffer.data() + buffer.size() );
+  REQUIRE( copied.vertices().isapprox(bzt.vertices()) );
+  REQUIRE( copied.get_brillouinzone().get_lattice().issame(bz.get_lattice()) );
+
+  LQVec<double> Q(d.star(), 10u);
+  for (size_t i=0; i<Q.size(); ++i) for (size_t j=0; j<3u; ++j)
+    Q.insert(0.37*static_cast<double>(i) - 0.11*static_cast<double>(j) - 1.3, i, j);
+  ArrayVector<double> v0, v1, v2;
+  ArrayVector<std::complex<double>> e0, e1, e2;
+  std::tie(v0, e0) = bzt.ir_interpolate_at(Q, 1);
+  std::tie(v1, e1) = copied.ir_interpolate_at(Q, 1);
+  std::tie(v2, e2) = borrowed.ir_interpolate_at(Q, 2);
+  auto same_vecs = [](const ArrayVector<std::complex<double>>& a, const ArrayVector<std::complex<double>>& b){
+    if (a.size()!=b.size() || a.numel()!=b.numel()) return false;
+    for (size_t i=0; i<a.size(); ++i) for (size_t j=0; j<a.numel(); ++j)
+      if (std::abs(a.getvalue(i,j)-b.getvalue(i,j)) > 1e-10) return false;
+    return true;
+  };
+  REQUIRE( v0.isapprox(v1) );
+  REQUIRE( same_vecs(e0, e1) );
+  REQUIRE( v0.isapprox(v2) );
+  REQUIRE( same_vecs(e0, e2) );
+
+  // truncated or foreign buffers are rejected
+  BinaryReader truncated(buffer.data(), buffer.size()/2);
+  REQUIRE_THROWS( BrillouinZoneTrellis3<double,std::complex<double>>::deserialize(truncated) );
+  BinaryReader wrong_type(buffer.data(), buffer.size());
+  REQUIRE_THROWS( BrillouinZoneTrellis3<double,double>::deserialize(wrong_type) );
+}
+
 TEST_CASE("BrillouinZoneTrellis3 interpolation profiling","[.][trellis][profiling]"){
   // The conventional cell for Nb
   Direct d(3.2598, 3.2598, 3.2598, PI/2, PI/2, PI/2, 529);
@@ -210,3 +360,243 @@ TEST_CASE("BrillouinZoneTrellis3 contains Gamma","[trellis][gamma]"){
   auto diff = find(norm(bzt.vertices()).is_approx(Comp::eq,0.));
   REQUIRE(diff.size() == 1u);
 }
+
+TEST_CASE("BrillouinZoneTrellis3 per-point status","[trellis][status]"){
+  BrillouinZone bz = nb_zone();
+  BrillouinZoneTrellis3<double,double> bzt(bz, 0.01);
+  fill_with_hkl(bzt);
+  // the trellis vertices are inside, a point far outside the polyhedron is not
+  ArrayVector<double> x = bzt.get_xyz().extract(std::vector<size_t>({0,1,2}));
+  x.set(1, std::array<double,3>({{100., 100., 100.}}));
+  for (int threads: {1, 2}){
+    std::vector<PointStatus> status;
+    ArrayVector<double> vals, vecs;
+    std::tie(vals, vecs) = bzt.PolyhedronTrellis<double,double>::interpolate_at(x, status, threads);
+    REQUIRE(status.size() == 3u);
+    REQUIRE(point_ok(status[0]));
+    REQUIRE(status[1] == PointStatus::not_found);
+    REQUIRE(point_ok(status[2]));
+    for (size_t j=0; j<3u; ++j) REQUIRE(vals.getvalue(1, j) == 0.);
+    // the all-or-nothing methods throw, whatever the number of threads
+    REQUIRE_THROWS(bzt.PolyhedronTrellis<double,double>::interpolate_at(x, threads));
+    // points marked as failed by an earlier stage are skipped
+    status = {PointStatus::fold_failed, PointStatus::found, PointStatus::found};
+    x.set(1, bzt.get_xyz().extract(1));
+    std::tie(vals, vecs) = bzt.PolyhedronTrellis<double,double>::interpolate_at(x, status, threads);
+    REQUIRE(status[0] == PointStatus::fold_failed);
+    REQUIRE(point_ok(status[1]));
+    for (size_t j=0; j<3u; ++j) REQUIRE(vals.getvalue(0, j) == 0.);
+    x.set(1, std::array<double,3>({{100., 100., 100.}}));
+  }
+  // every Q can be moved into the irreducible zone, so none fail
+  LQVec<double> Q(bz.get_lattice(), 20u);
+  for (size_t i=0; i<Q.size(); ++i) for (size_t j=0; j<3u; ++j)
+    Q.insert(static_cast<double>((5*i+7*j)%13) - 6.0, i, j);
+  std::vector<PointStatus> status;
+  bzt.ir_interpolate_at(Q, status, 2);
+  REQUIRE(std::all_of(status.begin(), status.end(), [](PointStatus s){return point_ok(s);}));
+}
+
+TEST_CASE("BrillouinZoneTrellis3 prepared Q","[trellis][prepared]"){
+  BrillouinZone bz = nb_zone();
+  BrillouinZoneTrellis3<double,double> bzt(bz, 0.01), other(bz, 0.005);
+  fill_with_hkl(bzt);
+  fill_with_hkl(other);
+  LQVec<double> Q = spread_q(bz, 30u);
+  PreparedQ prepared(bz, Q, 2);
+  REQUIRE(prepared.size() == Q.size());
+  REQUIRE(prepared.matches(bz));
+  // the same prepared points serve every interpolator on the zone
+  for (auto* t: {&bzt, &other}){
+    ArrayVector<double> direct, pdirect, vecs;
+    std::tie(direct, vecs) = t->ir_interpolate_at(Q, 2);
+    std::tie(pdirect, vecs) = t->ir_interpolate_at(prepared, 2);
+    REQUIRE(direct.size() == pdirect.size());
+    for (size_t i=0; i<Q.size(); ++i) for (size_t j=0; j<3u; ++j)
+      REQUIRE(direct.getvalue(i, j) == Approx(pdirect.getvalue(i, j)));
+  }
+  // but not one on a different zone
+  Direct h(3., 3., 9., PI/2, PI/2, 2*PI/3, 443);
+  BrillouinZone hbz(h.star());
+  REQUIRE_FALSE(prepared.matches(hbz));
+  BrillouinZoneTrellis3<double,double> hbzt(hbz, 0.01);
+  fill_with_hkl(hbzt);
+  REQUIRE_THROWS(hbzt.ir_interpolate_at(prepared, 1));
+}
+
+TEST_CASE("BrillouinZoneTrellis3 interpolation plan","[trellis][plan]"){
+  BrillouinZone bz = nb_zone();
+  BrillouinZoneTrellis3<double,double> bzt(bz, 0.01);
+  fill_with_hkl(bzt);
+  LQVec<double> Q = spread_q(bz, 40u);
+  PreparedQ prepared(bz, Q, 2);
+  auto same = [&](const ArrayVector<double>& a, const ArrayVector<double>& b){
+    REQUIRE(a.size() == b.size());
+    for (size_t i=0; i<a.size(); ++i) for (size_t j=0; j<a.numel(); ++j)
+      REQUIRE(a.getvalue(i, j) == Approx(b.getvalue(i, j)));
+  };
+  ArrayVector<double> expected, planned, vecs;
+  std::tie(expected, vecs) = bzt.ir_interpolate_at(prepared, 2);
+  for (bool with_permutations: {false, true}){
+    InterpolationPlan plan = bzt.ir_plan(prepared, 2, with_permutations);
+    REQUIRE(plan.size() == Q.size());
+    REQUIRE(plan.has_permutations() == with_permutations);
+    for (int threads: {1, 3}){
+      std::tie(planned, vecs) = bzt.ir_execute(prepared, plan, threads);
+      same(expected, planned);
+    }
+  }
+  // a plan without permutations follows replaced data
+  InterpolationPlan plan = bzt.ir_plan(prepared, 2);
+  fill_with_hkl(bzt, 2.0);
+  std::tie(expected, vecs) = bzt.ir_interpolate_at(prepared, 2);
+  std::tie(planned, vecs) = bzt.ir_execute(prepared, plan, 2);
+  same(expected, planned);
+  // but not data for a different number of vertices
+  BrillouinZoneTrellis3<double,double> other(bz, 0.002);
+  fill_with_hkl(other);
+  REQUIRE_THROWS(other.ir_execute(prepared, plan, 2));
+}
+
+TEST_CASE("BrillouinZoneTrellis3 memory usage","[trellis][memory]"){
+  BrillouinZone bz = nb_zone();
+  BrillouinZoneTrellis3<double,double> bzt(bz, 0.01);
+  auto empty = bzt.memory_usage();
+  REQUIRE(empty.vertices == bzt.get_xyz().size()*3u*sizeof(double));
+  REQUIRE(empty.nodes > 0u);
+  REQUIRE(empty.circumspheres > 0u);
+  REQUIRE(empty.values == 0u);
+  REQUIRE(empty.vectors == 0u);
+
+  size_t nv = bzt.get_xyz().size(), branches = 6u;
+  ArrayVector<double> vals(branches, nv), vecs(3u*branches, nv);
+  std::array<element_t,3> val_el{{1,0,0}}, vec_el{{0,3,0}};
+  bzt.replace_value_data(vals, std::vector<size_t>({nv, branches, 1u}), val_el);
+  bzt.replace_vector_data(vecs, std::vector<size_t>({nv, branches, 3u}), vec_el);
+  auto filled = bzt.memory_usage();
+  REQUIRE(filled.values == nv*branches*sizeof(double));
+  REQUIRE(filled.vectors == 3u*nv*branches*sizeof(double));
+  REQUIRE(filled.borrowed == 0u);
+  REQUIRE(filled.nodes == empty.nodes);
+  REQUIRE(filled.total() == empty.total() + filled.values + filled.vectors + filled.auxiliary - empty.auxiliary);
+
+  // borrowed data is counted, and reported as borrowed
+  bzt.replace_vector_data(ArrayVector<double>::borrow(vecs.data(), vecs.numel(), vecs.size()),
+                          std::vector<size_t>({nv, branches, 3u}), vec_el);
+  REQUIRE(bzt.memory_usage().borrowed == filled.vectors);
+  REQUIRE(bzt.data().memory_usage().vectors == filled.vectors);
+}
+
+TEST_CASE("BrillouinZoneTrellis3 deduplicated queries","[trellis][dedupe]"){
+  BrillouinZone bz = nb_zone();
+  BrillouinZoneTrellis3<double,double> bzt(bz, 0.01);
+  fill_with_hkl(bzt);
+  // each base point and its images under sign changes and cyclic permutations
+  size_t nbase{7};
+  LQVec<double> Q(bz.get_lattice(), 6u*nbase);
+  for (size_t i=0; i<nbase; ++i){
+    std::array<double,3> b;
+    for (size_t j=0; j<3u; ++j) b[j] = static_cast<double>((5*i+7*j)%13)/30.0 - 0.2;
+    for (size_t k=0; k<3u; ++k) for (size_t j=0; j<3u; ++j){
+      Q.insert( b[(j+k)%3], 6*i+2*k, j);
+      Q.insert(-b[(j+k)%3], 6*i+2*k+1, j);
+    }
+  }
+  PreparedQ prepared(bz, Q, 2);
+  REQUIRE(!prepared.is_deduplicated());
+  REQUIRE(prepared.unique_count() == Q.size());
+  ArrayVector<double> vals, vecs, dvals, dvecs;
+  std::tie(vals, vecs) = bzt.ir_interpolate_at(prepared, 2);
+  REQUIRE(prepared.deduplicate() <= nbase);
+  REQUIRE(prepared.is_deduplicated());
+  REQUIRE(prepared.unique_ir_q().size() == prepared.unique_count());
+  for (int threads: {1, 2}){
+    std::tie(dvals, dvecs) = bzt.ir_interpolate_at(Q, threads, false, true);
+    REQUIRE(dvecs.isapprox(vecs));
+    std::tie(dvals, dvecs) = bzt.ir_interpolate_at(prepared, threads);
+    REQUIRE(dvecs.isapprox(vecs));
+    InterpolationPlan plan = bzt.ir_plan(prepared, threads);
+    REQUIRE(plan.size() == prepared.unique_count());
+    std::tie(dvals, dvecs) = bzt.ir_execute(prepared, plan, threads);
+    REQUIRE(dvecs.isapprox(vecs));
+  }
+}
+
+TEST_CASE("BrillouinZoneTrellis3 result cache","[trellis][cache]"){
+  BrillouinZone bz = nb_zone();
+  BrillouinZoneTrellis3<double,double> bzt(bz, 0.01);
+  fill_with_hkl(bzt);
+  LQVec<double> Q = spread_q(bz, 30u);
+  ArrayVector<double> vals, vecs, cvals, cvecs;
+  std::tie(vals, vecs) = bzt.ir_interpolate_at(Q, 2);
+  // disabled by default
+  REQUIRE(bzt.cache_statistics().capacity == 0u);
+  bzt.ir_interpolate_at(Q, 2);
+  REQUIRE(bzt.cache_statistics().misses == 0u);
+  auto uncached = bzt.memory_usage();
+
+  bzt.set_cache(1000u);
+  std::tie(cvals, cvecs) = bzt.ir_interpolate_at(Q, 2);
+  REQUIRE(cvecs.isapprox(vecs));
+  auto stats = bzt.cache_statistics();
+  REQUIRE(stats.hits == 0u);
+  REQUIRE(stats.misses == Q.size());
+  // symmetry-equivalent points share an entry
+  size_t n_unique = stats.size;
+  REQUIRE(n_unique > 3u);
+  REQUIRE(n_unique <= Q.size());
+  REQUIRE(stats.bytes > 0u);
+  // cached results are counted in the memory usage
+  auto cached = bzt.memory_usage();
+  REQUIRE(cached.total() > uncached.total());
+  REQUIRE(cached.auxiliary == bzt.PolyhedronTrellis<double,double>::memory_usage().auxiliary + stats.bytes);
+  // repeated queries are served from the cache
+  for (int threads: {1, 2}){
+    std::tie(cvals, cvecs) = bzt.ir_interpolate_at(Q, threads);
+    REQUIRE(cvecs.isapprox(vecs));
+  }
+  stats = bzt.cache_statistics();
+  REQUIRE(stats.hits == 2u*Q.size());
+  REQUIRE(stats.misses == Q.size());
+  // replacing the data drops the cached results
+  fill_with_hkl(bzt, 2.0);
+  std::tie(cvals, cvecs) = bzt.ir_interpolate_at(Q, 2);
+  REQUIRE(cvecs.isapprox(vecs*2.));
+  stats = bzt.cache_statistics();
+  REQUIRE(stats.invalidations == 1u);
+  REQUIRE(stats.misses == 2u*Q.size());
+  // the least recently used entries are evicted beyond the capacity
+  bzt.set_cache(3u);
+  stats = bzt.cache_statistics();
+  REQUIRE(stats.size == 3u);
+  REQUIRE(stats.evictions == n_unique - 3u);
+  bzt.clear_cache();
+  stats = bzt.cache_statistics();
+  REQUIRE(stats.size == 0u);
+  REQUIRE(stats.hits == 0u);
+  REQUIRE(stats.capacity == 3u);
+}
+
+TEST_CASE("InterpolationCache skips results keyed before a reconfiguration","[trellis][cache]"){
+  BrillouinZone bz = nb_zone();
+  BrillouinZoneTrellis3<double,double> bzt(bz, 0.01);
+  fill_with_hkl(bzt);
+  ArrayVector<double> x = bzt.vertices().extract(std::vector<size_t>({0u, 1u, 2u}));
+  std::vector<PointStatus> status;
+  InterpolationCache<double,double> cache;
+  cache.configure(100u, 1e-6);
+  // another thread may change the resolution while the misses are interpolated
+  auto reconfigure = [&](const ArrayVector<double>& p, std::vector<PointStatus>&){
+    cache.configure(100u, 1e-3);
+    return std::make_tuple(ArrayVector<double>(3u, p.size()), ArrayVector<double>(3u, p.size()));
+  };
+  cache.interpolate_at(bzt.data(), x, status, reconfigure);
+  REQUIRE(cache.statistics().misses == x.size());
+  REQUIRE(cache.statistics().size == 0u);
+  // without a reconfiguration the results are stored
+  auto plain = [](const ArrayVector<double>& p, std::vector<PointStatus>&){
+    return std::make_tuple(ArrayVector<double>(3u, p.size()), ArrayVector<double>(3u, p.size()));
+  };
+  cache.interpolate_at(bzt.data(), x, status, plain);
+  REQUIRE(cache.statistics().size == x.size());
+}
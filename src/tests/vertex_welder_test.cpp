@@ -0,0 +1,45 @@
+#include <catch2/catch.hpp>
+#include <random>
+#include "latvec.hpp"
+#include "vertex_welder.hpp"
+
+TEST_CASE("VertexWelder finds equivalent vertices","[welder]"){
+  VertexWelder<double> welder(0.1);
+  std::array<double,3> a{{0.1, 0.2, 0.3}}, b{{0.1, 0.2, 0.3+1e-14}}, c{{0.3, 0.2, 0.1}};
+  auto ra = welder.weld(a);
+  REQUIRE(ra.second);
+  REQUIRE(ra.first == 0u);
+  auto rb = welder.weld(b);
+  REQUIRE(!rb.second);
+  REQUIRE(rb.first == 0u);
+  auto rc = welder.weld(c);
+  REQUIRE(rc.second);
+  REQUIRE(rc.first == 1u);
+  REQUIRE(welder.size() == 2u);
+  REQUIRE(welder.find(c) == 1u);
+}
+
+TEST_CASE("VertexWelder across cell boundaries","[welder]"){
+  // points straddling a cell boundary must still be found as equivalent
+  VertexWelder<double> welder(0.5);
+  std::array<double,3> a{{0.5-1e-14, 0.5, -1e-14}}, b{{0.5+1e-14, 0.5-1e-14, 1e-14}};
+  welder.weld(a);
+  REQUIRE(welder.find(b) == 0u);
+}
+
+TEST_CASE("VertexWelder matches linear search","[welder]"){
+  std::default_random_engine generator(1234u);
+  std::uniform_int_distribution<int> distribution(-10, 10);
+  // integer points on a coarse grid guarantee many duplicates
+  ArrayVector<double> points(3u, 2000u);
+  for (size_t i=0; i<points.size(); ++i) for (size_t j=0; j<3u; ++j)
+    points.insert(0.1*distribution(generator), i, j);
+  VertexWelder<double> welder(0.05);
+  std::vector<size_t> map = welder.weld(points);
+  ArrayVector<double> unique = welder.vertices();
+  for (size_t i=0; i<points.size(); ++i){
+    std::vector<size_t> idx = find(norm(unique - points.extract(i)).is_approx(Comp::eq, 0.));
+    REQUIRE(idx.size() == 1u);
+    REQUIRE(idx[0] == map[i]);
+  }
+}
@@ -27,8 +27,12 @@
 #include "utilities.hpp"
 #include "debug.hpp"
 #include "triangulation_simple.hpp"
+#include "barycentric.hpp"
 #include "interpolation_data.hpp"
 #include "permutation.hpp"
+#include "vertex_welder.hpp"
+#include "serialize.hpp"
+#include "point_status.hpp"
 
 #ifndef _TRELLIS_H_
 #define _TRELLIS_H_
@@ -90,7 +94,7 @@ public:
   virtual index_t vertex_count() const {return 0u;}
   virtual std::vector<index_t> vertices(void) const {return std::vector<index_t>();}
   virtual std::vector<std::array<index_t,4>> vertices_per_tetrahedron(void) const {return std::vector<std::array<index_t,4>>();}
-  virtual bool indices_weights(const ArrayVector<double>&, const ArrayVector<double>&, std::vector<index_t>&, std::vector<double>&) const {return false;};
+  virtual bool indices_weights(const ArrayVector<double>&, const ArrayVectorView<double>&, std::vector<index_t>&, std::vector<double>&) const {return false;};
 };
 class CubeNode: public NullNode {
   std::array<index_t, 8> vertex_indices;
@@ -102,6 +106,7 @@ public:
     for (index_t i=0; i<8u; ++i) vertex_indices[i] = vi[i];
   }
   index_t vertex_count() const { return 8u;}
+  const std::array<index_t,8>& vertex_index_array() const {return vertex_indices;}
   std::vector<index_t> vertices(void) const {
     std::vector<index_t> out;
     for (auto v: vertex_indices) out.push_back(v);
@@ -109,7 +114,7 @@ public:
   }
   bool indices_weights(
     const ArrayVector<double>& vertices,
-    const ArrayVector<double>& x,
+    const ArrayVectorView<double>& x,
     std::vector<index_t>& indices,
     std::vector<double>& weights
   ) const {
@@ -117,18 +122,24 @@ public:
     // the 8 corners of the cube. Those indices should be ordered
     // (000) (100) (110) (010) (101) (001) (011) (111)
     // so that vertex_indices[i] and vertex_indices[7-i] are connected by a body diagonal
-    ArrayVector<double> node_verts = vertices.extract(vertex_indices);
-    double node_volume = abs(node_verts.extract(0)-node_verts.extract(7)).prod(1).getvalue(0,0);
-    ArrayVector<double> w = abs(x - node_verts).prod(1)/node_volume; // the normalised volume of each sub-parallelpiped
+    double node_volume{1};
+    for (int j=0; j<3; ++j)
+      node_volume *= std::abs(vertices.getvalue(vertex_indices[0],j)-vertices.getvalue(vertex_indices[7],j));
+    std::array<double,8> w; // the normalised volume of each sub-parallelpiped
+    for (int i=0; i<8; ++i){
+      w[i] = 1.0;
+      for (int j=0; j<3; ++j) w[i] *= std::abs(x.getvalue(0,j)-vertices.getvalue(vertex_indices[i],j));
+      w[i] /= node_volume;
+    }
     // If any normalised weights are greater than 1+eps() the point isn't in this node
-    if (w.any_approx(Comp::gt,1.)) return false;
-    ArrayVector<bool> needed = w.is_approx(Comp::gt, 0.);
+    if (std::any_of(w.begin(), w.end(), [](double z){return z > 1. && !approx_scalar(z, 1.);}))
+      return false;
     indices.clear();
     weights.clear();
-    for (int i=0; i<8; ++i) if (needed.getvalue(i)) {
+    for (int i=0; i<8; ++i) if (w[i] > 0. && !approx_scalar(w[i], 0.)) {
       // the weight corresponds to the vertex opposite the one used to find the partial volume
       indices.push_back(vertex_indices[7-i]);
-      weights.push_back(w.getvalue(i));
+      weights.push_back(w[i]);
     }
     return true;
   }
@@ -137,6 +148,7 @@ class PolyNode: public NullNode {
   std::vector<std::array<index_t,4>> vi_t;  //!< vertex indices per tetrahedra
   std::vector<std::array<double,4>> ci_t;   //!< circumsphere information per tetrahedra
   std::vector<double> vol_t;                //!< volume per tetrahedra
+  std::vector<BarycentricTransform> bt_t;   //!< (optional) barycentric transform per tetrahedra
 public:
   PolyNode() {};
   // actually constructing the tetrahedra from, e.g., a Polyhedron object will
@@ -144,8 +156,9 @@ public:
   PolyNode(
     const std::vector<std::array<index_t,4>>& vit,
     const std::vector<std::array<double,4>>& cit,
-    const std::vector<double>& volt
-  ): vi_t(vit), ci_t(cit), vol_t(volt) {}
+    const std::vector<double>& volt,
+    const std::vector<BarycentricTransform>& btt=std::vector<BarycentricTransform>()
+  ): vi_t(vit), ci_t(cit), vol_t(volt), bt_t(btt) {}
   // count-up the number fo unique vertices in the tetrahedra-triangulated polyhedron
   index_t tetrahedra_count() const {return static_cast<index_t>(vi_t.size());}
   index_t vertex_count() const { return static_cast<index_t>(this->vertices().size());}
@@ -156,9 +169,31 @@ public:
     return out;
   }
   std::vector<std::array<index_t,4>> vertices_per_tetrahedron(void) const {return vi_t;}
+  //! The bytes held by the tetrahedra of this node
+  MemoryUsage memory_usage() const {
+    MemoryUsage m;
+    m.nodes = memory_bytes(vi_t) + memory_bytes(vol_t);
+    m.circumspheres = memory_bytes(ci_t);
+    m.auxiliary = memory_bytes(bt_t);
+    return m;
+  }
+  void serialize(BinaryWriter& w) const {
+    w.write(vi_t);
+    w.write(ci_t);
+    w.write(vol_t);
+    w.write(bt_t);
+  }
+  static PolyNode deserialize(BinaryReader& r){
+    PolyNode n;
+    r.read(n.vi_t);
+    r.read(n.ci_t);
+    r.read(n.vol_t);
+    r.read(n.bt_t);
+    return n;
+  }
   bool indices_weights(
     const ArrayVector<double>& vertices,
-    const ArrayVector<double>& x,
+    const ArrayVectorView<double>& x,
     std::vector<index_t>& indices,
     std::vector<double>& weights
   ) const {
@@ -179,22 +214,20 @@ private:
   bool tetrahedra_contains(
     const index_t t,
     const ArrayVector<double>& v,
-    const ArrayVector<double>& x,
+    const ArrayVectorView<double>& x,
     std::array<double,4>& w
   ) const {
     if (!this->tetrahedra_might_contain(t,x)) return false;
-    double vol6 = vol_t[t]*6.0;
-    w[0] = orient3d( x.data(),            v.data(vi_t[t][1u]), v.data(vi_t[t][2u]), v.data(vi_t[t][3u]) )/vol6;
-    w[1] = orient3d( v.data(vi_t[t][0u]), x.data(),            v.data(vi_t[t][2u]), v.data(vi_t[t][3u]) )/vol6;
-    w[2] = orient3d( v.data(vi_t[t][0u]), v.data(vi_t[t][1u]), x.data(),            v.data(vi_t[t][3u]) )/vol6;
-    w[3] = orient3d( v.data(vi_t[t][0u]), v.data(vi_t[t][1u]), v.data(vi_t[t][2u]), x.data()            )/vol6;
+    // use the precomputed transform if present and conclusive
+    if (t >= bt_t.size() || !bt_t[t].weights(x.data(), w))
+      orient3d_weights(v.data(vi_t[t][0u]), v.data(vi_t[t][1u]), v.data(vi_t[t][2u]), v.data(vi_t[t][3u]), x.data(), vol_t[t]*6.0, w);
     if (std::any_of(w.begin(), w.end(), [](double z){return z < 0. && !approx_scalar(z, 0.);}))
       return false;
     return true;
   }
   bool tetrahedra_might_contain(
     const index_t t,
-    const ArrayVector<double>& x
+    const ArrayVectorView<double>& x
   ) const {
     // find the vector from the circumsphere centre to x:
     double v[3];
@@ -267,12 +300,58 @@ public:
       return std::vector<index_t>();
     }
   }
+  //! The bytes held by the node tables and all polyhedron nodes
+  MemoryUsage memory_usage() const {
+    MemoryUsage m;
+    m.nodes = memory_bytes(nodes_) + memory_bytes(cube_nodes_) + memory_bytes(poly_nodes_);
+    for (const auto& p: poly_nodes_) m += p.memory_usage();
+    return m;
+  }
+  //! Write the node types and all cube and polyhedron nodes to a BinaryWriter
+  void serialize(BinaryWriter& w) const {
+    // std::pair is not trivially copyable, so write its two halves separately
+    std::vector<NodeType> types;
+    std::vector<index_t> indices;
+    for (const auto& n: nodes_){
+      types.push_back(n.first);
+      indices.push_back(n.second);
+    }
+    w.write(types);
+    w.write(indices);
+    std::vector<std::array<index_t,8>> cubes;
+    for (const auto& c: cube_nodes_) cubes.push_back(c.vertex_index_array());
+    w.write(cubes);
+    w.write(static_cast<uint64_t>(poly_nodes_.size()));
+    for (const auto& p: poly_nodes_) p.serialize(w);
+  }
+  //! Read a NodeContainer written by `serialize`
+  static NodeContainer deserialize(BinaryReader& r){
+    NodeContainer c;
+    std::vector<NodeType> types;
+    std::vector<index_t> indices;
+    r.read(types);
+    r.read(indices);
+    if (types.size() != indices.size())
+      throw std::runtime_error("Serialized node types and indices differ in number");
+    std::vector<std::array<index_t,8>> cubes;
+    r.read(cubes);
+    uint64_t npoly = r.read<uint64_t>();
+    for (uint64_t i=0; i<npoly; ++i) c.poly_nodes_.push_back(PolyNode::deserialize(r));
+    for (const auto& cube: cubes) c.cube_nodes_.emplace_back(cube);
+    for (size_t i=0; i<types.size(); ++i){
+      size_t count = NodeType::cube == types[i] ? c.cube_nodes_.size() : c.poly_nodes_.size();
+      if (NodeType::null != types[i] && indices[i] >= count)
+        throw std::runtime_error("Serialized node index is out of range");
+      c.nodes_.emplace_back(types[i], indices[i]);
+    }
+    return c;
+  }
   std::vector<std::array<index_t,4>> vertices_per_tetrahedron(const index_t i) const{
     if (nodes_[i].first == NodeType::poly)
       return poly_nodes_[nodes_[i].second].vertices_per_tetrahedron();
     return std::vector<std::array<index_t,4>>();
   }
-  bool indices_weights(const index_t i, const ArrayVector<double>& v, const ArrayVector<double>& x, std::vector<index_t>& indices, std::vector<double>& weights) const{
+  bool indices_weights(const index_t i, const ArrayVector<double>& v, const ArrayVectorView<double>& x, std::vector<index_t>& indices, std::vector<double>& weights) const{
     switch (nodes_[i].first){
       case NodeType::cube:
       return cube_nodes_[nodes_[i].second].indices_weights(v,x,indices,weights);
@@ -286,6 +365,13 @@ public:
   }
 };
 
+/*! \brief A Polyhedron-filling trellis of cubic and polyhedral nodes with data at its vertices
+
+The const query methods, e.g., `interpolate_at`, do not modify the trellis so
+one object can be shared by concurrent readers; each call takes its OpenMP
+thread count as an argument rather than setting a global value. Filling or
+replacing the data while queries are in progress is not safe.
+*/
 template<typename T, typename R> class PolyhedronTrellis{
   Polyhedron polyhedron_;                        //!< the Polyhedron bounding the Trellis
   InterpolationData<T,R> data_;                  //!< [optional] data stored at each Trellis vertex
@@ -293,7 +379,14 @@ template<typename T, typename R> class PolyhedronTrellis{
   NodeContainer nodes_;
   std::array<std::vector<double>,3> boundaries_; //!< The coordinates of the Trellis intersections, which bound the Trellis nodes
 public:
-  explicit PolyhedronTrellis(const Polyhedron& polyhedron, const double max_volume);
+  /*! \brief Construct a trellis filling a polyhedron
+
+  @param polyhedron The polyhedron to fill
+  @param max_volume The intended volume of each trellis node
+  @param precompute Whether to store a BarycentricTransform per tetrahedron,
+                    which speeds up point location at the cost of 112 bytes each
+  */
+  explicit PolyhedronTrellis(const Polyhedron& polyhedron, const double max_volume, const bool precompute=true);
   // explicit PolyhedronTrellis(const Polyhedron& polyhedron, const double max_volume){
   //   this->construct(polyhedron, max_volume);
   // }
@@ -313,6 +406,31 @@ public:
     if (v.numel()==3) vertices_ = v;
     return vertices_;
   }
+  //! Write the bounding Polyhedron, data, vertices, nodes, and boundaries to a BinaryWriter
+  void serialize(BinaryWriter& w) const {
+    polyhedron_.serialize(w);
+    data_.serialize(w);
+    w.write(vertices_);
+    nodes_.serialize(w);
+    for (const auto& b: boundaries_) w.write(b);
+  }
+  /*! \brief Read a PolyhedronTrellis written by `serialize`
+
+  @param r the reader
+  @param borrow if true the interpolation data references the reader's buffer,
+                which must then outlive the trellis; the geometry is always copied
+  */
+  static PolyhedronTrellis<T,R> deserialize(BinaryReader& r, const bool borrow=false){
+    PolyhedronTrellis<T,R> pt;
+    pt.polyhedron_ = Polyhedron::deserialize(r);
+    pt.data_ = InterpolationData<T,R>::deserialize(r, borrow);
+    pt.vertices_ = r.read_arrayvector<double>();
+    pt.nodes_ = NodeContainer::deserialize(r);
+    for (auto& b: pt.boundaries_) r.read(b);
+    if (pt.vertices_.numel() != 3u || (pt.data_.size() && pt.data_.size() != pt.vertices_.size()))
+      throw std::runtime_error("Serialized PolyhedronTrellis vertices and data are inconsistent");
+    return pt;
+  }
   ArrayVector<double> cube_vertices(void) const {
     std::vector<bool> keep(vertices_.size(), false);
     for (index_t i=0; i<nodes_.size(); ++i)
@@ -334,10 +452,22 @@ public:
     for (auto tet: nodes_.vertices_per_tetrahedron(i)) out.push_back(tet);
     return out;
   }
-  bool indices_weights(const ArrayVector<double>& x, std::vector<index_t>& indices, std::vector<double>& weights) const {
+  bool indices_weights(const ArrayVectorView<double>& x, std::vector<index_t>& indices, std::vector<double>& weights) const {
+    return point_ok(this->locate(x, indices, weights));
+  }
+  //! Find the vertices and weights for one point, reporting whether a bin boundary had to be crossed
+  PointStatus locate(const ArrayVectorView<double>& x, std::vector<index_t>& indices, std::vector<double>& weights) const {
     if (x.size()!=1u || x.numel()!=3u)
       throw std::runtime_error("The indices and weights can only be found for one point at a time.");
-    return nodes_.indices_weights(this->node_index(x), vertices_, x, indices, weights);
+    ProfileTimer timer(ProfileStage::locate);
+    bool nudged{false};
+    std::array<index_t,3> sub = this->node_subscript(x, nudged);
+    // points outside of the binned region have no node to search
+    if (!this->subscript_ok_and_not_null(sub))
+      return PointStatus::not_found;
+    if (!nodes_.indices_weights(this->sub2idx(sub), vertices_, x, indices, weights))
+      return PointStatus::not_found;
+    return nudged ? PointStatus::nudged : PointStatus::found;
   }
   template<class S> unsigned check_before_interpolating(const ArrayVector<S>& x) const{
     unsigned int mask = 0u;
@@ -349,26 +479,28 @@ public:
   }
   std::tuple<ArrayVector<T>, ArrayVector<R>>
   interpolate_at(const ArrayVector<double>& x) const {
-    verbose_update("Single thread interpolation at ",x.size()," points");
-    this->check_before_interpolating(x);
-    ArrayVector<T> vals_out(data_.values().numel(), x.size());
-    ArrayVector<R> vecs_out(data_.vectors().numel(), x.size());
-    std::vector<index_t> indices;
-    std::vector<double> weights;
-    for (size_t i=0; i<x.size(); ++i){
-      verbose_update("Locating ",x.to_string(i));
-      if (!this->indices_weights(x.extract(i), indices, weights))
-        throw std::runtime_error("Point not found in PolyhedronTrellis");
-      verbose_update("Interpolate between vertices ", indices," with weights ",weights);
-      data_.interpolate_at(indices, weights, vals_out, vecs_out, i);
-    }
-    return std::make_tuple(vals_out, vecs_out);
+    return this->interpolate_at(x, 1);
   }
   std::tuple<ArrayVector<T>, ArrayVector<R>>
   interpolate_at(const ArrayVector<double>& x, const int threads) const {
+    std::vector<PointStatus> status;
+    auto out = this->interpolate_at(x, status, threads);
+    throw_if_failed(status, "PolyhedronTrellis::interpolate_at");
+    return out;
+  }
+  /*! \brief Interpolate at every point which can be found, recording the outcome for each
+
+  Points not found in the trellis are marked PointStatus::not_found and their
+  results are zero. If `status` already holds one entry per point, as set by
+  BrillouinZone::ir_moveinto for example, points already marked as failed are
+  skipped.
+  */
+  std::tuple<ArrayVector<T>, ArrayVector<R>>
+  interpolate_at(const ArrayVector<double>& x, std::vector<PointStatus>& status, const int threads) const {
     this->check_before_interpolating(x);
-    omp_set_num_threads( (threads > 0) ? threads : omp_get_max_threads() );
-    verbose_update("Parallel interpolation at ",x.size()," points with ",threads," threads");
+    const int nth = (threads > 0) ? threads : omp_get_max_threads();
+    verbose_update("Interpolation at ",x.size()," points with ",nth," threads");
+    prepare_status(status, x.size());
     // shared between threads
     ArrayVector<T> vals_out(data_.values().numel(), x.size());
     ArrayVector<R> vecs_out(data_.vectors().numel(), x.size());
@@ -378,18 +510,45 @@ public:
     // OpenMP < v3.0 (VS uses v2.0) requires signed indexes for omp parallel
     long long xsize = unsigned_to_signed<long long, size_t>(x.size());
     size_t n_unfound{0};
-  #pragma omp parallel for default(none) shared(x,vals_out,vecs_out,xsize) private(indices, weights) reduction(+:n_unfound) schedule(dynamic)
+  #pragma omp parallel for num_threads(nth) default(none) shared(x,vals_out,vecs_out,xsize,status) private(indices, weights) reduction(+:n_unfound) schedule(dynamic)
     for (long long si=0; si<xsize; ++si){
       size_t i = signed_to_unsigned<size_t, long long>(si);
-      if (this->indices_weights(x.extract(i), indices, weights)){
+      if (!point_ok(status[i])) continue;
+      status[i] = this->locate(x.view(i), indices, weights);
+      if (point_ok(status[i])){
         data_.interpolate_at(indices, weights, vals_out, vecs_out, i);
       } else {
         ++n_unfound;
       }
     }
-    std::runtime_error("interpolate at failed to find "+std::to_string(n_unfound)+" point"+(n_unfound>1?"s.":"."));
+    Profile::count(ProfileCounter::not_found, n_unfound);
     return std::make_tuple(vals_out, vecs_out);
   }
+  /*! \brief Locate points once, for repeated interpolation while only the data changes
+
+  @param x The points, which must be inside of the trellis polyhedron
+  @param threads The number of OpenMP threads to use
+  @param with_permutations Also store the branch permutations for the current
+                           data, see InterpolationPlan
+  @param status An optional status per point, points already marked as failed
+                are skipped
+  */
+  InterpolationPlan plan(const ArrayVector<double>& x, const int threads, const bool with_permutations=false, const std::vector<PointStatus>& status=std::vector<PointStatus>()) const {
+    this->check_before_interpolating(x);
+    return InterpolationPlan::build<index_t>(data_.size(), x.size(), status,
+      [&](const size_t i, std::vector<index_t>& indices, std::vector<double>& weights){
+        return this->locate(x.view(i), indices, weights);
+      },
+      [&](const std::vector<index_t>& indices){return data_.get_permutations(indices);},
+      with_permutations ? data_.branches() : 0u, threads);
+  }
+  //! Interpolate the current data at the points of a plan made by `plan`
+  std::tuple<ArrayVector<T>, ArrayVector<R>>
+  execute(const InterpolationPlan& plan, const int threads) const {
+    if (this->data_.size()==0)
+      throw std::runtime_error("The trellis must be filled before interpolating!");
+    return data_.interpolate_at(plan, threads);
+  }
   index_t node_count() {
     index_t count = 1u;
     for (index_t i=0; i<3u; ++i) count *= static_cast<index_t>(boundaries_[i].size()-1);
@@ -408,13 +567,19 @@ public:
   // const std::array<std::vector<double>,3>& boundaries(void) const {return boundaries_;}
   //
   // Find the appropriate node for an arbitrary point:
-  std::array<index_t,3> node_subscript(const ArrayVector<double>& p) const {
+  std::array<index_t,3> node_subscript(const ArrayVectorView<double>& p) const {
+    bool nudged{false};
+    return this->node_subscript(p, nudged);
+  }
+  // as above, setting nudged if a neighbouring node had to be used
+  std::array<index_t,3> node_subscript(const ArrayVectorView<double>& p, bool& nudged) const {
     std::array<index_t,3> sub{{0,0,0}};
     for (index_t dim=0; dim<3u; ++dim)
       sub[dim] = static_cast<index_t>(find_bin(boundaries_[dim], p.getvalue(0, dim)));
     // it's possible that a subscript could go beyond the last bin in any direction!
     bool bad = !subscript_ok_and_not_null(sub);
     if (bad){
+      Profile::count(ProfileCounter::boundary_retries);
       std::array<int,3> close{{0,0,0}};
       // determine if we are close to a boundary along any of the three binning
       // directions. if we are, on_boundary returns the direction in which we
@@ -443,7 +608,10 @@ public:
         for (int i=0; i<3; ++i) newsub[i] += close[i];
         bad = !subscript_ok_and_not_null(newsub);
       }
-      if (!bad) sub = newsub;
+      if (!bad) {
+        nudged = newsub != sub;
+        sub = newsub;
+      }
     }
     info_update_if(bad,"The node subscript ",sub," for the point ",p.to_string()," is either invalid or points to a null node!");
     return sub;
@@ -486,9 +654,18 @@ public:
   }
   //! Get a constant reference to the stored data
   const InterpolationData<T,R>& data(void) const {return data_;}
+  //! The bytes held by the vertices, nodes, bounding polyhedron, and data
+  MemoryUsage memory_usage() const {
+    MemoryUsage m = data_.memory_usage();
+    m += nodes_.memory_usage();
+    m.vertices += memory_bytes(vertices_);
+    m.auxiliary += polyhedron_.memory_bytes();
+    for (const auto& b: boundaries_) m.auxiliary += memory_bytes(b);
+    return m;
+  }
   //! Replace the data stored in the object
-  template<typename... A> void replace_value_data(A... args) { data_.replace_value_data(args...); }
-  template<typename... A> void replace_vector_data(A... args) { data_.replace_vector_data(args...); }
+  template<typename... A> void replace_value_data(A&&... args) { data_.replace_value_data(std::forward<A>(args)...); }
+  template<typename... A> void replace_vector_data(A&&... args) { data_.replace_vector_data(std::forward<A>(args)...); }
   template<typename... A> void set_value_cost_info(A... args) { data_.set_value_cost_info(args...); }
   template<typename... A> void set_vector_cost_info(A... args) {data_.set_vector_cost_info(args...);}
   //! Calculate the Debye-Waller factor for the provided Q points and ion masses
@@ -16,7 +16,7 @@
 // along with brille. If not, see <https://www.gnu.org/licenses/>.            */
 
 template<class T, class R>
-PolyhedronTrellis<T,R>::PolyhedronTrellis(const Polyhedron& poly, const double max_volume):
+PolyhedronTrellis<T,R>::PolyhedronTrellis(const Polyhedron& poly, const double max_volume, const bool precompute):
   polyhedron_(poly), vertices_({3,0})
 {
   // find the extents of the polyhedron
@@ -89,8 +89,11 @@ PolyhedronTrellis<T,R>::PolyhedronTrellis(const Polyhedron& poly, const double m
   }
   // Pull out the intersection points which we will keep as vertices:
   ArrayVector<double> kept_intersections = all_intersections.extract(are_inside);
-  ArrayVector<double> extra_intersections(3u, 3*(all_intersections.size()-kept_intersections.size()));
-  index_t nExtra=0;
+  // and store them in a spatial hash which will also hold any extra vertices
+  // created by triangulating the nodes which intersect the polyhedron surface
+  VertexWelder<double> welder(intended_length);
+  welder.reserve(all_intersections.size());
+  for (size_t i=0; i<kept_intersections.size(); ++i) welder.insert(kept_intersections.data(i));
   // Now actually create the node objects (which are not fully outside)
   for (index_t i=0; i<nNodes; ++i)
     if (node_is_outside[i]) {
@@ -98,12 +101,10 @@ PolyhedronTrellis<T,R>::PolyhedronTrellis(const Polyhedron& poly, const double m
     } else {
     std::array<index_t,3> node_ijk = this->idx2sub(i);
     std::array<index_t,8> vert_idx; // the 8 vertex indices of the cube
-    std::vector<index_t> mapped_vert_idx;
     for (int k=0; k<8; ++k){
       size_t int_idx=0;
       for (int j=0; j<3; ++j) int_idx += (node_ijk[j]+node_intersections[k][j])*intersections_span[j];
       vert_idx[k] = static_cast<index_t>(map_idx[int_idx]);
-      if (map_idx[int_idx] < n_mapped) mapped_vert_idx.push_back(static_cast<index_t>(map_idx[int_idx]));
     }
     bool contains_Gamma{true};
     for (int j=0; j<3; ++j){
@@ -121,11 +122,18 @@ PolyhedronTrellis<T,R>::PolyhedronTrellis(const Polyhedron& poly, const double m
         min_corner[j] = boundaries_[j][node_ijk[j]  ];
         max_corner[j] = boundaries_[j][node_ijk[j]+1];
       }
-      Polyhedron cube = polyhedron_box(min_corner, max_corner);
-      debug_update("Node ",i," has bounding box\n",cube.get_vertices().to_string());
+      BoxOverlap overlap = classify_box(poly, min_corner, max_corner);
+      if (BoxOverlap::outside == overlap){
+        nodes_.push_back(NullNode());
+        continue;
+      }
+      double cube_volume{1};
+      for (int j=0; j<3; ++j) cube_volume *= max_corner[j] - min_corner[j];
       // the cubic node extends beyond the bounding polyhedron so we must truncate it
-      // Polyhedron pbc = poly.intersection(cube);
-      Polyhedron cbp = cube.intersection(poly); // <- this one should (probably) always be faster since the cube is smaller
+      Polyhedron cbp = BoxOverlap::inside == overlap
+        ? polyhedron_box(min_corner, max_corner)
+        : polyhedron_box_intersection(min_corner, max_corner, poly);
+      debug_update("Node ",i," truncated by the polyhedron is\n",cbp.get_vertices().to_string());
       double cut_volume = cbp.get_volume();
       if (cbp.get_vertices().size() < 4 || cut_volume < 0 || approx_scalar(cut_volume, 0.)){
         // less than four vertices can not be a polyhedron
@@ -134,11 +142,13 @@ PolyhedronTrellis<T,R>::PolyhedronTrellis(const Polyhedron& poly, const double m
         nodes_.push_back(NullNode());
         continue;
       }
-      if (cut_volume > cube.get_volume())
+      if (cut_volume > cube_volume && !approx_scalar(cut_volume, cube_volume))
         throw std::runtime_error("Cutting the node increased its volume?!");
-      // cut the larger polyhedron by the smaller one:
-      // Then triangulate it into tetrahedra
-      SimpleTet tri_cut(cbp, -1., contains_Gamma);
+      // Then triangulate it into tetrahedra; the cut node is convex so it can
+      // be decomposed directly, with tetgen used for any degenerate cases
+      SimpleTet tri_cut = convex_tetrahedralization(cbp, contains_Gamma);
+      if (tri_cut.get_vertices().size()<4)
+        tri_cut = SimpleTet(cbp, -1., contains_Gamma);
       // SimpleTet tri_cut(cbp, max_volume, contains_Gamma);
       if (tri_cut.get_vertices().size()<4){
         //something went wrong.
@@ -155,31 +165,9 @@ PolyhedronTrellis<T,R>::PolyhedronTrellis(const Polyhedron& poly, const double m
       std::vector<index_t> local_map;
       const ArrayVector<double>& triverts{tri_cut.get_vertices()};
       for (size_t j=0; j<triverts.size(); ++j){
-        const ArrayVector<double> trij{triverts.extract(j)};
-        debug_update("checking vertex ", trij.to_string(""));
-        auto cube_idx = find(norm(kept_intersections.extract(mapped_vert_idx)-trij).is_approx(Comp::eq,0.));
-        if (cube_idx.size()>1) throw std::logic_error("Too many matching vertices");
-        if (cube_idx.size()==1){
-          local_map.push_back(mapped_vert_idx[cube_idx[0]]);
-        } else {
-          auto extra_idx = find(norm(extra_intersections.first(nExtra)-trij).is_approx(Comp::eq,0.));
-          if (extra_idx.size()>1)
-            throw std::logic_error("How does one point match multiple points when all points should be unique?");
-          if (extra_idx.size()>0){
-            // info_update("Polyhedron vertex in extra_intersections: idx = ",cube_idx);
-            local_map.push_back(static_cast<index_t>(kept_intersections.size() + extra_idx[0]));
-          } else {
-            // info_update("Polyhedron vertex not in kept or extra intersections, so add it.");
-            // make sure we have room to store this new intersection
-            // if we don't, make room; but since this involves a memory copy make lots of room
-            if (extra_intersections.size() < nExtra+1) extra_intersections.resize(2*nExtra);
-            // store the extra vertex
-            extra_intersections.set(nExtra, trij);
-            // and its mapping information
-            local_map.push_back(static_cast<index_t>(kept_intersections.size()) + nExtra);
-            ++nExtra;
-          }
-        }
+        debug_update("checking vertex ", triverts.to_string(j));
+        // any vertex not already present is added to the end of the welder
+        local_map.push_back(static_cast<index_t>(welder.weld(triverts.data(j)).first));
       }
       std::vector<std::array<index_t,4>> idx_per_tet;
       const ArrayVector<size_t>& local_ipt{tri_cut.get_vertices_per_tetrahedron()};
@@ -190,21 +178,23 @@ PolyhedronTrellis<T,R>::PolyhedronTrellis(const Polyhedron& poly, const double m
       }
       std::vector<std::array<double,4>> cci_per_tet;
       std::vector<double> vol_per_tet;
+      std::vector<BarycentricTransform> bt_per_tet;
       for (size_t j=0; j<tri_cut.number_of_tetrahedra(); ++j){
         cci_per_tet.push_back(tri_cut.circumsphere_info(j));
         vol_per_tet.push_back(tri_cut.volume(j));
+        if (precompute) bt_per_tet.push_back(tri_cut.barycentric_transform(j));
       }
       if (idx_per_tet.size()<1){
         nodes_.push_back(NullNode());
       }
       else{
-        nodes_.push_back(PolyNode(idx_per_tet, cci_per_tet, vol_per_tet));
+        nodes_.push_back(PolyNode(idx_per_tet, cci_per_tet, vol_per_tet, bt_per_tet));
       }
     }
   }
   // Now all non-null nodes have been populated with the indices of their vertices
-  // Combine the retained trellis vertices and the extra triangulated vertices
-  vertices_ = cat(kept_intersections, extra_intersections.first(nExtra));
+  // The retained trellis vertices are followed by the extra triangulated vertices
+  vertices_ = welder.vertices();
 }
 
 /*! \brief Consensus sorting of objects on a relational mesh
@@ -26,6 +26,8 @@
 #include "tetgen.h"
 #include "debug.hpp"
 #include "balltrellis.hpp"
+#include "barycentric.hpp"
+#include "predicates.hpp"
 
 template<class T, size_t N> static size_t find_first(const std::array<T,N>& x, const T val){
   auto at = std::find(x.begin(), x.end(), val);
@@ -73,6 +75,7 @@ class TetTri{
   // std::vector<BallLeaf> leaves;
   Trellis tetrahedraTrellis;
   std::vector<TrellisLeaf> leaves;
+  std::vector<BarycentricTransform> transforms; // (nTetrahedra,)
 public:
   size_t number_of_vertices(void) const {return nVertices;}
   size_t number_of_tetrahedra(void) const {return nTetrahedra;}
@@ -109,6 +112,13 @@ public:
       neighbours_per_tetrahedron[i].push_back(static_cast<size_t>(tgio.neighborlist[i*4u+j]));
     // ensure that all tetrahedra have positive (orient3d) volume
     this->correct_tetrahedra_vertex_ordering();
+    // precompute the barycentric coordinate transformation for each tetrahedron
+    for (size_t i=0; i<nTetrahedra; ++i)
+      transforms.push_back(BarycentricTransform(
+        vertex_positions.data(vertices_per_tetrahedron.getvalue(i, 0u)),
+        vertex_positions.data(vertices_per_tetrahedron.getvalue(i, 1u)),
+        vertex_positions.data(vertices_per_tetrahedron.getvalue(i, 2u)),
+        vertex_positions.data(vertices_per_tetrahedron.getvalue(i, 3u)) ));
     // construct the tree for faster locating:
     this->make_balltree(fraction);
     // Create a string full of object information:
@@ -306,7 +316,7 @@ public:
   }
   double volume(const size_t tet) const {
     double v;
-    v = orient3d(
+    v = orient3d_filtered(
       vertex_positions.data(vertices_per_tetrahedron.getvalue(tet, 0u)),
       vertex_positions.data(vertices_per_tetrahedron.getvalue(tet, 1u)),
       vertex_positions.data(vertices_per_tetrahedron.getvalue(tet, 2u)),
@@ -338,27 +348,14 @@ protected:
     return leaves[tet].fuzzy_contains(x);
   }
   void weights(const size_t tet, const ArrayVector<double>& x, std::array<double,4>& w) const {
-    double vol6 = 6.0*this->volume(tet);
-    w[0] = orient3d(
-      x.data(),
-      vertex_positions.data(vertices_per_tetrahedron.getvalue(tet, 1u)),
-      vertex_positions.data(vertices_per_tetrahedron.getvalue(tet, 2u)),
-      vertex_positions.data(vertices_per_tetrahedron.getvalue(tet, 3u)) )/vol6;
-    w[1] = orient3d(
-      vertex_positions.data(vertices_per_tetrahedron.getvalue(tet, 0u)),
-      x.data(),
-      vertex_positions.data(vertices_per_tetrahedron.getvalue(tet, 2u)),
-      vertex_positions.data(vertices_per_tetrahedron.getvalue(tet, 3u)) )/vol6;
-    w[2] = orient3d(
-      vertex_positions.data(vertices_per_tetrahedron.getvalue(tet, 0u)),
-      vertex_positions.data(vertices_per_tetrahedron.getvalue(tet, 1u)),
-      x.data(),
-      vertex_positions.data(vertices_per_tetrahedron.getvalue(tet, 3u)) )/vol6;
-    w[3] = orient3d(
+    // the precomputed transform suffices unless x is (nearly) on a face
+    if (tet < transforms.size() && transforms[tet].weights(x.data(), w)) return;
+    orient3d_weights(
       vertex_positions.data(vertices_per_tetrahedron.getvalue(tet, 0u)),
       vertex_positions.data(vertices_per_tetrahedron.getvalue(tet, 1u)),
       vertex_positions.data(vertices_per_tetrahedron.getvalue(tet, 2u)),
-      x.data()                                                          )/vol6;
+      vertex_positions.data(vertices_per_tetrahedron.getvalue(tet, 3u)),
+      x.data(), 6.0*this->volume(tet), w);
   }
   void correct_tetrahedra_vertex_ordering(void){
     for (size_t i=0; i<nTetrahedra; ++i)
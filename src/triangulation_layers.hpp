@@ -25,6 +25,10 @@
 #include "tetgen.h"
 #include "debug.hpp"
 #include "polyhedron.hpp"
+#include "barycentric.hpp"
+#include "predicates.hpp"
+#include "serialize.hpp"
+#include "memory_usage.hpp"
 
 template<class T, size_t N> static size_t find_first(const std::array<T,N>& x, const T val){
   auto at = std::find(x.begin(), x.end(), val);
@@ -57,6 +61,42 @@ public:
   }
 
   TetTriLayer(void): nVertices(0), nTetrahedra(0), vertex_positions({3u,0u}), vertices_per_tetrahedron({4u,0u}), circum_centres({3u,0u}){}
+  //! The bytes held by the vertices, tetrahedra, connectivity, and circumspheres
+  MemoryUsage memory_usage() const {
+    MemoryUsage m;
+    m.vertices = memory_bytes(vertex_positions);
+    m.nodes = memory_bytes(vertices_per_tetrahedron) + memory_bytes(tetrahedra_per_vertex)
+            + memory_bytes(neighbours_per_tetrahedron);
+    m.circumspheres = memory_bytes(circum_centres) + memory_bytes(circum_radii);
+    return m;
+  }
+  //! Write the vertices, tetrahedra, connectivity, and circumspheres to a BinaryWriter
+  void serialize(BinaryWriter& w) const {
+    w.write(static_cast<uint64_t>(nVertices));
+    w.write(static_cast<uint64_t>(nTetrahedra));
+    w.write(vertex_positions);
+    w.write(vertices_per_tetrahedron);
+    w.write(tetrahedra_per_vertex);
+    w.write(neighbours_per_tetrahedron);
+    w.write(circum_centres);
+    w.write(circum_radii);
+  }
+  //! Read a TetTriLayer written by `serialize`
+  static TetTriLayer deserialize(BinaryReader& r){
+    TetTriLayer l;
+    l.nVertices = static_cast<size_t>(r.read<uint64_t>());
+    l.nTetrahedra = static_cast<size_t>(r.read<uint64_t>());
+    l.vertex_positions = r.read_arrayvector<double>();
+    l.vertices_per_tetrahedron = r.read_arrayvector<size_t>();
+    r.read(l.tetrahedra_per_vertex);
+    r.read(l.neighbours_per_tetrahedron);
+    l.circum_centres = r.read_arrayvector<double>();
+    r.read(l.circum_radii);
+    if (l.vertex_positions.size() != l.nVertices || l.vertices_per_tetrahedron.size() != l.nTetrahedra
+        || l.circum_radii.size() != l.nTetrahedra)
+      throw std::runtime_error("Serialized TetTriLayer sizes are inconsistent");
+    return l;
+  }
   TetTriLayer(const tetgenio& tgio): vertex_positions({3u,0u}), vertices_per_tetrahedron({4u,0u}), circum_centres({3u,0u}){
     nVertices = static_cast<size_t>(tgio.numberofpoints);
     nTetrahedra = static_cast<size_t>(tgio.numberoftetrahedra);
@@ -145,7 +185,7 @@ public:
   }
   double volume(const size_t tet) const {
     double v;
-    v = orient3d(
+    v = orient3d_filtered(
       vertex_positions.data(vertices_per_tetrahedron.getvalue(tet, 0u)),
       vertex_positions.data(vertices_per_tetrahedron.getvalue(tet, 1u)),
       vertex_positions.data(vertices_per_tetrahedron.getvalue(tet, 2u)),
@@ -175,7 +215,7 @@ public:
   }
 protected:
   bool unsafe_might_contain(const size_t tet, const ArrayVector<double>& x) const {
-    return norm(x - circum_centres.extract(tet)).all_approx(Comp::le, circum_radii[tet]);
+    return norm(lazy(x) - circum_centres.view(tet)).all_approx(Comp::le, circum_radii[tet]);
   }
   bool unsafe_contains(const size_t tet, const ArrayVector<double>& x) const {
     std::array<double,4> w{0.,0.,0.,0.};
@@ -186,27 +226,12 @@ protected:
     return std::all_of(w.begin(), w.end(), [](double z){ return (z>0.||approx_scalar(z,0.)); });
   }
   void weights(const size_t tet, const ArrayVector<double>& x, std::array<double,4>& w) const {
-    double vol6 = 6.0*this->volume(tet);
-    w[0] = orient3d(
-      x.data(),
-      vertex_positions.data(vertices_per_tetrahedron.getvalue(tet, 1u)),
-      vertex_positions.data(vertices_per_tetrahedron.getvalue(tet, 2u)),
-      vertex_positions.data(vertices_per_tetrahedron.getvalue(tet, 3u)) )/vol6;
-    w[1] = orient3d(
-      vertex_positions.data(vertices_per_tetrahedron.getvalue(tet, 0u)),
-      x.data(),
-      vertex_positions.data(vertices_per_tetrahedron.getvalue(tet, 2u)),
-      vertex_positions.data(vertices_per_tetrahedron.getvalue(tet, 3u)) )/vol6;
-    w[2] = orient3d(
-      vertex_positions.data(vertices_per_tetrahedron.getvalue(tet, 0u)),
-      vertex_positions.data(vertices_per_tetrahedron.getvalue(tet, 1u)),
-      x.data(),
-      vertex_positions.data(vertices_per_tetrahedron.getvalue(tet, 3u)) )/vol6;
-    w[3] = orient3d(
+    orient3d_weights(
       vertex_positions.data(vertices_per_tetrahedron.getvalue(tet, 0u)),
       vertex_positions.data(vertices_per_tetrahedron.getvalue(tet, 1u)),
       vertex_positions.data(vertices_per_tetrahedron.getvalue(tet, 2u)),
-      x.data()                                                          )/vol6;
+      vertex_positions.data(vertices_per_tetrahedron.getvalue(tet, 3u)),
+      x.data(), 6.0*this->volume(tet), w);
   }
   void correct_tetrahedra_vertex_ordering(void){
     for (size_t i=0; i<nTetrahedra; ++i)
@@ -250,6 +275,29 @@ public:
   TetTri(const std::vector<TetTriLayer>& l): layers(l) {
     this->find_connections();
   }
+  //! The bytes held by all layers and the connections between them
+  MemoryUsage memory_usage() const {
+    MemoryUsage m;
+    m.nodes = memory_bytes(layers) + memory_bytes(connections);
+    for (const auto& l: layers) m += l.memory_usage();
+    return m;
+  }
+  //! Write all layers and their connections to a BinaryWriter
+  void serialize(BinaryWriter& w) const {
+    w.write(static_cast<uint64_t>(layers.size()));
+    for (const auto& l: layers) l.serialize(w);
+    w.write(connections);
+  }
+  //! Read a TetTri written by `serialize`, without finding the layer connections again
+  static TetTri deserialize(BinaryReader& r){
+    TetTri t;
+    uint64_t count = r.read<uint64_t>();
+    for (uint64_t i=0; i<count; ++i) t.layers.push_back(TetTriLayer::deserialize(r));
+    r.read(t.connections);
+    if (t.layers.empty() || t.connections.size() + 1u != t.layers.size())
+      throw std::runtime_error("Serialized TetTri layers and connections are inconsistent");
+    return t;
+  }
   void find_connections(const size_t highest=0){
     if (highest < layers.size()-1)
     for (size_t i=highest; i<layers.size()-1; ++i)
@@ -340,7 +388,6 @@ private:
   //   return map;
   // }
 TetMap connect(const size_t high, const size_t low) const{
-  omp_set_num_threads(omp_get_max_threads());
   Stopwatch<> stopwatch;
   stopwatch.tic();
   TetMap map(layers[high].number_of_tetrahedra());
@@ -23,6 +23,9 @@
 #include <algorithm>
 #include "tetgen.h"
 #include "debug.hpp"
+#include "polyhedron.hpp"
+#include "barycentric.hpp"
+#include "predicates.hpp"
 
 class SimpleTet{
   ArrayVector<double> vertex_positions; // (nVertices, 3)
@@ -115,15 +118,27 @@ public:
     // ensure that all tetrahedra have positive (orient3d) volume
     this->correct_tetrahedra_vertex_ordering();
   }
+  //! Construct from already-determined vertex positions and tetrahedra
+  SimpleTet(const ArrayVector<double>& v, const ArrayVector<size_t>& vpt): vertex_positions(v), vertices_per_tetrahedron(vpt){
+    this->correct_tetrahedra_vertex_ordering();
+  }
   double volume(const size_t tet) const {
     double v;
-    v = orient3d(
+    v = orient3d_filtered(
       vertex_positions.data(vertices_per_tetrahedron.getvalue(tet, 0u)),
       vertex_positions.data(vertices_per_tetrahedron.getvalue(tet, 1u)),
       vertex_positions.data(vertices_per_tetrahedron.getvalue(tet, 2u)),
       vertex_positions.data(vertices_per_tetrahedron.getvalue(tet, 3u)) )/6.0;
     return v;
   }
+  //! Precompute the transformation to barycentric coordinates of tetrahedron tet
+  BarycentricTransform barycentric_transform(const size_t tet) const {
+    return BarycentricTransform(
+      vertex_positions.data(vertices_per_tetrahedron.getvalue(tet, 0u)),
+      vertex_positions.data(vertices_per_tetrahedron.getvalue(tet, 1u)),
+      vertex_positions.data(vertices_per_tetrahedron.getvalue(tet, 2u)),
+      vertex_positions.data(vertices_per_tetrahedron.getvalue(tet, 3u)) );
+  }
   double maximum_volume(void) const {
     double vol{0}, maxvol{0};
     for (size_t i=0; i<this->number_of_tetrahedra(); ++i){
@@ -170,4 +185,58 @@ protected:
     vertices_per_tetrahedron.swap(i, 0,1); // swap two vertices to switch sign
   }
 };
+
+/*! \brief Tetrahedralize a convex polyhedron without calling tetgen
+
+Every face polygon is fanned into triangles from its first vertex, and each
+triangle is joined to a common apex to form a tetrahedron; faces which contain
+the apex are skipped. The apex is the first polyhedron vertex or, if requested
+and the origin is inside of the polyhedron, the origin.
+
+@param poly a convex polyhedron with consistently wound faces
+@param addGamma whether the origin should be a vertex of the tetrahedra
+@returns the tetrahedralization, or an empty SimpleTet if the polyhedron is
+         degenerate or its volume is not reproduced by the tetrahedra, in
+         which case a tetgen-backed SimpleTet should be used instead
+*/
+inline SimpleTet convex_tetrahedralization(const Polyhedron& poly, const bool addGamma=false){
+  ArrayVector<double> verts = poly.get_vertices();
+  const std::vector<std::vector<int>>& vpf{poly.get_vertices_per_face()};
+  if (verts.size() < 4u || vpf.size() < 4u) return SimpleTet();
+  size_t apex{0};
+  if (addGamma){
+    ArrayVector<double> gamma(3u, 1u, 0.);
+    ArrayVector<bool> at_gamma = norm(verts).is_approx(Comp::eq, 0.);
+    bool found{false};
+    for (size_t i=0; i<verts.size(); ++i) if (at_gamma.getvalue(i)){
+      apex = i;
+      found = true;
+      break;
+    }
+    if (!found && poly.contains(gamma).getvalue(0)){
+      apex = verts.size();
+      verts.resize(apex+1);
+      verts.set(apex, gamma);
+    }
+  }
+  const double* a = verts.data(apex);
+  ArrayVector<size_t> vpt(4u, 0u);
+  std::vector<std::array<size_t,4>> tets;
+  double total{0};
+  for (const auto& face: vpf){
+    if (std::find(face.begin(), face.end(), static_cast<int>(apex)) != face.end()) continue;
+    for (size_t i=1; i+1<face.size(); ++i){
+      double vol = orient3d_filtered(a, verts.data(face[0]), verts.data(face[i]), verts.data(face[i+1]))/6.0;
+      // triangles coplanar with the apex add nothing
+      if (approx_scalar(vol, 0.)) continue;
+      total += std::abs(vol);
+      tets.push_back({{apex, static_cast<size_t>(face[0]), static_cast<size_t>(face[i]), static_cast<size_t>(face[i+1])}});
+    }
+  }
+  if (tets.size() < 1u || !approx_scalar(total, poly.get_volume())) return SimpleTet();
+  vpt.resize(tets.size());
+  for (size_t i=0; i<tets.size(); ++i) vpt.set(i, tets[i]);
+  return SimpleTet(verts, vpt);
+}
+
 #endif // _TRIANGULATION_H_
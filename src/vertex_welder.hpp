@@ -0,0 +1,177 @@
+/* Copyright 2020 Greg Tucker
+//
+// This file is part of brille.
+//
+// brille is free software: you can redistribute it and/or modify it under the
+// terms of the GNU Affero General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// brille is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with brille. If not, see <https://www.gnu.org/licenses/>.            */
+
+#ifndef _VERTEX_WELDER_H_
+#define _VERTEX_WELDER_H_
+
+#include <vector>
+#include <array>
+#include <cmath>
+#include <utility>
+#include <tuple>
+#include <unordered_map>
+#include "arrayvector.hpp"
+#include "utilities.hpp"
+
+/*! \brief A tolerance-aware spatial hash of unique three-vectors
+
+Building a Nest or PolyhedronTrellis from tetgen output requires that every new
+vertex be compared against all previously found vertices to avoid storing
+duplicates. A linear search over all stored vertices makes this quadratic in
+the number of vertices.
+
+The VertexWelder instead places each stored vertex into a cubic cell of a
+uniform grid, identified by its three integer subscripts, and keeps a hash map
+from cell subscripts to the indices of the vertices within that cell.
+A query point only needs to be compared against the vertices in its own cell
+and, if it is within the comparison tolerance of a cell face, the vertices in
+the neighbouring cell(s) on the other side of that face.
+
+Two vertices are considered equivalent if the length of their difference is
+approximately zero, via `approx_scalar`, which matches the equivalence used by
+`norm(a-b).is_approx(Comp::eq,0.)`.
+
+The cell size should be comparable to the expected vertex spacing; any positive
+value gives correct results but very small or very large cells remove the
+benefit of hashing.
+*/
+template<class T> class VertexWelder{
+public:
+  typedef std::array<long long,3> key_t;
+private:
+  struct KeyHash{
+    size_t operator()(const key_t& k) const {
+      // large odd multipliers to spread neighbouring cells across buckets
+      size_t h = static_cast<size_t>(k[0]) * 73856093u;
+      h ^= static_cast<size_t>(k[1]) * 19349663u;
+      h ^= static_cast<size_t>(k[2]) * 83492791u;
+      return h;
+    }
+  };
+  T cell_;                                        //!< the cubic cell side length
+  T tol_;                                         //!< the absolute distance tolerance
+  std::vector<std::array<T,3>> points_;           //!< the stored unique vertices
+  std::unordered_map<key_t, std::vector<size_t>, KeyHash> cells_;
+public:
+  explicit VertexWelder(const T cell_size=T(1), const int tol=1): cell_(cell_size) {
+    T Ttol, Rtol;
+    bool convertible, useTtol;
+    std::tie(convertible, useTtol, Ttol, Rtol) = determine_tols<T,T>(tol);
+    tol_ = Ttol;
+    if (!(cell_ > tol_)) cell_ = 2*tol_;
+  }
+  //! Return the number of unique vertices stored
+  size_t size() const {return points_.size();}
+  //! Pre-allocate storage for n vertices
+  void reserve(const size_t n) {points_.reserve(n); cells_.reserve(n);}
+  //! Return a reference to the ith stored vertex
+  const std::array<T,3>& operator[](const size_t i) const {return points_[i];}
+  //! Return a pointer to the ith stored vertex
+  const T* data(const size_t i) const {return points_[i].data();}
+  /*! \brief Look for a stored vertex equivalent to x
+
+  @param x a pointer to the three components of the query point
+  @returns the index of the equivalent stored vertex, or size() if there is none
+  */
+  size_t find(const T* x) const {
+    key_t k = this->key(x);
+    // determine which neighbouring cells could hold an equivalent point
+    std::array<std::array<long long,2>,3> range;
+    for (int i=0; i<3; ++i){
+      T lo = static_cast<T>(k[i])*cell_, hi = lo + cell_;
+      range[i][0] = (x[i]-lo <= tol_) ? k[i]-1 : k[i];
+      range[i][1] = (hi-x[i] <= tol_) ? k[i]+1 : k[i];
+    }
+    key_t n;
+    for (n[0]=range[0][0]; n[0]<=range[0][1]; ++n[0])
+    for (n[1]=range[1][0]; n[1]<=range[1][1]; ++n[1])
+    for (n[2]=range[2][0]; n[2]<=range[2][1]; ++n[2]){
+      auto itr = cells_.find(n);
+      if (itr != cells_.end()) for (size_t idx: itr->second)
+        if (this->equivalent(points_[idx].data(), x)) return idx;
+    }
+    return points_.size();
+  }
+  template<size_t N> size_t find(const std::array<T,N>& x) const {
+    static_assert(N==3u, "VertexWelder only handles three-vectors");
+    return this->find(x.data());
+  }
+  /*! \brief Store x without checking for an equivalent vertex
+
+  @param x a pointer to the three components of the new vertex
+  @returns the index of the stored vertex
+  */
+  size_t insert(const T* x){
+    size_t idx = points_.size();
+    points_.push_back({{x[0], x[1], x[2]}});
+    cells_[this->key(x)].push_back(idx);
+    return idx;
+  }
+  template<size_t N> size_t insert(const std::array<T,N>& x){
+    static_assert(N==3u, "VertexWelder only handles three-vectors");
+    return this->insert(x.data());
+  }
+  /*! \brief Find an equivalent stored vertex or store x as a new vertex
+
+  @param x a pointer to the three components of the vertex
+  @returns a pair with the index of the (possibly new) vertex and a flag
+           indicating whether x was added
+  */
+  std::pair<size_t,bool> weld(const T* x){
+    size_t idx = this->find(x);
+    if (idx < points_.size()) return std::make_pair(idx, false);
+    return std::make_pair(this->insert(x), true);
+  }
+  template<size_t N> std::pair<size_t,bool> weld(const std::array<T,N>& x){
+    static_assert(N==3u, "VertexWelder only handles three-vectors");
+    return this->weld(x.data());
+  }
+  //! Store all arrays of an (N,3) ArrayVector, returning the mapping to their unique indices
+  std::vector<size_t> weld(const ArrayVector<T>& x){
+    if (x.numel() != 3u)
+      throw std::runtime_error("VertexWelder only handles three-vectors");
+    std::vector<size_t> map;
+    map.reserve(x.size());
+    for (size_t i=0; i<x.size(); ++i) map.push_back(this->weld(x.data(i)).first);
+    return map;
+  }
+  //! Copy all stored vertices into an (N,3) ArrayVector
+  ArrayVector<T> vertices() const {
+    ArrayVector<T> out(3u, points_.size());
+    for (size_t i=0; i<points_.size(); ++i) out.set(i, points_[i]);
+    return out;
+  }
+  //! Copy the indexed stored vertices into an (N,3) ArrayVector
+  template<class I, size_t N> ArrayVector<T> vertices(const std::array<I,N>& idx) const {
+    ArrayVector<T> out(3u, N);
+    for (size_t i=0; i<N; ++i) out.set(i, points_[idx[i]]);
+    return out;
+  }
+private:
+  key_t key(const T* x) const {
+    key_t k;
+    for (int i=0; i<3; ++i) k[i] = static_cast<long long>(std::floor(x[i]/cell_));
+    return k;
+  }
+  bool equivalent(const T* a, const T* b) const {
+    T d2{0};
+    for (int i=0; i<3; ++i) d2 += (a[i]-b[i])*(a[i]-b[i]);
+    return approx_scalar(std::sqrt(d2), T(0));
+  }
+};
+
+#endif
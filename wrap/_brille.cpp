@@ -25,10 +25,13 @@ void wrap_hallsymbol(pybind11::module &);
 void wrap_lattice(pybind11::module &);
 void wrap_mesh(pybind11::module &);
 void wrap_nest(pybind11::module &);
+void wrap_point_status(pybind11::module &);
 void wrap_pointgroup(pybind11::module &);
 void wrap_pointsymmetry(pybind11::module &);
 void wrap_polyhedron(pybind11::module &);
+void wrap_prepared_q(pybind11::module &);
 void wrap_primitivetransform(pybind11::module &);
+void wrap_profiling(pybind11::module &);
 void wrap_spacegroup(pybind11::module &);
 void wrap_symmetry(pybind11::module &);
 void wrap_trellis(pybind11::module &);
@@ -77,5 +80,8 @@ PYBIND11_MODULE(_brille, m){
   wrap_pointsymmetry(m);
   wrap_polyhedron(m);
   wrap_hallsymbol(m);
+  wrap_profiling(m);
+  wrap_point_status(m);
+  wrap_prepared_q(m);
   //wrap_interpolationdata(m);
 }
@@ -90,38 +90,31 @@ void wrap_brillouinzone(py::module & m){
     return result;
   },"points"_a);
 
-  cls.def("moveinto",[](CLS &b, py::array_t<double> Q){
+  cls.def("moveinto",[](CLS &b, py::array_t<double, py::array::c_style|py::array::forcecast> Q){
     py::buffer_info bi = Q.request();
     ssize_t ndim=bi.ndim;
     if (bi.shape[ndim-1] !=3) throw std::runtime_error("one or more 3-dimensional Q points is required");
     ssize_t npts = 1;
     if (ndim > 1) for (ssize_t i=0; i<ndim-1; i++) npts *= bi.shape[i];
-    LQVec<double> Qv( b.get_lattice(),(double*) bi.ptr, bi.shape, bi.strides); // memcopy
+    LQVec<double> Qv(b.get_lattice(), np2av_view(Q)); // no copy
     LQVec<double> qv(b.get_lattice(), npts); // output
     LQVec<int>  tauv(b.get_lattice(), npts); // output
     bool success = b.moveinto(Qv,qv,tauv);
     if (!success) throw std::runtime_error("failed to move all Q into the first Brillouin Zone");
-    auto qout = py::array_t<double, py::array::c_style>(bi.shape);
-    auto tout = py::array_t<int, py::array::c_style>(bi.shape);
-    double *qptr = (double *) qout.request().ptr;
-    int *tptr = (int *) tout.request().ptr;
-    for (ssize_t i=0; i<npts; ++i){
-      for (size_t j=0; j<3u; ++j){
-        qptr[3u*i+j] = qv.getvalue(i,j);
-        tptr[3u*i+j] = tauv.getvalue(i,j);
-      }
-    }
+    // the outputs take the data of qv and tauv, rather than copying it
+    auto qout = av2np_adopt(std::move(qv), bi.shape);
+    auto tout = av2np_adopt(std::move(tauv), bi.shape);
     return py::make_tuple(qout,tout);
   }, "Q"_a);
 
-  cls.def("ir_moveinto",[](CLS &b, py::array_t<double> Q){
+  cls.def("ir_moveinto",[](CLS &b, py::array_t<double, py::array::c_style|py::array::forcecast> Q){
     py::buffer_info bi = Q.request();
     ssize_t ndim = bi.ndim;
     if (bi.shape[ndim-1] != 3)
       throw std::runtime_error("One or more 3-dimensional Q points are required.");
     ssize_t npts = 1;
     if (ndim > 1) for (ssize_t i=0; i<ndim-1; ++i) npts *= bi.shape[i];
-    LQVec<double> Qv(b.get_lattice(), (double*) bi.ptr, bi.shape, bi.strides);
+    LQVec<double> Qv(b.get_lattice(), np2av_view(Q)); // no copy
     // prepare intermediate outputs
     LQVec<double> qv(b.get_lattice(), npts);
     LQVec<int>  tauv(b.get_lattice(), npts);
@@ -129,7 +122,7 @@ void wrap_brillouinzone(py::module & m){
     if (!b.ir_moveinto(Qv, qv, tauv, rotidx, invrotidx))
       throw std::runtime_error("Moving points into irreducible zone failed.");
     // get the pointgroup symmetry operations indexed by rotidx and invrotidx
-    PointSymmetry ptsym = b.get_pointgroup_symmetry();
+    const PointSymmetry& ptsym = b.get_pointgroup_symmetry();
     // prepare Python outputs
     auto qout = py::array_t<double, py::array::c_style>(bi.shape);
     auto tout = py::array_t<int,    py::array::c_style>(bi.shape);
@@ -154,14 +147,14 @@ void wrap_brillouinzone(py::module & m){
     return py::make_tuple(qout, tout, rout, invrout);
   }, "Q"_a);
 
-  cls.def("ir_moveinto_wedge",[](CLS &b, py::array_t<double> Q){
+  cls.def("ir_moveinto_wedge",[](CLS &b, py::array_t<double, py::array::c_style|py::array::forcecast> Q){
     py::buffer_info bi = Q.request();
     ssize_t ndim = bi.ndim;
     if (bi.shape[ndim-1] != 3)
       throw std::runtime_error("One or more 3-dimensional Q points are required.");
     ssize_t npts = 1;
     if (ndim > 1) for (ssize_t i=0; i<ndim-1; ++i) npts *= bi.shape[i];
-    LQVec<double> Qv(b.get_lattice(), (double*) bi.ptr, bi.shape, bi.strides);
+    LQVec<double> Qv(b.get_lattice(), np2av_view(Q)); // no copy
     // prepare intermediate outputs
     LQVec<double> qv(b.get_lattice(), npts);
     std::vector<std::array<int,9>> rots(npts);
@@ -23,6 +23,7 @@
 
 #include "arrayvector.hpp"
 #include "utilities.hpp"
+#include "point_status.hpp"
 
 #ifndef __C_TO_PYTHON_H
 #define __C_TO_PYTHON_H
@@ -58,6 +59,12 @@ template<typename T> py::array_t<T> sv2np(const std::vector<ssize_t>& sz, const
   for (size_t i=0; i<numel; ++i) ptr[i] = sv[i];
   return np;
 }
+//! Per-point status codes, see PointStatus, as a uint8 array shaped like the queried points
+inline py::array_t<uint8_t> status2np(const std::vector<ssize_t>& sz, const std::vector<PointStatus>& status){
+  std::vector<uint8_t> codes(status.size());
+  std::transform(status.begin(), status.end(), codes.begin(), [](PointStatus s){return static_cast<uint8_t>(s);});
+  return sv2np(sz, codes);
+}
 template<typename T, size_t N>
 py::array_t<T> sva2np(const std::vector<ssize_t>&sz,
                       const std::vector<std::array<T,N>>& sva)
@@ -79,6 +86,47 @@ py::array_t<T> sva2np(const std::vector<ssize_t>&sz,
   return np;
 }
 
+/*! \brief View a C-contiguous numpy.ndarray as an ArrayVector without copying
+
+An array with shape (n₀, n₁, …, m) is referenced as an ArrayVector holding
+n₀×n₁×… arrays of m elements. The returned object borrows the numpy data, so
+the numpy.ndarray must outlive it.
+Taking a `py::array_t<T, c_style|forcecast>` argument lets pybind11 pass a
+matching C-contiguous array through untouched, and only make a contiguous
+copy if the provided array is strided or of a different type.
+*/
+template<typename T>
+ArrayVector<T> np2av_view(const py::array_t<T, py::array::c_style|py::array::forcecast>& np){
+  if (np.ndim() < 1)
+    throw std::runtime_error("An ArrayVector view requires at least a 1-D array");
+  size_t m = signed_to_unsigned<size_t>(np.shape(np.ndim()-1));
+  size_t n = 1u;
+  for (ssize_t i=0; i<np.ndim()-1; ++i) n *= signed_to_unsigned<size_t>(np.shape(i));
+  // the ArrayVector is only ever read through const references by the callers
+  return ArrayVector<T>::borrow(const_cast<T*>(np.data()), m, n);
+}
+
+/*! \brief Hand an ArrayVector's data to a new numpy.ndarray without copying
+
+The ArrayVector is moved to the heap and owned by a capsule which is the base
+object of the returned array, so its data is freed when Python releases the
+array.
+@param av The ArrayVector whose data is taken
+@param shape The shape of the returned array, which must have
+             av.size()*av.numel() elements
+*/
+template<typename T>
+py::array_t<T, py::array::c_style> av2np_adopt(ArrayVector<T>&& av, const std::vector<ssize_t>& shape){
+  size_t numel = signed_to_unsigned<size_t>(std::accumulate(shape.begin(), shape.end(), 1, std::multiplies<ssize_t>()));
+  if (numel != av.size()*av.numel())
+    throw std::runtime_error("Inconsistent required shape and ArrayVector size");
+  if (0 == numel || av.is_borrowed())
+    return py::array_t<T, py::array::c_style>(shape, av.size() && av.numel() ? av.data() : nullptr);
+  auto owned = new ArrayVector<T>(std::move(av));
+  py::capsule owner(owned, [](void *p){ delete reinterpret_cast<ArrayVector<T>*>(p); });
+  return py::array_t<T, py::array::c_style>(shape, owned->data(), owner);
+}
+
 template<typename T> py::array_t<T> av2np(const ArrayVector<T>& av){
   std::vector<ssize_t> shape(2); // ArrayVectors are 2D by default
   shape[0] = av.size();
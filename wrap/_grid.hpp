@@ -24,6 +24,8 @@
 
 #include "_c_to_python.hpp"
 #include "_interpolation_data.hpp"
+#include "_prepared_q.hpp"
+#include "_serialize.hpp"
 #include "bz_grid.hpp"
 #include "utilities.hpp"
 
@@ -36,7 +38,12 @@ void declare_bzgridq(py::module &m, const std::string &typestr) {
     using namespace pybind11::literals;
     using Class = BrillouinZoneGrid3<T,R>;
     std::string pyclass_name = std::string("BZGridQ") + typestr;
-    py::class_<Class>(m, pyclass_name.c_str(), py::buffer_protocol(), py::dynamic_attr())
+    py::class_<Class> cls(m, pyclass_name.c_str(), py::buffer_protocol(), py::dynamic_attr());
+    // flat binary serialization, e.g., into shared memory (see brille.shared), and pickling
+    def_serialization(cls);
+    def_memory_usage(cls);
+    def_cache(cls);
+    cls
     // Initializer (BrillouinZone, [half-]Number_of_steps vector)
     .def(py::init([](BrillouinZone &b, py::array_t<size_t> pyN){
       py::buffer_info bi = pyN.request();
@@ -65,22 +72,26 @@ void declare_bzgridq(py::module &m, const std::string &typestr) {
     .def_property_readonly("grid_invA",[](const Class& cobj){ return av2np(cobj.get_grid_xyz());} )
     .def_property_readonly("rlu",[](const Class& cobj){ return av2np(cobj.get_mapped_hkl());} )
     .def_property_readonly("invA",[](const Class& cobj){ return av2np(cobj.get_mapped_xyz());} )
-    .def("fill",[](Class& cobj,
+    .def("fill",[](py::object self,
       py::array_t<T> pyvals, py::array_t<int, py::array::c_style> pyvalelrl,
-      py::array_t<R> pyvecs, py::array_t<int, py::array::c_style> pyvecelrl
+      py::array_t<R> pyvecs, py::array_t<int, py::array::c_style> pyvecelrl, const bool copy
     ){
+      Class& cobj = self.cast<Class&>();
       ArrayVector<T> vals;
       ArrayVector<R> vecs;
       std::vector<size_t> val_sh, vec_sh;
       std::array<element_t, 3> val_el{{0,0,0}}, vec_el{{0,0,0}};
       RotatesLike val_rl, vec_rl;
       size_t count = cobj.valid_mapping_count();
-      std::tie(vals,val_sh,val_el,val_rl)=fill_check(pyvals,pyvalelrl,count);
-      std::tie(vecs,vec_sh,vec_el,vec_rl)=fill_check(pyvecs,pyvecelrl,count);
+      std::tie(vals,val_sh,val_el,val_rl)=fill_check(pyvals,pyvalelrl,count,copy);
+      std::tie(vecs,vec_sh,vec_el,vec_rl)=fill_check(pyvecs,pyvecelrl,count,copy);
 
-      cobj.replace_value_data(vals, val_sh, val_el, val_rl);
-      cobj.replace_vector_data(vecs, vec_sh, vec_el, vec_rl);
-    }, "values_data"_a, "values_elements"_a, "vectors_data"_a, "vectors_elements"_a)
+      bool val_borrowed{vals.is_borrowed()}, vec_borrowed{vecs.is_borrowed()};
+      keep_fill_arrays(self, pyvals, val_borrowed, pyvecs, vec_borrowed);
+      cobj.replace_value_data(std::move(vals), val_sh, val_el, val_rl);
+      cobj.replace_vector_data(std::move(vecs), vec_sh, vec_el, vec_rl);
+      release_replaced_fill_arrays(self);
+    }, "values_data"_a, "values_elements"_a, "vectors_data"_a, "vectors_elements"_a, "copy"_a=true)
     .def_property_readonly("values",[](Class& cobj){
       const auto & v{cobj.data().values()};
       return av2np_shape(v.data(), v.shape(), false);
@@ -133,8 +144,8 @@ void declare_bzgridq(py::module &m, const std::string &typestr) {
           throw std::runtime_error("The largest integer in the new mapping exceeds the number of data elements.");
         cobj.unsafe_set_map( (slong*)bi.ptr ); //no error, so this works.
     })
-    .def("interpolate_at",[](Class& cobj,
-                             py::array_t<double> pyX,
+    .def("interpolate_at",[](const Class& cobj,
+                             py::array_t<double, py::array::c_style|py::array::forcecast> pyX,
                              const bool& moveinto,
                              const bool& useparallel,
                              const int& threads){
@@ -144,54 +155,81 @@ void declare_bzgridq(py::module &m, const std::string &typestr) {
       // store shape of X before three-vector dimension for shaping output
       std::vector<ssize_t> preshape;
       for (ssize_t i=0; i < bi.ndim-1; ++i) preshape.push_back(bi.shape[i]);
-      // copy the Python X array
+      // reference the (C-contiguous) Python X array without copying
       BrillouinZone b = cobj.get_brillouinzone();
       Reciprocal lat = b.get_lattice();
-      LQVec<double> qv(lat,(double*)bi.ptr, bi.shape, bi.strides); //memcopy
-      if (moveinto){
-        LQVec<double> Qv(qv); // second memcopy
-        LQVec<int>  tauv(lat, qv.size()); // filled by moveinto
-        bool success = b.moveinto(Qv,qv,tauv);
-        if (!success)
-          throw std::runtime_error("failed to move all Q into the first Brillouin Zone");
-      }
-      // perform the interpolation and rotate and vectors/tensors afterwards
+      LQVec<double> qv(lat, np2av_view(pyX));
       const int maxth(static_cast<int>(std::thread::hardware_concurrency()));
       int nthreads = (useparallel) ? ((threads < 1) ? maxth : threads) : 1;
       ArrayVector<T> valres;
       ArrayVector<R> vecres;
-      std::tie(valres, vecres) = useparallel ?  cobj.parallel_linear_interpolate_at(qv, nthreads) : cobj.linear_interpolate_at(qv);
-      // copy the results to Python arrays and return
-      auto valout = iid2np(valres, cobj.data().values(),  preshape);
-      auto vecout = iid2np(vecres, cobj.data().vectors(), preshape);
+      {
+        // the C++ interpolation only reads cobj, so other Python threads can run
+        // (the exception thrown on failure reacquires the GIL as it propagates)
+        py::gil_scoped_release release;
+        if (moveinto){
+          // qv references the Python array, so the moved points need their own
+          LQVec<double> Qv(lat, qv.size()); // filled by moveinto
+          LQVec<int>  tauv(lat, qv.size()); // filled by moveinto
+          bool success = b.moveinto(qv,Qv,tauv,nthreads);
+          if (!success)
+            throw std::runtime_error("failed to move all Q into the first Brillouin Zone");
+          qv = std::move(Qv);
+        }
+        // perform the interpolation and rotate and vectors/tensors afterwards
+        std::tie(valres, vecres) = useparallel ?  cobj.parallel_linear_interpolate_at(qv, nthreads) : cobj.linear_interpolate_at(qv);
+      }
+      // hand the result data to Python arrays and return
+      auto valout = iid2np(std::move(valres), cobj.data().values(),  preshape);
+      auto vecout = iid2np(std::move(vecres), cobj.data().vectors(), preshape);
       return std::make_tuple(valout, vecout);
     },"Q"_a,"moveinto"_a=true,"useparallel"_a=false,"threads"_a=-1)
     //
-    .def("ir_interpolate_at",[](Class& cobj,
-                             py::array_t<double> pyX,
+    .def("ir_interpolate_at",[](const Class& cobj,
+                             py::array_t<double, py::array::c_style|py::array::forcecast> pyX,
                              const bool& useparallel,
-                             const int& threads, const bool& no_move){
+                             const int& threads, const bool& no_move, const bool& dedupe){
       py::buffer_info bi = pyX.request();
       if ( bi.shape[bi.ndim-1] !=3 )
         throw std::runtime_error("Interpolation requires one or more 3-vectors");
       // store shape of X before three-vector dimension for shaping output
       std::vector<ssize_t> preshape;
       for (ssize_t i=0; i < bi.ndim-1; ++i) preshape.push_back(bi.shape[i]);
-      // copy the Python X array
+      // reference the (C-contiguous) Python X array without copying
       BrillouinZone b = cobj.get_brillouinzone();
       Reciprocal lat = b.get_lattice();
-      LQVec<double> qv(lat,(double*)bi.ptr, bi.shape, bi.strides); //memcopy
+      LQVec<double> qv(lat, np2av_view(pyX));
       // perform the interpolation and rotate and vectors/tensors afterwards
       const int maxth(static_cast<int>(std::thread::hardware_concurrency()));
       int nthreads = (useparallel) ? ((threads < 1) ? maxth : threads) : 1;
       ArrayVector<T> valres;
       ArrayVector<R> vecres;
-      std::tie(valres, vecres) = cobj.ir_interpolate_at(qv, nthreads, no_move);
-      // copy results to Python arrays and return
-      auto valout = iid2np(valres, cobj.data().values(),  preshape);
-      auto vecout = iid2np(vecres, cobj.data().vectors(), preshape);
+      {
+        // the C++ interpolation only reads cobj, so other Python threads can run
+        py::gil_scoped_release release;
+        std::tie(valres, vecres) = cobj.ir_interpolate_at(qv, nthreads, no_move, dedupe);
+      }
+      // hand the result data to Python arrays and return
+      auto valout = iid2np(std::move(valres), cobj.data().values(),  preshape);
+      auto vecout = iid2np(std::move(vecres), cobj.data().vectors(), preshape);
       return std::make_tuple(valout, vecout);
-    },"Q"_a,"useparallel"_a=false,"threads"_a=-1,"do_not_move_points"_a=false)
+    },"Q"_a,"useparallel"_a=false,"threads"_a=-1,"do_not_move_points"_a=false,"deduplicate"_a=false)
+
+    // points already moved into the irreducible zone, see brille.PreparedQ
+    .def("ir_interpolate_at",[](const Class& cobj, const PyPreparedQ& prepared,
+                             const bool& useparallel, const int& threads){
+      const int maxth(static_cast<int>(std::thread::hardware_concurrency()));
+      int nthreads = (useparallel) ? ((threads < 1) ? maxth : threads) : 1;
+      ArrayVector<T> valres;
+      ArrayVector<R> vecres;
+      {
+        py::gil_scoped_release release;
+        std::tie(valres, vecres) = cobj.ir_interpolate_at(prepared, nthreads);
+      }
+      auto valout = iid2np(std::move(valres), cobj.data().values(),  prepared.preshape());
+      auto vecout = iid2np(std::move(vecres), cobj.data().vectors(), prepared.preshape());
+      return std::make_tuple(valout, vecout);
+    },"Q"_a,"useparallel"_a=false,"threads"_a=-1)
     //
     // .def("sum_data",[](Class& cobj, const int axis, const bool squeeze){
     //   return av2np_shape( cobj.sum_data(axis), cobj.data_shape(), squeeze);
@@ -236,7 +274,7 @@ void declare_bzgridq(py::module &m, const std::string &typestr) {
       py::tuple ret = py::make_tuple(flg, cobj.sub2map(subidx));
       return ret;
     },"x"_a,"isrlu"_a=true)
-    .def("debye_waller",[](Class& cobj, py::array_t<double> pyQ, py::array_t<double> pyM, double temp_k){
+    .def("debye_waller",[](const Class& cobj, py::array_t<double, py::array::c_style|py::array::forcecast> pyQ, py::array_t<double> pyM, double temp_k){
       // handle Q
       py::buffer_info bi = pyQ.request();
       if ( bi.shape[bi.ndim-1] !=3 )
@@ -245,7 +283,7 @@ void declare_bzgridq(py::module &m, const std::string &typestr) {
       // if (bi.ndim > 1) for (ssize_t i=0; i<bi.ndim-1; i++) npts *= bi.shape[i];
       BrillouinZone b = cobj.get_brillouinzone();
       Reciprocal lat = b.get_lattice();
-      LQVec<double> cQ(lat, (double*)bi.ptr, bi.shape, bi.strides); //memcopy
+      LQVec<double> cQ(lat, np2av_view(pyQ));
       // handle the masses
       py::buffer_info mi = pyM.request();
       if ( mi.ndim != 1u )
@@ -254,7 +292,12 @@ void declare_bzgridq(py::module &m, const std::string &typestr) {
       std::vector<double> masses(mi.shape[0]);
       double * mass_ptr = (double*) mi.ptr;
       for (size_t i=0; i<static_cast<size_t>(mi.shape[0]); ++i) masses.push_back(mass_ptr[i*span]);
-      return av2np_squeeze(cobj.debye_waller(cQ, masses, temp_k));
+      ArrayVector<double> dw;
+      {
+        py::gil_scoped_release release;
+        dw = cobj.debye_waller(cQ, masses, temp_k);
+      }
+      return av2np_squeeze(dw);
     }, "Q"_a, "masses"_a, "Temperature_in_K"_a);
 }
 
@@ -3,16 +3,64 @@
 
 #include <pybind11/pybind11.h>
 #include "interpolation_data.hpp"
+#include "interpolation_cache.hpp"
 #include "phonon.hpp"
 #include "utilities.hpp"
 
+/*! \brief Copy, or reference, an array provided to `fill`
+
+@param pyarray the (n, …) numpy.ndarray of data for n vertices
+@param copy if false and pyarray is C-contiguous, the returned ArrayVector
+            borrows its data rather than copying it
+*/
+template<class T>
+ArrayVector<T> fill_array(py::array_t<T> pyarray, const bool copy){
+  py::buffer_info bi = pyarray.request();
+  if (!copy && bi.ndim > 0 && (pyarray.flags() & py::array::c_style)){
+    size_t m{1};
+    for (ssize_t i=1; i<bi.ndim; ++i) m *= signed_to_unsigned<size_t>(bi.shape[i]);
+    return ArrayVector<T>::borrow((T*) bi.ptr, m, signed_to_unsigned<size_t>(bi.shape[0]));
+  }
+  return ArrayVector<T>((T*) bi.ptr, bi.shape, bi.strides);
+}
+
+/*! \brief Keep numpy arrays referenced by a filled interpolator alive
+
+After `fill(…, copy=False)` the interpolator may reference the provided
+numpy data directly. Each borrowed array is stored as an attribute of the
+Python object holding the interpolator, so that it lives at least as long as
+the interpolator, and is made read-only so that it can not be changed behind
+the interpolator's back.
+
+Call this *before* replacing the interpolator data: if the replacement throws
+part way the interpolator may still reference the previously borrowed arrays,
+so those are only dropped by `release_replaced_fill_arrays` once both the
+values and vectors have been replaced.
+*/
+template<class T, class R>
+void keep_fill_arrays(py::object self, py::array_t<T> values, const bool values_borrowed,
+                      py::array_t<R> vectors, const bool vectors_borrowed){
+  if (values_borrowed) values.attr("flags").attr("writeable") = false;
+  if (vectors_borrowed) vectors.attr("flags").attr("writeable") = false;
+  py::list replaced = py::hasattr(self, "_replaced_borrowed") ? py::list(self.attr("_replaced_borrowed")) : py::list();
+  if (py::hasattr(self, "_borrowed_values")) replaced.append(self.attr("_borrowed_values"));
+  if (py::hasattr(self, "_borrowed_vectors")) replaced.append(self.attr("_borrowed_vectors"));
+  self.attr("_replaced_borrowed") = replaced;
+  self.attr("_borrowed_values") = values_borrowed ? py::object(values) : py::none();
+  self.attr("_borrowed_vectors") = vectors_borrowed ? py::object(vectors) : py::none();
+}
+//! Drop references to arrays borrowed before a successful `fill`
+inline void release_replaced_fill_arrays(py::object self){
+  self.attr("_replaced_borrowed") = py::list();
+}
+
 template<class T>
 std::tuple< ArrayVector<T>, std::vector<size_t>, std::array<element_t,3>, RotatesLike >
-fill_check(py::array_t<T> pyarray, py::array_t<int> pyel, const size_t count){
+fill_check(py::array_t<T> pyarray, py::array_t<int> pyel, const size_t count, const bool copy=true){
   py::buffer_info bi;
-  // copy-over the N-D array information
+  // copy-over (or reference) the N-D array information
   bi = pyarray.request();
-  ArrayVector<T> data( (T*) bi.ptr, bi.shape, bi.strides);
+  ArrayVector<T> data = fill_array(pyarray, copy);
   if (count != data.size()){
     std::string msg;
     msg = "Provided " + std::to_string(data.size()) + " arrays but ";
@@ -38,16 +86,16 @@ fill_check(py::array_t<T> pyarray, py::array_t<int> pyel, const size_t count){
     default: throw std::runtime_error("Unknown RotatesLike value "+std::to_string(intel[3]));
   }
   // tie everything up
-  return std::make_tuple(data, shape, el, rl);
+  return std::make_tuple(std::move(data), shape, el, rl);
 }
 
 template<class T>
 std::tuple< ArrayVector<T>, std::vector<size_t>, std::array<element_t,3>, RotatesLike, int, int, std::array<double,3>>
-fill_check(py::array_t<T> pyarray, py::array_t<int> pyel, py::array_t<double> pywght, const size_t count){
+fill_check(py::array_t<T> pyarray, py::array_t<int> pyel, py::array_t<double> pywght, const size_t count, const bool copy=true){
   py::buffer_info bi;
-  // copy-over the N-D array information
+  // copy-over (or reference) the N-D array information
   bi = pyarray.request();
-  ArrayVector<T> data( (T*) bi.ptr, bi.shape, bi.strides);
+  ArrayVector<T> data = fill_array(pyarray, copy);
   if (count != data.size()){
     std::string msg;
     msg = "Provided " + std::to_string(data.size()) + " arrays but ";
@@ -83,12 +131,12 @@ fill_check(py::array_t<T> pyarray, py::array_t<int> pyel, py::array_t<double> py
   double *dblwght = (double*) bi.ptr;
   for (ssize_t i=0; i<bi.shape[0] && i<3; ++i) wght[i] = dblwght[i];
   // tie everything up
-  return std::make_tuple(data, shape, el, rl, csf, cvf, wght);
+  return std::make_tuple(std::move(data), shape, el, rl, csf, cvf, wght);
 }
 
 template<class T>
-py::array_t<T,py::array::c_style>
-iid2np(const ArrayVector<T>& av, const InnerInterpolationData<T>& iid, const std::vector<ssize_t>& preshape){
+std::vector<ssize_t>
+iid2np_shape(const ArrayVector<T>& av, const InnerInterpolationData<T>& iid, const std::vector<ssize_t>& preshape){
   std::vector<ssize_t> shape;
   std::copy(preshape.begin(), preshape.end(), std::back_inserter(shape));
   if (iid.shape().size()>1){
@@ -107,6 +155,13 @@ iid2np(const ArrayVector<T>& av, const InnerInterpolationData<T>& iid, const std
     msg += ") vs ("+std::to_string(av.numel())+" x "+std::to_string(av.size())+")]";
     throw std::runtime_error(msg);
   }
+  return shape;
+}
+
+template<class T>
+py::array_t<T,py::array::c_style>
+iid2np(const ArrayVector<T>& av, const InnerInterpolationData<T>& iid, const std::vector<ssize_t>& preshape){
+  std::vector<ssize_t> shape = iid2np_shape(av, iid, preshape);
   auto out = py::array_t<T,py::array::c_style>(shape);
   T *ptr = (T*) out.request().ptr;
   for (size_t i=0; i<av.size(); ++i) for (size_t j=0; j<av.numel(); ++j)
@@ -114,4 +169,80 @@ iid2np(const ArrayVector<T>& av, const InnerInterpolationData<T>& iid, const std
   return out;
 }
 
+//! Return interpolated results to Python by taking their data, without a copy
+template<class T>
+py::array_t<T,py::array::c_style>
+iid2np(ArrayVector<T>&& av, const InnerInterpolationData<T>& iid, const std::vector<ssize_t>& preshape){
+  std::vector<ssize_t> shape = iid2np_shape(av, iid, preshape);
+  return av2np_adopt(std::move(av), shape);
+}
+
+/*! \brief Add `memory_usage` to a wrapped interpolator
+
+The Python method returns the bytes held by the interpolator, broken down by
+category, as a dict which also contains their total.
+*/
+template<class C> void def_memory_usage(py::class_<C>& cls){
+  cls.def("memory_usage",[](const C& cobj){
+    MemoryUsage m = cobj.memory_usage();
+    py::dict out;
+    out["vertices"] = m.vertices;
+    out["nodes"] = m.nodes;
+    out["circumspheres"] = m.circumspheres;
+    out["values"] = m.values;
+    out["vectors"] = m.vectors;
+    out["auxiliary"] = m.auxiliary;
+    out["borrowed"] = m.borrowed;
+    out["total"] = m.total();
+    return out;
+  }, R"pbdoc(
+    The number of bytes held by this object, by category
+
+    Returns
+    -------
+    dict
+      Bytes used for ``vertices``; the ``nodes``, tetrahedra, or connectivity
+      tables; ``circumspheres``; interpolation ``values`` and ``vectors``;
+      ``auxiliary`` information like bin boundaries and barycentric
+      transforms; and the ``total``. ``borrowed`` is the part of ``values``
+      and ``vectors`` which references memory not owned by this object, e.g.,
+      after ``fill(..., copy=False)`` or ``brille.shared.attach``.
+  )pbdoc");
+}
+
+/*! \brief Add the result cache methods to a wrapped Brillouin zone interpolator
+
+See InterpolationCache. The Python `cache_statistics` property is a dict.
+*/
+template<class C> void def_cache(py::class_<C>& cls){
+  using namespace pybind11::literals;
+  cls.def("set_cache", &C::set_cache, "capacity"_a, "resolution"_a=1e-10, R"pbdoc(
+    Keep the interpolated results for recently used irreducible points
+
+    Later ``ir_interpolate_at`` calls reuse the unrotated results for any
+    point within about `resolution` of a kept point, skipping its location and
+    interpolation. All kept results are dropped when the data is replaced.
+
+    Parameters
+    ----------
+    capacity : int
+      The maximum number of points to keep, 0 disables the cache
+    resolution : float, optional
+      The spacing, in inverse angstrom, of the grid used to match points
+  )pbdoc");
+  cls.def("clear_cache", &C::clear_cache, "Drop all kept results and zero the cache statistics");
+  cls.def_property_readonly("cache_statistics", [](const C& cobj){
+    CacheStatistics c = cobj.cache_statistics();
+    py::dict out;
+    out["hits"] = c.hits;
+    out["misses"] = c.misses;
+    out["evictions"] = c.evictions;
+    out["invalidations"] = c.invalidations;
+    out["size"] = c.size;
+    out["capacity"] = c.capacity;
+    out["bytes"] = c.bytes;
+    return out;
+  }, "The cache ``hits``, ``misses``, ``evictions``, ``invalidations``, ``size``, ``capacity``, and ``bytes``");
+}
+
 #endif
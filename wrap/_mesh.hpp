@@ -25,6 +25,8 @@
 
 #include "_c_to_python.hpp"
 #include "_interpolation_data.hpp"
+#include "_prepared_q.hpp"
+#include "_serialize.hpp"
 #include "bz_mesh.hpp"
 #include "utilities.hpp"
 
@@ -37,7 +39,12 @@ void declare_bzmeshq(py::module &m, const std::string &typestr){
   using namespace pybind11::literals;
   using Class = BrillouinZoneMesh3<T,R>;
   std::string pyclass_name = std::string("BZMeshQ")+typestr;
-  py::class_<Class>(m, pyclass_name.c_str(), py::buffer_protocol(), py::dynamic_attr())
+  py::class_<Class> cls(m, pyclass_name.c_str(), py::buffer_protocol(), py::dynamic_attr());
+  // flat binary serialization, e.g., into shared memory (see brille.shared), and pickling
+  def_serialization(cls);
+  def_memory_usage(cls);
+  def_cache(cls);
+  cls
   // Initializer (BrillouinZone, max-volume, is-volume-rlu)
   .def(py::init<BrillouinZone,double,int,int>(), "brillouinzone"_a, "max_size"_a=-1., "num_levels"_a=3, "max_points"_a=-1)
   .def_property_readonly("BrillouinZone",[](const Class& cobj){return cobj.get_brillouinzone();})
@@ -45,22 +52,26 @@ void declare_bzmeshq(py::module &m, const std::string &typestr){
   .def_property_readonly("invA",[](const Class& cobj){return av2np(cobj.get_mesh_xyz());})
   .def_property_readonly("tetrahedra",[](const Class& cobj){return av2np(cobj.get_mesh_tetrehedra());})
 
-  .def("fill",[](Class& cobj,
+  .def("fill",[](py::object self,
     py::array_t<T> pyvals, py::array_t<int, py::array::c_style> pyvalelrl,
-    py::array_t<R> pyvecs, py::array_t<int, py::array::c_style> pyvecelrl
+    py::array_t<R> pyvecs, py::array_t<int, py::array::c_style> pyvecelrl, const bool copy
   ){
+    Class& cobj = self.cast<Class&>();
     ArrayVector<T> vals;
     ArrayVector<R> vecs;
     std::vector<size_t> val_sh, vec_sh;
     std::array<element_t, 3> val_el{{0,0,0}}, vec_el{{0,0,0}};
     RotatesLike val_rl, vec_rl;
     size_t count = cobj.size();
-    std::tie(vals,val_sh,val_el,val_rl)=fill_check(pyvals,pyvalelrl,count);
-    std::tie(vecs,vec_sh,vec_el,vec_rl)=fill_check(pyvecs,pyvecelrl,count);
+    std::tie(vals,val_sh,val_el,val_rl)=fill_check(pyvals,pyvalelrl,count,copy);
+    std::tie(vecs,vec_sh,vec_el,vec_rl)=fill_check(pyvecs,pyvecelrl,count,copy);
 
-    cobj.replace_value_data(vals, val_sh, val_el, val_rl);
-    cobj.replace_vector_data(vecs, vec_sh, vec_el, vec_rl);
-  }, "values_data"_a, "values_elements"_a, "vectors_data"_a, "vectors_elements"_a)
+    bool val_borrowed{vals.is_borrowed()}, vec_borrowed{vecs.is_borrowed()};
+    keep_fill_arrays(self, pyvals, val_borrowed, pyvecs, vec_borrowed);
+    cobj.replace_value_data(std::move(vals), val_sh, val_el, val_rl);
+    cobj.replace_vector_data(std::move(vecs), vec_sh, vec_el, vec_rl);
+    release_replaced_fill_arrays(self);
+  }, "values_data"_a, "values_elements"_a, "vectors_data"_a, "vectors_elements"_a, "copy"_a=true)
 
   .def_property_readonly("values",[](Class& cobj){
     const auto & v{cobj.data().values()};
@@ -81,33 +92,77 @@ void declare_bzmeshq(py::module &m, const std::string &typestr){
      "vector_weight_function"_a=0
   )
 
-  .def("ir_interpolate_at",[](Class& cobj,
-                           py::array_t<double> pyX,
+  .def("ir_interpolate_at",[](const Class& cobj,
+                           py::array_t<double, py::array::c_style|py::array::forcecast> pyX,
                            const bool& useparallel,
-                           const int& threads, const bool& no_move){
+                           const int& threads, const bool& no_move, const bool& dedupe){
     py::buffer_info bi = pyX.request();
     if ( bi.shape[bi.ndim-1] !=3 )
       throw std::runtime_error("Interpolation requires one or more 3-vectors");
     // store shape of X before three-vector dimension for shaping output
     std::vector<ssize_t> preshape;
     for (ssize_t i=0; i < bi.ndim-1; ++i) preshape.push_back(bi.shape[i]);
-    // copy the Python X array
+    // reference the (C-contiguous) Python X array without copying
     BrillouinZone b = cobj.get_brillouinzone();
     Reciprocal lat = b.get_lattice();
-    LQVec<double> qv(lat,(double*)bi.ptr, bi.shape, bi.strides); //memcopy
+    LQVec<double> qv(lat, np2av_view(pyX));
     // perform the interpolation and rotate and vectors/tensors afterwards
     const int maxth(static_cast<int>(std::thread::hardware_concurrency()));
     int nthreads = (useparallel) ? ((threads < 1) ? maxth : threads) : 1;
     ArrayVector<T> valres;
     ArrayVector<R> vecres;
-    std::tie(valres, vecres) = cobj.ir_interpolate_at(qv, nthreads, no_move);
-    // copy results to Python arrays and return
-    py::array_t<T, py::array::c_style> valout = iid2np(valres, cobj.data().values(),  preshape);
-    py::array_t<R, py::array::c_style> vecout = iid2np(vecres, cobj.data().vectors(), preshape);
+    {
+      // the C++ interpolation only reads cobj, so other Python threads can run
+      py::gil_scoped_release release;
+      std::tie(valres, vecres) = cobj.ir_interpolate_at(qv, nthreads, no_move, dedupe);
+    }
+    // hand the result data to Python arrays and return
+    py::array_t<T, py::array::c_style> valout = iid2np(std::move(valres), cobj.data().values(),  preshape);
+    py::array_t<R, py::array::c_style> vecout = iid2np(std::move(vecres), cobj.data().vectors(), preshape);
     return std::make_tuple(valout, vecout);
-  },"Q"_a,"useparallel"_a=false,"threads"_a=-1,"do_not_move_points"_a=false)
+  },"Q"_a,"useparallel"_a=false,"threads"_a=-1,"do_not_move_points"_a=false,"deduplicate"_a=false)
 
-  .def("debye_waller",[](Class& cobj, py::array_t<double> pyQ, py::array_t<double> pyM, double temp_k){
+  // points already moved into the irreducible zone, see brille.PreparedQ
+  .def("ir_interpolate_at",[](const Class& cobj, const PyPreparedQ& prepared,
+                           const bool& useparallel, const int& threads){
+    const int maxth(static_cast<int>(std::thread::hardware_concurrency()));
+    int nthreads = (useparallel) ? ((threads < 1) ? maxth : threads) : 1;
+    ArrayVector<T> valres;
+    ArrayVector<R> vecres;
+    {
+      py::gil_scoped_release release;
+      std::tie(valres, vecres) = cobj.ir_interpolate_at(prepared, nthreads);
+    }
+    py::array_t<T, py::array::c_style> valout = iid2np(std::move(valres), cobj.data().values(),  prepared.preshape());
+    py::array_t<R, py::array::c_style> vecout = iid2np(std::move(vecres), cobj.data().vectors(), prepared.preshape());
+    return std::make_tuple(valout, vecout);
+  },"Q"_a,"useparallel"_a=false,"threads"_a=-1)
+
+  // locate prepared points once, for repeated interpolation of replaced data
+  .def("ir_plan",[](const Class& cobj, const PyPreparedQ& prepared,
+                    const bool& with_permutations, const bool& useparallel, const int& threads){
+    const int maxth(static_cast<int>(std::thread::hardware_concurrency()));
+    int nthreads = (useparallel) ? ((threads < 1) ? maxth : threads) : 1;
+    py::gil_scoped_release release;
+    return PyInterpolationPlan(cobj.ir_plan(prepared, nthreads, with_permutations), prepared.preshape());
+  },"Q"_a,"with_permutations"_a=false,"useparallel"_a=false,"threads"_a=-1)
+
+  .def("ir_execute",[](const Class& cobj, const PyPreparedQ& prepared, const PyInterpolationPlan& plan,
+                       const bool& useparallel, const int& threads){
+    const int maxth(static_cast<int>(std::thread::hardware_concurrency()));
+    int nthreads = (useparallel) ? ((threads < 1) ? maxth : threads) : 1;
+    ArrayVector<T> valres;
+    ArrayVector<R> vecres;
+    {
+      py::gil_scoped_release release;
+      std::tie(valres, vecres) = cobj.ir_execute(prepared, plan, nthreads);
+    }
+    py::array_t<T, py::array::c_style> valout = iid2np(std::move(valres), cobj.data().values(),  prepared.preshape());
+    py::array_t<R, py::array::c_style> vecout = iid2np(std::move(vecres), cobj.data().vectors(), prepared.preshape());
+    return std::make_tuple(valout, vecout);
+  },"Q"_a,"plan"_a,"useparallel"_a=false,"threads"_a=-1)
+
+  .def("debye_waller",[](const Class& cobj, py::array_t<double, py::array::c_style|py::array::forcecast> pyQ, py::array_t<double> pyM, double temp_k){
     // handle Q
     py::buffer_info bi = pyQ.request();
     if ( bi.shape[bi.ndim-1] !=3 )
@@ -116,7 +171,7 @@ void declare_bzmeshq(py::module &m, const std::string &typestr){
     // if (bi.ndim > 1) for (ssize_t i=0; i<bi.ndim-1; i++) npts *= bi.shape[i];
     BrillouinZone b = cobj.get_brillouinzone();
     Reciprocal lat = b.get_lattice();
-    LQVec<double> cQ(lat, (double*)bi.ptr, bi.shape, bi.strides); //memcopy
+    LQVec<double> cQ(lat, np2av_view(pyQ));
     // handle the masses
     py::buffer_info mi = pyM.request();
     if ( mi.ndim != 1u )
@@ -125,7 +180,12 @@ void declare_bzmeshq(py::module &m, const std::string &typestr){
     std::vector<double> masses(mi.shape[0]);
     double * mass_ptr = (double*) mi.ptr;
     for (size_t i=0; i<static_cast<size_t>(mi.shape[0]); ++i) masses.push_back(mass_ptr[i*span]);
-    return av2np_squeeze(cobj.debye_waller(cQ, masses, temp_k));
+    ArrayVector<double> dw;
+    {
+      py::gil_scoped_release release;
+      dw = cobj.debye_waller(cQ, masses, temp_k);
+    }
+    return av2np_squeeze(dw);
   }, "Q"_a, "masses"_a, "Temperature_in_K"_a)
   .def("__repr__",&Class::to_string);
 }
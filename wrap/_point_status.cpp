@@ -0,0 +1,33 @@
+/* Copyright 2020 Greg Tucker
+//
+// This file is part of brille.
+//
+// brille is free software: you can redistribute it and/or modify it under the
+// terms of the GNU Affero General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// brille is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with brille. If not, see <https://www.gnu.org/licenses/>.            */
+#include <pybind11/pybind11.h>
+#include "point_status.hpp"
+
+namespace py = pybind11;
+
+void wrap_point_status(py::module & m){
+  py::enum_<PointStatus> enm(m, "PointStatus", py::arithmetic(), R"pbdoc(
+    The per-point outcome codes returned by ``interpolate_at(..., return_status=True)``
+
+    The returned status array holds the integer value of each code, so failed
+    points can be found with, e.g., ``status >= PointStatus.not_found``.
+  )pbdoc");
+  enm.value("found", PointStatus::found);
+  enm.value("nudged", PointStatus::nudged);
+  enm.value("not_found", PointStatus::not_found);
+  enm.value("fold_failed", PointStatus::fold_failed);
+}
@@ -0,0 +1,112 @@
+/* Copyright 2020 Greg Tucker
+//
+// This file is part of brille.
+//
+// brille is free software: you can redistribute it and/or modify it under the
+// terms of the GNU Affero General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// brille is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with brille. If not, see <https://www.gnu.org/licenses/>.            */
+#include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
+#include <thread>
+#include "_c_to_python.hpp"
+#include "_prepared_q.hpp"
+
+namespace py = pybind11;
+
+void wrap_prepared_q(py::module & m){
+  using namespace pybind11::literals;
+  py::class_<PyPreparedQ> cls(m, "PreparedQ", R"pbdoc(
+    Q points moved into the irreducible Brillouin zone once, for reuse
+
+    Moving points into the irreducible Brillouin zone is often the largest
+    single cost of ``ir_interpolate_at``. A ``PreparedQ`` can instead be passed
+    to the ``ir_interpolate_at`` method of any ``BZTrellisQ``, ``BZNestQ``,
+    ``BZMeshQ``, or ``BZGridQ`` built on the same Brillouin zone.
+
+    Parameters
+    ----------
+    brillouinzone : :py:class:`BrillouinZone`
+      The zone shared by the interpolators which will use the points
+    Q : numpy.ndarray
+      The points, in relative lattice units, with shape ``(..., 3)``
+    useparallel : bool, optional
+      Move the points using OpenMP threads
+    threads : int, optional
+      The number of threads to use, all available if less than one
+    gamma_table : bool, optional
+      Also prepare the table used to rotate phonon eigenvectors
+    do_not_move_points : bool, optional
+      For testing, take the points as already within the irreducible zone
+    deduplicate : bool, optional
+      Interpolate points which are equivalent within the irreducible zone only
+      once, copying the results to each before rotation
+  )pbdoc");
+  cls.def(py::init([](const BrillouinZone& bz,
+                      py::array_t<double, py::array::c_style|py::array::forcecast> pyX,
+                      const bool useparallel, const int threads,
+                      const bool gamma_table, const bool no_move, const bool dedupe){
+    py::buffer_info bi = pyX.request();
+    if ( bi.shape[bi.ndim-1] !=3 )
+      throw std::runtime_error("PreparedQ requires one or more 3-vectors");
+    std::vector<ssize_t> preshape;
+    for (ssize_t i=0; i < bi.ndim-1; ++i) preshape.push_back(bi.shape[i]);
+    LQVec<double> qv(bz.get_lattice(), np2av_view(pyX));
+    const int maxth(static_cast<int>(std::thread::hardware_concurrency()));
+    int nthreads = (useparallel) ? ((threads < 1) ? maxth : threads) : 1;
+    py::gil_scoped_release release;
+    return PyPreparedQ(PreparedQ(bz, qv, nthreads, gamma_table, no_move, dedupe), preshape);
+  }), "brillouinzone"_a, "Q"_a, "useparallel"_a=false, "threads"_a=-1, "gamma_table"_a=false, "do_not_move_points"_a=false, "deduplicate"_a=false);
+
+  cls.def("__len__", &PyPreparedQ::size);
+  cls.def_property_readonly("ir_q", [](const PyPreparedQ& p){
+    std::vector<ssize_t> shape{p.preshape()};
+    shape.push_back(3);
+    return av2np_adopt(ArrayVector<double>(p.ir_q()), shape);
+  }, "The points within the irreducible Brillouin zone");
+  cls.def_property_readonly("tau", [](const PyPreparedQ& p){
+    std::vector<ssize_t> shape{p.preshape()};
+    shape.push_back(3);
+    return av2np_adopt(ArrayVector<int>(p.tau()), shape);
+  }, "The zone centre of each point");
+  cls.def_property_readonly("rotations", [](const PyPreparedQ& p){
+    return sv2np(p.preshape(), p.rotations());
+  }, "The pointgroup operation index taking each irreducible point to its Q");
+  cls.def_property_readonly("inverse_rotations", [](const PyPreparedQ& p){
+    return sv2np(p.preshape(), p.inverse_rotations());
+  });
+  cls.def_property_readonly("status", [](const PyPreparedQ& p){
+    return status2np(p.preshape(), p.status());
+  }, "The PointStatus of each point after moving it into the irreducible zone");
+  cls.def_property_readonly("unique_count", &PyPreparedQ::unique_count,
+    "The number of distinct irreducible points which are interpolated");
+  cls.def("matches", &PyPreparedQ::matches, "brillouinzone"_a,
+    "Whether the points were prepared for the given Brillouin zone");
+
+  py::class_<PyInterpolationPlan> plan(m, "InterpolationPlan", R"pbdoc(
+    The located vertices and weights for a fixed set of prepared points
+
+    Made by the ``ir_plan`` method of a ``BZTrellisQ``, ``BZNestQ``, or
+    ``BZMeshQ`` and executed by its ``ir_execute`` method, a plan remains valid
+    while the interpolation data is replaced, e.g., by ``fill``. Only plans made
+    ``with_permutations`` store the branch permutations, which are otherwise
+    found for the current data on each execution.
+  )pbdoc");
+  plan.def("__len__", &PyInterpolationPlan::size);
+  plan.def_property_readonly("vertex_count", &PyInterpolationPlan::vertex_count,
+    "The number of vertices of the interpolator the plan was made for");
+  plan.def_property_readonly("has_permutations", &PyInterpolationPlan::has_permutations);
+  plan.def_property_readonly("status", [](const PyInterpolationPlan& p){
+    return status2np(p.preshape(), p.status());
+  }, "The PointStatus of each point after locating it");
+  plan.def_property_readonly("memory_bytes", &PyInterpolationPlan::memory_bytes,
+    "The bytes held by the plan");
+}
@@ -0,0 +1,44 @@
+/* Copyright 2020 Greg Tucker
+//
+// This file is part of brille.
+//
+// brille is free software: you can redistribute it and/or modify it under the
+// terms of the GNU Affero General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// brille is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with brille. If not, see <https://www.gnu.org/licenses/>.            */
+#ifndef __PREPARED_Q_H
+#define __PREPARED_Q_H
+
+#include <pybind11/pybind11.h>
+#include <utility>
+#include <vector>
+#include "prepared_q.hpp"
+#include "interpolation_plan.hpp"
+
+namespace py = pybind11;
+
+//! A PreparedQ which remembers the shape of the Python array of points, for shaping results
+class PyPreparedQ: public PreparedQ{
+  std::vector<ssize_t> preshape_;
+public:
+  PyPreparedQ(PreparedQ&& p, std::vector<ssize_t> preshape): PreparedQ(std::move(p)), preshape_(std::move(preshape)) {}
+  const std::vector<ssize_t>& preshape() const {return preshape_;}
+};
+
+//! An InterpolationPlan which remembers the shape of the prepared points it was made for
+class PyInterpolationPlan: public InterpolationPlan{
+  std::vector<ssize_t> preshape_;
+public:
+  PyInterpolationPlan(InterpolationPlan&& p, std::vector<ssize_t> preshape): InterpolationPlan(std::move(p)), preshape_(std::move(preshape)) {}
+  const std::vector<ssize_t>& preshape() const {return preshape_;}
+};
+
+#endif
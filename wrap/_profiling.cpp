@@ -0,0 +1,64 @@
+/* Copyright 2020 Greg Tucker
+//
+// This file is part of brille.
+//
+// brille is free software: you can redistribute it and/or modify it under the
+// terms of the GNU Affero General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// brille is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with brille. If not, see <https://www.gnu.org/licenses/>.            */
+#include <pybind11/pybind11.h>
+#include "profiling.hpp"
+
+namespace py = pybind11;
+
+void wrap_profiling(py::module & m){
+  using namespace pybind11::literals;
+
+  m.def("set_profiling", &Profile::enable, "enabled"_a, R"pbdoc(
+    Enable or disable timing and counting of the interpolation pipeline
+
+    Profiling is disabled by default and, while disabled, costs next to nothing.
+  )pbdoc");
+
+  m.def("profiling_enabled", &Profile::enabled);
+
+  m.def("profile", [](const bool cumulative){
+    Profile::Snapshot snap = Profile::snapshot(cumulative);
+    py::dict seconds, counts;
+    for (size_t i=0; i<Profile::n_stages; ++i)
+      seconds[Profile::name(static_cast<ProfileStage>(i)).c_str()] = static_cast<double>(snap.nanoseconds[i])*1e-9;
+    for (size_t i=0; i<Profile::n_counters; ++i)
+      counts[Profile::name(static_cast<ProfileCounter>(i)).c_str()] = snap.counts[i];
+    py::dict out;
+    out["seconds"] = seconds;
+    out["counts"] = counts;
+    return out;
+  }, "cumulative"_a=false, R"pbdoc(
+    The profile of the last interpolation call, or of all calls
+
+    Parameters
+    ----------
+    cumulative : bool, optional
+      Return the totals since profiling was enabled or last reset, instead of
+      the record of the most recent `interpolate_at` or `ir_interpolate_at`.
+
+    Returns
+    -------
+    dict
+      ``'seconds'`` maps each stage -- ``moveinto``, ``ir_moveinto``,
+      ``locate``, ``permute``, ``sum``, and ``rotate`` -- to its time summed
+      over all OpenMP threads; ``'counts'`` maps ``points``,
+      ``permutation_solves``, ``boundary_retries``, and ``not_found`` to their
+      totals.
+  )pbdoc");
+
+  m.def("reset_profile", &Profile::reset, "Zero the last-call and cumulative profiles");
+}
@@ -0,0 +1,124 @@
+/* Copyright 2020 Greg Tucker
+//
+// This file is part of brille.
+//
+// brille is free software: you can redistribute it and/or modify it under the
+// terms of the GNU Affero General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// brille is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with brille. If not, see <https://www.gnu.org/licenses/>.            */
+#ifndef __SERIALIZE_H
+#define __SERIALIZE_H
+
+#include <pybind11/pybind11.h>
+#include <utility>
+#include "serialize.hpp"
+
+namespace py = pybind11;
+
+// The number of contiguous bytes in a Python buffer, which must be C-contiguous
+static size_t contiguous_buffer_bytes(const py::buffer_info& bi){
+  ssize_t expected{bi.itemsize};
+  for (ssize_t i=bi.ndim; i--;){
+    if (bi.shape[i] > 1 && bi.strides[i] != expected)
+      throw std::runtime_error("A C-contiguous buffer is required");
+    expected *= bi.shape[i];
+  }
+  return static_cast<size_t>(expected);
+}
+
+// The number of bytes `serialize_into` will write for an object
+template<class C> size_t serialized_size(const C& cobj){
+  BinaryWriter counter;
+  cobj.serialize(counter);
+  return counter.size();
+}
+
+// Write an object into a writable Python buffer, returning the bytes written
+template<class C> size_t serialize_into(const C& cobj, py::buffer buffer){
+  py::buffer_info bi = buffer.request(true);
+  size_t capacity = contiguous_buffer_bytes(bi);
+  BinaryWriter writer(static_cast<unsigned char*>(bi.ptr), capacity);
+  {
+    py::gil_scoped_release release;
+    cobj.serialize(writer);
+  }
+  return writer.size();
+}
+
+/* Read an object from a Python buffer. Without copying, the interpolation data
+   references the buffer which is kept alive by the returned object; anything
+   else holding the buffer must not modify it. */
+template<class C> py::object deserialize_from(py::buffer buffer, const bool copy){
+  py::buffer_info bi = buffer.request();
+  size_t size = contiguous_buffer_bytes(bi);
+  BinaryReader reader(static_cast<const unsigned char*>(bi.ptr), size);
+  py::object pyobj = py::cast(C::deserialize(reader, !copy));
+  if (!copy) py::setattr(pyobj, "_borrowed_buffer", buffer);
+  return pyobj;
+}
+
+// Serialize an object into a new bytes object
+template<class C> py::bytes serialize_to_bytes(const C& cobj){
+  size_t size = serialized_size(cobj);
+  py::bytes out = py::reinterpret_steal<py::bytes>(PyBytes_FromStringAndSize(nullptr, static_cast<ssize_t>(size)));
+  BinaryWriter writer(reinterpret_cast<unsigned char*>(PyBytes_AS_STRING(out.ptr())), size);
+  {
+    py::gil_scoped_release release;
+    cobj.serialize(writer);
+  }
+  return out;
+}
+
+/* Pickle support. For protocol 5 and above the serialized object is handed to
+   the pickler as a PickleBuffer, so that it can be transferred out-of-band
+   without further copies; earlier protocols get a bytes object. Unpickling
+   references the interpolation data in the pickled buffer rather than copying
+   it, and keeps the buffer alive alongside the object. */
+template<class C> py::tuple pickle_reduce_ex(py::object self, const int protocol){
+  const C& cobj = self.cast<const C&>();
+  py::object state;
+  if (protocol >= 5){
+    size_t size = serialized_size(cobj);
+    py::bytearray data = py::reinterpret_steal<py::bytearray>(PyByteArray_FromStringAndSize(nullptr, static_cast<ssize_t>(size)));
+    BinaryWriter writer(reinterpret_cast<unsigned char*>(PyByteArray_AS_STRING(data.ptr())), size);
+    {
+      py::gil_scoped_release release;
+      cobj.serialize(writer);
+    }
+    state = py::module::import("pickle").attr("PickleBuffer")(data);
+  } else {
+    state = serialize_to_bytes(cobj);
+  }
+  py::object newobj = py::module::import("copyreg").attr("__newobj__");
+  return py::make_tuple(newobj, py::make_tuple(self.attr("__class__")), state);
+}
+template<class C> std::pair<C, py::dict> pickle_setstate(py::buffer state){
+  py::buffer_info bi = state.request();
+  size_t size = contiguous_buffer_bytes(bi);
+  BinaryReader reader(static_cast<const unsigned char*>(bi.ptr), size);
+  py::dict attributes;
+  attributes["_borrowed_buffer"] = state;
+  return std::make_pair(C::deserialize(reader, true), attributes);
+}
+
+// Add serialization and pickling to a wrapped interpolator
+template<class C> void def_serialization(py::class_<C>& cls){
+  using namespace pybind11::literals;
+  cls.def_property_readonly("serialized_size",[](const C& cobj){return serialized_size(cobj);})
+  .def("to_buffer",[](const C& cobj, py::buffer buffer){return serialize_into(cobj, buffer);}, "buffer"_a)
+  .def_static("from_buffer",[](py::buffer buffer, const bool copy){
+    return deserialize_from<C>(buffer, copy);
+  }, "buffer"_a, "copy"_a=true)
+  .def("__reduce_ex__", &pickle_reduce_ex<C>)
+  .def(py::pickle(&serialize_to_bytes<C>, &pickle_setstate<C>));
+}
+
+#endif
@@ -1,8 +1,11 @@
 #!/usr/bin/env python3
 """Run tests of the interpolation functionality."""
 import os
+import pickle
 import sys
+import tempfile
 import unittest
+from concurrent.futures import ThreadPoolExecutor
 from importlib.util import find_spec
 import numpy as np
 
@@ -19,6 +22,12 @@ elif find_spec('_brille') is not None:
     import _brille as s
 else:
     raise Exception("Required brille module not found!")
+# The shared-memory helpers are only available from the installed package
+try:
+    from brille.shared import publish, attach, unpublish
+    HAS_SHARED = True
+except ImportError:
+    HAS_SHARED = False
 
 
 def sqwfunc_ones(Q):
@@ -266,6 +275,250 @@ class Interpolate (unittest.TestCase):
         antres = fe_dispersion(Q)
         self.assertTrue(np.isclose(intres, antres).all())
 
+    def test_j_concurrent_readers(self):
+        """Test that one grid can be interpolated from several threads at once."""
+        bzg = setup_grid()
+        Qi = define_Q_points(rand=True, N=1000)
+        bzg.fill(sqwfunc_ones(bzg.rlu), [1,], vecfun_ident(bzg.rlu), [0,3])
+        expected_vals, expected_vecs = bzg.interpolate_at(Qi)
+        with ThreadPoolExecutor(max_workers=4) as pool:
+            results = list(pool.map(lambda _: bzg.interpolate_at(Qi), range(8)))
+        for vals, vecs in results:
+            self.assertTrue(np.array_equal(vals, expected_vals))
+            self.assertTrue(np.array_equal(vecs, expected_vecs))
+
+    def test_k_strided_input_unchanged(self):
+        """Test that contiguous and strided Q give the same result and are not modified."""
+        bzg = setup_grid()
+        bzg.fill(sqwfunc_ones(bzg.rlu), [1,], vecfun_ident(bzg.rlu), [0,3])
+        Qi = define_Q_points(rand=True, N=100)
+        Qs = np.asfortranarray(Qi)
+        Qc = Qi.copy()
+        vals, vecs = bzg.interpolate_at(Qi)
+        strided_vals, strided_vecs = bzg.interpolate_at(Qs)
+        self.assertTrue(np.array_equal(vals, strided_vals))
+        self.assertTrue(np.array_equal(vecs, strided_vecs))
+        self.assertTrue(np.array_equal(Qi, Qc))
+        self.assertTrue(vals.flags['C_CONTIGUOUS'])
+        self.assertTrue(vecs.flags['C_CONTIGUOUS'])
+
+    def test_l_fill_without_copy(self):
+        """Test that filling by reference matches filling by copy."""
+        Qi = define_Q_points()
+        copied = setup_grid()
+        values = sqwfunc_ones(copied.rlu)
+        vectors = vecfun_ident(copied.rlu)
+        copied.fill(values, [1,], vectors, [0,3])
+        referenced = setup_grid()
+        referenced.fill(values, [1,], vectors, [0,3], copy=False)
+        self.assertFalse(values.flags['WRITEABLE'])
+        self.assertFalse(vectors.flags['WRITEABLE'])
+        for res, exp in zip(referenced.interpolate_at(Qi), copied.interpolate_at(Qi)):
+            self.assertTrue(np.array_equal(res, exp))
+        # a fill which fails part way must not release the arrays still in use
+        del values, vectors
+        with self.assertRaises(RuntimeError):
+            referenced.fill(sqwfunc_ones(referenced.rlu), [1,], vecfun_ident(referenced.rlu), [0,4], copy=False)
+        for res, exp in zip(referenced.interpolate_at(Qi), copied.interpolate_at(Qi)):
+            self.assertTrue(np.array_equal(res, exp))
+
+    @unittest.skipIf(not HAS_SHARED, "brille.shared requires the installed brille package")
+    def test_m_shared_trellis(self):
+        """Test that an attached trellis interpolates like the published one."""
+        rlat = s.Reciprocal((1, 1, 1), np.array([1, 1, 1])*np.pi/2)
+        trellis = s.BZTrellisQdd(s.BrillouinZone(rlat), 0.1)
+        trellis.fill(sqwfunc_ones(trellis.rlu), [1,], vecfun_ident(trellis.rlu), [0,3])
+        Qi = define_Q_points(rand=True, N=100)
+        expected = trellis.ir_interpolate_at(Qi)
+        handle = publish(trellis)
+        attached = None
+        try:
+            attached = attach(handle)
+            self.assertTrue(np.array_equal(attached.rlu, trellis.rlu))
+            for res, exp in zip(attached.ir_interpolate_at(Qi), expected):
+                self.assertTrue(np.array_equal(res, exp))
+        finally:
+            del attached
+            unpublish(handle)
+        with tempfile.TemporaryDirectory() as tmpdir:
+            handle = publish(trellis, os.path.join(tmpdir, 'trellis.brille'))
+            attached = attach(handle)
+            for res, exp in zip(attached.ir_interpolate_at(Qi), expected):
+                self.assertTrue(np.array_equal(res, exp))
+            del attached
+
+
+    def test_n_pickle(self):
+        """Test that unpickled interpolators interpolate like the originals."""
+        rlat = s.Reciprocal((1, 1, 1), np.array([1, 1, 1])*np.pi/2)
+        bz = s.BrillouinZone(rlat)
+        Qi = define_Q_points(rand=True, N=100)
+        for obj in (s.BZTrellisQdd(bz, 0.1), s.BZNestQdd(bz, 0.1),
+                    s.BZGridQdd(bz, np.array([2, 2, 2]))):
+            obj.fill(sqwfunc_ones(obj.rlu), [1,], vecfun_ident(obj.rlu), [0,3])
+            expected = obj.ir_interpolate_at(Qi)
+            for protocol in (None, 2, 4):
+                if protocol is not None and protocol > pickle.HIGHEST_PROTOCOL:
+                    continue
+                copy = pickle.loads(pickle.dumps(obj, protocol=protocol))
+                self.assertEqual(type(copy), type(obj))
+                self.assertTrue(np.array_equal(copy.rlu, obj.rlu))
+                for res, exp in zip(copy.ir_interpolate_at(Qi), expected):
+                    self.assertTrue(np.array_equal(res, exp))
+
+    @unittest.skipIf(pickle.HIGHEST_PROTOCOL < 5, "out-of-band pickling requires protocol 5")
+    def test_n_pickle_out_of_band(self):
+        """Test that protocol 5 pickles the data out-of-band."""
+        rlat = s.Reciprocal((1, 1, 1), np.array([1, 1, 1])*np.pi/2)
+        bz = s.BrillouinZone(rlat)
+        Qi = define_Q_points(rand=True, N=100)
+        for obj in (s.BZTrellisQdd(bz, 0.1), s.BZNestQdd(bz, 0.1),
+                    s.BZGridQdd(bz, np.array([2, 2, 2]))):
+            obj.fill(sqwfunc_ones(obj.rlu), [1,], vecfun_ident(obj.rlu), [0,3])
+            expected = obj.ir_interpolate_at(Qi)
+            buffers = []
+            data = pickle.dumps(obj, protocol=5, buffer_callback=buffers.append)
+            self.assertEqual(len(buffers), 1)
+            self.assertLess(len(data), 1024)
+            copy = pickle.loads(data, buffers=buffers)
+            self.assertEqual(type(copy), type(obj))
+            self.assertTrue(np.array_equal(copy.rlu, obj.rlu))
+            for res, exp in zip(copy.ir_interpolate_at(Qi), expected):
+                self.assertTrue(np.array_equal(res, exp))
+
+    def test_o_profile(self):
+        """Test that profiling records the stages of the last call."""
+        rlat = s.Reciprocal((1, 1, 1), np.array([1, 1, 1])*np.pi/2)
+        trellis = s.BZTrellisQdd(s.BrillouinZone(rlat), 0.1)
+        trellis.fill(sqwfunc_ones(trellis.rlu), [1,], vecfun_ident(trellis.rlu), [0,3])
+        Qi = define_Q_points(rand=True, N=100)
+        s.reset_profile()
+        s.set_profiling(True)
+        try:
+            trellis.ir_interpolate_at(Qi, useparallel=True, threads=2)
+            last = s.profile()
+            self.assertEqual(last['counts']['points'], 100)
+            self.assertEqual(last['counts']['not_found'], 0)
+            self.assertGreater(last['counts']['permutation_solves'], 0)
+            for stage in ('ir_moveinto', 'locate', 'permute', 'sum', 'rotate'):
+                self.assertGreater(last['seconds'][stage], 0)
+            trellis.ir_interpolate_at(Qi)
+            self.assertEqual(s.profile(cumulative=True)['counts']['points'], 200)
+        finally:
+            s.set_profiling(False)
+            s.reset_profile()
+
+    def test_p_memory_usage(self):
+        """Test that memory usage reports the filled data."""
+        rlat = s.Reciprocal((1, 1, 1), np.array([1, 1, 1])*np.pi/2)
+        trellis = s.BZTrellisQdd(s.BrillouinZone(rlat), 0.1)
+        empty = trellis.memory_usage()
+        self.assertGreaterEqual(empty['vertices'], trellis.rlu.size*8)
+        self.assertEqual(empty['values'], 0)
+        trellis.fill(sqwfunc_ones(trellis.rlu), [1,], vecfun_ident(trellis.rlu), [0,3])
+        filled = trellis.memory_usage()
+        self.assertEqual(filled['values'], trellis.rlu.shape[0]*8)
+        self.assertEqual(filled['vectors'], trellis.rlu.size*8)
+        self.assertEqual(filled['total'], sum(v for k, v in filled.items() if k not in ('total', 'borrowed')))
+
+    def test_q_status(self):
+        """Test that per-point status replaces all-or-nothing exceptions."""
+        rlat = s.Reciprocal((1, 1, 1), np.array([1, 1, 1])*np.pi/2)
+        trellis = s.BZTrellisQdd(s.BrillouinZone(rlat), 0.1)
+        trellis.fill(sqwfunc_ones(trellis.rlu), [1,], vecfun_ident(trellis.rlu), [0,3])
+        Q = (np.random.rand(2, 5, 3) - 0.5) * 10
+        vals, vecs, status = trellis.ir_interpolate_at(Q, return_status=True)
+        self.assertEqual(status.shape, Q.shape[:-1])
+        self.assertTrue(np.all(status <= int(s.PointStatus.nudged)))
+        # without moving them, points outside of the irreducible wedge are not found
+        Q = np.concatenate((trellis.rlu[:2], [[100, 100, 100]]))
+        with self.assertRaises(RuntimeError):
+            trellis.interpolate_at(Q, do_not_move_points=True)
+        for parallel in (False, True):
+            vals, vecs, status = trellis.interpolate_at(Q, parallel, do_not_move_points=True, return_status=True)
+            self.assertEqual(status[2], int(s.PointStatus.not_found))
+            self.assertTrue(np.all(status[:2] <= int(s.PointStatus.nudged)))
+            self.assertTrue(np.all(vals[2] == 0))
+
+    def test_r_prepared_q(self):
+        """Test that prepared points can be reused by interpolators sharing a zone."""
+        rlat = s.Reciprocal((1, 1, 1), np.array([1, 1, 1])*np.pi/2)
+        bz = s.BrillouinZone(rlat)
+        Q = (np.random.rand(4, 5, 3) - 0.5) * 10
+        prepared = s.PreparedQ(bz, Q)
+        self.assertEqual(len(prepared), 20)
+        self.assertEqual(prepared.ir_q.shape, Q.shape)
+        self.assertEqual(prepared.status.shape, Q.shape[:-1])
+        self.assertTrue(prepared.matches(bz))
+        for interpolator in (s.BZTrellisQdd(bz, 0.1), s.BZNestQdd(bz, 0.1)):
+            interpolator.fill(sqwfunc_ones(interpolator.rlu), [1,], vecfun_ident(interpolator.rlu), [0,3])
+            direct = interpolator.ir_interpolate_at(Q)
+            reused = interpolator.ir_interpolate_at(prepared)
+            for d, r in zip(direct, reused):
+                self.assertEqual(d.shape, r.shape)
+                self.assertTrue(np.allclose(d, r))
+
+    def test_s_interpolation_plan(self):
+        """Test that a plan follows replaced data and matches direct interpolation."""
+        rlat = s.Reciprocal((1, 1, 1), np.array([1, 1, 1])*np.pi/2)
+        bz = s.BrillouinZone(rlat)
+        Q = (np.random.rand(4, 5, 3) - 0.5) * 10
+        prepared = s.PreparedQ(bz, Q)
+        for interpolator in (s.BZTrellisQdd(bz, 0.1), s.BZNestQdd(bz, 0.1)):
+            interpolator.fill(sqwfunc_ones(interpolator.rlu), [1,], vecfun_ident(interpolator.rlu), [0,3])
+            plan = interpolator.ir_plan(prepared)
+            self.assertEqual(len(plan), 20)
+            self.assertEqual(plan.status.shape, Q.shape[:-1])
+            self.assertFalse(plan.has_permutations)
+            for scale in (1, 2):
+                interpolator.fill(scale*sqwfunc_ones(interpolator.rlu), [1,], vecfun_ident(interpolator.rlu), [0,3])
+                direct = interpolator.ir_interpolate_at(prepared)
+                planned = interpolator.ir_execute(prepared, plan)
+                for d, p in zip(direct, planned):
+                    self.assertEqual(d.shape, p.shape)
+                    self.assertTrue(np.allclose(d, p))
+
+    def test_t_deduplicate(self):
+        """Test that symmetry-equivalent points are interpolated once with identical results."""
+        # Pm-3m, with a point group of order 48
+        rlat = s.Reciprocal((1, 1, 1), np.array([1, 1, 1])*np.pi/2, 529)
+        bz = s.BrillouinZone(rlat)
+        base = (np.random.rand(10, 3) - 0.5) * 10
+        Q = np.concatenate((base, -base, base[:, [1, 2, 0]]))
+        prepared = s.PreparedQ(bz, Q, deduplicate=True)
+        self.assertEqual(len(prepared), 30)
+        self.assertLess(prepared.unique_count, 30)
+        trellis = s.BZTrellisQdd(bz, 0.1)
+        trellis.fill(sqwfunc_ones(trellis.rlu), [1,], vecfun_ident(trellis.rlu), [0,3])
+        direct = trellis.ir_interpolate_at(Q)
+        for deduplicated in (trellis.ir_interpolate_at(Q, deduplicate=True), trellis.ir_interpolate_at(prepared)):
+            for d, u in zip(direct, deduplicated):
+                self.assertEqual(d.shape, u.shape)
+                self.assertTrue(np.allclose(d, u))
+
+    def test_u_cache(self):
+        """Test that repeated queries are served from the result cache."""
+        rlat = s.Reciprocal((1, 1, 1), np.array([1, 1, 1])*np.pi/2)
+        bz = s.BrillouinZone(rlat)
+        Q = (np.random.rand(20, 3) - 0.5) * 10
+        for interpolator in (s.BZTrellisQdd(bz, 0.1), s.BZNestQdd(bz, 0.1)):
+            interpolator.fill(sqwfunc_ones(interpolator.rlu), [1,], vecfun_ident(interpolator.rlu), [0,3])
+            direct = interpolator.ir_interpolate_at(Q)
+            self.assertEqual(interpolator.cache_statistics['capacity'], 0)
+            interpolator.set_cache(1000)
+            for _ in range(2):
+                cached = interpolator.ir_interpolate_at(Q)
+                for d, c in zip(direct, cached):
+                    self.assertTrue(np.allclose(d, c))
+            stats = interpolator.cache_statistics
+            self.assertEqual(stats['misses'], 20)
+            self.assertEqual(stats['hits'], 20)
+            interpolator.fill(2*sqwfunc_ones(interpolator.rlu), [1,], vecfun_ident(interpolator.rlu), [0,3])
+            cached = interpolator.ir_interpolate_at(Q)
+            self.assertTrue(np.allclose(2*direct[0], cached[0]))
+            self.assertEqual(interpolator.cache_statistics['invalidations'], 1)
+            interpolator.clear_cache()
+            self.assertEqual(interpolator.cache_statistics['size'], 0)
 
 if __name__ == '__main__':
     unittest.main()